@@ -9,7 +9,8 @@
 #include <assert.h>
 #include <stdlib.h>
 
-#if defined(__GNUC__) && !defined(_WIN32) && !defined(__cplusplus)
+/* the inline co_switch addresses co_active_handle directly, not per thread */
+#if defined(__GNUC__) && !defined(_WIN32) && !defined(__cplusplus) && !defined(LIBCO_MP)
 #define CO_USE_INLINE_ASM
 #endif
 
@@ -10,16 +10,21 @@
 
 #include <libco.h>
 
+#include "uae_types.h"
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #endif
 
-extern cothread_t mainThread;
-extern cothread_t emuThread;
-extern int retrow; 
-extern int retroh;
+extern UAE_TLS cothread_t mainThread;
+extern UAE_TLS cothread_t emuThread;
+extern UAE_TLS int retrow; 
+extern UAE_TLS int retroh;
 extern bool retro_update_av_info(bool, bool, bool);
+extern bool retro_frameskip_auto(void);
+extern bool retro_frameskip_check(void);
+extern bool retro_picasso_screen(const void **, int *, int *, int *);
 
 #define LOGI printf
 
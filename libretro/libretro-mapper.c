@@ -15,6 +15,7 @@
 #include "gui.h"
 #include "xwin.h"
 #include "disk.h"
+#include "hostprof.h"
 
 #ifdef __CELLOS_LV2__
 #include "sys/sys_time.h"
@@ -37,8 +38,8 @@ void gettimeofday (struct timeval *tv, void *blah)
 #include <time.h>
 #endif
 
-unsigned short int bmp[1024*1024];
-unsigned short int savebmp[1024*1024];
+UAE_TLS unsigned short int bmp[1024*1024];
+UAE_TLS unsigned short int savebmp[1024*1024];
 
 // Mouse speed flags
 #define MOUSE_SPEED_SLOWER 1
@@ -47,26 +48,24 @@ unsigned short int savebmp[1024*1024];
 #define MOUSE_SPEED_SLOW 5
 #define MOUSE_SPEED_FAST 2
 
-int NPAGE=-1;
-int SHIFTON=-1,ALTON=-1;
-int MOUSEMODE=-1,SHOWKEY=-1,SHOWKEYPOS=-1,SHOWKEYTRANS=-1,STATUSON=-1,LEDON=-1;
-
-char RPATH[512];
-
-int analog_left[2];
-int analog_right[2];
-unsigned int mouse_speed[2]={0};
-int slowdown=0;
-extern int pix_bytes;
-extern bool fake_ntsc;
-extern bool real_ntsc;
-
-int vkflag[7]={0};
-static int jflag[4][16]={0};
-static int kjflag[2][16]={0};
-static int mflag[2][16]={0};
-static int jbt[2][24]={0};
-static int kbt[16]={0};
+UAE_TLS int NPAGE=-1;
+UAE_TLS int SHIFTON=-1,ALTON=-1;
+UAE_TLS int MOUSEMODE=-1,SHOWKEY=-1,SHOWKEYPOS=-1,SHOWKEYTRANS=-1,STATUSON=-1,LEDON=-1;
+
+UAE_TLS int analog_left[2];
+UAE_TLS int analog_right[2];
+UAE_TLS unsigned int mouse_speed[2]={0};
+UAE_TLS int slowdown=0;
+extern UAE_TLS int pix_bytes;
+extern UAE_TLS bool fake_ntsc;
+extern UAE_TLS bool real_ntsc;
+
+UAE_TLS int vkflag[7]={0};
+static UAE_TLS int jflag[4][16]={0};
+static UAE_TLS int kjflag[2][16]={0};
+static UAE_TLS int mflag[2][16]={0};
+static UAE_TLS int jbt[2][24]={0};
+static UAE_TLS int kbt[16]={0};
 
 extern void reset_drawing(void);
 extern void retro_key_up(int);
@@ -75,25 +74,25 @@ extern void retro_mouse(int, int, int);
 extern void retro_mouse_button(int, int, int);
 extern void retro_joystick(int, int, int);
 extern void retro_joystick_button(int, int, int);
-extern unsigned int uae_devices[4];
-extern int mapper_keys[32];
-extern int video_config;
-extern int video_config_aspect;
-extern int zoom_mode_id;
-extern bool request_update_av_info;
-extern bool opt_enhanced_statusbar;
-extern int opt_statusbar_position;
-extern unsigned int opt_analogmouse;
-extern unsigned int opt_analogmouse_deadzone;
-extern float opt_analogmouse_speed;
-extern unsigned int opt_dpadmouse_speed;
-extern bool opt_multimouse;
-extern bool opt_keyrahkeypad;
-extern bool opt_keyboard_pass_through;
-int turbo_fire_button=-1;
-unsigned int turbo_pulse=2;
-unsigned int turbo_state[5]={0};
-unsigned int turbo_toggle[5]={0};
+extern UAE_TLS unsigned int uae_devices[4];
+extern UAE_TLS int mapper_keys[32];
+extern UAE_TLS int video_config;
+extern UAE_TLS int video_config_aspect;
+extern UAE_TLS int zoom_mode_id;
+extern UAE_TLS bool request_update_av_info;
+extern UAE_TLS bool opt_enhanced_statusbar;
+extern UAE_TLS int opt_statusbar_position;
+extern UAE_TLS unsigned int opt_analogmouse;
+extern UAE_TLS unsigned int opt_analogmouse_deadzone;
+extern UAE_TLS float opt_analogmouse_speed;
+extern UAE_TLS unsigned int opt_dpadmouse_speed;
+extern UAE_TLS bool opt_multimouse;
+extern UAE_TLS bool opt_keyrahkeypad;
+extern UAE_TLS bool opt_keyboard_pass_through;
+UAE_TLS int turbo_fire_button=-1;
+UAE_TLS unsigned int turbo_pulse=2;
+UAE_TLS unsigned int turbo_state[5]={0};
+UAE_TLS unsigned int turbo_toggle[5]={0};
 
 enum EMU_FUNCTIONS {
    EMU_VKBD = 0,
@@ -109,9 +108,9 @@ enum EMU_FUNCTIONS {
 /* VKBD_MOVE_DELAY: Delay between automatic movement from button to button */
 #define VKBD_MIN_HOLDING_TIME 200
 #define VKBD_MOVE_DELAY 50
-bool let_go_of_direction = true;
-long last_move_time = 0;
-long last_press_time = 0;
+UAE_TLS bool let_go_of_direction = true;
+UAE_TLS long last_move_time = 0;
+UAE_TLS long last_press_time = 0;
 
 void emu_function(int function) {
    switch (function)
@@ -151,20 +150,20 @@ void emu_function(int function) {
    }
 }
 
-int STAT_BASEY;
-int STAT_DECX=4;
-int FONT_WIDTH=1;
-int FONT_HEIGHT=1;
-int BOX_PADDING=2;
-int BOX_Y;
-int BOX_WIDTH;
-int BOX_HEIGHT=11;
+UAE_TLS int STAT_BASEY;
+UAE_TLS int STAT_DECX=4;
+UAE_TLS int FONT_WIDTH=1;
+UAE_TLS int FONT_HEIGHT=1;
+UAE_TLS int BOX_PADDING=2;
+UAE_TLS int BOX_Y;
+UAE_TLS int BOX_WIDTH;
+UAE_TLS int BOX_HEIGHT=11;
 
-extern char key_state[512];
-extern char key_state2[512];
+extern UAE_TLS char key_state[512];
+extern UAE_TLS char key_state2[512];
 
-static retro_input_state_t input_state_cb;
-static retro_input_poll_t input_poll_cb;
+static UAE_TLS retro_input_state_t input_state_cb;
+static UAE_TLS retro_input_poll_t input_poll_cb;
 
 void retro_set_input_state(retro_input_state_t cb)
 {
@@ -205,7 +204,7 @@ long GetTicks(void)
 
 char* joystick_value_human(int val[16])
 {
-    static char str[4];
+    static UAE_TLS char str[4];
     sprintf(str, "%3s", "   ");
 
     if (val[RETRO_DEVICE_ID_JOYPAD_UP])
@@ -378,6 +377,38 @@ void Print_Status(void)
    }
 }
 
+void Print_Hostprof(void)
+{
+   static const char *labels[HOSTPROF_MAX] = { "CPU", "BLT", "COP", "AUD", "DSK", "GFX" };
+   char str[80] = { 0 };
+   int i, y, width;
+
+   // Milliseconds per frame, averaged
+   for (i = 0; i < HOSTPROF_MAX; i++)
+      sprintf(str + strlen(str), "%s%u.%u ", labels[i], hostprof_avg_us[i] / 1000, (hostprof_avg_us[i] % 1000) / 100);
+   // Lines not redrawn because they did not change
+   sprintf(str + strlen(str), "RE%u%%", hostprof_avg_reuse);
+
+   // Keep clear of a statusbar at the top
+   y = BOX_PADDING;
+   if (STATUSON == 1 && opt_statusbar_position < 0)
+      y += BOX_HEIGHT;
+   width = STAT_DECX * 2 + strlen(str) * 7;
+   if (width > retrow)
+      width = retrow;
+
+   if (pix_bytes == 4)
+   {
+      DrawFBoxBmp32((uint32_t *)bmp,0,y-BOX_PADDING,width,BOX_HEIGHT,RGB888(0,0,0));
+      Draw_text32((uint32_t *)bmp,STAT_DECX,y,0xffffff,0x0000,FONT_WIDTH,FONT_HEIGHT,60,str);
+   }
+   else
+   {
+      DrawFBoxBmp(bmp,0,y-BOX_PADDING,width,BOX_HEIGHT,RGB565(0,0,0));
+      Draw_text(bmp,STAT_DECX,y,0xffff,0x0000,FONT_WIDTH,FONT_HEIGHT,60,str);
+   }
+}
+
 void Screen_SetFullUpdate(void)
 {
    reset_drawing();
@@ -796,12 +827,12 @@ void update_input(int disable_physical_cursor_keys)
    // RETRO    B   Y   SLT STA UP  DWN LFT RGT A   X   L   R   L2  R2  L3  R3  LR  LL  LD  LU  RR  RL  RD  RU
    // INDEX    0   1   2   3   4   5   6   7   8   9   10  11  12  13  14  15  16  17  18  19  20  21  22  23
 
-   static int i, j, mk;
-   static int oldi=-1;
-   static int vkx=0,vky=0;
+   static UAE_TLS int i, j, mk;
+   static UAE_TLS int oldi=-1;
+   static UAE_TLS int vkx=0,vky=0;
 
-   static int LX, LY, RX, RY;
-   static int threshold=20000;
+   static UAE_TLS int LX, LY, RX, RY;
+   static UAE_TLS int threshold=20000;
 
    /* Keyup only after button is up */
    if (oldi!=-1 && vkflag[4]!=1)
@@ -1190,13 +1221,13 @@ void retro_poll_event()
    /* override keydown, but allow keyup, to prevent key sticking during keyboard use, if held down on opening keyboard */
    /* keyup allowing most likely not needed on actual keyboard presses even though they get stuck also */
    {
-      static float mouse_multiplier=1;
-      static int dpadmouse_speed;
-      static int uae_mouse_x[2],uae_mouse_y[2];
-      static int uae_mouse_l[2]={0},uae_mouse_r[2]={0},uae_mouse_m[2]={0};
-      static int mouse_lmb[2]={0},mouse_rmb[2]={0},mouse_mmb[2]={0};
-      static int16_t mouse_x[2]={0},mouse_y[2]={0};
-      static int i=0,j=0;
+      static UAE_TLS float mouse_multiplier=1;
+      static UAE_TLS int dpadmouse_speed;
+      static UAE_TLS int uae_mouse_x[2],uae_mouse_y[2];
+      static UAE_TLS int uae_mouse_l[2]={0},uae_mouse_r[2]={0},uae_mouse_m[2]={0};
+      static UAE_TLS int mouse_lmb[2]={0},mouse_rmb[2]={0},mouse_mmb[2]={0};
+      static UAE_TLS int16_t mouse_x[2]={0},mouse_y[2]={0};
+      static UAE_TLS int i=0,j=0;
 
       int retro_port;
       for (retro_port = 0; retro_port <= 3; retro_port++)
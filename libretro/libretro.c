@@ -5,6 +5,7 @@
 #include "retro_files.h"
 #include "retro_strings.h"
 #include "retro_disk_control.h"
+#include "retro_prefs.h"
 #include "uae_types.h"
 
 #include "sysdeps.h"
@@ -13,6 +14,12 @@
 #include "inputdevice.h"
 #include "savestate.h"
 #include "custom.h"
+#include "hostprof.h"
+#include "romshare.h"
+#include "statehash.h"
+#include "lockstep.h"
+#include "inputrecord.h"
+#include "debug.h"
 
 #define EMULATOR_DEF_WIDTH 720
 #define EMULATOR_DEF_HEIGHT 568
@@ -26,66 +33,103 @@
 #error EMULATOR_DEF_WIDTH || EMULATOR_DEF_HEIGHT
 #endif
 
-cothread_t mainThread;
-cothread_t emuThread;
-
-int defaultw = EMULATOR_DEF_WIDTH;
-int defaulth = EMULATOR_DEF_HEIGHT;
-int retrow = 0;
-int retroh = 0;
-char key_state[512];
-char key_state2[512];
-bool opt_use_whdload_hdf = true;
-bool opt_enhanced_statusbar = true;
-int opt_statusbar_position = 0;
-int opt_statusbar_position_old = 0;
-int opt_statusbar_position_offset = 0;
-int opt_statusbar_position_offset_lores = 0;
-bool opt_keyrahkeypad = false;
-bool opt_keyboard_pass_through = false;
-bool opt_multimouse = false;
-unsigned int opt_dpadmouse_speed = 4;
-unsigned int opt_analogmouse = 0;
-unsigned int opt_analogmouse_deadzone = 15;
-float opt_analogmouse_speed = 1.0;
-extern int turbo_fire_button;
-extern unsigned int turbo_pulse;
-int pix_bytes = 2;
-static bool pix_bytes_initialized = false;
-bool fake_ntsc = false;
-bool real_ntsc = false;
-bool request_update_av_info = false;
-int zoom_mode_id = 0;
-int zoomed_height;
+UAE_TLS cothread_t mainThread;
+UAE_TLS cothread_t emuThread;
+
+UAE_TLS int defaultw = EMULATOR_DEF_WIDTH;
+UAE_TLS int defaulth = EMULATOR_DEF_HEIGHT;
+UAE_TLS int retrow = 0;
+UAE_TLS int retroh = 0;
+UAE_TLS char key_state[512];
+UAE_TLS char key_state2[512];
+UAE_TLS bool opt_use_whdload_hdf = true;
+UAE_TLS bool opt_enhanced_statusbar = true;
+UAE_TLS int opt_statusbar_position = 0;
+UAE_TLS int opt_statusbar_position_old = 0;
+UAE_TLS int opt_statusbar_position_offset = 0;
+UAE_TLS int opt_statusbar_position_offset_lores = 0;
+UAE_TLS bool opt_keyrahkeypad = false;
+UAE_TLS bool opt_keyboard_pass_through = false;
+UAE_TLS bool opt_multimouse = false;
+UAE_TLS unsigned int opt_dpadmouse_speed = 4;
+UAE_TLS unsigned int opt_analogmouse = 0;
+UAE_TLS unsigned int opt_analogmouse_deadzone = 15;
+UAE_TLS float opt_analogmouse_speed = 1.0;
+extern UAE_TLS int turbo_fire_button;
+extern UAE_TLS unsigned int turbo_pulse;
+UAE_TLS int pix_bytes = 2;
+static UAE_TLS bool pix_bytes_initialized = false;
+UAE_TLS bool fake_ntsc = false;
+UAE_TLS bool real_ntsc = false;
+UAE_TLS bool request_update_av_info = false;
+UAE_TLS int zoom_mode_id = 0;
+UAE_TLS int zoomed_height;
 
 #if defined(NATMEM_OFFSET)
 extern uae_u8 *natmem_offset;
 extern uae_u32 natmem_size;
 #endif
-extern unsigned short int bmp[EMULATOR_MAX_WIDTH*EMULATOR_MAX_HEIGHT];
-extern unsigned short int savebmp[EMULATOR_MAX_WIDTH*EMULATOR_MAX_HEIGHT];
-extern int SHIFTON;
-extern int STATUSON;
-extern char RPATH[512];
+extern UAE_TLS unsigned short int bmp[EMULATOR_MAX_WIDTH*EMULATOR_MAX_HEIGHT];
+extern UAE_TLS unsigned short int savebmp[EMULATOR_MAX_WIDTH*EMULATOR_MAX_HEIGHT];
+extern UAE_TLS int SHIFTON;
+extern UAE_TLS int STATUSON;
 extern void Print_Status(void);
-static int firstpass = 1;
-extern int prefs_changed;
-int opt_vertical_offset = 0;
-bool opt_vertical_offset_auto = true;
-extern int minfirstline;
-extern int thisframe_first_drawn_line;
-static int thisframe_first_drawn_line_old = -1;
-extern int thisframe_last_drawn_line;
-static int thisframe_last_drawn_line_old = -1;
-extern int thisframe_y_adjust;
-static int thisframe_y_adjust_old = 0;
-static int thisframe_y_adjust_update_frame_timer = 3;
-unsigned int video_config = 0;
-unsigned int video_config_old = 0;
-unsigned int video_config_aspect = 0;
-unsigned int video_config_geometry = 0;
-unsigned int video_config_allow_hz_change = 0;
-unsigned int inputdevice_finalized = 0;
+extern void Print_Hostprof(void);
+extern void dump_counts(void);
+static UAE_TLS int firstpass = 1;
+extern UAE_TLS int prefs_changed;
+UAE_TLS int opt_vertical_offset = 0;
+UAE_TLS bool opt_vertical_offset_auto = true;
+extern UAE_TLS int minfirstline;
+extern UAE_TLS int thisframe_first_drawn_line;
+static UAE_TLS int thisframe_first_drawn_line_old = -1;
+extern UAE_TLS int thisframe_last_drawn_line;
+static UAE_TLS int thisframe_last_drawn_line_old = -1;
+extern UAE_TLS int thisframe_y_adjust;
+static UAE_TLS int thisframe_y_adjust_old = 0;
+static UAE_TLS int thisframe_y_adjust_update_frame_timer = 3;
+UAE_TLS unsigned int video_config = 0;
+UAE_TLS unsigned int video_config_old = 0;
+UAE_TLS unsigned int video_config_aspect = 0;
+UAE_TLS unsigned int video_config_geometry = 0;
+UAE_TLS unsigned int video_config_allow_hz_change = 0;
+UAE_TLS unsigned int video_config_line_doubling = 1;
+UAE_TLS unsigned int inputdevice_finalized = 0;
+
+/* Automatic frameskip */
+#define PUAE_FRAMESKIP_FIXED     0
+#define PUAE_FRAMESKIP_AUTO      1
+#define PUAE_FRAMESKIP_THRESHOLD 2
+UAE_TLS unsigned int opt_frameskip_type = PUAE_FRAMESKIP_FIXED;
+UAE_TLS unsigned int opt_frameskip_threshold = 33;
+UAE_TLS unsigned int opt_frameskip_max = 3;
+UAE_TLS unsigned int frameskip_counter_skipped = 0;
+UAE_TLS unsigned int frameskip_counter_total = 0;
+static UAE_TLS unsigned int frameskip_consecutive = 0;
+static UAE_TLS bool frameskip_active = false;
+static UAE_TLS bool frameskip_last_skipped = false;
+static UAE_TLS bool retro_can_dupe = false;
+static UAE_TLS bool retro_audio_buff_active = false;
+
+static UAE_TLS bool opt_lockstep_selftest = false;
+static UAE_TLS unsigned retro_audio_buff_occupancy = 0;
+static UAE_TLS bool retro_audio_buff_underrun = false;
+static UAE_TLS unsigned retro_audio_latency = 0;
+static UAE_TLS bool update_audio_latency = false;
+
+/* Host time per subsystem */
+#define PUAE_HOSTPROF_OVERLAY 0x01
+#define PUAE_HOSTPROF_CSV     0x02
+#define LIBRETRO_PUAE_HOSTPROF "puae_hostprof.csv"
+#define LIBRETRO_PUAE_PCPROF "puae_pcprof.txt"
+UAE_TLS unsigned int opt_hostprof = 0;
+
+/* Input recording, replays can be seeked with retro_replay_seek() */
+#define PUAE_REPLAY_RECORD 1
+#define PUAE_REPLAY_PLAY   2
+#define LIBRETRO_PUAE_REPLAY "puae_replay.inp"
+static UAE_TLS unsigned int opt_input_replay = 0;
+static UAE_TLS unsigned int input_replay_mode = 0;
 
 #include "libretro-keyboard.i"
 int keyId(const char *val)
@@ -101,11 +145,11 @@ int keyId(const char *val)
 }
 
 extern void retro_poll_event(void);
-unsigned int uae_devices[4];
-extern int cd32_pad_enabled[NORMAL_JPORTS];
+UAE_TLS unsigned int uae_devices[4];
+extern UAE_TLS int cd32_pad_enabled[NORMAL_JPORTS];
 
-int mapper_keys[31]={0};
-static char buf[64][4096]={0};
+UAE_TLS int mapper_keys[31]={0};
+static UAE_TLS char buf[128][4096]={0};
 
 #ifdef WIN32
 #define DIR_SEP_STR "\\"
@@ -113,70 +157,87 @@ static char buf[64][4096]={0};
 #define DIR_SEP_STR "/"
 #endif
 
-static retro_video_refresh_t video_cb;
-static retro_audio_sample_t audio_cb;
-static retro_audio_sample_batch_t audio_batch_cb;
-static retro_environment_t environ_cb;
+static UAE_TLS retro_video_refresh_t video_cb;
+static UAE_TLS retro_audio_sample_t audio_cb;
+static UAE_TLS retro_audio_sample_batch_t audio_batch_cb;
+static UAE_TLS retro_environment_t environ_cb;
 
-const char *retro_save_directory;
-const char *retro_system_directory;
-const char *retro_content_directory;
+UAE_TLS const char *retro_save_directory;
+UAE_TLS const char *retro_system_directory;
+UAE_TLS const char *retro_content_directory;
 
 // Disk control context
-static dc_storage* dc;
-
-// Amiga models
-// chipmem_size 1 = 0.5MB, 2 = 1MB, 4 = 2MB
-// bogomem_size 2 = 0.5MB, 4 = 1MB, 6 = 1.5MB, 7 = 1.8MB
-
-#define A500 "\
-cpu_type=68000\n\
-chipmem_size=1\n\
-bogomem_size=2\n\
-chipset_compatible=A500\n\
-chipset=ocs\n"
-
-#define A500OG "\
-cpu_type=68000\n\
-chipmem_size=1\n\
-bogomem_size=0\n\
-chipset_compatible=A500\n\
-chipset=ocs\n"
-
-#define A500PLUS "\
-cpu_type=68000\n\
-chipmem_size=2\n\
-bogomem_size=4\n\
-chipset_compatible=A500+\n\
-chipset=ecs\n"
-
-#define A600 "\
-cpu_type=68000\n\
-chipmem_size=4\n\
-fastmem_size=8\n\
-chipset_compatible=A600\n\
-chipset=ecs\n"
-
-#define A1200 "\
-cpu_type=68ec020\n\
-chipmem_size=4\n\
-fastmem_size=8\n\
-chipset_compatible=A1200\n\
-chipset=aga\n"
-
-#define A1200OG "\
-cpu_type=68ec020\n\
-chipmem_size=4\n\
-fastmem_size=0\n\
-chipset_compatible=A1200\n\
-chipset=aga\n"
-
+static UAE_TLS dc_storage* dc;
 
 // Amiga kickstarts
 #define A500_ROM    "kick34005.A500"
 #define A500KS2_ROM "kick37175.A500"
 #define A600_ROM    "kick40063.A600"
 #define A1200_ROM   "kick40068.A1200"
+#define CD32_ROM    "kick40060.CD32"
+#define CD32EXT_ROM "kick40060.CD32.ext"
+
+// Amiga models, memory sizes of -1 keep the emulator default
+struct retro_model {
+   const char *name;
+   int cpu_model;
+   bool cpu_24bit;
+   int chipmem;
+   int bogomem;
+   int fastmem;
+   int cs_compatible;
+   int chipset_mask;
+   const char *kickstart;
+   const char *kickstart_ext;
+};
+
+static const struct retro_model retro_models[] = {
+   { "A500",     68000, false, 0x080000, 0x080000, -1,       CP_A500,  0, A500_ROM },
+   { "A500OG",   68000, false, 0x080000, 0,        -1,       CP_A500,  0, A500_ROM },
+   { "A500PLUS", 68000, false, 0x100000, 0x100000, -1,       CP_A500P, CSMASK_ECS_AGNUS | CSMASK_ECS_DENISE, A500KS2_ROM },
+   { "A600",     68000, false, 0x200000, -1,       0x800000, CP_A600,  CSMASK_ECS_AGNUS | CSMASK_ECS_DENISE, A600_ROM },
+   { "A1200",    68020, true,  0x200000, -1,       0x800000, CP_A1200, CSMASK_AGA | CSMASK_ECS_AGNUS | CSMASK_ECS_DENISE, A1200_ROM },
+   { "A1200OG",  68020, true,  0x200000, -1,       0,        CP_A1200, CSMASK_AGA | CSMASK_ECS_AGNUS | CSMASK_ECS_DENISE, A1200_ROM },
+   { "CD32",     68020, true,  0x200000, 0,        0,        CP_CD32,  CSMASK_AGA | CSMASK_ECS_AGNUS | CSMASK_ECS_DENISE, CD32_ROM, CD32EXT_ROM },
+   { NULL }
+};
+
+static const struct retro_model *retro_model_find(const char *name)
+{
+   for (const struct retro_model *m = retro_models; m->name; m++)
+      if (strcmp(m->name, name) == 0)
+         return m;
+   return NULL;
+}
+
+static void retro_prefs_model(struct retro_prefs *rp, const struct retro_model *m)
+{
+   if (!m)
+      return;
+   retro_prefs_int(rp, PREF_CPU_MODEL, m->cpu_model);
+   if (m->cpu_24bit)
+      retro_prefs_int(rp, PREF_CPU_24BIT, 1);
+   retro_prefs_int(rp, PREF_CHIPMEM, m->chipmem);
+   if (m->bogomem >= 0)
+      retro_prefs_int(rp, PREF_BOGOMEM, m->bogomem);
+   if (m->fastmem >= 0)
+      retro_prefs_int(rp, PREF_FASTMEM, m->fastmem);
+   retro_prefs_int(rp, PREF_CHIPSET_COMPAT, m->cs_compatible);
+   retro_prefs_int(rp, PREF_CHIPSET_MASK, m->chipset_mask);
+}
+
+static void retro_prefs_roms(struct retro_prefs *rp, const struct retro_model *m)
+{
+   char path[RETRO_PATH_MAX];
+
+   path_join((char*)&path, retro_system_directory, m ? m->kickstart : "");
+   retro_prefs_string(rp, PREF_KICKSTART, 0, path);
+   if (m && m->kickstart_ext)
+   {
+      path_join((char*)&path, retro_system_directory, m->kickstart_ext);
+      retro_prefs_string(rp, PREF_KICKSTART_EXT, 0, path);
+   }
+}
 
 #define PUAE_VIDEO_PAL 		0x01
 #define PUAE_VIDEO_NTSC 	0x02
@@ -188,9 +249,24 @@ chipset=aga\n"
 #define PUAE_VIDEO_NTSC_LO 	PUAE_VIDEO_NTSC
 #define PUAE_VIDEO_NTSC_HI 	PUAE_VIDEO_NTSC|PUAE_VIDEO_HIRES
 
-static char uae_machine[256];
-static char uae_kickstart[16];
-static char uae_config[1024];
+/* Hires without line doubling outputs each Amiga line once, at half height */
+static bool video_single_lines(void)
+{
+   return (video_config & PUAE_VIDEO_HIRES) && !video_config_line_doubling;
+}
+
+static float video_aspect_ratio(int width, int height, bool ntsc)
+{
+   /* The frontend scales single lines back to full height */
+   if (video_single_lines())
+      height *= 2;
+   if (ntsc)
+      return (float)width/(float)height * 44.0/52.0;
+   return (float)width/(float)height;
+}
+
+static UAE_TLS const struct retro_model *uae_model;
+static UAE_TLS struct retro_prefs uae_config;
 
 void retro_set_environment(retro_environment_t cb)
 {
@@ -225,7 +301,7 @@ void retro_set_environment(retro_environment_t cb)
       { NULL, 0 }
    };
 
-   static struct retro_core_option_definition core_options[] =
+   static UAE_TLS struct retro_core_option_definition core_options[] =
    {
       {
          "puae_model",
@@ -238,6 +314,7 @@ void retro_set_environment(retro_environment_t cb)
             { "A600", "A600 (2MB Chip + 8MB Fast)" },
             { "A1200", "A1200 (2MB Chip + 8MB Fast)" },
             { "A1200OG", "A1200 (2MB Chip)" },
+            { "CD32", "CD32 (2MB Chip)" },
             { NULL, NULL },
          },
          "A500"
@@ -287,6 +364,17 @@ void retro_set_environment(retro_environment_t cb)
          },
          "true"
       },
+      {
+         "puae_video_line_doubling",
+         "Line doubling",
+         "Needs restart. Disabled outputs high resolution at half height, each line once, and leaves vertical scaling to the frontend",
+         {
+            { "enabled", NULL },
+            { "disabled", NULL },
+            { NULL, NULL },
+         },
+         "enabled"
+      },
       {
          "puae_zoom_mode",
          "Zoom mode",
@@ -390,11 +478,104 @@ void retro_set_environment(retro_environment_t cb)
       {
          "puae_gfx_framerate",
          "Frameskip",
-         "Not compatible with Cycle exact",
+         "Not compatible with Cycle exact. 'Auto' skips frames when the frontend audio buffer is about to underrun, 'Auto (Threshold)' when its occupancy drops below the threshold",
          {
             { "disabled", NULL },
             { "1", NULL },
             { "2", NULL },
+            { "auto", "Auto" },
+            { "auto_threshold", "Auto (Threshold)" },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+      {
+         "puae_gfx_framerate_threshold",
+         "Frameskip threshold",
+         "Audio buffer occupancy below which 'Auto (Threshold)' skips frames",
+         {
+            { "33", "33\%" },
+            { "40", "40\%" },
+            { "50", "50\%" },
+            { "60", "60\%" },
+            { "15", "15\%" },
+            { "20", "20\%" },
+            { "25", "25\%" },
+            { "30", "30\%" },
+            { NULL, NULL },
+         },
+         "33"
+      },
+      {
+         "puae_gfx_framerate_max",
+         "Frameskip max consecutive",
+         "Maximum number of frames skipped in a row by automatic frameskip",
+         {
+            { "3", NULL },
+            { "4", NULL },
+            { "6", NULL },
+            { "8", NULL },
+            { "1", NULL },
+            { "2", NULL },
+            { NULL, NULL },
+         },
+         "3"
+      },
+      {
+         "puae_headless",
+         "Headless max speed",
+         "Emulates without rendering video or generating sound, chipset timing, collisions and interrupts stay exact. The speed reached is written to the log. Use with fast-forward for batch runs",
+         {
+            { "disabled", NULL },
+            { "enabled", NULL },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+      {
+         "puae_lockstep",
+         "Deterministic lockstep",
+         "Keeps host time and host random numbers out of the emulation, so the same input always gives the same frames, for netplay and replays. 'self-test' also runs the next 250 frames twice from a snapshot with the same input and writes the result to the log",
+         {
+            { "disabled", NULL },
+            { "enabled", NULL },
+            { "self-test", NULL },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+      {
+         "puae_shared_roms",
+         "Shared ROM memory",
+         "Maps Kickstart ROMs from their files and keeps the unpacked AROS ROM and CPU tables in a cache in the save directory, so cores running side by side share one copy. Takes effect when the ROM is loaded",
+         {
+            { "disabled", NULL },
+            { "enabled", NULL },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+      {
+         "puae_state_digest",
+         "State digest",
+         "Keeps a per-frame hash of CPU, chipset and written RAM pages for netplay desync checks and replay validation. RAM is fully rehashed at the given interval to catch writes that bypass the memory handlers",
+         {
+            { "disabled", NULL },
+            { "50", "Full pass every 50 frames" },
+            { "250", "Full pass every 250 frames" },
+            { "1000", "Full pass every 1000 frames" },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+      {
+         "puae_input_replay",
+         "Input recording",
+         "Records input to 'puae_replay.inp' in the save directory, starting from a statefile of the current machine, with a snapshot every 10 seconds, or plays it back. Playback can be seeked by replay tools. Switching back to 'disabled' closes the recording",
+         {
+            { "disabled", NULL },
+            { "record", "Record" },
+            { "play", "Play" },
             { NULL, NULL },
          },
          "disabled"
@@ -412,6 +593,30 @@ void retro_set_environment(retro_environment_t cb)
          },
          "bottom"
       },
+      {
+         "puae_hostprof",
+         "Host profiling",
+         "Host time per frame spent in CPU, blitter, copper, audio, disk and drawing. CSV is written to 'puae_hostprof.csv' in the save directory",
+         {
+            { "disabled", NULL },
+            { "overlay", "On-screen" },
+            { "csv", "CSV log" },
+            { "overlay_csv", "On-screen and CSV log" },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+      {
+         "puae_pcprof",
+         "Guest PC profiler",
+         "Samples the 68k program counter every scanline. A report sorted by hits and resolved to Kickstart library functions is written to 'puae_pcprof.txt' in the save directory when the core is closed or the option is disabled",
+         {
+            { "disabled", NULL },
+            { "enabled", NULL },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
       {
          "puae_cpu_compatibility",
          "CPU compatibility",
@@ -974,7 +1179,7 @@ void retro_set_environment(retro_environment_t cb)
    else
    {
       /* Fallback for older API */
-      static struct retro_variable variables[64] = { 0 };
+      static UAE_TLS struct retro_variable variables[128] = { 0 };
       i = 0;
       while(core_options[i].key)
       {
@@ -998,15 +1203,104 @@ void retro_set_environment(retro_environment_t cb)
       cb( RETRO_ENVIRONMENT_SET_VARIABLES, variables);
    }
 
-   static bool allowNoGameMode;
+   static UAE_TLS bool allowNoGameMode;
    allowNoGameMode = true;
    environ_cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &allowNoGameMode);
 }
 
+static void retro_audio_buff_status_cb(bool active, unsigned occupancy, bool underrun_likely)
+{
+   retro_audio_buff_active    = active;
+   retro_audio_buff_occupancy = occupancy;
+   retro_audio_buff_underrun  = underrun_likely;
+}
+
+static void retro_frameskip_init(void)
+{
+   struct retro_audio_buffer_status_callback buf_status_cb;
+
+   frameskip_active = false;
+   if (opt_frameskip_type != PUAE_FRAMESKIP_FIXED)
+   {
+      buf_status_cb.callback = retro_audio_buff_status_cb;
+      if (environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &buf_status_cb))
+         frameskip_active = true;
+      else
+         fprintf(stderr, "[libretro-uae]: Audio buffer status is not supported, automatic frameskip disabled.\n");
+   }
+   else
+      environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, NULL);
+
+   retro_audio_buff_active    = false;
+   retro_audio_buff_occupancy = 0;
+   retro_audio_buff_underrun  = false;
+   frameskip_consecutive      = 0;
+   frameskip_last_skipped     = false;
+
+   /* Skipping only helps if the frontend buffers a few frames of audio,
+    * so ask for 6 frames worth, rounded up to a multiple of 32ms */
+   if (frameskip_active)
+   {
+      float frame_time_msec = 1000.0f / (float)((retro_get_region() == RETRO_REGION_NTSC) ? UAE_HZ_NTSC : UAE_HZ_PAL);
+      retro_audio_latency = (unsigned)((6.0f * frame_time_msec) + 0.5f);
+      retro_audio_latency = (retro_audio_latency + 0x1F) & ~0x1F;
+   }
+   else
+      retro_audio_latency = 0;
+   update_audio_latency = true;
+}
+
+/* Called from the emulator thread once per frame before the frame is started */
+bool retro_frameskip_auto(void)
+{
+   return frameskip_active;
+}
+
+bool retro_frameskip_check(void)
+{
+   bool skip = false;
+
+   if (retro_audio_buff_active && frameskip_consecutive < opt_frameskip_max)
+   {
+      if (opt_frameskip_type == PUAE_FRAMESKIP_THRESHOLD)
+         skip = retro_audio_buff_occupancy < opt_frameskip_threshold;
+      else
+         skip = retro_audio_buff_underrun;
+   }
+
+   frameskip_counter_total++;
+   if (skip)
+   {
+      frameskip_counter_skipped++;
+      frameskip_consecutive++;
+   }
+   else
+      frameskip_consecutive = 0;
+
+   frameskip_last_skipped = skip;
+   return skip;
+}
+
+static void retro_input_replay(unsigned int mode)
+{
+   char path[RETRO_PATH_MAX] = { 0 };
+
+   input_replay_mode = mode;
+   if (!mode)
+   {
+      // Closing a recording writes its snapshot index
+      inprec_close(true);
+      changed_prefs.inprecfile[0] = currprefs.inprecfile[0] = 0;
+      return;
+   }
+
+   path_join((char*)&path, retro_save_directory, LIBRETRO_PUAE_REPLAY);
+   inprec_start(path, mode == PUAE_REPLAY_RECORD);
+}
+
 static void update_variables(void)
 {
-   uae_machine[0] = '\0';
-   uae_config[0] = '\0';
+   retro_prefs_clear(&uae_config);
 
    struct retro_variable var = {0};
 
@@ -1014,38 +1308,7 @@ static void update_variables(void)
    var.value = NULL;
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
-   {
-      if (strcmp(var.value, "A500") == 0)
-      {
-         strcat(uae_machine, A500);
-         strcpy(uae_kickstart, A500_ROM);
-      }
-      if (strcmp(var.value, "A500OG") == 0)
-      {
-         strcat(uae_machine, A500OG);
-         strcpy(uae_kickstart, A500_ROM);
-      }
-      if (strcmp(var.value, "A500PLUS") == 0)
-      {
-         strcat(uae_machine, A500PLUS);
-         strcpy(uae_kickstart, A500KS2_ROM);
-      }
-      if (strcmp(var.value, "A600") == 0)
-      {
-         strcat(uae_machine, A600);
-         strcpy(uae_kickstart, A600_ROM);
-      }
-      if (strcmp(var.value, "A1200") == 0)
-      {
-         strcat(uae_machine, A1200);
-         strcpy(uae_kickstart, A1200_ROM);
-      }
-      if (strcmp(var.value, "A1200OG") == 0)
-      {
-         strcat(uae_machine, A1200OG);
-         strcpy(uae_kickstart, A1200_ROM);
-      }
-   }
+      uae_model = retro_model_find(var.value);
 
    var.key = "puae_video_standard";
    var.value = NULL;
@@ -1057,12 +1320,12 @@ static void update_variables(void)
          if (strcmp(var.value, "PAL") == 0)
          {
             video_config |= PUAE_VIDEO_PAL;
-            strcat(uae_config, "ntsc=false\n");
+            retro_prefs_int(&uae_config, PREF_NTSC, 0);
          }
          else
          {
             video_config |= PUAE_VIDEO_NTSC;
-            strcat(uae_config, "ntsc=true\n");
+            retro_prefs_int(&uae_config, PREF_NTSC, 1);
             real_ntsc = true;
          }
       else
@@ -1104,6 +1367,15 @@ static void update_variables(void)
          video_config &= ~PUAE_VIDEO_HIRES;
    }
 
+   var.key = "puae_video_line_doubling";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "enabled") == 0) video_config_line_doubling = 1;
+      else if (strcmp(var.value, "disabled") == 0) video_config_line_doubling = 0;
+   }
+
    var.key = "puae_statusbar";
    var.value = NULL;
 
@@ -1152,6 +1424,71 @@ static void update_variables(void)
       opt_statusbar_position_old = opt_statusbar_position;
    }
 
+   var.key = "puae_hostprof";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      unsigned int hostprof = 0;
+      if (strcmp(var.value, "overlay") == 0) hostprof = PUAE_HOSTPROF_OVERLAY;
+      else if (strcmp(var.value, "csv") == 0) hostprof = PUAE_HOSTPROF_CSV;
+      else if (strcmp(var.value, "overlay_csv") == 0) hostprof = PUAE_HOSTPROF_OVERLAY | PUAE_HOSTPROF_CSV;
+
+      if (hostprof != opt_hostprof)
+      {
+         char csvname[RETRO_PATH_MAX] = { 0 };
+         if (hostprof & PUAE_HOSTPROF_CSV)
+            path_join((char*)&csvname, retro_save_directory, LIBRETRO_PUAE_HOSTPROF);
+         hostprof_init(hostprof != 0, csvname);
+         opt_hostprof = hostprof;
+      }
+   }
+
+   var.key = "puae_shared_roms";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      romshare_init(strcmp(var.value, "enabled") == 0, retro_save_directory);
+   }
+
+   var.key = "puae_state_digest";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      statehash_enable(atoi(var.value));
+   }
+
+   var.key = "puae_input_replay";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      unsigned int replay = 0;
+      if (strcmp(var.value, "record") == 0) replay = PUAE_REPLAY_RECORD;
+      else if (strcmp(var.value, "play") == 0) replay = PUAE_REPLAY_PLAY;
+
+      // Started once the machine is up, see retro_run()
+      opt_input_replay = replay;
+   }
+
+#ifdef DEBUGGER
+   var.key = "puae_pcprof";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      bool pcprof = strcmp(var.value, "enabled") == 0;
+      if (pcprof != (pcprof_enabled != 0))
+      {
+         char reportname[RETRO_PATH_MAX] = { 0 };
+         path_join((char*)&reportname, retro_save_directory, LIBRETRO_PUAE_PCPROF);
+         pcprof_init(pcprof, reportname);
+      }
+   }
+#endif
+
    var.key = "puae_cpu_compatibility";
    var.value = NULL;
 
@@ -1182,18 +1519,18 @@ static void update_variables(void)
       {
          if (strcmp(var.value, "normal") == 0)
          {
-            strcat(uae_config, "cpu_compatible=false\n");
-            strcat(uae_config, "cycle_exact=false\n");
+            retro_prefs_int(&uae_config, PREF_CPU_COMPATIBLE, 0);
+            retro_prefs_int(&uae_config, PREF_CYCLE_EXACT, 0);
          }
          else if (strcmp(var.value, "compatible") == 0)
          {
-            strcat(uae_config, "cpu_compatible=true\n");
-            strcat(uae_config, "cycle_exact=false\n");
+            retro_prefs_int(&uae_config, PREF_CPU_COMPATIBLE, 1);
+            retro_prefs_int(&uae_config, PREF_CYCLE_EXACT, 0);
          }
          else if (strcmp(var.value, "exact") == 0)
          {
-            strcat(uae_config, "cpu_compatible=true\n");
-            strcat(uae_config, "cycle_exact=true\n");
+            retro_prefs_int(&uae_config, PREF_CPU_COMPATIBLE, 1);
+            retro_prefs_int(&uae_config, PREF_CYCLE_EXACT, 1);
          }
       }
    }
@@ -1203,9 +1540,7 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "cpu_throttle=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      retro_prefs_double(&uae_config, PREF_CPU_THROTTLE, atof(var.value));
 
       if (firstpass != 1)
          changed_prefs.m68k_speed_throttle=atof(var.value);
@@ -1216,14 +1551,17 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "sound_output=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      int val = -1;
+      if (strcmp(var.value, "none") == 0) val=0;
+      else if (strcmp(var.value, "interrupts") == 0) val=1;
+      else if (strcmp(var.value, "normal") == 0) val=2;
+      else if (strcmp(var.value, "exact") == 0) val=3;
 
-      if (strcmp(var.value, "none") == 0) changed_prefs.produce_sound=0;
-      else if (strcmp(var.value, "interrupts") == 0) changed_prefs.produce_sound=1;
-      else if (strcmp(var.value, "normal") == 0) changed_prefs.produce_sound=2;
-      else if (strcmp(var.value, "exact") == 0) changed_prefs.produce_sound=3;
+      if (val >= 0)
+      {
+         retro_prefs_int(&uae_config, PREF_SOUND_OUTPUT, val);
+         changed_prefs.produce_sound=val;
+      }
    }
 
    var.key = "puae_sound_stereo_separation";
@@ -1233,12 +1571,7 @@ static void update_variables(void)
    {
       int val = atoi(var.value) / 10;
       changed_prefs.sound_stereo_separation=val;
-
-      char valbuf[50];
-      snprintf(valbuf, 50, "%d", val);
-      strcat(uae_config, "sound_stereo_separation=");
-      strcat(uae_config, valbuf);
-      strcat(uae_config, "\n");
+      retro_prefs_int(&uae_config, PREF_SOUND_SEPARATION, val);
    }
 
    var.key = "puae_sound_interpol";
@@ -1246,15 +1579,18 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "sound_interpol=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      int val = -1;
+      if (strcmp(var.value, "none") == 0) val=0;
+      else if (strcmp(var.value, "anti") == 0) val=1;
+      else if (strcmp(var.value, "sinc") == 0) val=2;
+      else if (strcmp(var.value, "rh") == 0) val=3;
+      else if (strcmp(var.value, "crux") == 0) val=4;
 
-      if (strcmp(var.value, "none") == 0) changed_prefs.sound_interpol=0;
-      else if (strcmp(var.value, "anti") == 0) changed_prefs.sound_interpol=1;
-      else if (strcmp(var.value, "sinc") == 0) changed_prefs.sound_interpol=2;
-      else if (strcmp(var.value, "rh") == 0) changed_prefs.sound_interpol=3;
-      else if (strcmp(var.value, "crux") == 0) changed_prefs.sound_interpol=4;
+      if (val >= 0)
+      {
+         retro_prefs_int(&uae_config, PREF_SOUND_INTERPOL, val);
+         changed_prefs.sound_interpol=val;
+      }
    }
 
    var.key = "puae_sound_filter";
@@ -1262,13 +1598,16 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "sound_filter=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
-      
-      if (strcmp(var.value, "emulated") == 0) changed_prefs.sound_filter=FILTER_SOUND_EMUL; 
-      else if (strcmp(var.value, "off") == 0) changed_prefs.sound_filter=FILTER_SOUND_OFF;
-      else if (strcmp(var.value, "on") == 0) changed_prefs.sound_filter=FILTER_SOUND_ON;
+      int val = -1;
+      if (strcmp(var.value, "emulated") == 0) val=FILTER_SOUND_EMUL;
+      else if (strcmp(var.value, "off") == 0) val=FILTER_SOUND_OFF;
+      else if (strcmp(var.value, "on") == 0) val=FILTER_SOUND_ON;
+
+      if (val >= 0)
+      {
+         retro_prefs_int(&uae_config, PREF_SOUND_FILTER, val);
+         changed_prefs.sound_filter=val;
+      }
    }
 
    var.key = "puae_sound_filter_type";
@@ -1276,12 +1615,15 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "sound_filter_type=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      int val = -1;
+      if (strcmp(var.value, "standard") == 0) val=FILTER_SOUND_TYPE_A500;
+      else if (strcmp(var.value, "enhanced") == 0) val=FILTER_SOUND_TYPE_A1200;
 
-      if (strcmp(var.value, "standard") == 0) changed_prefs.sound_filter_type=FILTER_SOUND_TYPE_A500;
-      else if (strcmp(var.value, "enhanced") == 0) changed_prefs.sound_filter_type=FILTER_SOUND_TYPE_A1200;
+      if (val >= 0)
+      {
+         retro_prefs_int(&uae_config, PREF_SOUND_FILTER_TYPE, val);
+         changed_prefs.sound_filter_type=val;
+      }
    }
 
    var.key = "puae_floppy_speed";
@@ -1289,9 +1631,7 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "floppy_speed=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      retro_prefs_int(&uae_config, PREF_FLOPPY_SPEED, atoi(var.value));
 
       if (firstpass != 1)
          changed_prefs.floppy_speed=atoi(var.value);
@@ -1304,9 +1644,7 @@ static void update_variables(void)
    {
       /* Sound is enabled by default if files are found, so this needs to be set always */
       /* 100 is mute, 0 is max */
-      strcat(uae_config, "floppy_volume=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      retro_prefs_int(&uae_config, PREF_FLOPPY_VOLUME, atoi(var.value));
 
       /* Setting volume in realtime will crash on first pass */
       if (firstpass != 1)
@@ -1338,30 +1676,12 @@ static void update_variables(void)
       {
          if (strcmp(var.value, "internal") == 0)
          {
-            strcat(uae_config, "floppy0sound=1\n");
-            strcat(uae_config, "floppy1sound=1\n");
-            strcat(uae_config, "floppy2sound=1\n");
-            strcat(uae_config, "floppy3sound=1\n");
+            retro_prefs_int(&uae_config, PREF_FLOPPY_CLICK, 1);
          }
          else
          {
-            strcat(uae_config, "floppy0sound=-1\n");
-            strcat(uae_config, "floppy1sound=-1\n");
-            strcat(uae_config, "floppy2sound=-1\n");
-            strcat(uae_config, "floppy3sound=-1\n");
-
-            strcat(uae_config, "floppy0soundext=");
-            strcat(uae_config, var.value);
-            strcat(uae_config, "\n");
-            strcat(uae_config, "floppy1soundext=");
-            strcat(uae_config, var.value);
-            strcat(uae_config, "\n");
-            strcat(uae_config, "floppy2soundext=");
-            strcat(uae_config, var.value);
-            strcat(uae_config, "\n");
-            strcat(uae_config, "floppy3soundext=");
-            strcat(uae_config, var.value);
-            strcat(uae_config, "\n");
+            retro_prefs_int(&uae_config, PREF_FLOPPY_CLICK, -1);
+            retro_prefs_string(&uae_config, PREF_FLOPPY_CLICK_EXT, 0, var.value);
          }
       }
    }
@@ -1371,9 +1691,7 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "input.mouse_speed=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      retro_prefs_int(&uae_config, PREF_MOUSE_SPEED, atoi(var.value));
 
       if (firstpass != 1)
       {
@@ -1390,18 +1708,18 @@ static void update_variables(void)
    {
       if (strcmp(var.value, "false") == 0)
       {
-         strcat(uae_config, "immediate_blits=false\n");
-         strcat(uae_config, "waiting_blits=false\n");
+         retro_prefs_int(&uae_config, PREF_IMMEDIATE_BLITS, 0);
+         retro_prefs_int(&uae_config, PREF_WAITING_BLITS, 0);
       }
       else if (strcmp(var.value, "immediate") == 0)
       {
-         strcat(uae_config, "immediate_blits=true\n");
-         strcat(uae_config, "waiting_blits=disabled\n");
+         retro_prefs_int(&uae_config, PREF_IMMEDIATE_BLITS, 1);
+         retro_prefs_int(&uae_config, PREF_WAITING_BLITS, 0);
       }
       else if (strcmp(var.value, "waiting") == 0)
       {
-         strcat(uae_config, "immediate_blits=false\n");
-         strcat(uae_config, "waiting_blits=automatic\n");
+         retro_prefs_int(&uae_config, PREF_IMMEDIATE_BLITS, 0);
+         retro_prefs_int(&uae_config, PREF_WAITING_BLITS, 1);
       }
 
       if (firstpass != 1)
@@ -1429,16 +1747,17 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "collision_level=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      int val = -1;
+      if (strcmp(var.value, "none") == 0) val=0;
+      else if (strcmp(var.value, "sprites") == 0) val=1;
+      else if (strcmp(var.value, "playfields") == 0) val=2;
+      else if (strcmp(var.value, "full") == 0) val=3;
 
-      if (firstpass != 1)
+      if (val >= 0)
       {
-         if (strcmp(var.value, "none") == 0) changed_prefs.collision_level=0;
-         else if (strcmp(var.value, "sprites") == 0) changed_prefs.collision_level=1;
-         else if (strcmp(var.value, "playfields") == 0) changed_prefs.collision_level=2;
-         else if (strcmp(var.value, "full") == 0) changed_prefs.collision_level=3;
+         retro_prefs_int(&uae_config, PREF_COLLISION_LEVEL, val);
+         if (firstpass != 1)
+            changed_prefs.collision_level=val;
       }
    }
 
@@ -1447,20 +1766,67 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      int val;
+      int val = 1;
+      unsigned int frameskip_type = PUAE_FRAMESKIP_FIXED;
       if (strcmp(var.value, "disabled") == 0) val=1;
       else if (strcmp(var.value, "1") == 0) val=2;
       else if (strcmp(var.value, "2") == 0) val=3;
+      else if (strcmp(var.value, "auto") == 0) frameskip_type=PUAE_FRAMESKIP_AUTO;
+      else if (strcmp(var.value, "auto_threshold") == 0) frameskip_type=PUAE_FRAMESKIP_THRESHOLD;
       changed_prefs.gfx_framerate=val;
 
-      if (val>1)
+      if (frameskip_type != opt_frameskip_type)
       {
-         char valbuf[50];
-         snprintf(valbuf, 50, "%d", val);
-         strcat(uae_config, "gfx_framerate=");
-         strcat(uae_config, valbuf);
-         strcat(uae_config, "\n");
+         opt_frameskip_type = frameskip_type;
+         retro_frameskip_init();
       }
+
+      if (val>1)
+         retro_prefs_int(&uae_config, PREF_FRAMERATE, val);
+   }
+
+   var.key = "puae_gfx_framerate_threshold";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      opt_frameskip_threshold = atoi(var.value);
+   }
+
+   var.key = "puae_gfx_framerate_max";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      opt_frameskip_max = atoi(var.value);
+   }
+
+   var.key = "puae_headless";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      int val = strcmp(var.value, "enabled") == 0;
+      if (val)
+         retro_prefs_int(&uae_config, PREF_HEADLESS, val);
+      if (firstpass != 1)
+         changed_prefs.headless=val;
+   }
+
+   var.key = "puae_lockstep";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      int val = strcmp(var.value, "disabled") != 0;
+      bool selftest = strcmp(var.value, "self-test") == 0;
+      if (val)
+         retro_prefs_int(&uae_config, PREF_LOCKSTEP, val);
+      if (firstpass != 1)
+         changed_prefs.lockstep=val;
+      if (selftest && !opt_lockstep_selftest)
+         lockstep_selftest(LOCKSTEP_SELFTEST_FRAMES);
+      opt_lockstep_selftest = selftest;
    }
 
    var.key = "puae_gfx_colors";
@@ -1482,17 +1848,16 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "gfx_center_horizontal=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      int val = -1;
+      if (strcmp(var.value, "none") == 0) val=0;
+      else if (strcmp(var.value, "simple") == 0) val=1;
+      else if (strcmp(var.value, "smart") == 0) val=2;
 
-      if (firstpass != 1)
+      if (val >= 0)
       {
-         int val;
-         if (strcmp(var.value, "none") == 0) val=0;
-         else if (strcmp(var.value, "simple") == 0) val=1;
-         else if (strcmp(var.value, "smart") == 0) val=2;
-         changed_prefs.gfx_xcenter=val;
+         retro_prefs_int(&uae_config, PREF_XCENTER, val);
+         if (firstpass != 1)
+            changed_prefs.gfx_xcenter=val;
       }
    }
 
@@ -1501,17 +1866,16 @@ static void update_variables(void)
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      strcat(uae_config, "gfx_center_vertical=");
-      strcat(uae_config, var.value);
-      strcat(uae_config, "\n");
+      int val = -1;
+      if (strcmp(var.value, "none") == 0) val=0;
+      else if (strcmp(var.value, "simple") == 0) val=1;
+      else if (strcmp(var.value, "smart") == 0) val=2;
 
-      if (firstpass != 1)
+      if (val >= 0)
       {
-         int val;
-         if (strcmp(var.value, "none") == 0) val=0;
-         else if (strcmp(var.value, "simple") == 0) val=1;
-         else if (strcmp(var.value, "smart") == 0) val=2;
-         changed_prefs.gfx_ycenter=val;
+         retro_prefs_int(&uae_config, PREF_YCENTER, val);
+         if (firstpass != 1)
+            changed_prefs.gfx_ycenter=val;
       }
    }
 
@@ -1853,32 +2217,33 @@ static void update_variables(void)
    // - **360x240**: NTSC Low resolution
    // - **720x568**: PAL High resolution
    // - **720x480**: NTSC High resolution
+   // - **720x284**, **720x240**: High resolution without line doubling
    switch(video_config)
    {
 		case PUAE_VIDEO_PAL_HI:
 			defaultw = 720;
-			defaulth = 568;
-			strcat(uae_config, "gfx_lores=false\n");
-			strcat(uae_config, "gfx_linemode=double\n");
+			defaulth = video_config_line_doubling ? 568 : 284;
+			retro_prefs_int(&uae_config, PREF_RESOLUTION, RES_HIRES);
+			retro_prefs_int(&uae_config, PREF_VRESOLUTION, video_config_line_doubling ? VRES_DOUBLE : VRES_NONDOUBLE);
 			break;
 		case PUAE_VIDEO_PAL_LO:
 			defaultw = 360;
 			defaulth = 284;
-			strcat(uae_config, "gfx_lores=true\n");
-			strcat(uae_config, "gfx_linemode=none\n");
+			retro_prefs_int(&uae_config, PREF_RESOLUTION, RES_LORES);
+			retro_prefs_int(&uae_config, PREF_VRESOLUTION, VRES_NONDOUBLE);
 			break;
 
 		case PUAE_VIDEO_NTSC_HI:
 			defaultw = 720;
-			defaulth = 480;
-			strcat(uae_config, "gfx_lores=false\n");
-			strcat(uae_config, "gfx_linemode=double\n");
+			defaulth = video_config_line_doubling ? 480 : 240;
+			retro_prefs_int(&uae_config, PREF_RESOLUTION, RES_HIRES);
+			retro_prefs_int(&uae_config, PREF_VRESOLUTION, video_config_line_doubling ? VRES_DOUBLE : VRES_NONDOUBLE);
 			break;
 		case PUAE_VIDEO_NTSC_LO:
 			defaultw = 360;
 			defaulth = 240;
-			strcat(uae_config, "gfx_lores=true\n");
-			strcat(uae_config, "gfx_linemode=none\n");
+			retro_prefs_int(&uae_config, PREF_RESOLUTION, RES_LORES);
+			retro_prefs_int(&uae_config, PREF_VRESOLUTION, VRES_NONDOUBLE);
 			break;
    }
 
@@ -1895,7 +2260,8 @@ static void update_variables(void)
 
 static void retro_wrap_emulator(void)
 {
-   static char *argv[] = { "puae", RPATH };
+   /* The configuration is handed over in retro_boot_prefs */
+   static UAE_TLS char *argv[] = { "puae" };
    umain(sizeof(argv)/sizeof(*argv), argv);
 
    environ_cb(RETRO_ENVIRONMENT_SHUTDOWN, 0); 
@@ -2040,7 +2406,7 @@ static bool disk_add_image_index(void)
     return false;
 }
 
-static struct retro_disk_control_callback disk_interface = {
+static UAE_TLS struct retro_disk_control_callback disk_interface = {
    disk_set_eject_state,
    disk_get_eject_state,
    disk_get_image_index,
@@ -2095,7 +2461,7 @@ void retro_init(void)
    environ_cb(RETRO_ENVIRONMENT_SET_DISK_CONTROL_INTERFACE, &disk_interface);
 
    // Savestates
-   static uint32_t quirks = RETRO_SERIALIZATION_QUIRK_INCOMPLETE | RETRO_SERIALIZATION_QUIRK_MUST_INITIALIZE | RETRO_SERIALIZATION_QUIRK_CORE_VARIABLE_SIZE;
+   static UAE_TLS uint32_t quirks = RETRO_SERIALIZATION_QUIRK_INCOMPLETE | RETRO_SERIALIZATION_QUIRK_MUST_INITIALIZE | RETRO_SERIALIZATION_QUIRK_CORE_VARIABLE_SIZE;
    environ_cb(RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS, &quirks);
 
    // Inputs
@@ -2121,7 +2487,7 @@ void retro_init(void)
    { _user, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_X, "Right Analog X" },             \
    { _user, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_Y, "Right Analog Y" }
 
-   static struct retro_input_descriptor input_descriptors[] =
+   static UAE_TLS struct retro_input_descriptor input_descriptors[] =
    {
       RETRO_DESCRIPTOR_BLOCK( 0 ),
       RETRO_DESCRIPTOR_BLOCK( 1 ),
@@ -2138,6 +2504,9 @@ void retro_init(void)
    memset(key_state, 0, sizeof(key_state));
    memset(key_state2, 0, sizeof(key_state2));
 
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &retro_can_dupe))
+      retro_can_dupe = false;
+
    if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &fmt))
    {
       fprintf(stderr, "[libretro-uae]: RGB565 is not supported.\n");
@@ -2157,13 +2526,29 @@ void retro_init(void)
 
 void retro_deinit(void)
 {	
+   if (frameskip_counter_total)
+      printf("Frameskip: %u of %u frames skipped\n", frameskip_counter_skipped, frameskip_counter_total);
+   hostprof_free();
+   opt_hostprof = 0;
+#ifdef DEBUGGER
+   pcprof_free();
+#endif
+   /* The emulator thread is dropped without leaving the program,
+    * write the instruction counts of a COUNT_INSTRS build here */
+   dump_counts();
+
    if (emuThread)
       co_delete(emuThread);
    emuThread = 0;
+   // The statefile compression threads would outlive the core
+   savestate_cleanup();
 
 	// Clean the m3u storage
 	if (dc)
 		dc_free(dc);
+
+   retro_prefs_clear(&uae_config);
+   retro_prefs_clear(&retro_boot_prefs);
 }
 
 unsigned retro_api_version(void)
@@ -2217,7 +2602,7 @@ void retro_get_system_info(struct retro_system_info *info)
    info->library_version  = "2.6.1" GIT_VERSION;
    info->need_fullpath    = true;
    info->block_extract    = false;	
-   info->valid_extensions = "adf|dms|fdi|ipf|zip|hdf|hdz|uae|m3u";
+   info->valid_extensions = "adf|dms|fdi|ipf|zip|hdf|hdz|uae|m3u|cue|ccd|mds|iso";
 }
 
 bool retro_update_av_info(bool change_geometry, bool change_timing, bool isntsc)
@@ -2316,6 +2701,9 @@ bool retro_update_av_info(bool change_geometry, bool change_timing, bool isntsc)
          break;
    }
 
+   if (video_single_lines())
+      retroh /= 2;
+
    /* When the actual dimensions change and not just the view */
    if (change_timing)
    {
@@ -2323,14 +2711,11 @@ bool retro_update_av_info(bool change_geometry, bool change_timing, bool isntsc)
       defaulth = retroh;
    }
 
-   static struct retro_system_av_info new_av_info;
+   static UAE_TLS struct retro_system_av_info new_av_info;
    new_av_info.geometry.base_width = retrow;
    new_av_info.geometry.base_height = retroh;
 
-   if (video_config_geometry & PUAE_VIDEO_NTSC)
-      new_av_info.geometry.aspect_ratio=(float)retrow/(float)retroh * 44.0/52.0;
-   else
-      new_av_info.geometry.aspect_ratio=(float)retrow/(float)retroh;
+   new_av_info.geometry.aspect_ratio = video_aspect_ratio(retrow, retroh, video_config_geometry & PUAE_VIDEO_NTSC);
 
    /* Disable Hz change if not allowed */
    if (!video_config_allow_hz_change)
@@ -2441,16 +2826,17 @@ bool retro_update_av_info(bool change_geometry, bool change_timing, bool isntsc)
          break;
    }
 
+   /* Zoom heights above are in doubled lines */
+   if (zoom_mode_id != 0 && video_single_lines())
+      zoomed_height /= 2;
+
    if (zoomed_height > retroh)
       zoomed_height = retroh;
 
    if (zoomed_height != retroh)
    {
       new_av_info.geometry.base_height = zoomed_height;
-      if (video_config_geometry & PUAE_VIDEO_NTSC)
-         new_av_info.geometry.aspect_ratio=(float)retrow/(float)zoomed_height * 44.0/52.0;
-      else
-         new_av_info.geometry.aspect_ratio=(float)retrow/(float)zoomed_height;
+      new_av_info.geometry.aspect_ratio = video_aspect_ratio(retrow, zoomed_height, video_config_geometry & PUAE_VIDEO_NTSC);
       environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &new_av_info);
 
       /* Ensure statusbar stays visible at the bottom */
@@ -2463,7 +2849,7 @@ bool retro_update_av_info(bool change_geometry, bool change_timing, bool isntsc)
    /* If zoom mode should be centered automagically */
    if (opt_vertical_offset_auto && zoom_mode_id != 0 && firstpass != 1)
    {
-      int zoomed_height_normal = (video_config & PUAE_VIDEO_HIRES) ? zoomed_height / 2 : zoomed_height;
+      int zoomed_height_normal = ((video_config & PUAE_VIDEO_HIRES) && !video_single_lines()) ? zoomed_height / 2 : zoomed_height;
       int thisframe_y_adjust_new = minfirstline;
 
       /* Need proper values for calculations */
@@ -2517,16 +2903,13 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
       }
    }
 
-   static struct retro_game_geometry geom;
+   static UAE_TLS struct retro_game_geometry geom;
    geom.base_width=retrow;
    geom.base_height=retroh;
    geom.max_width=EMULATOR_MAX_WIDTH;
    geom.max_height=EMULATOR_MAX_HEIGHT;
 
-   if (retro_get_region() == RETRO_REGION_NTSC)
-      geom.aspect_ratio=(float)retrow/(float)retroh * 44.0/52.0;
-   else
-      geom.aspect_ratio=(float)retrow/(float)retroh;
+   geom.aspect_ratio = video_aspect_ratio(retrow, retroh, retro_get_region() == RETRO_REGION_NTSC);
    info->geometry = geom;
 
    info->timing.sample_rate = 44100.0;
@@ -2568,6 +2951,11 @@ void retro_run(void)
 {
    // Core options
    bool updated = false;
+#ifdef PICASSO96
+   static UAE_TLS int rtg_geometry_w = 0, rtg_geometry_h = 0;
+   const void *rtg_data;
+   int rtg_w, rtg_h, rtg_pitch;
+#endif
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
       update_variables();
 
@@ -2608,6 +2996,13 @@ void retro_run(void)
    if (request_update_av_info)
       retro_update_av_info(1, 0, 0);
 
+   // Audio latency for automatic frameskip can only be set from here
+   if (update_audio_latency)
+   {
+      environ_cb(RETRO_ENVIRONMENT_SET_MINIMUM_AUDIO_LATENCY, &retro_audio_latency);
+      update_audio_latency = false;
+   }
+
    if (firstpass)
    {
       firstpass=0;
@@ -2615,11 +3010,41 @@ void retro_run(void)
    }
 
    retro_poll_event();
+   if (input_replay_mode != opt_input_replay)
+      retro_input_replay(opt_input_replay);
    if (STATUSON==1) Print_Status();
+   if (opt_hostprof & PUAE_HOSTPROF_OVERLAY) Print_Hostprof();
 
 sortie:
-   video_cb(bmp, retrow, zoomed_height, retrow << (pix_bytes / 2));
+#ifdef PICASSO96
+   if (retro_picasso_screen(&rtg_data, &rtg_w, &rtg_h, &rtg_pitch))
+   {
+      // RTG screen has its own geometry, restored when the chipset takes over again
+      if (rtg_w != rtg_geometry_w || rtg_h != rtg_geometry_h)
+      {
+         struct retro_game_geometry geom = { rtg_w, rtg_h, EMULATOR_MAX_WIDTH, EMULATOR_MAX_HEIGHT, (float)rtg_w / (float)rtg_h };
+         environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &geom);
+         rtg_geometry_w = rtg_w;
+         rtg_geometry_h = rtg_h;
+      }
+      video_cb((frameskip_last_skipped && retro_can_dupe) ? NULL : rtg_data, rtg_w, rtg_h, rtg_pitch);
+   }
+   else
+   {
+      if (rtg_geometry_w)
+      {
+         rtg_geometry_w = rtg_geometry_h = 0;
+         retro_update_av_info(1, 0, 0);
+      }
+#endif
+   // Skipped and headless frames leave bmp untouched, let the frontend repeat the last one
+   video_cb(((frameskip_last_skipped || currprefs.headless) && retro_can_dupe) ? NULL : bmp, retrow, zoomed_height, retrow << (pix_bytes / 2));
+#ifdef PICASSO96
+   }
+#endif
+   hostprof_frame_begin();
    co_switch(emuThread);
+   hostprof_frame_end();
 }
 
 #define ADF_FILE_EXT "adf"
@@ -2631,15 +3056,20 @@ sortie:
 #define HDZ_FILE_EXT "hdz"
 #define UAE_FILE_EXT "uae"
 #define M3U_FILE_EXT "m3u"
-#define LIBRETRO_PUAE_CONF "puae_libretro.uae"
+#define CUE_FILE_EXT "cue"
+#define CCD_FILE_EXT "ccd"
+#define MDS_FILE_EXT "mds"
+#define ISO_FILE_EXT "iso"
 #define WHDLOAD_HDF "WHDLoad.hdf"
 
 bool retro_load_game(const struct retro_game_info *info)
 {
    int w = 0, h = 0;
+   struct retro_prefs *rp = &retro_boot_prefs;
+   const struct retro_model *model = uae_model;
+
+   retro_prefs_clear(rp);
 
-   RPATH[0] = '\0';
-  
    if (info)
    {
       const char *full_path = (const char*)info->path;
@@ -2656,213 +3086,159 @@ bool retro_load_game(const struct retro_game_info *info)
 	  {
 	     printf("Game '%s' is a disk, a hard drive image or a m3u file.\n", full_path);
 
-	     path_join((char*)&RPATH, retro_save_directory, LIBRETRO_PUAE_CONF);
-	     printf("Generating temporary uae config file '%s'.\n", (const char*)&RPATH);
+         // If a machine was specified in the name of the game
+         if (strstr(full_path, "(A1200OG)") != NULL || strstr(full_path, "(A1200NF)") != NULL)
+         {
+            // Use A1200 barebone
+            printf("Found '(A1200OG)' or '(A1200NF)' in filename '%s'. Booting A1200 NoFast with Kickstart 3.1 r40.068 rom.\n", full_path);
+            model = retro_model_find("A1200OG");
+         }
+         else if (strstr(full_path, "(A1200)") != NULL || strstr(full_path, "(AGA)") != NULL)
+         {
+            // Use A1200
+            printf("Found '(A1200)' or '(AGA)' in filename '%s'. Booting A1200 with Kickstart 3.1 r40.068 rom.\n", full_path);
+            model = retro_model_find("A1200");
+         }
+         else if (strstr(full_path, "(A600)") != NULL || strstr(full_path, "(ECS)") != NULL)
+         {
+            // Use A600
+            printf("Found '(A600)' or '(ECS)' in filename '%s'. Booting A600 with Kickstart 3.1 r40.063 rom.\n", full_path);
+            model = retro_model_find("A600");
+         }
+         else if (strstr(full_path, "(A500+)") != NULL || strstr(full_path, "(A500PLUS)") != NULL)
+         {
+            // Use A500+
+            printf("Found '(A500+)' or '(A500PLUS)' in filename '%s'. Booting A500+ with Kickstart 2.04 r37.175.\n", full_path);
+            model = retro_model_find("A500PLUS");
+         }
+         else if (strstr(full_path, "(A500OG)") != NULL || strstr(full_path, "(512K)") != NULL)
+         {
+            // Use A500 barebone
+            printf("Found '(A500OG)' or '(512K)' in filename '%s'. Booting A500 512K with Kickstart 1.3 r34.005.\n", full_path);
+            model = retro_model_find("A500OG");
+         }
+         else if (strstr(full_path, "(A500)") != NULL || strstr(full_path, "(OCS)") != NULL)
+         {
+            // Use A500
+            printf("Found '(A500)' or '(OCS)' in filename '%s'. Booting A500 with Kickstart 1.3 r34.005.\n", full_path);
+            model = retro_model_find("A500");
+         }
+         else
+         {
+            // No machine specified, we will use the configured one
+            printf("No machine specified in filename '%s'. Booting default configuration.\n", full_path);
+         }
 
-	     // Open tmp config file
-	     FILE * configfile;
-	     if (configfile = fopen(RPATH, "w"))
-	     {
-	        char kickstart[RETRO_PATH_MAX];
+         retro_prefs_model(rp, model);
 
-            // If a machine was specified in the name of the game
-            if (strstr(full_path, "(A1200OG)") != NULL || strstr(full_path, "(A1200NF)") != NULL)
-            {
-               // Use A1200 barebone
-               printf("Found '(A1200OG)' or '(A1200NF)' in filename '%s'. Booting A1200 NoFast with Kickstart 3.1 r40.068 rom.\n", full_path);
-               fprintf(configfile, A1200OG);
-               path_join((char*)&kickstart, retro_system_directory, A1200_ROM);
-            }
-            else if (strstr(full_path, "(A1200)") != NULL || strstr(full_path, "(AGA)") != NULL)
-            {
-               // Use A1200
-               printf("Found '(A1200)' or '(AGA)' in filename '%s'. Booting A1200 with Kickstart 3.1 r40.068 rom.\n", full_path);
-               fprintf(configfile, A1200);
-               path_join((char*)&kickstart, retro_system_directory, A1200_ROM);
-            }
-            else if (strstr(full_path, "(A600)") != NULL || strstr(full_path, "(ECS)") != NULL)
-            {
-               // Use A600
-               printf("Found '(A600)' or '(ECS)' in filename '%s'. Booting A600 with Kickstart 3.1 r40.063 rom.\n", full_path);
-               fprintf(configfile, A600);
-               path_join((char*)&kickstart, retro_system_directory, A600_ROM);
-            }
-            else if (strstr(full_path, "(A500+)") != NULL || strstr(full_path, "(A500PLUS)") != NULL)
-            {
-               // Use A500+
-               printf("Found '(A500+)' or '(A500PLUS)' in filename '%s'. Booting A500+ with Kickstart 2.04 r37.175.\n", full_path);
-               fprintf(configfile, A500PLUS);
-               path_join((char*)&kickstart, retro_system_directory, A500KS2_ROM);
-            }
-            else if (strstr(full_path, "(A500OG)") != NULL || strstr(full_path, "(512K)") != NULL)
-            {
-               // Use A500 barebone
-               printf("Found '(A500OG)' or '(512K)' in filename '%s'. Booting A500 512K with Kickstart 1.3 r34.005.\n", full_path);
-               fprintf(configfile, A500OG);
-               path_join((char*)&kickstart, retro_system_directory, A500_ROM);
-            }
-            else if (strstr(full_path, "(A500)") != NULL || strstr(full_path, "(OCS)") != NULL)
-            {
-               // Use A500
-               printf("Found '(A500)' or '(OCS)' in filename '%s'. Booting A500 with Kickstart 1.3 r34.005.\n", full_path);
-               fprintf(configfile, A500);
-               path_join((char*)&kickstart, retro_system_directory, A500_ROM);
-            }
-            else
-            {
-               // No machine specified, we will use the configured one
-               printf("No machine specified in filename '%s'. Booting default configuration.\n", full_path);
-               fprintf(configfile, uae_machine);
-               path_join((char*)&kickstart, retro_system_directory, uae_kickstart);
-            }
+         // Common config
+         retro_prefs_append(rp, &uae_config);
+
+         // If region was specified in the name of the game
+         if (strstr(full_path, "(NTSC)") != NULL)
+         {
+            printf("Found '(NTSC)' in filename '%s'\n", full_path);
+            retro_prefs_int(rp, PREF_NTSC, 1);
+         }
+         else if (strstr(full_path, "(PAL)") != NULL)
+         {
+            printf("Found '(PAL)' in filename '%s'\n", full_path);
+            retro_prefs_int(rp, PREF_NTSC, 0);
+         }
 
-            // Write common config
-            fprintf(configfile, uae_config);
+         retro_prefs_roms(rp, model);
 
-            // If region was specified in the name of the game
-            if (strstr(full_path, "(NTSC)") != NULL)
+         // If argument is a hard drive image file
+         if (  strendswith(full_path, HDF_FILE_EXT)
+            || strendswith(full_path, HDZ_FILE_EXT))
+         {
+            if (opt_use_whdload_hdf)
             {
-               printf("Found '(NTSC)' in filename '%s'\n", full_path);
-               fprintf(configfile, "ntsc=true\n");
+               // Init WHDLoad
+               char whdload[RETRO_PATH_MAX];
+               path_join((char*)&whdload, retro_system_directory, WHDLOAD_HDF);
+
+               // Verify WHDLoad
+               if (file_exists(whdload))
+                  retro_prefs_string(rp, PREF_HARDFILE, 0, whdload);
+               else
+                  fprintf(stderr, "WHDLoad image file '%s' not found.\n", (const char*)&whdload);
             }
-            else if (strstr(full_path, "(PAL)") != NULL)
+            retro_prefs_string(rp, PREF_HARDFILE, 0, full_path);
+         }
+         else
+         {
+            // If argument is a m3u playlist
+            if (strendswith(full_path, M3U_FILE_EXT))
             {
-               printf("Found '(PAL)' in filename '%s'\n", full_path);
-               fprintf(configfile, "ntsc=false\n");
-            }
+               // Parse the m3u file
+               dc_parse_m3u(dc, full_path);
 
-            // Verify kickstart
-            if (!file_exists(kickstart))
+               // Some debugging
+               printf("M3U file parsed, %d file(s) found\n", dc->count);
+               for (unsigned i = 0; i < dc->count; i++)
+                  printf("File %d: %s\n", i+1, dc->files[i]);
+            }
+            else
             {
-               // Kickstart rom not found
-               fprintf(stderr, "Kickstart rom '%s' not found.\n", (const char*)&kickstart);
-               fprintf(stderr, "You must have a correct kickstart file ('%s') in your RetroArch system directory.\n", kickstart);
-               fclose(configfile);
-               return false;
+               // Add the file to disk control context
+               // Maybe, in a later version of retroarch, we could add disk on the fly (didn't find how to do this)
+               dc_add_file(dc, full_path);
             }
 
-            fprintf(configfile, "kickstart_rom_file=%s\n", (const char*)&kickstart);
+            // Init first disk
+            dc->index = 0;
+            dc->eject_state = false;
+            printf("Disk (%d) inserted into drive DF0: %s\n", dc->index+1, dc->files[dc->index]);
+            retro_prefs_string(rp, PREF_FLOPPY, 0, dc->files[0]);
 
-            // If argument is a hard drive image file
-            if (  strendswith(full_path, HDF_FILE_EXT)
-               || strendswith(full_path, HDZ_FILE_EXT))
+            // Append rest of the disks to the config if m3u is a MultiDrive-m3u
+            if (strstr(full_path, "(MD)") != NULL)
             {
-               if (opt_use_whdload_hdf)
+               for (unsigned i = 1; i < dc->count; i++)
                {
-                  // Init WHDLoad
-                  char whdload[RETRO_PATH_MAX];
-                  path_join((char*)&whdload, retro_system_directory, WHDLOAD_HDF);
+                  dc->index = i;
+                  if (i <= 3)
+                  {
+                     printf("Disk (%d) inserted into drive DF%d: %s\n", dc->index+1, i, dc->files[dc->index]);
+                     retro_prefs_string(rp, PREF_FLOPPY, i, dc->files[i]);
 
-                  // Verify WHDLoad
-                  if (file_exists(whdload))
-                     fprintf(configfile, "hardfile=read-write,32,1,2,512,%s\n", (const char*)&whdload);
+                     // By default only DF0: is enabled, so the drive type needs to be set on the extra drives
+                     retro_prefs_index(rp, PREF_FLOPPY_TYPE, i, 0); // 0 = 3.5" DD
+                  }
                   else
-                     fprintf(stderr, "WHDLoad image file '%s' not found.\n", (const char*)&whdload);
-               }
-               fprintf(configfile, "hardfile=read-write,32,1,2,512,%s\n", full_path);
-            }
-            else
-            {
-               // If argument is a m3u playlist
-               if (strendswith(full_path, M3U_FILE_EXT))
-               {
-                  // Parse the m3u file
-                  dc_parse_m3u(dc, full_path);
-
-                  // Some debugging
-                  printf("M3U file parsed, %d file(s) found\n", dc->count);
-                  for (unsigned i = 0; i < dc->count; i++)
-                     printf("File %d: %s\n", i+1, dc->files[i]);
-               }
-               else
-               {
-                  // Add the file to disk control context
-                  // Maybe, in a later version of retroarch, we could add disk on the fly (didn't find how to do this)
-                  dc_add_file(dc, full_path);
-               }
-
-               // Init first disk
-               dc->index = 0;
-               dc->eject_state = false;
-               printf("Disk (%d) inserted into drive DF0: %s\n", dc->index+1, dc->files[dc->index]);
-               fprintf(configfile, "floppy0=%s\n", dc->files[0]);
-
-               // Append rest of the disks to the config if m3u is a MultiDrive-m3u
-               if (strstr(full_path, "(MD)") != NULL)
-               {
-                  for (unsigned i = 1; i < dc->count; i++)
                   {
-                     dc->index = i;
-                     if (i <= 3)
-                     {
-                        printf("Disk (%d) inserted into drive DF%d: %s\n", dc->index+1, i, dc->files[dc->index]);
-                        fprintf(configfile, "floppy%d=%s\n", i, dc->files[i]);
-
-                        // By default only DF0: is enabled, so floppyXtype needs to be set on the extra drives
-                        if (i > 0)
-                           fprintf(configfile, "floppy%dtype=%d\n", i, 0); // 0 = 3.5" DD
-                     }
-                     else
-                     {
-                        fprintf(stderr, "Too many disks for MultiDrive!\n");
-                        fclose(configfile);
-                        return false;
-                     }
+                     fprintf(stderr, "Too many disks for MultiDrive!\n");
+                     return false;
                   }
                }
             }
-            fclose(configfile);
-         }
-         else
-         {
-            // Error
-            fprintf(stderr, "Error while writing '%s' file.\n", (const char*)&RPATH);
-            return false;
          }
       }
+      // If argument is a CD image
+      else if (  strendswith(full_path, CUE_FILE_EXT)
+              || strendswith(full_path, CCD_FILE_EXT)
+              || strendswith(full_path, MDS_FILE_EXT)
+              || strendswith(full_path, ISO_FILE_EXT))
+      {
+         printf("Game '%s' is a CD image. Booting CD32 with Kickstart 3.1 r40.060 rom.\n", full_path);
+
+         model = retro_model_find("CD32");
+         retro_prefs_model(rp, model);
+         retro_prefs_append(rp, &uae_config);
+         retro_prefs_roms(rp, model);
+         retro_prefs_string(rp, PREF_CDIMAGE, 0, full_path);
+      }
       // If argument is an uae file
 	  else if (strendswith(full_path, UAE_FILE_EXT))
 	  {
 	     printf("Game '%s' is an UAE config file.\n", full_path);
 
-	     // Prepend default config
-	     path_join((char*)&RPATH, retro_save_directory, LIBRETRO_PUAE_CONF);
-	     printf("Generating temporary uae config file '%s'.\n", (const char*)&RPATH);
-
-	     // Open tmp config file
-	     FILE * configfile;
-
-	     if (configfile = fopen(RPATH, "w"))
-	     {
-	        char kickstart[RETRO_PATH_MAX];
-
-	        fprintf(configfile, uae_machine);
-	        path_join((char*)&kickstart, retro_system_directory, uae_kickstart);
-
-	        // Write common config
-	        fprintf(configfile, uae_config);
-	        fprintf(configfile, "kickstart_rom_file=%s\n", (const char*)&kickstart);
-
-	        // Iterate parsed file and append all rows to the temporary config
-	        FILE * configfile_custom;
-
-	        char filebuf[4096];
-	        if (configfile_custom = fopen (full_path, "r"))
-	        {
-	           while (fgets(filebuf, sizeof(filebuf), configfile_custom))
-	           {
-	              fprintf(configfile, filebuf);
-               }
-               fclose(configfile_custom);
-            }
-            fclose(configfile);
-         }
-         else
-         {
-            // Error
-            fprintf(stderr, "Error while writing '%s' file.\n", (const char*)&RPATH);
-            return false;
-         }
+	     // Default config first, the file is parsed on top of it
+	     retro_prefs_model(rp, model);
+	     retro_prefs_append(rp, &uae_config);
+	     retro_prefs_roms(rp, model);
+	     retro_prefs_string(rp, PREF_CONFIG_FILE, 0, full_path);
       }
 	  // Other extensions
 	  else
@@ -2875,38 +3251,20 @@ bool retro_load_game(const struct retro_game_info *info)
    // Empty content
    else
    {
-      path_join((char*)&RPATH, retro_save_directory, LIBRETRO_PUAE_CONF);
-      printf("Generating temporary uae config file '%s'.\n", (const char*)&RPATH);
-
-      // Open tmp config file
-      FILE * configfile;
-      if (configfile = fopen(RPATH, "w"))
-      {
-         char kickstart[RETRO_PATH_MAX];
+      // No machine specified we will use the configured one
+      printf("No machine specified. Booting default configuration.\n");
+      retro_prefs_model(rp, model);
 
-         // No machine specified we will use the configured one
-         printf("No machine specified. Booting default configuration.\n");
-         fprintf(configfile, uae_machine);
-         path_join((char*)&kickstart, retro_system_directory, uae_kickstart);
-
-         // Write common config
-         fprintf(configfile, uae_config);
-
-         // Verify kickstart
-         if (!file_exists(kickstart))
-         {
-            // Kickstart rom not found
-            fprintf(stderr, "Kickstart rom '%s' not found.\n", (const char*)&kickstart);
-            fprintf(stderr, "You must have a correct kickstart file ('%s') in your RetroArch system directory.\n", kickstart);
-            fclose(configfile);
-            return false;
-         }
+      // Common config
+      retro_prefs_append(rp, &uae_config);
 
-         fprintf(configfile, "kickstart_rom_file=%s\n", (const char*)&kickstart);
-         fclose(configfile);
-      }
+      retro_prefs_roms(rp, model);
    }
 
+   // Drops unusable entries, fails on a missing kickstart
+   if (!retro_prefs_validate(rp))
+      return false;
+
    if (w<=0 || h<=0 || w>EMULATOR_MAX_WIDTH || h>EMULATOR_MAX_HEIGHT) 
    {
       w = defaultw;
@@ -2939,24 +3297,55 @@ bool retro_load_game_special(unsigned type, const struct retro_game_info *info,
    return false;
 }
 
-size_t retro_serialize_size(void)
+// Not part of the libretro API: netplay and replay tools look it up with
+// dlsym and compare it every frame, 0 while the state digest is disabled
+RETRO_API uint64_t retro_get_state_digest(void)
 {
-   if (firstpass != 1)
+   return statehash_get();
+}
+
+// Not part of the libretro API either: replay tools note positions while
+// recording and seek the replay to them. Positions count scanlines from
+// the start of the recording, in both recording and playback
+RETRO_API uint32_t retro_replay_tell(void)
+{
+   return (input_play || input_record) ? hsync_counter : 0;
+}
+
+RETRO_API bool retro_replay_seek(uint32_t hsync)
+{
+   return inprec_seek(hsync);
+}
+
+// Frontend states are fast compressed, but the size the frontend sees
+// has to stay the same from frame to frame for netplay and run-ahead,
+// so report the uncompressed size and pad the compressed state up to it
+static long retro_save_tempstate(int mode)
+{
+   long size = -1;
+   snprintf(savestate_fname, sizeof(savestate_fname), "%s%suae_tempsave.uss", retro_save_directory, DIR_SEP_STR);
+   savestate_setcompress(mode);
+   if (save_state(savestate_fname, "retro") >= 0)
    {
-      snprintf(savestate_fname, sizeof(savestate_fname), "%s%suae_tempsave.uss", retro_save_directory, DIR_SEP_STR);
-      if (save_state(savestate_fname, "retro") >= 0)
+      FILE *file = fopen(savestate_fname, "rb");
+      if (file)
       {
-         FILE *file = fopen(savestate_fname, "rb");
-         if (file)
-         {
-            size_t size = 0;
-            fseek(file, 0L, SEEK_END);
-            size = ftell(file);
-            fclose(file);
-            return size;
-         }
+         fseek(file, 0L, SEEK_END);
+         size = ftell(file);
+         fclose(file);
       }
    }
+   return size;
+}
+
+size_t retro_serialize_size(void)
+{
+   if (firstpass != 1)
+   {
+      long size = retro_save_tempstate(0);
+      if (size > 0)
+         return size;
+   }
    return 0;
 }
 
@@ -2964,15 +3353,19 @@ bool retro_serialize(void *data_, size_t size)
 {
    if (firstpass != 1)
    {
-      snprintf(savestate_fname, sizeof(savestate_fname), "%s%suae_tempsave.uss", retro_save_directory, DIR_SEP_STR);
-      if (save_state(savestate_fname, "retro") >= 0)
+      long len = retro_save_tempstate(5);
+      // Incompressible memory, the uncompressed state always fits
+      if (len > (long)size)
+         len = retro_save_tempstate(0);
+      if (len > 0 && len <= (long)size)
       {
          FILE *file = fopen(savestate_fname, "rb");
          if (file)
          {
-            if (fread(data_, size, 1, file) == 1)
+            if (fread(data_, len, 1, file) == 1)
             {
                fclose(file);
+               memset((uint8_t*)data_ + len, 0, size - len);
                return true;
             }
             fclose(file);
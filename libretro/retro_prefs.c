@@ -0,0 +1,436 @@
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "options.h"
+#include "cfgfile.h"
+#include "custom.h"
+#include "disk.h"
+#include "blkdev.h"
+#include "zfile.h"
+#include "filesys.h"
+
+#include "retro_files.h"
+#include "retro_prefs.h"
+
+UAE_TLS struct retro_prefs retro_boot_prefs;
+
+void retro_prefs_clear(struct retro_prefs *rp)
+{
+   for (int i = 0; i < rp->count; i++)
+      free(rp->list[i].s);
+   free(rp->list);
+   rp->list = NULL;
+   rp->count = rp->size = 0;
+}
+
+static struct retro_pref *retro_prefs_add(struct retro_prefs *rp, int key, int index)
+{
+   struct retro_pref *e;
+
+   if (rp->count >= rp->size)
+   {
+      int size = rp->size ? rp->size * 2 : 32;
+      struct retro_pref *list = (struct retro_pref*)realloc(rp->list, size * sizeof(*list));
+      if (!list)
+         return NULL;
+      rp->list = list;
+      rp->size = size;
+   }
+   e = &rp->list[rp->count++];
+   memset(e, 0, sizeof(*e));
+   e->key = key;
+   e->index = index;
+   return e;
+}
+
+void retro_prefs_int(struct retro_prefs *rp, int key, int value)
+{
+   retro_prefs_index(rp, key, 0, value);
+}
+
+void retro_prefs_index(struct retro_prefs *rp, int key, int index, int value)
+{
+   struct retro_pref *e = retro_prefs_add(rp, key, index);
+   if (e)
+      e->i = value;
+}
+
+void retro_prefs_double(struct retro_prefs *rp, int key, double value)
+{
+   struct retro_pref *e = retro_prefs_add(rp, key, 0);
+   if (e)
+      e->d = value;
+}
+
+void retro_prefs_string(struct retro_prefs *rp, int key, int index, const char *value)
+{
+   struct retro_pref *e = retro_prefs_add(rp, key, index);
+   if (e)
+      e->s = strdup(value);
+}
+
+void retro_prefs_append(struct retro_prefs *rp, const struct retro_prefs *src)
+{
+   for (int i = 0; i < src->count; i++)
+   {
+      const struct retro_pref *s = &src->list[i];
+      struct retro_pref *e = retro_prefs_add(rp, s->key, s->index);
+      if (!e)
+         break;
+      e->i = s->i;
+      e->d = s->d;
+      if (s->s)
+         e->s = strdup(s->s);
+   }
+}
+
+static bool pref_in_range(const struct retro_pref *e, int min, int max)
+{
+   return e->i >= min && e->i <= max;
+}
+
+/* Checks every entry before anything touches the emulator. Out of range
+ * values and missing media are dropped so the built-in default stays in
+ * effect, a missing kickstart fails the whole load. */
+bool retro_prefs_validate(struct retro_prefs *rp)
+{
+   bool kickstart = false, config = false, ok = true;
+   int i, n = 0;
+
+   for (i = 0; i < rp->count; i++)
+   {
+      struct retro_pref *e = &rp->list[i];
+      bool valid = true;
+
+      switch (e->key)
+      {
+         case PREF_CPU_MODEL:
+            valid = e->i == 68000 || e->i == 68010 || e->i == 68020
+               || e->i == 68030 || e->i == 68040 || e->i == 68060;
+            break;
+         case PREF_CHIPMEM:
+            valid = e->i >= 0x40000 && e->i <= 0x800000 && !(e->i & 0x3ffff);
+            break;
+         case PREF_BOGOMEM:
+            valid = e->i >= 0 && e->i <= 0x1c0000 && !(e->i & 0x3ffff);
+            break;
+         case PREF_FASTMEM:
+            valid = e->i >= 0 && e->i <= 0x800000 && !(e->i & 0xfffff);
+            break;
+         case PREF_CHIPSET_COMPAT:
+            valid = pref_in_range(e, 0, CP_A4000T);
+            break;
+         case PREF_CHIPSET_MASK:
+            valid = pref_in_range(e, 0, CSMASK_AGA | CSMASK_ECS_DENISE | CSMASK_ECS_AGNUS);
+            break;
+         case PREF_CPU_THROTTLE:
+            valid = e->d >= -900.0 && e->d <= 5000.0;
+            break;
+         case PREF_SOUND_OUTPUT:
+         case PREF_COLLISION_LEVEL:
+            valid = pref_in_range(e, 0, 3);
+            break;
+         case PREF_SOUND_SEPARATION:
+            valid = pref_in_range(e, 0, 10);
+            break;
+         case PREF_SOUND_INTERPOL:
+            valid = pref_in_range(e, 0, 4);
+            break;
+         case PREF_SOUND_FILTER:
+         case PREF_XCENTER:
+         case PREF_YCENTER:
+         case PREF_RESOLUTION:
+         case PREF_VRESOLUTION:
+            valid = pref_in_range(e, 0, 2);
+            break;
+         case PREF_SOUND_FILTER_TYPE:
+         case PREF_WAITING_BLITS:
+            valid = pref_in_range(e, 0, 1);
+            break;
+         case PREF_FLOPPY_SPEED:
+            valid = e->i >= 0;
+            break;
+         case PREF_FLOPPY_VOLUME:
+            valid = pref_in_range(e, 0, 100);
+            break;
+         case PREF_MOUSE_SPEED:
+            valid = e->i > 0;
+            break;
+         case PREF_FRAMERATE:
+            valid = e->i >= 1;
+            break;
+         case PREF_FLOPPY_CLICK_EXT:
+            valid = e->s && e->s[0];
+            break;
+         case PREF_FLOPPY_TYPE:
+            valid = e->index >= 0 && e->index < 4 && e->i >= DRV_NONE && e->i <= DRV_35_DD_ESCOM;
+            break;
+         case PREF_FLOPPY:
+            valid = e->index >= 0 && e->index < 4;
+            /* fall through */
+         case PREF_CDIMAGE:
+            if (e->key == PREF_CDIMAGE)
+               valid = e->index >= 0 && e->index < MAX_TOTAL_SCSI_DEVICES;
+            /* fall through */
+         case PREF_HARDFILE:
+         case PREF_KICKSTART_EXT:
+         case PREF_KICKSTART:
+         case PREF_CONFIG_FILE:
+            valid = valid && e->s && file_exists(e->s);
+            if (e->key == PREF_KICKSTART)
+            {
+               kickstart = valid;
+               if (!valid)
+               {
+                  fprintf(stderr, "Kickstart rom '%s' not found.\n", e->s ? e->s : "");
+                  fprintf(stderr, "You must have a correct kickstart file in your RetroArch system directory.\n");
+               }
+            }
+            else if (e->key == PREF_KICKSTART_EXT && !valid)
+               fprintf(stderr, "Extended rom '%s' not found.\n", e->s ? e->s : "");
+            else if (e->key == PREF_CONFIG_FILE)
+               config = valid;
+            break;
+         default:
+            valid = e->key >= 0 && e->key < PREF_MAX;
+            break;
+      }
+
+      if (!valid)
+      {
+         if (e->key != PREF_KICKSTART)
+            fprintf(stderr, "[libretro-uae]: Ignoring invalid setting %d (index %d, value %d, '%s').\n",
+                  e->key, e->index, e->i, e->s ? e->s : "");
+         free(e->s);
+         continue;
+      }
+      rp->list[n++] = *e;
+   }
+   rp->count = n;
+
+   /* A .uae content file may bring its own kickstart */
+   if (!kickstart && !config)
+      ok = false;
+   return ok;
+}
+
+#ifdef GAYLE
+/* Kickstart looks for the rigid disk block in the first 16 blocks */
+static bool hardfile_has_rdb(const char *path)
+{
+   struct zfile *f = zfile_fopen(path, "rb", ZFD_NORMAL);
+   uae_u8 buf[512];
+   bool rdb = false;
+
+   if (!f)
+      return false;
+   for (int i = 0; i < 16 && !rdb; i++)
+   {
+      if (zfile_fread(buf, sizeof buf, 1, f) != 1)
+         break;
+      rdb = !memcmp(buf, "RDSK", 4);
+   }
+   zfile_fclose(f);
+   return rdb;
+}
+#endif
+
+void retro_prefs_apply(const struct retro_prefs *rp, struct uae_prefs *p)
+{
+   int ide_units = 0;
+
+   for (int i = 0; i < rp->count; i++)
+   {
+      const struct retro_pref *e = &rp->list[i];
+      int j;
+
+      switch (e->key)
+      {
+         case PREF_CPU_MODEL:
+            p->cpu_model = e->i;
+            p->fpu_model = 0;
+            p->address_space_24 = 0;
+            break;
+         case PREF_CPU_24BIT:
+            p->address_space_24 = e->i != 0;
+            break;
+         case PREF_CHIPMEM:
+            p->chipmem_size = e->i;
+            break;
+         case PREF_BOGOMEM:
+            p->bogomem_size = e->i;
+            break;
+         case PREF_FASTMEM:
+            p->fastmem_size = e->i;
+            break;
+         case PREF_CHIPSET_COMPAT:
+            p->cs_compatible = e->i;
+            built_in_chipset_prefs(p);
+            break;
+         case PREF_CHIPSET_MASK:
+            p->chipset_mask = e->i;
+            break;
+         case PREF_NTSC:
+            p->ntscmode = e->i != 0;
+            break;
+         case PREF_CPU_COMPATIBLE:
+            p->cpu_compatible = e->i != 0;
+            break;
+         case PREF_CYCLE_EXACT:
+            p->cpu_cycle_exact = p->blitter_cycle_exact = e->i != 0;
+#ifdef JIT
+            if (p->cpu_model >= 68020 && p->cachesize > 0)
+               p->cpu_cycle_exact = p->blitter_cycle_exact = false;
+#endif
+            break;
+         case PREF_CPU_THROTTLE:
+            p->m68k_speed_throttle = e->d;
+            break;
+         case PREF_SOUND_OUTPUT:
+            p->produce_sound = e->i;
+            break;
+         case PREF_SOUND_SEPARATION:
+            p->sound_stereo_separation = e->i;
+            break;
+         case PREF_SOUND_INTERPOL:
+            p->sound_interpol = e->i;
+            break;
+         case PREF_SOUND_FILTER:
+            p->sound_filter = e->i;
+            break;
+         case PREF_SOUND_FILTER_TYPE:
+            p->sound_filter_type = e->i;
+            break;
+         case PREF_FLOPPY_SPEED:
+            p->floppy_speed = e->i;
+            break;
+         case PREF_FLOPPY_VOLUME:
+            p->dfxclickvolume = e->i;
+            break;
+         case PREF_FLOPPY_CLICK:
+            for (j = 0; j < 4; j++)
+               p->floppyslots[j].dfxclick = e->i;
+            break;
+         case PREF_FLOPPY_CLICK_EXT:
+            for (j = 0; j < 4; j++)
+            {
+               _tcsncpy(p->floppyslots[j].dfxclickexternal, e->s, sizeof p->floppyslots[j].dfxclickexternal / sizeof (TCHAR) - 1);
+               p->floppyslots[j].dfxclickexternal[sizeof p->floppyslots[j].dfxclickexternal / sizeof (TCHAR) - 1] = 0;
+            }
+            break;
+         case PREF_MOUSE_SPEED:
+            p->input_mouse_speed = e->i;
+            break;
+         case PREF_IMMEDIATE_BLITS:
+            p->immediate_blits = e->i != 0;
+            break;
+         case PREF_WAITING_BLITS:
+            p->waiting_blits = e->i;
+            break;
+         case PREF_COLLISION_LEVEL:
+            p->collision_level = e->i;
+            break;
+         case PREF_FRAMERATE:
+            p->gfx_framerate = e->i;
+            break;
+         case PREF_HEADLESS:
+            p->headless = e->i != 0;
+            break;
+         case PREF_LOCKSTEP:
+            p->lockstep = e->i != 0;
+            break;
+         case PREF_XCENTER:
+            p->gfx_xcenter = e->i;
+            break;
+         case PREF_YCENTER:
+            p->gfx_ycenter = e->i;
+            break;
+         case PREF_RESOLUTION:
+            p->gfx_resolution = e->i;
+            break;
+         case PREF_VRESOLUTION:
+            p->gfx_vresolution = e->i;
+            p->gfx_scanlines = false;
+            break;
+         case PREF_KICKSTART:
+            _tcsncpy(p->romfile, e->s, sizeof p->romfile / sizeof (TCHAR) - 1);
+            p->romfile[sizeof p->romfile / sizeof (TCHAR) - 1] = 0;
+            break;
+         case PREF_KICKSTART_EXT:
+            _tcsncpy(p->romextfile, e->s, sizeof p->romextfile / sizeof (TCHAR) - 1);
+            p->romextfile[sizeof p->romextfile / sizeof (TCHAR) - 1] = 0;
+            break;
+         case PREF_CDIMAGE:
+            _tcsncpy(p->cdslots[e->index].name, e->s, sizeof p->cdslots[e->index].name / sizeof (TCHAR) - 1);
+            p->cdslots[e->index].name[sizeof p->cdslots[e->index].name / sizeof (TCHAR) - 1] = 0;
+            p->cdslots[e->index].inuse = true;
+            p->cdslots[e->index].type = SCSI_UNIT_DEFAULT;
+            break;
+         case PREF_FLOPPY:
+            _tcsncpy(p->floppyslots[e->index].df, e->s, sizeof p->floppyslots[e->index].df / sizeof (TCHAR) - 1);
+            p->floppyslots[e->index].df[sizeof p->floppyslots[e->index].df / sizeof (TCHAR) - 1] = 0;
+            break;
+         case PREF_FLOPPY_TYPE:
+            p->floppyslots[e->index].dfxtype = e->i;
+            break;
+         case PREF_HARDFILE:
+         {
+#ifdef FILESYS
+            struct uaedev_config_info uci;
+
+            uci_set_defaults(&uci, false);
+            uci.readonly = false;
+            uci.sectors = 32;
+            uci.surfaces = 1;
+            uci.reserved = 2;
+            uci.blocksize = 512;
+            _tcsncpy(uci.rootdir, e->s, sizeof uci.rootdir / sizeof (TCHAR) - 1);
+            uci.rootdir[sizeof uci.rootdir / sizeof (TCHAR) - 1] = 0;
+            uci.type = UAEDEV_HDF;
+#ifdef GAYLE
+            /* Partitioned images go to the A600/A1200 IDE port so that
+             * scsi.device sees a real drive, plain partition images like
+             * WHDLoad.hdf stay on uaehf.device which can mount them */
+            if (p->cs_ide == IDE_A600A1200 && ide_units < 2 && hardfile_has_rdb(e->s))
+            {
+               uci.controller = HD_CONTROLLER_IDE0 + ide_units++;
+               uci.sectors = 0;
+               uci.surfaces = 0;
+               uci.reserved = 0;
+            }
+#endif
+            add_filesys_config(p, -1, &uci);
+#endif
+            break;
+         }
+         case PREF_CONFIG_FILE:
+            /* Parsed by retro_prefs_load() once the typed entries are in */
+            break;
+      }
+   }
+}
+
+/* Replaces target_cfgfile_load() for the libretro core */
+int retro_prefs_load(struct uae_prefs *p)
+{
+   const struct retro_prefs *rp = &retro_boot_prefs;
+   int i, v = 1;
+
+   discard_prefs(p, 0);
+   default_prefs(p, 0);
+   p->config_version = 0;
+
+   retro_prefs_apply(rp, p);
+
+   for (i = 0; i < rp->count; i++)
+   {
+      if (rp->list[i].key == PREF_CONFIG_FILE)
+      {
+         int type = 0;
+         v = cfgfile_load(p, rp->list[i].s, &type, 0, 0);
+      }
+   }
+
+   fixup_prefs(p);
+   return v;
+}
@@ -0,0 +1,85 @@
+#ifndef RETRO_PREFS_H__
+#define RETRO_PREFS_H__
+
+#include <stdbool.h>
+
+//*****************************************************************************
+// In-memory configuration builder
+//
+// The core options and the loaded content are recorded as a list of typed
+// entries and applied straight to struct uae_prefs when the emulator starts,
+// in the same order and with the same side effects as the equivalent .uae
+// lines would have. Nothing is written to disk.
+
+enum retro_pref_key {
+   PREF_CPU_MODEL,         // i: 68000..68060, resets FPU and 24-bit addressing
+   PREF_CPU_24BIT,         // i: bool
+   PREF_CHIPMEM,           // i: bytes
+   PREF_BOGOMEM,           // i: bytes
+   PREF_FASTMEM,           // i: bytes
+   PREF_CHIPSET_COMPAT,    // i: CP_*, applies the built-in chipset defaults
+   PREF_CHIPSET_MASK,      // i: CSMASK_*
+   PREF_NTSC,              // i: bool
+   PREF_CPU_COMPATIBLE,    // i: bool
+   PREF_CYCLE_EXACT,       // i: bool, CPU and blitter
+   PREF_CPU_THROTTLE,      // d
+   PREF_SOUND_OUTPUT,      // i: 0 none .. 3 exact
+   PREF_SOUND_SEPARATION,  // i: 0..10
+   PREF_SOUND_INTERPOL,    // i: 0 none .. 4 crux
+   PREF_SOUND_FILTER,      // i: FILTER_SOUND_*
+   PREF_SOUND_FILTER_TYPE, // i: FILTER_SOUND_TYPE_*
+   PREF_FLOPPY_SPEED,      // i
+   PREF_FLOPPY_VOLUME,     // i: 0 max .. 100 mute
+   PREF_FLOPPY_CLICK,      // i: all drives, 1 internal, -1 external
+   PREF_FLOPPY_CLICK_EXT,  // s: all drives
+   PREF_MOUSE_SPEED,       // i: percent
+   PREF_IMMEDIATE_BLITS,   // i: bool
+   PREF_WAITING_BLITS,     // i: 0 disabled, 1 automatic
+   PREF_COLLISION_LEVEL,   // i: 0 none .. 3 full
+   PREF_FRAMERATE,         // i: 1 = every frame
+   PREF_HEADLESS,          // i: bool, no rendering or sound output
+   PREF_LOCKSTEP,          // i: bool, no host time or host random numbers
+   PREF_XCENTER,           // i: 0 none, 1 simple, 2 smart
+   PREF_YCENTER,           // i: 0 none, 1 simple, 2 smart
+   PREF_RESOLUTION,        // i: RES_*
+   PREF_VRESOLUTION,       // i: VRES_*, clears scanlines
+   PREF_KICKSTART,         // s: path
+   PREF_KICKSTART_EXT,     // s: path, extended rom
+   PREF_FLOPPY,            // s: path, index = drive
+   PREF_FLOPPY_TYPE,       // i: DRV_*, index = drive
+   PREF_HARDFILE,          // s: path, read-write 32/1/2/512 geometry
+   PREF_CDIMAGE,           // s: path, index = unit
+   PREF_CONFIG_FILE,       // s: .uae file parsed on top of everything else
+   PREF_MAX
+};
+
+struct retro_pref {
+   int key;
+   int index;
+   int i;
+   double d;
+   char *s;
+};
+
+struct retro_prefs {
+   struct retro_pref *list;
+   int count;
+   int size;
+};
+
+// Built by retro_load_game(), consumed by the emulator at startup
+extern UAE_TLS struct retro_prefs retro_boot_prefs;
+
+void retro_prefs_clear(struct retro_prefs *rp);
+void retro_prefs_int(struct retro_prefs *rp, int key, int value);
+void retro_prefs_double(struct retro_prefs *rp, int key, double value);
+void retro_prefs_string(struct retro_prefs *rp, int key, int index, const char *value);
+void retro_prefs_index(struct retro_prefs *rp, int key, int index, int value);
+void retro_prefs_append(struct retro_prefs *rp, const struct retro_prefs *src);
+bool retro_prefs_validate(struct retro_prefs *rp);
+
+struct uae_prefs;
+void retro_prefs_apply(const struct retro_prefs *rp, struct uae_prefs *p);
+int retro_prefs_load(struct uae_prefs *p);
+
+#endif
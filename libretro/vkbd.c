@@ -3,13 +3,13 @@
 #include "vkbd_def.h"
 #include "graph.h"
 
-extern int NPAGE;
-extern int SHOWKEYPOS;
-extern int SHOWKEYTRANS;
-extern int SHIFTON;
-extern int vkflag[7];
-extern int video_config_geometry;
-extern int pix_bytes;
+extern UAE_TLS int NPAGE;
+extern UAE_TLS int SHOWKEYPOS;
+extern UAE_TLS int SHOWKEYTRANS;
+extern UAE_TLS int SHIFTON;
+extern UAE_TLS int vkflag[7];
+extern UAE_TLS int video_config_geometry;
+extern UAE_TLS int pix_bytes;
 
 void virtual_kbd(unsigned short int *pixels, int vx, int vy)
 {
@@ -84,7 +84,7 @@ void gui_cd_led (int led)
 
 static void gui_flicker_led2 (int led, int unitnum, int status)
 {
-	static int resetcounter[LED_MAX];
+	static UAE_TLS int resetcounter[LED_MAX];
 	uae_s8 old;
 	uae_s8 *p;
 
@@ -163,7 +163,7 @@ void gui_display(int shortcut)
 
 void gui_message (const char *format,...)
 {   
-       static char msg[2048];
+       static UAE_TLS char msg[2048];
        va_list parms;
 
        va_start (parms,format);
@@ -172,9 +172,9 @@ void gui_message (const char *format,...)
 }
 
 
-static int guijoybutton[MAX_JPORTS];
-static int guijoyaxis[MAX_JPORTS][4];
-static bool guijoychange;
+static UAE_TLS int guijoybutton[MAX_JPORTS];
+static UAE_TLS int guijoyaxis[MAX_JPORTS][4];
+static UAE_TLS bool guijoychange;
 
 void gui_gameport_button_change (int port, int button, int onoff)
 {
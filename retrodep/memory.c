@@ -27,7 +27,7 @@
 #include "include/memory_uae.h"
 #include "misc.h"
 
-uae_u32 max_z3fastmem;
+UAE_TLS uae_u32 max_z3fastmem;
 
 #if defined(NATMEM_OFFSET)
 
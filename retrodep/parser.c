@@ -93,9 +93,9 @@ void uaeser_close (void *vsd)
 
 #define SERIAL_WRITE_BUFFER 100
 #define SERIAL_READ_BUFFER 100
-static uae_u8 outputbuffer[SERIAL_WRITE_BUFFER];
-static uae_u8 outputbufferout[SERIAL_WRITE_BUFFER];
-static uae_u8 inputbuffer[SERIAL_READ_BUFFER];
-static int datainoutput;
-static int dataininput, dataininputcnt;
-static int writepending;
+static UAE_TLS uae_u8 outputbuffer[SERIAL_WRITE_BUFFER];
+static UAE_TLS uae_u8 outputbufferout[SERIAL_WRITE_BUFFER];
+static UAE_TLS uae_u8 inputbuffer[SERIAL_READ_BUFFER];
+static UAE_TLS int datainoutput;
+static UAE_TLS int dataininput, dataininputcnt;
+static UAE_TLS int writepending;
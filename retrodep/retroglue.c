@@ -18,23 +18,25 @@
 
 #include "inputdevice.h"
 void inputdevice_release_all_keys (void);
-extern int mouse_port[NORMAL_JPORTS];
+extern UAE_TLS int mouse_port[NORMAL_JPORTS];
 
 #include "drawing.h"
 #include "hotkeys.h"
+#include "picasso96.h"
+#include "lockstep.h"
 
 #include "libretro.h"
 #include "libretro-glue.h"
 #include "libretro-mapper.h"
-extern unsigned int uae_devices[4];
-extern unsigned int inputdevice_finalized;
-extern int pix_bytes;
+extern UAE_TLS unsigned int uae_devices[4];
+extern UAE_TLS unsigned int inputdevice_finalized;
+extern UAE_TLS int pix_bytes;
 
 #define LOG_MSG(...) 
 #define LOG_MSG2(...) 
 
-extern int defaultw;
-extern int defaulth;
+extern UAE_TLS int defaultw;
+extern UAE_TLS int defaulth;
 
 unsigned short int clut[] = {
 	0x0000,  /* full background transparency */
@@ -43,16 +45,16 @@ unsigned short int clut[] = {
 	0x06AA,  /* opaque + dark orange  */
 } ;
 
-unsigned short int* pixbuf = NULL;
+UAE_TLS unsigned short int* pixbuf = NULL;
 
-extern unsigned short int bmp[1024*1024];
+extern UAE_TLS unsigned short int bmp[1024*1024];
 void retro_audio_cb(short l, short r);
 
-int prefs_changed = 0;
-int vsync_enabled = 0;
-int opt_scrw = 0;
-int opt_scrh = 0;
-unsigned long stat_value = 0;
+UAE_TLS int prefs_changed = 0;
+UAE_TLS int vsync_enabled = 0;
+UAE_TLS int opt_scrw = 0;
+UAE_TLS int opt_scrh = 0;
+UAE_TLS unsigned long stat_value = 0;
 
 int gui_init (void)
 {
@@ -78,6 +80,8 @@ void target_default_options (struct uae_prefs *p, int type)
 /* --- mouse input --- */
 void retro_mouse(int port, int dx, int dy)
 {
+    if (lockstep_input(LOCKSTEP_MOUSE, port, dx, dy))
+        return;
     mouse_port[port] = 1;
     setmousestate(port, 0, dx, 0);
     setmousestate(port, 1, dy, 0);
@@ -85,6 +89,8 @@ void retro_mouse(int port, int dx, int dy)
 
 void retro_mouse_button(int port, int button, int state)
 {
+    if (lockstep_input(LOCKSTEP_MOUSE_BUTTON, port, button, state))
+        return;
     mouse_port[port] = 1;
     setmousebuttonstate(port, button, state);
 }
@@ -92,6 +98,8 @@ void retro_mouse_button(int port, int button, int state)
 /* --- joystick input --- */
 void retro_joystick(int port, int axis, int state)
 {
+    if (lockstep_input(LOCKSTEP_JOY, port, axis, state))
+        return;
     // disable mouse in normal ports, joystick/mouse inverted
     if(port < 2)
     {
@@ -103,6 +111,8 @@ void retro_joystick(int port, int axis, int state)
 
 void retro_joystick_button(int port, int button, int state)
 {
+    if (lockstep_input(LOCKSTEP_JOY_BUTTON, port, button, state))
+        return;
     // disable mouse in normal ports, joystick/mouse inverted
     if(port < 2)
     {
@@ -115,11 +125,15 @@ void retro_joystick_button(int port, int button, int state)
 /* --- keyboard input --- */
 void retro_key_down(int key)
 {
+	if (lockstep_input (LOCKSTEP_KEY, 0, key, 1))
+		return;
 	inputdevice_do_keyboard (key, 1);
 }
 
 void retro_key_up(int key)
 {
+	if (lockstep_input (LOCKSTEP_KEY, 0, key, 0))
+		return;
 	inputdevice_do_keyboard (key, 0);
 }
 
@@ -307,6 +321,127 @@ int check_prefs_changed_gfx (void)
     return 0;
 }
 
+#ifdef PICASSO96
+/***************************************************************
+  Picasso96 functions
+****************************************************************/
+
+extern UAE_TLS int screen_is_picasso, screen_was_picasso;
+
+/* Converted RTG screen, only used when gfx memory is not already in the
+ * frontend pixel format */
+static UAE_TLS uae_u8 *rtg_buffer = NULL;
+static UAE_TLS int rtg_buffer_size = 0;
+
+int picasso_palette (void)
+{
+	int i, changed = 0;
+
+	for (i = 0; i < 256; i++) {
+		int r = picasso96_state.CLUT[i].Red;
+		int g = picasso96_state.CLUT[i].Green;
+		int b = picasso96_state.CLUT[i].Blue;
+		uae_u32 v;
+		if (pix_bytes == 2)
+			v = doMask256 (r, 5, 11) | doMask256 (g, 6, 5) | doMask256 (b, 5, 0);
+		else
+			v = doMask256 (r, 8, 16) | doMask256 (g, 8, 8) | doMask256 (b, 8, 0);
+		if (v != picasso_vidinfo.clut[i]) {
+			picasso_vidinfo.clut[i] = v;
+			changed = 1;
+		}
+	}
+	return changed;
+}
+
+void DX_Invalidate (int first, int count)
+{
+}
+
+int DX_Fill (int dstx, int dsty, int width, int height, uae_u32 color, RGBFTYPE rgbtype)
+{
+	return 0;
+}
+
+void gfx_set_picasso_modeinfo (uae_u32 w, uae_u32 h, uae_u32 depth, RGBFTYPE rgbfmt)
+{
+	int size = w * h * pix_bytes;
+
+	picasso_vidinfo.width = w;
+	picasso_vidinfo.height = h;
+	picasso_vidinfo.depth = depth;
+	picasso_vidinfo.pixbytes = pix_bytes;
+	picasso_vidinfo.rowbytes = w * pix_bytes;
+	picasso_vidinfo.offset = 0;
+	picasso_vidinfo.extra_mem = 1;
+#ifdef WORDS_BIGENDIAN
+	picasso_vidinfo.rgbformat = pix_bytes == 2 ? RGBFB_R5G6B5 : RGBFB_A8R8G8B8;
+#else
+	picasso_vidinfo.rgbformat = pix_bytes == 2 ? RGBFB_R5G6B5PC : RGBFB_B8G8R8A8;
+#endif
+	picasso_vidinfo.selected_rgbformat = rgbfmt;
+
+	if (size > rtg_buffer_size) {
+		free (rtg_buffer);
+		rtg_buffer = (uae_u8*)calloc (1, size);
+		rtg_buffer_size = rtg_buffer ? size : 0;
+	}
+}
+
+void gfx_set_picasso_colors (RGBFTYPE rgbfmt)
+{
+	if (pix_bytes == 2)
+		alloc_colors_picasso (5, 6, 5, 11, 5, 0, rgbfmt);
+	else
+		alloc_colors_picasso (8, 8, 8, 16, 8, 0, rgbfmt);
+}
+
+void gfx_set_picasso_state (int on)
+{
+	if (on == screen_is_picasso)
+		return;
+	screen_was_picasso = screen_is_picasso;
+	screen_is_picasso = on;
+}
+
+uae_u8 *gfx_lock_picasso (bool fullupdate, bool doclear)
+{
+	if (!rtg_buffer)
+		return NULL;
+	picasso_vidinfo.rowbytes = picasso_vidinfo.width * picasso_vidinfo.pixbytes;
+	if (doclear)
+		memset (rtg_buffer, 0, rtg_buffer_size);
+	return rtg_buffer;
+}
+
+void gfx_unlock_picasso (bool dorender)
+{
+}
+
+/* Frame to present while the Picasso96 screen is shown. Gfx memory goes
+ * out as it is when it already is in the frontend format, otherwise the
+ * rows flushpixels () converted into rtg_buffer. */
+bool retro_picasso_screen (const void **data, int *width, int *height, int *pitch)
+{
+	uae_u8 *direct;
+
+	if (!screen_is_picasso || !picasso_on)
+		return false;
+	direct = picasso_direct_screen (width, height, pitch);
+	if (direct) {
+		*data = direct;
+		return true;
+	}
+	if (!rtg_buffer)
+		return false;
+	*data = rtg_buffer;
+	*width = picasso_vidinfo.width;
+	*height = picasso_vidinfo.height;
+	*pitch = picasso_vidinfo.rowbytes;
+	return true;
+}
+#endif
+
 
 /***************************************************************
   Joystick functions
@@ -402,7 +537,7 @@ static TCHAR *get_joystick_friendlyname (int joy)
 	}
 }
 
-struct inputdevice_functions inputdevicefunc_joystick = {
+UAE_TLS struct inputdevice_functions inputdevicefunc_joystick = {
     init_joysticks, 
     close_joysticks, 
     acquire_joystick,
@@ -570,7 +705,7 @@ static int get_mouse_flags (int num)
     return 0;
 }
 
-struct inputdevice_functions inputdevicefunc_mouse = {
+UAE_TLS struct inputdevice_functions inputdevicefunc_mouse = {
     init_mouse,
     close_mouse,
     acquire_mouse,
@@ -668,7 +803,7 @@ static int get_kb_flags (int num)
 	return 0;
 }
 
-struct inputdevice_functions inputdevicefunc_keyboard = {
+UAE_TLS struct inputdevice_functions inputdevicefunc_keyboard = {
     init_kb, 
     close_kb, 
     acquire_kb, 
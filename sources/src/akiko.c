@@ -67,14 +67,14 @@ enum i2c { I2C_WAIT, I2C_START, I2C_DEVICEADDR,	I2C_WORDADDR, I2C_DATA };
 /* max size of one write request */
 #define NVRAM_PAGE_SIZE 16
 
-static uae_u8 cd32_nvram[NVRAM_SIZE], nvram_writetmp[NVRAM_PAGE_SIZE];
-static int nvram_address, nvram_writeaddr;
-static int nvram_rw;
-static int bitcounter = -1, direction = -1;
-static uae_u8 nvram_byte;
-static int scl_out, scl_in, scl_dir, oscl, sda_out, sda_in, sda_dir, osda;
-static int sda_dir_nvram;
-static int state = I2C_WAIT;
+static UAE_TLS uae_u8 cd32_nvram[NVRAM_SIZE], nvram_writetmp[NVRAM_PAGE_SIZE];
+static UAE_TLS int nvram_address, nvram_writeaddr;
+static UAE_TLS int nvram_rw;
+static UAE_TLS int bitcounter = -1, direction = -1;
+static UAE_TLS uae_u8 nvram_byte;
+static UAE_TLS int scl_out, scl_in, scl_dir, oscl, sda_out, sda_in, sda_dir, osda;
+static UAE_TLS int sda_dir_nvram;
+static UAE_TLS int state = I2C_WAIT;
 
 static void nvram_write (int offset, int len)
 {
@@ -287,9 +287,9 @@ static uae_u32 akiko_nvram_read (int offset)
  * 0xb80038-0xb8003b
  */
 
-static uae_u32 akiko_buffer[8];
-static int akiko_read_offset, akiko_write_offset;
-static uae_u32 akiko_result[8];
+static UAE_TLS uae_u32 akiko_buffer[8];
+static UAE_TLS int akiko_read_offset, akiko_write_offset;
+static UAE_TLS uae_u32 akiko_result[8];
 
 #if 0
 static void akiko_c2p_do (void)
@@ -304,61 +304,18 @@ static void akiko_c2p_do (void)
 			akiko_result[i & 7] |= 1 << (i >> 3);
 	}
 }
-#else
-/* Optimised Chunky-to-Planar algorithm by Mequa */
-static uae_u32 akiko_precalc_shift[32];
-static uae_u32 akiko_precalc_bytenum[32][8];
-static void akiko_precalculate (void)
-{
-	uae_u32 i, j;
-	for (i = 0; i < 32; i++) {
-		akiko_precalc_shift  [(int)i] = 1 << i;
-		for (j = 0; j < 8; j++) {
-			akiko_precalc_bytenum[(int)i][(int)j] = (i >> 3) + ((7 - j) << 2);
-		}
-	}
-}
+#endif
+
+#include "akiko_c2p.c"
 
 static void akiko_c2p_do (void)
 {
-	int i;
-
-	for (i = 0; i < 8; i++) {
-		akiko_result[i]    =  (((akiko_buffer[0] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][0])   )
-				    	   |  (((akiko_buffer[1] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][1])   )
-				    	   |  (((akiko_buffer[2] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][2])   )
-				    	   |  (((akiko_buffer[3] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][3])   )
-				    	   |  (((akiko_buffer[4] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][4])   )
-				    	   |  (((akiko_buffer[5] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][5])   )
-				    	   |  (((akiko_buffer[6] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][6])   )
-				    	   |  (((akiko_buffer[7] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][7])   )
-						   |  (((akiko_buffer[0] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][0]) )
-				    	   |  (((akiko_buffer[1] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][1]) )
-				    	   |  (((akiko_buffer[2] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][2]) )
-				    	   |  (((akiko_buffer[3] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][3]) )
-				    	   |  (((akiko_buffer[4] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][4]) )
-				    	   |  (((akiko_buffer[5] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][5]) )
-				    	   |  (((akiko_buffer[6] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][6]) )
-				    	   |  (((akiko_buffer[7] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][7]) )
-						   |  (((akiko_buffer[0] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][0]))
-				    	   |  (((akiko_buffer[1] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][1]))
-				    	   |  (((akiko_buffer[2] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][2]))
-				    	   |  (((akiko_buffer[3] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][3]))
-				    	   |  (((akiko_buffer[4] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][4]))
-				    	   |  (((akiko_buffer[5] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][5]))
-				    	   |  (((akiko_buffer[6] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][6]))
-				    	   |  (((akiko_buffer[7] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][7]))
-						   |  (((akiko_buffer[0] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][0]))
-				    	   |  (((akiko_buffer[1] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][1]))
-				    	   |  (((akiko_buffer[2] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][2]))
-				    	   |  (((akiko_buffer[3] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][3]))
-				    	   |  (((akiko_buffer[4] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][4]))
-				    	   |  (((akiko_buffer[5] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][5]))
-				    	   |  (((akiko_buffer[6] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][6]))
-				    	   |  (((akiko_buffer[7] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][7]));
-	}
-}
+#ifdef AKIKO_C2P_SIMD
+	akiko_c2p_simd (akiko_buffer, akiko_result);
+#else
+	akiko_c2p_scalar (akiko_buffer, akiko_result);
 #endif
+}
 
 static void akiko_c2p_write (int offset, uae_u32 v)
 {
@@ -427,62 +384,65 @@ static uae_u32 akiko_c2p_read (int offset)
 #define CH_ERR_ABNORMALSEEK     0xf0 // %11110000
 #define CH_ERR_NODISK           0xf8 // %11111000
 
-static int subcodecounter;
+static UAE_TLS int subcodecounter;
 
 #define MAX_SUBCODEBUFFER 36
-static volatile int subcodebufferoffset, subcodebufferoffsetw;
-static uae_u8 subcodebufferinuse[MAX_SUBCODEBUFFER];
-static uae_u8 subcodebuffer[MAX_SUBCODEBUFFER * SUB_CHANNEL_SIZE];
-
-static uae_u32 cdrom_intreq, cdrom_intena;
-static uae_u8 cdrom_subcodeoffset;
-static uae_u32 cdrom_addressdata, cdrom_addressmisc;
-static uae_u32 subcode_address, cdrx_address, cdtx_address;
-static uae_u32 cdrom_flags;
-static uae_u32 cdrom_pbx;
-
-static uae_u8 cdcomtxinx; /* 0x19 */
-static uae_u8 cdcomrxinx; /* 0x1a */
-static uae_u8 cdcomtxcmp; /* 0x1d */
-static uae_u8 cdcomrxcmp; /* 0x1f */
-static uae_u8 cdrom_result_buffer[32];
-static uae_u8 cdrom_command_buffer[32];
-static uae_u8 cdrom_command;
-
-static int cdrom_toc_counter;
-static uae_u32 cdrom_toc_crc;
-static uae_u8 cdrom_toc_buffer[MAX_TOC_ENTRIES * 13];
-static struct cd_toc_head cdrom_toc_cd_buffer;
-static uae_u8 qcode_buf[SUBQ_SIZE];
-static int qcode_valid;
-
-static int cdrom_disk, cdrom_paused, cdrom_playing, cdrom_audiostatus;
-static int cdrom_command_active;
-static int cdrom_command_length;
-static int cdrom_checksum_error, cdrom_unknown_command;
-static int cdrom_data_offset, cdrom_speed, cdrom_sector_counter;
-static int cdrom_current_sector, cdrom_seek_delay;
-static int cdrom_data_end;
-static int cdrom_audiotimeout;
-static int cdrom_led;
-static int cdrom_receive_length, cdrom_receive_offset;
-static int cdrom_muted;
-static int cd_initialized;
-static int cdrom_tx_dma_delay;
-
-static uae_u8 *sector_buffer_1, *sector_buffer_2;
-static int sector_buffer_sector_1, sector_buffer_sector_2;
+static UAE_TLS volatile int subcodebufferoffset, subcodebufferoffsetw;
+static UAE_TLS uae_u8 subcodebufferinuse[MAX_SUBCODEBUFFER];
+static UAE_TLS uae_u8 subcodebuffer[MAX_SUBCODEBUFFER * SUB_CHANNEL_SIZE];
+
+static UAE_TLS uae_u32 cdrom_intreq, cdrom_intena;
+static UAE_TLS uae_u8 cdrom_subcodeoffset;
+static UAE_TLS uae_u32 cdrom_addressdata, cdrom_addressmisc;
+static UAE_TLS uae_u32 subcode_address, cdrx_address, cdtx_address;
+static UAE_TLS uae_u32 cdrom_flags;
+static UAE_TLS uae_u32 cdrom_pbx;
+
+static UAE_TLS uae_u8 cdcomtxinx; /* 0x19 */
+static UAE_TLS uae_u8 cdcomrxinx; /* 0x1a */
+static UAE_TLS uae_u8 cdcomtxcmp; /* 0x1d */
+static UAE_TLS uae_u8 cdcomrxcmp; /* 0x1f */
+static UAE_TLS uae_u8 cdrom_result_buffer[32];
+static UAE_TLS uae_u8 cdrom_command_buffer[32];
+static UAE_TLS uae_u8 cdrom_command;
+
+static UAE_TLS int cdrom_toc_counter;
+static UAE_TLS uae_u32 cdrom_toc_crc;
+static UAE_TLS uae_u8 cdrom_toc_buffer[MAX_TOC_ENTRIES * 13];
+static UAE_TLS struct cd_toc_head cdrom_toc_cd_buffer;
+static UAE_TLS uae_u8 qcode_buf[SUBQ_SIZE];
+static UAE_TLS int qcode_valid;
+
+static UAE_TLS int cdrom_disk, cdrom_paused, cdrom_playing, cdrom_audiostatus;
+static UAE_TLS int cdrom_command_active;
+static UAE_TLS int cdrom_command_length;
+static UAE_TLS int cdrom_checksum_error, cdrom_unknown_command;
+static UAE_TLS int cdrom_data_offset, cdrom_speed, cdrom_sector_counter;
+static UAE_TLS int cdrom_current_sector, cdrom_seek_delay;
+static UAE_TLS int cdrom_data_end;
+static UAE_TLS int cdrom_audiotimeout;
+static UAE_TLS int cdrom_led;
+static UAE_TLS int cdrom_receive_length, cdrom_receive_offset;
+static UAE_TLS int cdrom_muted;
+static UAE_TLS int cd_initialized;
+static UAE_TLS int cdrom_tx_dma_delay;
+
+/* Read-ahead ring, sector N lives in slot N % SECTOR_BUFFER_SIZE.
+ * Filled by akiko_thread, host I/O is done without holding akiko_sem. */
+static UAE_TLS uae_u8 *sector_buffer;
+static UAE_TLS int *sector_buffer_sector;
 #define	SECTOR_BUFFER_SIZE 64
-static uae_u8 *sector_buffer_info_1, *sector_buffer_info_2;
+#define	SECTOR_READAHEAD_BATCH 8
+static UAE_TLS uae_u8 *sector_buffer_info;
 
-static int unitnum = -1;
-static bool akiko_inited;
-static volatile int mediachanged, mediacheckcounter;
-static volatile int frame2counter;
+static UAE_TLS int unitnum = -1;
+static UAE_TLS bool akiko_inited;
+static UAE_TLS volatile int mediachanged, mediacheckcounter;
+static UAE_TLS volatile int frame2counter;
 
-static smp_comm_pipe requests;
-static volatile int akiko_thread_running;
-static uae_sem_t akiko_sem, sub_sem;
+static UAE_TLS smp_comm_pipe requests;
+static UAE_TLS volatile int akiko_thread_running;
+static UAE_TLS uae_sem_t akiko_sem, sub_sem;
 
 static void checkint (void)
 {
@@ -628,7 +588,7 @@ static struct cd_toc *get_track (int startlsn)
 	return NULL;
 }
 
-static int last_play_end;
+static UAE_TLS int last_play_end;
 static int cd_play_audio (int startlsn, int endlsn, int scan)
 {
 	struct cd_toc *s = NULL;
@@ -660,7 +620,7 @@ static int cd_play_audio (int startlsn, int endlsn, int scan)
 
 
 /* read qcode */
-static int last_play_pos;
+static UAE_TLS int last_play_pos;
 static int cd_qcode (uae_u8 *d)
 {
 	uae_u8 *buf, *s, as;
@@ -1004,6 +964,8 @@ static int cdrom_command_multi (void)
 			if (cdrom_seek_delay > 100)
 				cdrom_seek_delay = 100;
 		}
+		/* start read-ahead while the emulated seek is in progress */
+		cdrom_current_sector = cdrom_data_offset;
 #if AKIKO_DEBUG_IO_CMD
 		write_log (_T("READ DATA %06X (%d) - %06X (%d) SPD=%dx PC=%08X\n"),
 			seekpos, cdrom_data_offset, endpos, cdrom_data_offset_end, cdrom_speed, M68K_GETPC);
@@ -1198,6 +1160,7 @@ static void cdrom_run_read (void)
 	int i, sector, inc;
 	int sec;
 	int seccnt;
+	uae_u8 buf[2352];
 
 	if (!(cdrom_flags & CDFLAG_ENABLE))
 		return;
@@ -1212,46 +1175,45 @@ static void cdrom_run_read (void)
 	if (unitnum < 0)
 		return;
 
-	inc = 1;
 	// always use highest available slot or Lotus 3 (Lotus Trilogy) fails to load
 	for (seccnt = 15; seccnt >= 0; seccnt--) {
 		if (cdrom_pbx & (1 << seccnt))
 			break;
 	}
 	sector = cdrom_current_sector = cdrom_data_offset + cdrom_sector_counter;
-	sec = sector - sector_buffer_sector_1;
-	if (sector_buffer_sector_1 >= 0 && sec >= 0 && sec < SECTOR_BUFFER_SIZE) {
-		if (sector_buffer_info_1[sec] != 0xff && sector_buffer_info_1[sec] != 0) {
-			uae_u8 buf[2352];
-
-			memcpy (buf, sector_buffer_1 + sec * 2352, 2352);
-			buf[0] = 0;
-			buf[1] = 0;
-			buf[2] = 0;
-			buf[3] = cdrom_sector_counter & 31;
-			for (i = 0; i < 2352; i++)
-				put_byte (cdrom_addressdata + seccnt * 4096 + i, buf[i]);
-			for (i = 0; i < 73 * 2; i++)
-				put_byte (cdrom_addressdata + seccnt * 4096 + 0xc00 + i, 0);
-			cdrom_pbx &= ~(1 << seccnt);
-			set_status (CDINTERRUPT_PBX);
+	sec = sector % SECTOR_BUFFER_SIZE;
+	inc = 0;
+	uae_sem_wait (&akiko_sem);
+	if (sector_buffer_sector[sec] == sector) {
+		if (sector_buffer_info[sec]) {
+			memcpy (buf, sector_buffer + sec * 2352, 2352);
+			inc = 1;
 		} else {
-			inc = 0;
+			/* read error, let the thread try again */
+			sector_buffer_sector[sec] = -1;
 		}
-		if (sector_buffer_info_1[sec] != 0xff)
-			sector_buffer_info_1[sec]--;
+	}
+	uae_sem_post (&akiko_sem);
+	if (inc) {
+		buf[0] = 0;
+		buf[1] = 0;
+		buf[2] = 0;
+		buf[3] = cdrom_sector_counter & 31;
+		for (i = 0; i < 2352; i++)
+			put_byte (cdrom_addressdata + seccnt * 4096 + i, buf[i]);
+		for (i = 0; i < 73 * 2; i++)
+			put_byte (cdrom_addressdata + seccnt * 4096 + 0xc00 + i, 0);
+		cdrom_pbx &= ~(1 << seccnt);
+		set_status (CDINTERRUPT_PBX);
 #if AKIKO_DEBUG_IO_CMD
 		write_log (_T("pbx=%04x sec=%d, scnt=%d -> %d. %d (%04x) %08X\n"),
 			cdrom_pbx, cdrom_data_offset, cdrom_sector_counter, sector, seccnt, 1 << seccnt, cdrom_addressdata + seccnt * 4096);
 #endif
-	} else {
-		inc = 0;
-	}
-	if (inc)
 		cdrom_sector_counter++;
+	}
 }
 
-static int lastmediastate = 0;
+static UAE_TLS int lastmediastate = 0;
 
 static void akiko_handler (bool framesync)
 {
@@ -1323,7 +1285,7 @@ void AKIKO_hsync_handler (void)
 	if (!currprefs.cs_cd32cd || !akiko_inited)
 		return;
 
-	static float framecounter;
+	static UAE_TLS float framecounter;
 	framecounter--;
 	if (framecounter <= 0) {
 		if (cdrom_seek_delay <= 0) {
@@ -1373,16 +1335,64 @@ void AKIKO_hsync_handler (void)
 	akiko_handler (framesync);
 }
 
-/* cdrom data buffering thread */
-static void *akiko_thread (void *null)
+static void cdrom_readahead_flush (void)
 {
 	int i;
-	uae_u8 *tmp1;
-	uae_u8 *tmp2;
-	int tmp3;
-	int offset;
-	int sector;
 
+	uae_sem_wait (&akiko_sem);
+	for (i = 0; i < SECTOR_BUFFER_SIZE; i++)
+		sector_buffer_sector[i] = -1;
+	uae_sem_post (&akiko_sem);
+}
+
+/* Fetch the first missing sectors in front of the drive head. Only the
+ * ring bookkeeping is done under akiko_sem, emulation never waits for
+ * host I/O. Returns false when the window is already full. */
+static bool cdrom_readahead (void)
+{
+	uae_u8 buf[2352];
+	int cnt, sector, head, ok;
+
+	for (cnt = 0; cnt < SECTOR_READAHEAD_BATCH; cnt++) {
+		uae_sem_wait (&akiko_sem);
+		head = cdrom_current_sector;
+		sector = -1;
+		if (head >= 0 && cdrom_data_end > 0) {
+			for (sector = head; sector < head + SECTOR_BUFFER_SIZE && sector < cdrom_data_end; sector++) {
+				if (sector_buffer_sector[sector % SECTOR_BUFFER_SIZE] != sector)
+					break;
+			}
+			if (sector >= head + SECTOR_BUFFER_SIZE || sector >= cdrom_data_end)
+				sector = -1;
+		}
+		uae_sem_post (&akiko_sem);
+		if (sector < 0)
+			break;
+
+		ok = sys_command_cd_rawread (unitnum, buf, sector, 1, 2352);
+
+		uae_sem_wait (&akiko_sem);
+		head = cdrom_current_sector;
+		/* drop it if the head moved elsewhere meanwhile */
+		if (head >= 0 && sector >= head && sector < head + SECTOR_BUFFER_SIZE) {
+			int sec = sector % SECTOR_BUFFER_SIZE;
+			if (ok)
+				memcpy (sector_buffer + sec * 2352, buf, 2352);
+			sector_buffer_info[sec] = ok ? 1 : 0;
+			sector_buffer_sector[sec] = sector;
+		}
+		uae_sem_post (&akiko_sem);
+	}
+#if AKIKO_DEBUG_IO_CMD
+	if (cnt)
+		write_log (_T("read-ahead %d sectors, head=%d (max=%d)\n"), cnt, cdrom_current_sector, cdrom_data_end);
+#endif
+	return cnt > 0;
+}
+
+/* cdrom data buffering thread */
+static void *akiko_thread (void *null)
+{
 	while (akiko_thread_running || comm_pipe_has_data (&requests)) {
 
 		if (comm_pipe_has_data (&requests)) {
@@ -1423,6 +1433,7 @@ static void *akiko_thread (void *null)
 				media = lastmediastate = cdrom_disk = 0;
 				mediachanged = 1;
 				cdaudiostop_do ();
+				cdrom_readahead_flush ();
 			} else if (media != lastmediastate) {
 				if (!media && lastmediastate > 1) {
 					// ignore missing media if statefile restored with cd present
@@ -1434,44 +1445,13 @@ static void *akiko_thread (void *null)
 				lastmediastate = cdrom_disk = media;
 				mediachanged = 1;
 				cdaudiostop_do ();
+				cdrom_readahead_flush ();
 			}
 		}
 		}
 
-		uae_sem_wait (&akiko_sem);
-		sector = cdrom_current_sector;
-		for (i = 0; i < SECTOR_BUFFER_SIZE; i++) {
-			if (sector_buffer_info_1[i] == 0xff)
-				break;
-		}
-		if (cdrom_data_end > 0 && sector >= 0 &&
-			(sector_buffer_sector_1 < 0 || sector < sector_buffer_sector_1 || sector >= sector_buffer_sector_1 + SECTOR_BUFFER_SIZE * 2 / 3 || i != SECTOR_BUFFER_SIZE)) {
-				memset (sector_buffer_info_2, 0, SECTOR_BUFFER_SIZE);
-#if AKIKO_DEBUG_IO_CMD
-				write_log (_T("filling buffer sector=%d (max=%d)\n"), sector, cdrom_data_end);
-#endif
-				sector_buffer_sector_2 = sector;
-				offset = 0;
-				while (offset < SECTOR_BUFFER_SIZE) {
-					int ok = 0;
-					if (sector < cdrom_data_end)
-						ok = sys_command_cd_rawread (unitnum, sector_buffer_2 + offset * 2352, sector, 1, 2352);
-					sector_buffer_info_2[offset] = ok ? 3 : 0;
-					offset++;
-					sector++;
-				}
-				tmp1 = sector_buffer_info_1;
-				sector_buffer_info_1 = sector_buffer_info_2;
-				sector_buffer_info_2 = tmp1;
-				tmp2 = sector_buffer_1;
-				sector_buffer_1 = sector_buffer_2;
-				sector_buffer_2 = tmp2;
-				tmp3 = sector_buffer_sector_1;
-				sector_buffer_sector_1 = sector_buffer_sector_2;
-				sector_buffer_sector_2 = tmp3;
-		}
-		uae_sem_post (&akiko_sem);
-		sleep_millis (10);
+		if (!cdrom_readahead ())
+			sleep_millis (10);
 	}
 	akiko_thread_running = -1;
 	return 0;
@@ -1541,8 +1521,7 @@ static uae_u32 akiko_bget2 (uaecptr addr, int msg)
 	uae_sem_wait (&akiko_sem);
 	switch (addr)
 	{
-		if (currprefs.cs_cd32cd) {
-			/* CDROM control */
+	/* CDROM control */
 	case 0x04:
 	case 0x05:
 	case 0x06:
@@ -1589,10 +1568,6 @@ static uae_u32 akiko_bget2 (uaecptr addr, int msg)
 	case 0x27:
 		v = akiko_get_long (cdrom_flags, addr - 0x24);
 		break;
-		} else if (addr < 0x30) {
-			break;
-		}
-
 	default:
 		write_log (_T("akiko_bget: unknown address %08X PC=%08X\n"), addr, M68K_GETPC);
 		v = 0;
@@ -1676,7 +1651,6 @@ static void akiko_bput2 (uaecptr addr, uae_u32 v, int msg)
 	uae_sem_wait (&akiko_sem);
 	switch (addr)
 	{
-		if (currprefs.cs_cd32cd) {
 	case 0x04:
 	case 0x05:
 	case 0x06:
@@ -1745,10 +1719,6 @@ static void akiko_bput2 (uaecptr addr, uae_u32 v, int msg)
 			uae_sem_post (&sub_sem);
 		}
 		break;
-		} else if (addr < 0x30) {
-			break;
-		}
-
 	default:
 		write_log (_T("akiko_bput: unknown address %08X=%02X PC=%08X\n"), addr, v & 0xff, M68K_GETPC);
 		break;
@@ -1791,7 +1761,7 @@ static void REGPARAM2 akiko_lput (uaecptr addr, uae_u32 v)
 	akiko_bput2 (addr + 0, (v >> 24) & 0xff, 0);
 }
 
-addrbank akiko_bank = {
+UAE_TLS addrbank akiko_bank = {
 	akiko_lget, akiko_wget, akiko_bget,
 	akiko_lput, akiko_wput, akiko_bput,
 	default_xlate, default_check, NULL, _T("Akiko"),
@@ -1806,12 +1776,16 @@ static void patchrom (void)
 		uae_u8 *p = (uae_u8*)extendedkickmemory;
 		for (i = 0; i < 524288 - sizeof (patchdata); i++) {
 			if (!memcmp (p + i, patchdata, sizeof(patchdata))) {
+#ifdef NATMEM_OFFSET
 				protect_roms (false);
+#endif
 				p[i + 6] = 0x4e;
 				p[i + 7] = 0x71;
 				p[i + 8] = 0x4e;
 				p[i + 9] = 0x71;
+#ifdef NATMEM_OFFSET
 				protect_roms (true);
+#endif
 				write_log (_T("extended rom delay loop patched at 0x%p\n"), i + 6 + 0xe00000);
 				return;
 			}
@@ -1823,14 +1797,12 @@ static void patchrom (void)
 static void akiko_cdrom_free (void)
 {
 	sys_cddev_close ();
-	xfree (sector_buffer_1);
-	xfree (sector_buffer_2);
-	xfree (sector_buffer_info_1);
-	xfree (sector_buffer_info_2);
-	sector_buffer_1 = 0;
-	sector_buffer_2 = 0;
-	sector_buffer_info_1 = 0;
-	sector_buffer_info_2 = 0;
+	xfree (sector_buffer);
+	xfree (sector_buffer_sector);
+	xfree (sector_buffer_info);
+	sector_buffer = 0;
+	sector_buffer_sector = 0;
+	sector_buffer_info = 0;
 }
 
 void akiko_reset (void)
@@ -1881,12 +1853,11 @@ int akiko_init (void)
 	akiko_precalculate ();
 	unitnum = -1;
 	sys_cddev_open ();
-	sector_buffer_1 = xmalloc (uae_u8, SECTOR_BUFFER_SIZE * 2352);
-	sector_buffer_2 = xmalloc (uae_u8, SECTOR_BUFFER_SIZE * 2352);
-	sector_buffer_info_1 = xmalloc (uae_u8, SECTOR_BUFFER_SIZE);
-	sector_buffer_info_2 = xmalloc (uae_u8, SECTOR_BUFFER_SIZE);
-	sector_buffer_sector_1 = -1;
-	sector_buffer_sector_2 = -1;
+	sector_buffer = xmalloc (uae_u8, SECTOR_BUFFER_SIZE * 2352);
+	sector_buffer_sector = xmalloc (int, SECTOR_BUFFER_SIZE);
+	sector_buffer_info = xmalloc (uae_u8, SECTOR_BUFFER_SIZE);
+	for (int i = 0; i < SECTOR_BUFFER_SIZE; i++)
+		sector_buffer_sector[i] = -1;
 	uae_sem_init (&akiko_sem, 0, 1);
 	uae_sem_init (&sub_sem, 0, 1);
 	if (!savestate_state) {
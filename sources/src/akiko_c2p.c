@@ -0,0 +1,119 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Akiko chunky to planar kernels
+  *
+  * #included by akiko.c, and by test/test_c2p.c which checks the SIMD
+  * kernel against the scalar one.
+  */
+
+/* The C2P result is an 8x32 bit matrix transpose: bit i of byte k of
+ * akiko_buffer[j] becomes bit k + 4 * (7 - j) of akiko_result[i]. With
+ * the buffer words stored in reverse order that is bit i of byte n going
+ * to bit n, so each plane is one byte sign mask of the 32 byte vector
+ * shifted left by 7 - i. */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define AKIKO_C2P_SSE2
+#define AKIKO_C2P_SIMD
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <arm_neon.h>
+#define AKIKO_C2P_NEON
+#define AKIKO_C2P_SIMD
+#endif
+
+/* Optimised Chunky-to-Planar algorithm by Mequa */
+static UAE_TLS uae_u32 akiko_precalc_shift[32];
+static UAE_TLS uae_u32 akiko_precalc_bytenum[32][8];
+static void akiko_precalculate (void)
+{
+	uae_u32 i, j;
+	for (i = 0; i < 32; i++) {
+		akiko_precalc_shift  [(int)i] = 1 << i;
+		for (j = 0; j < 8; j++) {
+			akiko_precalc_bytenum[(int)i][(int)j] = (i >> 3) + ((7 - j) << 2);
+		}
+	}
+}
+
+static void akiko_c2p_scalar (const uae_u32 *buffer, uae_u32 *result)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		result[i] = (((buffer[0] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][0])   )
+			| (((buffer[1] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][1])   )
+			| (((buffer[2] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][2])   )
+			| (((buffer[3] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][3])   )
+			| (((buffer[4] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][4])   )
+			| (((buffer[5] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][5])   )
+			| (((buffer[6] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][6])   )
+			| (((buffer[7] & akiko_precalc_shift[i])    != 0) << (akiko_precalc_bytenum[i][7])   )
+			| (((buffer[0] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][0]) )
+			| (((buffer[1] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][1]) )
+			| (((buffer[2] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][2]) )
+			| (((buffer[3] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][3]) )
+			| (((buffer[4] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][4]) )
+			| (((buffer[5] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][5]) )
+			| (((buffer[6] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][6]) )
+			| (((buffer[7] & akiko_precalc_shift[i+8])  != 0) << (akiko_precalc_bytenum[i+8][7]) )
+			| (((buffer[0] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][0]))
+			| (((buffer[1] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][1]))
+			| (((buffer[2] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][2]))
+			| (((buffer[3] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][3]))
+			| (((buffer[4] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][4]))
+			| (((buffer[5] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][5]))
+			| (((buffer[6] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][6]))
+			| (((buffer[7] & akiko_precalc_shift[i+16]) != 0) << (akiko_precalc_bytenum[i+16][7]))
+			| (((buffer[0] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][0]))
+			| (((buffer[1] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][1]))
+			| (((buffer[2] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][2]))
+			| (((buffer[3] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][3]))
+			| (((buffer[4] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][4]))
+			| (((buffer[5] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][5]))
+			| (((buffer[6] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][6]))
+			| (((buffer[7] & akiko_precalc_shift[i+24]) != 0) << (akiko_precalc_bytenum[i+24][7]));
+	}
+}
+
+#if defined(AKIKO_C2P_SSE2)
+static void akiko_c2p_simd (const uae_u32 *buffer, uae_u32 *result)
+{
+	__m128i lo = _mm_set_epi32 (buffer[4], buffer[5], buffer[6], buffer[7]);
+	__m128i hi = _mm_set_epi32 (buffer[0], buffer[1], buffer[2], buffer[3]);
+	int i;
+
+	for (i = 7; i >= 0; i--) {
+		result[i] = (uae_u32)_mm_movemask_epi8 (lo) | ((uae_u32)_mm_movemask_epi8 (hi) << 16);
+		lo = _mm_add_epi8 (lo, lo);
+		hi = _mm_add_epi8 (hi, hi);
+	}
+}
+#elif defined(AKIKO_C2P_NEON)
+STATIC_INLINE uae_u32 akiko_movemask_neon (uint8x16_t v)
+{
+	static const uae_u8 weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t m = vandq_u8 (vreinterpretq_u8_s8 (vshrq_n_s8 (vreinterpretq_s8_u8 (v), 7)), vld1q_u8 (weights));
+	uint8x8_t t = vpadd_u8 (vget_low_u8 (m), vget_high_u8 (m));
+	t = vpadd_u8 (t, t);
+	t = vpadd_u8 (t, t);
+	return vget_lane_u8 (t, 0) | (vget_lane_u8 (t, 1) << 8);
+}
+
+static void akiko_c2p_simd (const uae_u32 *buffer, uae_u32 *result)
+{
+	uae_u32 tmp[8];
+	uint8x16_t lo, hi;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		tmp[i] = buffer[7 - i];
+	lo = vld1q_u8 ((const uae_u8*)&tmp[0]);
+	hi = vld1q_u8 ((const uae_u8*)&tmp[4]);
+	for (i = 7; i >= 0; i--) {
+		result[i] = akiko_movemask_neon (lo) | (akiko_movemask_neon (hi) << 16);
+		lo = vshlq_n_u8 (lo, 1);
+		hi = vshlq_n_u8 (hi, 1);
+	}
+}
+#endif
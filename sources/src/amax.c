@@ -14,12 +14,12 @@
 static int data_scramble[8] = { 3, 2, 4, 5, 7, 6, 0, 1 };
 static int addr_scramble[16] = { 14, 12, 2, 10, 15, 13, 1, 0, 7, 6, 5, 4, 8, 9, 11, 3 };
 
-static int romptr;
-static uae_u8 *rom;
-static int amax_rom_size, rom_oddeven;
-static uae_u8 data;
-static uae_u8 bfd100, bfe001;
-static uae_u8 dselect;
+static UAE_TLS int romptr;
+static UAE_TLS uae_u8 *rom;
+static UAE_TLS int amax_rom_size, rom_oddeven;
+static UAE_TLS uae_u8 data;
+static UAE_TLS uae_u8 bfd100, bfe001;
+static UAE_TLS uae_u8 dselect;
 
 #define AMAX_LOG 0
 
@@ -59,7 +59,7 @@ static void amax_check (void)
 	}
 }
 
-static int dwlastbit;
+static UAE_TLS int dwlastbit;
 
 void amax_diskwrite (uae_u16 w)
 {
@@ -79,7 +79,7 @@ void amax_diskwrite (uae_u16 w)
 	amax_check ();
 }
 
-static uae_u8 bfe001_ov;
+static UAE_TLS uae_u8 bfe001_ov;
 
 void amax_bfe001_write (uae_u8 pra, uae_u8 dra)
 {
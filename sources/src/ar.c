@@ -235,29 +235,29 @@ static TCHAR *cart_memnames[] = { NULL, _T("hrtmon"), _T("arhrtmon"), _T("superi
 #define CART_AR1200 2
 #define CART_SUPER4 3
 
-uae_u8 ar_custom[2*256];
-uae_u8 ar_ciaa[16], ar_ciab[16];
-static int hrtmon_ciadiv = 256;
+UAE_TLS uae_u8 ar_custom[2*256];
+UAE_TLS uae_u8 ar_ciaa[16], ar_ciab[16];
+static UAE_TLS int hrtmon_ciadiv = 256;
 
-int hrtmon_flag = ACTION_REPLAY_INACTIVE;
-static int cart_type;
+UAE_TLS int hrtmon_flag = ACTION_REPLAY_INACTIVE;
+static UAE_TLS int cart_type;
 
-static uae_u8 *hrtmemory = 0, *hrtmemory2 = 0, *hrtmemory3 = 0;
-static uae_u8 *armemory_rom = 0, *armemory_ram = 0;
+static UAE_TLS uae_u8 *hrtmemory = 0, *hrtmemory2 = 0, *hrtmemory3 = 0;
+static UAE_TLS uae_u8 *armemory_rom = 0, *armemory_ram = 0;
 
-static uae_u32 hrtmem_mask, hrtmem2_mask, hrtmem3_mask;
-static uae_u8 *hrtmon_custom, *hrtmon_ciaa, *hrtmon_ciab, *hrtmon_zeropage;
-uae_u32 hrtmem_start, hrtmem2_start, hrtmem3_start, hrtmem_size, hrtmem2_size, hrtmem2_size2, hrtmem3_size;
-uae_u32 hrtmem_end, hrtmem2_end;
-static int hrtmem_rom;
-static int triggered_once;
-static bool action_replay_hardreset;
+static UAE_TLS uae_u32 hrtmem_mask, hrtmem2_mask, hrtmem3_mask;
+static UAE_TLS uae_u8 *hrtmon_custom, *hrtmon_ciaa, *hrtmon_ciab, *hrtmon_zeropage;
+UAE_TLS uae_u32 hrtmem_start, hrtmem2_start, hrtmem3_start, hrtmem_size, hrtmem2_size, hrtmem2_size2, hrtmem3_size;
+UAE_TLS uae_u32 hrtmem_end, hrtmem2_end;
+static UAE_TLS int hrtmem_rom;
+static UAE_TLS int triggered_once;
+static UAE_TLS bool action_replay_hardreset;
 
 static void hrtmon_unmap_banks (void);
 
 void check_prefs_changed_carts (int in_memory_reset);
 
-static int stored_picasso_on = -1;
+static UAE_TLS int stored_picasso_on = -1;
 
 static void cartridge_enter (void)
 {
@@ -333,7 +333,7 @@ static uae_u8 *REGPARAM2 hrtmem3_xlate (uaecptr addr)
 static uae_u32 REGPARAM2 hrtmem2_bget (uaecptr addr)
 {
 	if (addr == 0xb8007c && cart_type == CART_SUPER4) {
-		static int cnt = 60;
+		static UAE_TLS int cnt = 60;
 		cnt--;
 		if (cnt == 0)
 			uae_reset(0, 0);
@@ -460,19 +460,19 @@ static uae_u8 *REGPARAM2 hrtmem_xlate (uaecptr addr)
 	return hrtmemory + addr;
 }
 
-static addrbank hrtmem_bank = {
+static UAE_TLS addrbank hrtmem_bank = {
 	hrtmem_lget, hrtmem_wget, hrtmem_bget,
 	hrtmem_lput, hrtmem_wput, hrtmem_bput,
 	hrtmem_xlate, hrtmem_check, NULL, _T("Cartridge Bank"),
 	hrtmem_lget, hrtmem_wget, ABFLAG_RAM
 };
-static addrbank hrtmem2_bank = {
+static UAE_TLS addrbank hrtmem2_bank = {
 	hrtmem2_lget, hrtmem2_wget, hrtmem2_bget,
 	hrtmem2_lput, hrtmem2_wput, hrtmem2_bput,
 	hrtmem2_xlate, hrtmem2_check, NULL, _T("Cartridge Bank 2"),
 	hrtmem2_lget, hrtmem2_wget, ABFLAG_RAM
 };
-static addrbank hrtmem3_bank = {
+static UAE_TLS addrbank hrtmem3_bank = {
 	hrtmem3_lget, hrtmem3_wget, hrtmem3_bget,
 	hrtmem3_lput, hrtmem3_wput, hrtmem3_bput,
 	hrtmem3_xlate, hrtmem3_check, NULL, _T("Cartridge Bank 3"),
@@ -495,20 +495,20 @@ static void copytoamiga (uaecptr dst, uae_u8 *src, int len)
 	}
 }
 
-int action_replay_flag = ACTION_REPLAY_INACTIVE;
-static uae_u32 ar_rom_file_size;
+UAE_TLS int action_replay_flag = ACTION_REPLAY_INACTIVE;
+static UAE_TLS uae_u32 ar_rom_file_size;
 
 /* Use this for relocating AR? */
 //static int ar_rom_location;
-/*static*/ int armodel;
-static uae_u8 artemp[4]; /* Space to store the 'real' level 7 interrupt */
-static uae_u8 armode;
+/*static*/ UAE_TLS int armodel;
+static UAE_TLS uae_u8 artemp[4]; /* Space to store the 'real' level 7 interrupt */
+static UAE_TLS uae_u8 armode;
 
-static uae_u32 arrom_start, arrom_size, arrom_mask;
-static uae_u32 arram_start, arram_size, arram_mask;
+static UAE_TLS uae_u32 arrom_start, arrom_size, arrom_mask;
+static UAE_TLS uae_u32 arram_start, arram_size, arram_mask;
 
-static int ar_wait_pop = 0; /* bool used by AR1 when waiting for the program counter to exit it's ram. */
-uaecptr wait_for_pc = 0;    /* The program counter that we wait for. */
+static UAE_TLS int ar_wait_pop = 0; /* bool used by AR1 when waiting for the program counter to exit it's ram. */
+UAE_TLS uaecptr wait_for_pc = 0;    /* The program counter that we wait for. */
 
 /* returns true if the Program counter is currently in the AR rom. */
 int is_ar_pc_in_rom (void)
@@ -876,13 +876,13 @@ static uae_u8 *REGPARAM2 arrom_xlate (uaecptr addr)
 	return armemory_rom + addr;
 }
 
-static addrbank arrom_bank = {
+static UAE_TLS addrbank arrom_bank = {
 	arrom_lget, arrom_wget, arrom_bget,
 	arrom_lput, arrom_wput, arrom_bput,
 	arrom_xlate, arrom_check, NULL, _T("Action Replay ROM"),
 	arrom_lget, arrom_wget, ABFLAG_ROM
 };
-static addrbank arram_bank = {
+static UAE_TLS addrbank arram_bank = {
 	arram_lget, arram_wget, arram_bget,
 	arram_lput, arram_wput, arram_bput,
 	arram_xlate, arram_check, NULL, _T("Action Replay RAM"),
@@ -1755,7 +1755,7 @@ void action_replay_cleanup()
 	hrtmem2_end = 0;
 }
 
-int hrtmon_lang = 0;
+UAE_TLS int hrtmon_lang = 0;
 
 static void hrtmon_configure(void)
 {
@@ -1826,7 +1826,7 @@ int hrtmon_load (void)
 	hrtmem_mask = hrtmem_size - 1;
 	if (isinternal) {
 #ifdef ACTION_REPLAY_HRTMON
-		extern unsigned char hrtrom[];
+		extern const unsigned char hrtrom[];
 		extern unsigned int hrtrom_len;
 		struct zfile *zf;
 		zf = zfile_fopen_data (_T("hrtrom.gz"), hrtrom_len, hrtrom);
@@ -1917,7 +1917,7 @@ static void hrtmon_unmap_banks (void)
 #define AR_VER_STR_OFFSET 0x4 /* offset in the rom where the version string begins. */
 #define AR_VER_STR_END 0x7c   /* offset in the rom where the version string ends. */
 #define AR_VER_STR_LEN (AR_VER_STR_END - AR_VER_STR_OFFSET)
-static uae_char arVersionString[AR_VER_STR_LEN+1];
+static UAE_TLS uae_char arVersionString[AR_VER_STR_LEN+1];
 
 /* This function extracts the version info for AR2 and AR3. */
 
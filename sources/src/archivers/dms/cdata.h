@@ -7,6 +7,7 @@
  *     dependant features and other global stuff
  */
 
+#include "uae_types.h"
 
 #ifndef UCHAR
 #define UCHAR unsigned char
@@ -75,6 +76,6 @@
 #define DIR_SEPARATORS ":\\/"
 
 
-extern UCHAR *dms_text;
-extern USHORT dms_lastlen, dms_np;
+extern UAE_TLS UCHAR *dms_text;
+extern UAE_TLS USHORT dms_lastlen, dms_np;
 
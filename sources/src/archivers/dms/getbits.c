@@ -19,8 +19,8 @@ ULONG dms_mask_bits[]={
 };
 
 
-UCHAR *dms_indata, dms_bitcount;
-ULONG dms_bitbuf;
+UAE_TLS UCHAR *dms_indata, dms_bitcount;
+UAE_TLS ULONG dms_bitbuf;
 
 
 
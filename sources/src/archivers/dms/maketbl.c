@@ -13,10 +13,10 @@
 #include "maketbl.h"
 
 
-static SHORT c;
-static USHORT n, tblsiz, len, depth, maxdepth, avail;
-static USHORT codeword, bit, *tbl, TabErr;
-static UCHAR *blen;
+static UAE_TLS SHORT c;
+static UAE_TLS USHORT n, tblsiz, len, depth, maxdepth, avail;
+static UAE_TLS USHORT codeword, bit, *tbl, TabErr;
+static UAE_TLS UCHAR *blen;
 
 
 static USHORT mktbl(void);
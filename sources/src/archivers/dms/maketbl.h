@@ -1,5 +1,5 @@
 
-extern USHORT dms_left[], dms_right[];
+extern UAE_TLS USHORT dms_left[], dms_right[];
 
 USHORT dms_make_table(USHORT nchar, UCHAR bitlen[], USHORT tablebits, USHORT table[]);
 
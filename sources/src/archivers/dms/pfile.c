@@ -33,7 +33,7 @@
 #include "crc_csum.h"
 #include "pfile.h"
 
-static int dolog = 0;
+static UAE_TLS int dolog = 0;
 
 #define DMSFLAG_ENCRYPTED 2
 #define DMSFLAG_HD 16
@@ -59,12 +59,12 @@ static int dolog = 0;
 static USHORT Process_Track(struct zfile *, struct zfile *, UCHAR *, UCHAR *, USHORT, USHORT, int, struct zfile **extra);
 static USHORT Unpack_Track(UCHAR *, UCHAR *, USHORT, USHORT, UCHAR, UCHAR, USHORT, USHORT, USHORT, int);
 
-static int passfound, passretries;
+static UAE_TLS int passfound, passretries;
 
 static TCHAR modes[7][7]={"NOCOMP","SIMPLE","QUICK ","MEDIUM","DEEP  ","HEAVY1","HEAVY2"};
-static USHORT PWDCRC;
+static UAE_TLS USHORT PWDCRC;
 
-UCHAR *dms_text;
+UAE_TLS UCHAR *dms_text;
 
 static void log_error(int track)
 {
@@ -486,7 +486,7 @@ static void dms_decrypt(UCHAR *p, USHORT len, UCHAR *src){
 static USHORT Unpack_Track(UCHAR *b1, UCHAR *b2, USHORT pklen2, USHORT unpklen, UCHAR cmode, UCHAR flags, USHORT number, USHORT pklen1, USHORT usum1, int enc)
 {
 	USHORT r, err = NO_PROBLEM;
-	static USHORT pass;
+	static UAE_TLS USHORT pass;
 	int maybeencrypted;
 	int pwrounds;
 	UCHAR *tmp;
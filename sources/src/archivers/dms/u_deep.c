@@ -23,8 +23,8 @@ void update(USHORT c);
 static void reconst(void);
 
 
-USHORT dms_deep_text_loc;
-int dms_init_deep_tabs=1;
+UAE_TLS USHORT dms_deep_text_loc;
+UAE_TLS int dms_init_deep_tabs=1;
 
 
 
@@ -38,13 +38,13 @@ int dms_init_deep_tabs=1;
 #define MAX_FREQ    0x8000      /* updates tree when the */
 
 
-static USHORT freq[T + 1]; /* frequency table */
+static UAE_TLS USHORT freq[T + 1]; /* frequency table */
 
-static USHORT prnt[T + N_CHAR]; /* pointers to parent nodes, except for the */
+static UAE_TLS USHORT prnt[T + N_CHAR]; /* pointers to parent nodes, except for the */
 				/* elements [T..T + N_CHAR - 1] which are used to get */
 				/* the positions of leaves corresponding to the codes. */
 
-static USHORT son[T];   /* pointers to child nodes (son[], son[] + 1) */
+static UAE_TLS USHORT son[T];   /* pointers to child nodes (son[], son[] + 1) */
 
 
 
@@ -2,7 +2,7 @@
 
 USHORT Unpack_DEEP(UCHAR *, UCHAR *, USHORT);
 
-extern int dms_init_deep_tabs;
-extern USHORT dms_deep_text_loc;
+extern UAE_TLS int dms_init_deep_tabs;
+extern UAE_TLS USHORT dms_deep_text_loc;
 extern void Init_DEEP_Tabs(void);
 
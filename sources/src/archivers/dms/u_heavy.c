@@ -21,11 +21,11 @@
 #define N1 510
 #define OFFSET 253
 
-USHORT dms_left[2 * NC - 1], dms_right[2 * NC - 1 + 9];
-static UCHAR c_len[NC], pt_len[NPT];
-static USHORT c_table[4096], pt_table[256];
-USHORT dms_lastlen, dms_np;
-USHORT dms_heavy_text_loc;
+UAE_TLS USHORT dms_left[2 * NC - 1], dms_right[2 * NC - 1 + 9];
+static UAE_TLS UCHAR c_len[NC], pt_len[NPT];
+static UAE_TLS USHORT c_table[4096], pt_table[256];
+UAE_TLS USHORT dms_lastlen, dms_np;
+UAE_TLS USHORT dms_heavy_text_loc;
 
 
 static USHORT read_tree_c(void);
@@ -2,5 +2,5 @@
 
 USHORT Unpack_HEAVY(UCHAR *, UCHAR *, UCHAR, USHORT);
 
-extern USHORT dms_heavy_text_loc;
+extern UAE_TLS USHORT dms_heavy_text_loc;
 
@@ -19,7 +19,7 @@
 #define MBITMASK 0x3fff
 
 
-USHORT dms_medium_text_loc;
+UAE_TLS USHORT dms_medium_text_loc;
 
 
 
@@ -1,5 +1,5 @@
 
 USHORT Unpack_MEDIUM(UCHAR *, UCHAR *, USHORT);
 
-extern USHORT dms_medium_text_loc;
+extern UAE_TLS USHORT dms_medium_text_loc;
 
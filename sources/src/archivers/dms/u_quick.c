@@ -17,7 +17,7 @@
 #define QBITMASK 0xff
 
 
-USHORT dms_quick_text_loc;
+UAE_TLS USHORT dms_quick_text_loc;
 
 
 USHORT Unpack_QUICK(UCHAR *in, UCHAR *out, USHORT origsize){
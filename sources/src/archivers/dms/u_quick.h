@@ -1,5 +1,5 @@
 
 USHORT Unpack_QUICK(UCHAR *, UCHAR *, USHORT);
 
-extern USHORT dms_quick_text_loc;
+extern UAE_TLS USHORT dms_quick_text_loc;
 
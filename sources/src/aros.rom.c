@@ -1,4 +1,4 @@
-unsigned char arosrom[] = {
+const unsigned char arosrom[] = {
 0x1f, 0x8b, 0x08, 0x08, 0xcb, 0xd8, 0xd0, 0x4e, 0x02, 0x03, 0x61, 0x72, 0x6f, 0x73, 0x2e, 0x72, 
 0x6f, 0x6d, 0x00, 0xdc, 0xfd, 0x0f, 0x7c, 0x53, 0xc7, 0x95, 0x37, 0x0e, 0x1f, 0x5d, 0xcb, 0x42, 
 0x18, 0xc5, 0x08, 0xc7, 0x71, 0x55, 0xd7, 0x4b, 0x6f, 0x54, 0xa1, 0x08, 0x59, 0x58, 0x42, 0x31, 
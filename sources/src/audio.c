@@ -32,6 +32,7 @@
 #include "xwin.h"
 #include "debug.h"
 #include "misc.h"
+#include "hostprof.h"
 #ifdef AVIOUTPUT
 #include "avioutput.h"
 #endif
@@ -53,7 +54,7 @@
 #define PERIOD_MIN 4
 #define PERIOD_MIN_NONCE 60
 
-int audio_channel_mask = 15;
+UAE_TLS int audio_channel_mask = 15;
 
 STATIC_INLINE bool isaudio (void)
 {
@@ -85,13 +86,14 @@ STATIC_INLINE bool usehacks2 (void)
 /* Queue length 256 implies minimum emulated period of 8. This should be
  * sufficient for all imaginable purposes. This must be power of two. */
 #define SINC_QUEUE_LENGTH 256
+/* The ring holds twice the mixed length, so output samples still waiting
+ * in the block renderer keep their BLEPs while newer ones are queued. */
+#define SINC_QUEUE_SIZE (SINC_QUEUE_LENGTH * 2)
+/* Output samples collected before their BLEPs are mixed in one pass */
+#define SINC_BLOCK_LENGTH 1024
 
 #include "sinctable.c"
 
-typedef struct {
-	int time, output;
-} sinc_queue_t;
-
 struct audio_channel_data {
 	unsigned int adk_mask;
 	unsigned int evtime;
@@ -111,9 +113,12 @@ struct audio_channel_data {
 	uae_u16 dat, dat2;
 	int sample_accum, sample_accum_time;
 	int sinc_output_state;
-	sinc_queue_t sinc_queue[SINC_QUEUE_LENGTH];
-    int sinc_queue_time;
-    int sinc_queue_head;
+	/* BLEP n lives at n & (SINC_QUEUE_SIZE - 1), the first SINC_QUEUE_LENGTH
+	 * slots are mirrored past the end so any mixed run is contiguous */
+	int sinc_time[SINC_QUEUE_SIZE + SINC_QUEUE_LENGTH];
+	int sinc_output[SINC_QUEUE_SIZE + SINC_QUEUE_LENGTH];
+	int sinc_queue_time;
+	uae_u32 sinc_queue_head;
 #if TEST_AUDIO > 0
 	bool hisample, losample;
 	bool have_dat;
@@ -125,13 +130,13 @@ struct audio_channel_data {
 	bool ptx_tofetch;
 };
 
-static int samplecnt;
+static UAE_TLS int samplecnt;
 #if SOUNDSTUFF > 0
-static int extrasamples;
-int outputsample, doublesample;
+static UAE_TLS int extrasamples;
+UAE_TLS int outputsample, doublesample;
 #endif
 
-int sampleripper_enabled;
+UAE_TLS int sampleripper_enabled;
 struct ripped_sample
 {
 	struct ripped_sample *next;
@@ -139,7 +144,7 @@ struct ripped_sample
 	int len, per, changed;
 };
 
-static struct ripped_sample *ripped_samples;
+static UAE_TLS struct ripped_sample *ripped_samples;
 
 void write_wavheader (struct zfile *wavfile, uae_u32 size, uae_u32 freq)
 {
@@ -306,22 +311,22 @@ static void do_samplerip (struct audio_channel_data *adp)
 	audio_sampleripper (0);
 }
 
-static struct audio_channel_data audio_channel[4];
-int sound_available = 0;
-void (*sample_handler) (void);
-static void (*sample_prehandler) (unsigned long best_evtime);
+static UAE_TLS struct audio_channel_data audio_channel[4];
+UAE_TLS int sound_available = 0;
+UAE_TLS void (*sample_handler) (void);
+static UAE_TLS void (*sample_prehandler) (unsigned long best_evtime);
 
 /* REMOVEME:
  * nowhere used
  */
 #if 0
-static float sample_evtime;
+static UAE_TLS float sample_evtime;
 #endif
-float scaled_sample_evtime;
+UAE_TLS float scaled_sample_evtime;
 
-static unsigned long last_cycles;
-static float next_sample_evtime;
-unsigned int obtainedfreq;
+static UAE_TLS unsigned long last_cycles;
+static UAE_TLS float next_sample_evtime;
+UAE_TLS unsigned int obtainedfreq;
 
 typedef uae_s8 sample8_t;
 #define DO_CHANNEL_1(v, c) do { (v) *= audio_channel[c].vol; } while (0)
@@ -340,27 +345,27 @@ STATIC_INLINE int FINISH_DATA (int data, int bits)
 	return data;
 }
 
-static uae_u32 right_word_saved[SOUND_MAX_DELAY_BUFFER];
-static uae_u32 left_word_saved[SOUND_MAX_DELAY_BUFFER];
-static uae_u32 right2_word_saved[SOUND_MAX_DELAY_BUFFER];
-static uae_u32 left2_word_saved[SOUND_MAX_DELAY_BUFFER];
-static int saved_ptr, saved_ptr2;
+static UAE_TLS uae_u32 right_word_saved[SOUND_MAX_DELAY_BUFFER];
+static UAE_TLS uae_u32 left_word_saved[SOUND_MAX_DELAY_BUFFER];
+static UAE_TLS uae_u32 right2_word_saved[SOUND_MAX_DELAY_BUFFER];
+static UAE_TLS uae_u32 left2_word_saved[SOUND_MAX_DELAY_BUFFER];
+static UAE_TLS int saved_ptr, saved_ptr2;
 
-static int mixed_on, mixed_stereo_size, mixed_mul1, mixed_mul2;
-static int led_filter_forced, sound_use_filter, sound_use_filter_sinc, led_filter_on;
+static UAE_TLS int mixed_on, mixed_stereo_size, mixed_mul1, mixed_mul2;
+static UAE_TLS int led_filter_forced, sound_use_filter, sound_use_filter_sinc, led_filter_on;
 
 /* denormals are very small floating point numbers that force FPUs into slow
 mode. All lowpass filters using floats are suspectible to denormals unless
 a small offset is added to avoid very small floating point numbers. */
 #define DENORMAL_OFFSET (1E-10)
 
-static struct filter_state {
+static UAE_TLS struct filter_state {
 	float rc1, rc2, rc3, rc4, rc5;
 } sound_filter_state[4];
 
-static float a500e_filter1_a0;
-static float a500e_filter2_a0;
-static float filter_a0; /* a500 and a1200 use the same */
+static UAE_TLS float a500e_filter1_a0;
+static UAE_TLS float a500e_filter2_a0;
+static UAE_TLS float filter_a0; /* a500 and a1200 use the same */
 
 enum {
 	FILTER_NONE = 0,
@@ -531,6 +536,66 @@ STATIC_INLINE void samplexx_anti_handler (int *datasp)
 	}
 }
 
+/* Sinc output samples are not mixed when they are due. Each one records the
+ * BLEP queue position and time of every channel, and sinc_block_flush ()
+ * mixes the whole block later, at the latest at vsync. */
+struct sinc_block_sample {
+	int time[4];
+	uae_u32 head[4];
+	int state[4];
+	int table;
+};
+
+static UAE_TLS struct sinc_block_sample sinc_block[SINC_BLOCK_LENGTH];
+static UAE_TLS int sinc_block_count;
+static UAE_TLS void (*sinc_block_output)(int *datas);
+
+static void sinc_block_flush (void)
+{
+	int i, j, count = sinc_block_count;
+
+	if (!count)
+		return;
+	sinc_block_count = 0;
+	for (i = 0; i < 4; i++) {
+		struct audio_channel_data *acd = &audio_channel[i];
+		/* BLEPs older than SINC_QUEUE_MAX_AGE stay out of the mix for good,
+		 * queue times only increase */
+		uae_u32 lo = sinc_block[0].head[i] - SINC_QUEUE_LENGTH;
+		for (j = 0; j < count; j++) {
+			struct sinc_block_sample *bs = &sinc_block[j];
+			int const *winsinc = winsinc_integral[bs->table];
+			uae_u32 head = bs->head[i];
+			int t = bs->time[i];
+			int sum, v, k, n, pos;
+			const int *tp, *op;
+
+			if (head - lo > SINC_QUEUE_LENGTH)
+				lo = head - SINC_QUEUE_LENGTH;
+			while (lo != head && t - acd->sinc_time[lo & (SINC_QUEUE_SIZE - 1)] >= SINC_QUEUE_MAX_AGE)
+				lo++;
+			pos = lo & (SINC_QUEUE_SIZE - 1);
+			n = head - lo;
+			tp = acd->sinc_time + pos;
+			op = acd->sinc_output + pos;
+			/* The sum rings with harmonic components up to infinity... */
+			sum = bs->state[i] << 17;
+			/* ...but we cancel them through mixing in BLEPs instead */
+			for (k = 0; k < n; k++)
+				sum -= winsinc[t - tp[k]] * op[k];
+			v = sum >> 15;
+			if (v > 32767)
+				v = 32767;
+			else if (v < -32768)
+				v = -32768;
+			/* channel results are parked in the sample record */
+			bs->state[i] = v;
+		}
+	}
+	for (j = 0; j < count; j++)
+		sinc_block_output (sinc_block[j].state);
+}
+
 static void sinc_prehandler (unsigned long best_evtime)
 {
 	int i, output;
@@ -544,9 +609,17 @@ static void sinc_prehandler (unsigned long best_evtime)
 		/* if output state changes, record the state change and also
 		* write data into sinc queue for mixing in the BLEP */
 		if (acd->sinc_output_state != output) {
-			acd->sinc_queue_head = (acd->sinc_queue_head - 1) & (SINC_QUEUE_LENGTH - 1);
-			acd->sinc_queue[acd->sinc_queue_head].time = acd->sinc_queue_time;
-			acd->sinc_queue[acd->sinc_queue_head].output = output - acd->sinc_output_state;
+			int pos = acd->sinc_queue_head & (SINC_QUEUE_SIZE - 1);
+			/* the new BLEP would overwrite one a pending sample still mixes */
+			if (sinc_block_count && acd->sinc_queue_head - sinc_block[0].head[i] >= SINC_QUEUE_LENGTH)
+				sinc_block_flush ();
+			acd->sinc_time[pos] = acd->sinc_queue_time;
+			acd->sinc_output[pos] = output - acd->sinc_output_state;
+			if (pos < SINC_QUEUE_LENGTH) {
+				acd->sinc_time[pos + SINC_QUEUE_SIZE] = acd->sinc_time[pos];
+				acd->sinc_output[pos + SINC_QUEUE_SIZE] = acd->sinc_output[pos];
+			}
+			acd->sinc_queue_head++;
 			acd->sinc_output_state = output;
 		}
 
@@ -556,10 +629,10 @@ static void sinc_prehandler (unsigned long best_evtime)
 
 /* this interpolator performs BLEP mixing (bleps are shaped like integrated sinc
 * functions) with a type of BLEP that matches the filtering configuration. */
-STATIC_INLINE void samplexx_sinc_handler (int *datasp)
+STATIC_INLINE void samplexx_sinc_handler (void (*output)(int *datas))
 {
+	struct sinc_block_sample *bs = &sinc_block[sinc_block_count];
 	int i, n;
-	int const *winsinc;
 
 	if (sound_use_filter_sinc) {
 		n = (sound_use_filter_sinc == FILTER_MODEL_A500) ? 0 : 2;
@@ -568,30 +641,16 @@ STATIC_INLINE void samplexx_sinc_handler (int *datasp)
 	} else {
 		n = 4;
 	}
-	winsinc = winsinc_integral[n];
-
-
-	for (i = 0; i < 4; i += 1) {
-		int j, v;
+	bs->table = n;
+	for (i = 0; i < 4; i++) {
 		struct audio_channel_data *acd = &audio_channel[i];
-		/* The sum rings with harmonic components up to infinity... */
-		int sum = acd->sinc_output_state << 17;
-		/* ...but we cancel them through mixing in BLEPs instead */
-		int offsetpos = acd->sinc_queue_head & (SINC_QUEUE_LENGTH - 1);
-		for (j = 0; j < SINC_QUEUE_LENGTH; j += 1) {
-			int age = acd->sinc_queue_time - acd->sinc_queue[offsetpos].time;
-			if (age >= SINC_QUEUE_MAX_AGE || age < 0)
-				break;
-			sum -= winsinc[age] * acd->sinc_queue[offsetpos].output;
-			offsetpos = (offsetpos + 1) & (SINC_QUEUE_LENGTH - 1);
-		}
-		v = sum >> 15;
-		if (v > 32767)
-			v = 32767;
-		else if (v < -32768)
-			v = -32768;
-		datasp[i] = v;
+		bs->time[i] = acd->sinc_queue_time;
+		bs->head[i] = acd->sinc_queue_head;
+		bs->state[i] = acd->sinc_output_state;
 	}
+	sinc_block_output = output;
+	if (++sinc_block_count >= SINC_BLOCK_LENGTH)
+		sinc_block_flush ();
 }
 
 static void do_filter(int *data, int num)
@@ -600,11 +659,10 @@ static void do_filter(int *data, int num)
         *data = filter(*data, &sound_filter_state[num]);
 }
 
-static void sample16i_sinc_handler (void)
+static void sample16i_sinc_output (int *datas)
 {
-	int datas[4], data1;
+	int data1;
 
-	samplexx_sinc_handler (datas);
 	data1 = datas[0] + datas[3] + datas[1] + datas[2];
 	data1 = FINISH_DATA (data1, 18);
 	set_sound_buffers ();
@@ -612,6 +670,11 @@ static void sample16i_sinc_handler (void)
 	check_sound_buffers ();
 }
 
+static void sample16i_sinc_handler (void)
+{
+	samplexx_sinc_handler (sample16i_sinc_output);
+}
+
 void sample16_handler (void)
 {
 	uae_u32 data0 = audio_channel[0].current_sample;
@@ -858,12 +921,10 @@ static void sample16si_anti_handler (void)
 	check_sound_buffers ();
 }
 
-static void sample16ss_sinc_handler (void)
+static void sample16ss_sinc_output (int *datas)
 {
 	int data0, data1, data2, data3;
-	int datas[4];
 
-	samplexx_sinc_handler (datas);
 	data0 = FINISH_DATA (datas[0], 16);
 	data1 = FINISH_DATA (datas[1], 16);
 	data2 = FINISH_DATA (datas[2], 16);
@@ -878,11 +939,15 @@ static void sample16ss_sinc_handler (void)
 	check_sound_buffers ();
 }
 
-static void sample16si_sinc_handler (void)
+static void sample16ss_sinc_handler (void)
 {
-	int datas[4], data1, data2;
+	samplexx_sinc_handler (sample16ss_sinc_output);
+}
+
+static void sample16si_sinc_output (int *datas)
+{
+	int data1, data2;
 
-	samplexx_sinc_handler (datas);
 	data1 = datas[0] + datas[3];
 	data2 = datas[1] + datas[2];
 	data1 = FINISH_DATA (data1, 17);
@@ -897,6 +962,11 @@ static void sample16si_sinc_handler (void)
 	check_sound_buffers ();
 }
 
+static void sample16si_sinc_handler (void)
+{
+	samplexx_sinc_handler (sample16si_sinc_output);
+}
+
 void sample16s_handler (void)
 {
 	uae_u32 data0 = audio_channel[0].current_sample;
@@ -1079,7 +1149,7 @@ static void sample16si_rh_handler (void)
 }
 #endif
 
-static int audio_work_to_do;
+static UAE_TLS int audio_work_to_do;
 
 static void zerostate (int nr)
 {
@@ -1139,6 +1209,7 @@ static void audio_deactivate (void)
 {
 	if (!currprefs.sound_auto)
 		return;
+	sinc_block_flush ();
 	gui_data.sndbuf_status = 3;
 	gui_data.sndbuf = 0;
 	//pause_sound_buffer ();
@@ -1151,6 +1222,7 @@ int audio_activate (void)
 	int ret = 0;
 
 	if (!audio_work_to_do) {
+		sinc_block_flush ();
 		restart_sound_buffer ();
 		ret = 1;
 		audio_event_reset ();
@@ -1183,14 +1255,14 @@ uae_u16 audio_dmal (void)
  * since it was common to all.
  * Needs further cleaning up and a better name - or replacing entirely.
  */
-extern unsigned int have_sound;
+extern UAE_TLS unsigned int have_sound;
 #ifdef SAMPLER
 extern float sampler_evtime;
 #endif
 
 void update_sound (double freq, int longframe, int linetoggle)
 {
-	static int lastfreq;
+	static UAE_TLS int lastfreq;
 	double lines = 0;
 	double hpos;
 
@@ -1541,6 +1613,7 @@ void audio_reset (void)
 	ahi_close_sound ();
 	free_ahi_v2 ();
 #endif
+	sinc_block_flush ();
 	reset_sound ();
 	memset (sound_filter_state, 0, sizeof sound_filter_state);
 	if (!isrestore ()) {
@@ -1608,6 +1681,8 @@ void check_prefs_changed_audio (void)
 
 	if (sound_available) {
 		ch = sound_prefs_changed ();
+		if (ch)
+			sinc_block_flush ();
 		if (ch > 0) {
 #ifdef AVIOUTPUT
 			AVIOutput_Restart ();
@@ -1630,6 +1705,7 @@ void set_audio (void)
 	int sep, delay;
 	int ch;
 
+	sinc_block_flush ();
 	ch = sound_prefs_changed ();
 	if (ch >= 0)
 		close_sound ();
@@ -1756,6 +1832,8 @@ void set_audio (void)
 void update_audio (void)
 {
 	unsigned long int n_cycles = 0;
+	/* headless: channel state and interrupts only, no sample output */
+	bool output = currprefs.produce_sound > 1 && !currprefs.headless;
 #if SOUNDSTUFF > 1
 	static int samplecounter;
 #endif
@@ -1767,6 +1845,7 @@ void update_audio (void)
 	if (!is_audio_active ())
 		goto end;
 
+	hostprof_enter (HOSTPROF_AUDIO);
 	n_cycles = get_cycles () - last_cycles;
 	while (n_cycles > 0) {
 		unsigned long int best_evtime = n_cycles + 1;
@@ -1783,16 +1862,17 @@ void update_audio (void)
 		if ((next_sample_evtime - rounded) >= 0.5)
 			rounded++;
 
-		if (currprefs.produce_sound > 1 && best_evtime > rounded)
+		if (output && best_evtime > rounded)
 			best_evtime = rounded;
 
 		if (best_evtime > n_cycles)
 			best_evtime = n_cycles;
 
 		/* Decrease time-to-wait counters */
-		next_sample_evtime -= best_evtime;
+		if (output)
+			next_sample_evtime -= best_evtime;
 
-		if (currprefs.produce_sound > 1) {
+		if (output) {
 			if (sample_prehandler)
 				sample_prehandler (best_evtime / CYCLE_UNIT);
 		}
@@ -1804,7 +1884,7 @@ void update_audio (void)
 
 		n_cycles -= best_evtime;
 
-		if (currprefs.produce_sound > 1) {
+		if (output) {
 			/* Test if new sample needs to be outputted */
 			if (rounded == best_evtime) {
 				/* Before the following addition, next_sample_evtime is in range [-0.5, 0.5) */
@@ -1845,6 +1925,7 @@ void update_audio (void)
 			}
 		}
 	}
+	hostprof_leave ();
 end:
 	last_cycles = get_cycles () - n_cycles;
 }
@@ -2041,7 +2122,7 @@ void AUDxVOL (int nr, uae_u16 v)
 
 void audio_update_adkmasks (void)
 {
-	static int prevcon = -1;
+	static UAE_TLS int prevcon = -1;
 	unsigned long t = adkcon | (adkcon >> 4);
 
 	audio_channel[0].adk_mask = (((t >> 0) & 1) - 1);
@@ -2071,10 +2152,24 @@ void led_filter_audio (void)
 
 void audio_vsync (void)
 {
+	if (currprefs.headless && currprefs.produce_sound > 1) {
+		/* nothing is mixed, still use up queued CD audio in emulated time */
+		static UAE_TLS double cda_samples;
+		int n;
+		cda_samples += currprefs.sound_freq / vblank_hz;
+		n = (int)cda_samples;
+		cda_samples -= n;
+		cda_audio_mix (NULL, n * 2);
+	}
+	if (sinc_block_count) {
+		hostprof_enter (HOSTPROF_AUDIO);
+		sinc_block_flush ();
+		hostprof_leave ();
+	}
 #if SOUNDSTUFF > 0
 	int max, min;
 	int vsync = isvsync ();
-	static int lastdir;
+	static UAE_TLS int lastdir;
 
 	if (1 || !vsync) {
 		extrasamples = 0;
@@ -25,14 +25,14 @@
 
 /* Commonly used autoconfig strings */
 
-uaecptr EXPANSION_explibname, EXPANSION_doslibname, EXPANSION_uaeversion;
-uaecptr EXPANSION_uaedevname, EXPANSION_explibbase = 0;
-uaecptr EXPANSION_bootcode, EXPANSION_nullfunc;
+UAE_TLS uaecptr EXPANSION_explibname, EXPANSION_doslibname, EXPANSION_uaeversion;
+UAE_TLS uaecptr EXPANSION_uaedevname, EXPANSION_explibbase = 0;
+UAE_TLS uaecptr EXPANSION_bootcode, EXPANSION_nullfunc;
 
 /* ROM tag area memory access */
 
-uae_u8 *rtarea;
-uaecptr rtarea_base = RTAREA_DEFAULT;
+UAE_TLS uae_u8 *rtarea;
+UAE_TLS uaecptr rtarea_base = RTAREA_DEFAULT;
 
 static uae_u32 REGPARAM3 rtarea_lget (uaecptr) REGPARAM;
 static uae_u32 REGPARAM3 rtarea_wget (uaecptr) REGPARAM;
@@ -43,7 +43,7 @@ static void REGPARAM3 rtarea_bput (uaecptr, uae_u32) REGPARAM;
 static uae_u8 *REGPARAM3 rtarea_xlate (uaecptr) REGPARAM;
 static int REGPARAM3 rtarea_check (uaecptr addr, uae_u32 size) REGPARAM;
 
-addrbank rtarea_bank = {
+UAE_TLS addrbank rtarea_bank = {
 	rtarea_lget, rtarea_wget, rtarea_bget,
 	rtarea_lput, rtarea_wput, rtarea_bput,
 	rtarea_xlate, rtarea_check, NULL, _T("UAE Boot ROM"),
@@ -126,8 +126,8 @@ static void REGPARAM2 rtarea_lput (uaecptr addr, uae_u32 value)
 * scratch paper
 */
 
-static int rt_addr;
-static int rt_straddr;
+static UAE_TLS int rt_addr;
+static UAE_TLS int rt_straddr;
 
 uae_u32 addr (int ptr)
 {
@@ -304,7 +304,7 @@ void rtarea_init (void)
 	init_extended_traps ();
 }
 
-volatile int uae_int_requested = 0;
+UAE_TLS volatile int uae_int_requested = 0;
 
 void set_uae_int_flag (void)
 {
@@ -23,6 +23,8 @@
 #include "blit.h"
 #include "savestate.h"
 #include "debug.h"
+#include "hostprof.h"
+#include "statehash.h"
 
 // 1 = logging
 // 2 = no wait detection
@@ -30,22 +32,22 @@
 // 8 = instant
 
 /* we must not change ce-mode while blitter is running.. */
-static int blitter_cycle_exact;
-static int blt_statefile_type;
+static UAE_TLS int blitter_cycle_exact;
+static UAE_TLS int blt_statefile_type;
 
-uae_u16 bltcon0, bltcon1;
-uae_u32 bltapt, bltbpt, bltcpt, bltdpt;
-int blitter_nasty;
+UAE_TLS uae_u16 bltcon0, bltcon1;
+UAE_TLS uae_u32 bltapt, bltbpt, bltcpt, bltdpt;
+UAE_TLS int blitter_nasty;
 
-static int original_ch, original_fill, original_line;
+static UAE_TLS int original_ch, original_fill, original_line;
 
-static int blinea_shift;
-static uae_u16 blinea, blineb;
-static int blitline, blitfc, blitfill, blitife, blitsing, blitdesc;
-static int blitonedot, blitsign, blitlinepixel;
-static int blit_add;
-static int blit_modadda, blit_modaddb, blit_modaddc, blit_modaddd;
-static int blit_ch;
+static UAE_TLS int blinea_shift;
+static UAE_TLS uae_u16 blinea, blineb;
+static UAE_TLS int blitline, blitfc, blitfill, blitife, blitsing, blitdesc;
+static UAE_TLS int blitonedot, blitsign, blitlinepixel;
+static UAE_TLS int blit_add;
+static UAE_TLS int blit_modadda, blit_modaddb, blit_modaddc, blit_modaddd;
+static UAE_TLS int blit_ch;
 
 #ifdef BLITTER_DEBUG
 static int blitter_dontdo;
@@ -55,39 +57,41 @@ static int blitter_delayed_debug;
 static int blitter_slowdowndebug;
 #endif
 
-struct bltinfo blt_info;
+UAE_TLS struct bltinfo blt_info;
 
+/* shared by all instances, see build_blitfilltable () */
 static uae_u8 blit_filltable[256][4][2];
-uae_u32 blit_masktable[BLITTER_MAX_WORDS];
-enum blitter_states bltstate;
+static volatile bool blit_filltable_done;
+UAE_TLS uae_u32 blit_masktable[BLITTER_MAX_WORDS];
+UAE_TLS enum blitter_states bltstate;
 
-static int blit_cyclecounter, blit_waitcyclecounter;
-static int blit_maxcyclecounter, blit_slowdown, blit_totalcyclecounter;
-static int blit_startcycles, blit_misscyclecounter;
+static UAE_TLS int blit_cyclecounter, blit_waitcyclecounter;
+static UAE_TLS int blit_maxcyclecounter, blit_slowdown, blit_totalcyclecounter;
+static UAE_TLS int blit_startcycles, blit_misscyclecounter;
 
 #ifdef CPUEMU_12
-extern uae_u8 cycle_line[256];
+extern UAE_TLS uae_u8 cycle_line[256];
 #endif
 
-static long blit_firstline_cycles;
-static long blit_first_cycle;
-static int blit_last_cycle, blit_dmacount, blit_dmacount2;
+static UAE_TLS long blit_firstline_cycles;
+static UAE_TLS long blit_first_cycle;
+static UAE_TLS int blit_last_cycle, blit_dmacount, blit_dmacount2;
 
 /// REMOVEME: nowhere used
 #if 0
 static int blit_linecycles, blit_extracycles;
 #endif // 0
-static int blit_nod;
-static const int *blit_diag;
-static int blit_frozen, blit_faulty;
-static int blit_final;
-static int blt_delayed_irq;
-static uae_u16 ddat1, ddat2;
-static int ddat1use, ddat2use;
+static UAE_TLS int blit_nod;
+static UAE_TLS const int *blit_diag;
+static UAE_TLS int blit_frozen, blit_faulty;
+static UAE_TLS int blit_final;
+static UAE_TLS int blt_delayed_irq;
+static UAE_TLS uae_u16 ddat1, ddat2;
+static UAE_TLS int ddat1use, ddat2use;
 
-int blit_interrupt;
+UAE_TLS int blit_interrupt;
 
-static int last_blitter_hpos;
+static UAE_TLS int last_blitter_hpos;
 
 #define BLITTER_STARTUP_CYCLES 2
 
@@ -235,6 +239,9 @@ void build_blitfilltable (void)
 	for (i = 0; i < BLITTER_MAX_WORDS; i++)
 		blit_masktable[i] = 0xFFFF;
 
+	/* instances starting at the same time may both fill it, with the same data */
+	if (blit_filltable_done)
+		return;
 	for (d = 0; d < 256; d++) {
 		for (i = 0; i < 4; i++) {
 			int fc = i & 1;
@@ -253,6 +260,7 @@ void build_blitfilltable (void)
 			blit_filltable[d][i][1] = fc;
 		}
 	}
+	blit_filltable_done = true;
 }
 
 STATIC_INLINE void record_dma_blit (uae_u16 reg, uae_u16 dat, uae_u32 addr, int hpos)
@@ -687,9 +695,9 @@ STATIC_INLINE void blitter_nxline (void)
 
 #ifdef CPUEMU_12
 
-static int blitter_cyclecounter;
-static int blitter_hcounter1, blitter_hcounter2;
-static int blitter_vcounter1, blitter_vcounter2;
+static UAE_TLS int blitter_cyclecounter;
+static UAE_TLS int blitter_hcounter1, blitter_hcounter2;
+static UAE_TLS int blitter_vcounter1, blitter_vcounter2;
 
 static void decide_blitter_line (int hsync, int hpos)
 {
@@ -771,6 +779,7 @@ static void decide_blitter_line (int hsync, int hpos)
 
 static void actually_do_blit (void)
 {
+	hostprof_enter (HOSTPROF_BLITTER);
 	if (blitline) {
 		do {
 			blitter_read ();
@@ -795,6 +804,7 @@ static void actually_do_blit (void)
 			blitter_dofast ();
 		bltstate = BLT_done;
 	}
+	hostprof_leave ();
 }
 
 static void blitter_doit (void)
@@ -812,7 +822,7 @@ static void blitter_doit (void)
 
 void blitter_handler (uae_u32 data)
 {
-	static int blitter_stuck;
+	static UAE_TLS int blitter_stuck;
 
 	if (!dmaen (DMA_BLITTER)) {
 		event2_newevent (ev2_blitter, 10, 0);
@@ -835,7 +845,7 @@ void blitter_handler (uae_u32 data)
 
 #ifdef CPUEMU_12
 
-static uae_u32 preva, prevb;
+static UAE_TLS uae_u32 preva, prevb;
 STATIC_INLINE uae_u16 blitter_doblit (void)
 {
 	uae_u32 blitahold;
@@ -889,7 +899,7 @@ STATIC_INLINE void blitter_doddma (int hpos)
 		ddat1use = 0;
 //		wd = 1;
 	} else {
-		static int warn = 10;
+		static UAE_TLS int warn = 10;
 		if (warn > 0) {
 			warn--;
 			write_log (_T("BLITTER: D-channel without nothing to do?\n"));
@@ -1015,7 +1025,7 @@ static void do_startcycles (int hpos)
 	}
 }
 
-void decide_blitter (int hpos)
+static void decide_blitter_1 (int hpos)
 {
 	int hsync = hpos < 0;
 
@@ -1129,6 +1139,13 @@ void decide_blitter (int hpos)
 	if (hsync)
 		last_blitter_hpos = 0;
 }
+
+void decide_blitter (int hpos)
+{
+	hostprof_enter (HOSTPROF_BLITTER);
+	decide_blitter_1 (hpos);
+	hostprof_leave ();
+}
 #else
 void decide_blitter (int hpos) { }
 #endif
@@ -1222,7 +1239,7 @@ static void blit_bltset (int con)
 	// extra free cycle changes to another D write..
 	// (Absolute Inebriation vector cube inside semi-filled vector object requires freezing blitter.)
 	if (!savestate_state && invstate ()) {
-		static int freezes = 10;
+		static UAE_TLS int freezes = 10;
 		int isen = blit_diag >= &blit_cycle_diagram_fill[0][0] && blit_diag <= &blit_cycle_diagram_fill[15][0];
 		int iseo = olddiag >= &blit_cycle_diagram_fill[0][0] && olddiag <= &blit_cycle_diagram_fill[15][0];
 		if (iseo != isen) {
@@ -1248,7 +1265,7 @@ static void blit_bltset (int con)
 	// on the fly switching from CH=1 to CH=D -> blitter stops writing (Rampage/TEK)
 	// currently just switch to no-channels mode, better than crashing the demo..
 	if (!savestate_state && invstate ()) {
-		static uae_u8 changetable[32 * 32];
+		static UAE_TLS uae_u8 changetable[32 * 32];
 		int o = original_ch + (original_fill ? 16 : 0);
 		int n = blit_ch + (blitfill ? 16 : 0);
 		if (o != n) {
@@ -1308,7 +1325,7 @@ void reset_blit (int bltcon)
 
 static bool waitingblits (void)
 {
-	static int warned = 10;
+	static UAE_TLS int warned = 10;
 
 	bool waited = false;
 	while (bltstate != BLT_done && dmaen (DMA_BLITTER)) {
@@ -1507,7 +1524,7 @@ void do_blitter (int hpos, int copper)
 
 void maybe_blit (int hpos, int hack)
 {
-	static int warned = 10;
+	static UAE_TLS int warned = 10;
 
 	if (bltstate == BLT_done)
 		return;
@@ -1589,8 +1606,8 @@ int blitnasty (void)
 /* very approximate emulation of blitter slowdown caused by bitplane DMA */
 void blitter_slowdown (int ddfstrt, int ddfstop, int totalcycles, int freecycles)
 {
-	static int oddfstrt, oddfstop, ototal, ofree;
-	static int slow;
+	static UAE_TLS int oddfstrt, oddfstop, ototal, ofree;
+	static UAE_TLS int slow;
 
 	if (!totalcycles || ddfstrt < 0 || ddfstop < 0)
 		return;
@@ -1844,3 +1861,18 @@ uae_u8 *save_blitter_new (int *len, uae_u8 *dstptr)
 }
 
 #endif /* SAVESTATE */
+
+/* unlike save_blitter () this does not finish a running blit */
+uae_u64 hash_blitter (uae_u64 h)
+{
+	h = statehash_mix (h, ((uae_u64)bltcon0 << 48) | ((uae_u64)bltcon1 << 32) | (bltstate << 8) | blit_interrupt);
+	h = statehash_mix (h, ((uae_u64)bltapt << 32) | bltbpt);
+	h = statehash_mix (h, ((uae_u64)bltcpt << 32) | bltdpt);
+	h = statehash_mix (h, ((uae_u64)blt_info.vblitsize << 32) | blt_info.hblitsize);
+	h = statehash_mix (h, ((uae_u64)(uae_u16)blt_info.bltamod << 48) | ((uae_u64)(uae_u16)blt_info.bltbmod << 32)
+		| ((uae_u32)(uae_u16)blt_info.bltcmod << 16) | (uae_u16)blt_info.bltdmod);
+	h = statehash_mix (h, ((uae_u64)blt_info.bltadat << 48) | ((uae_u64)blt_info.bltbdat << 32) | ((uae_u32)blt_info.bltcdat << 16) | blt_info.bltddat);
+	h = statehash_mix (h, ((uae_u64)blt_info.bltafwm << 48) | ((uae_u64)blt_info.bltalwm << 32) | ((uae_u32)blt_info.bltahold << 16) | blt_info.bltbhold);
+	h = statehash_mix (h, ((uae_u64)blit_cyclecounter << 32) | (uae_u32)blt_info.blitzero);
+	return h;
+}
@@ -25,7 +25,7 @@
 #include "rp.h"
 #endif
 
-int log_scsiemu = 0;
+UAE_TLS int log_scsiemu = 0;
 
 #define PRE_INSERT_DELAY (3 * (currprefs.ntscmode ? 60 : 50))
 
@@ -47,7 +47,7 @@ struct blkdevstate
 	bool mediawaschanged;
 };
 
-struct blkdevstate state[MAX_TOTAL_SCSI_DEVICES];
+UAE_TLS struct blkdevstate state[MAX_TOTAL_SCSI_DEVICES];
 
 #if 0
 static int scsiemu[MAX_TOTAL_SCSI_DEVICES];
@@ -68,7 +68,7 @@ static bool cdimagefileinuse[MAX_TOTAL_SCSI_DEVICES];
 static int wasopen[MAX_TOTAL_SCSI_DEVICES];
 #endif
 
-static bool dev_init;
+static UAE_TLS bool dev_init;
 
 /* convert minutes, seconds and frames -> logical sector number */
 int msf2lsn (int msf)
@@ -131,7 +131,7 @@ int isdatatrack (struct cd_toc_head *th, int block)
 	return !isaudiotrack (th, block);
 }
 
-static int cdscsidevicetype[MAX_TOTAL_SCSI_DEVICES];
+static UAE_TLS int cdscsidevicetype[MAX_TOTAL_SCSI_DEVICES];
 
 extern struct device_functions devicefunc_cdimage;
 
@@ -140,7 +140,7 @@ static struct device_functions *devicetable[] = {
 	&devicefunc_cdimage,
 	NULL
 };
-static int driver_installed[6];
+static UAE_TLS int driver_installed[6];
 
 static void install_driver (int flags)
 {
@@ -14,6 +14,8 @@
 #include "sysconfig.h"
 #include "sysdeps.h"
 
+#include <ctype.h>
+
 #include "options.h"
 #include "blkdev.h"
 #include "zfile.h"
@@ -21,18 +23,34 @@
 #include "fsdb.h"
 #include "threaddep/thread.h"
 #include "scsidev.h"
+#include "sleep.h"
+#include "misc.h"
 #ifdef BLKDEV_CDIMAGE
+
+/* The libretro core is plain C and has no MP3/FLAC decoders and no CHD
+ * library: only uncompressed images and PCM/WAVE audio tracks. */
+#ifndef __LIBRETRO__
+#define USE_MP3 1
+#define USE_FLAC 1
+#endif
+
+#if USE_MP3
 #include <mp3decoder.h>
+#endif
 #include <memory_uae.h>
 #ifdef RETROPLATFORM
 #include "rp.h"
 #endif
 
 #include "cdrom.h"
+#include "cda_play.h"
+#include "machdep/rpt.h"
 
+#if USE_CHD
 #include "archivers/chd/chdtypes.h"
 #include "archivers/chd/chd.h"
 #include "archivers/chd/chdcd.h"
+#endif
 
 #define scsi_log write_log
 
@@ -57,10 +75,12 @@ struct cdtoc
 	int track;
 	int size;
 	int skipsize; // bytes to skip after each block
-	audenc enctype;
+	enum audenc enctype;
 	int writeoffset;
 	int subcode;
+#if USE_CHD
 	const cdrom_track_info *chdtrack;
+#endif
 };
 
 struct cdunit {
@@ -86,15 +106,17 @@ struct cdunit {
 	TCHAR imgname[MAX_DPATH];
 	uae_sem_t sub_sem;
 	struct device_info di;
+#if USE_CHD
 	chd_file *chd_f;
 	cdrom_file *chd_cdf;
+#endif
 };
 
-static struct cdunit cdunits[MAX_TOTAL_SCSI_DEVICES];
-static int bus_open;
+static UAE_TLS struct cdunit cdunits[MAX_TOTAL_SCSI_DEVICES];
+static UAE_TLS int bus_open;
 
-static volatile int cdimage_unpack_thread, cdimage_unpack_active;
-static smp_comm_pipe unpack_pipe;
+static UAE_TLS volatile int cdimage_unpack_thread, cdimage_unpack_active;
+static UAE_TLS smp_comm_pipe unpack_pipe;
 
 static struct cdunit *unitisopen (int unitnum)
 {
@@ -131,9 +153,12 @@ static struct cdtoc *findtoc (struct cdunit *cdu, int *sectorp)
 
 static int do_read (struct cdunit *cdu, struct cdtoc *t, uae_u8 *data, int sector, int offset, int size)
 {
+#if USE_CHD
 	if (t->enctype == ENC_CHD) {
 		return read_partial_sector(cdu->chd_cdf, data, sector + t->offset, 0, offset, size) == CHDERR_NONE;
-	} else if (t->handle) {
+	} else
+#endif
+	if (t->handle) {
 		int ssize = t->size + t->skipsize;
 		zfile_fseek (t->handle, t->offset + (uae_u64)sector * ssize + offset, SEEK_SET);
 		return zfile_fread (data, 1, size, t->handle) == size;
@@ -141,6 +166,7 @@ static int do_read (struct cdunit *cdu, struct cdtoc *t, uae_u8 *data, int secto
 	return 0;
 }
 
+#if USE_FLAC
 // WOHOO, library that supports virtual file access functions. Perfect!
 static void flac_metadata_callback (const FLAC__StreamDecoder *decoder, const FLAC__StreamMetadata *metadata, void *client_data)
 {
@@ -227,6 +253,7 @@ static uae_u8 *flac_get_data (struct cdtoc *t)
 	}
 	return t->data;
 }
+#endif
 
 static void sub_to_interleaved (const uae_u8 *s, uae_u8 *d)
 {
@@ -260,12 +287,15 @@ static int getsub_deinterleaved (uae_u8 *dst, struct cdunit *cdu, struct cdtoc *
 	int ret = 0;
 	uae_sem_wait (&cdu->sub_sem);
 	if (t->subcode) {
+#if USE_CHD
 		if (t->enctype == ENC_CHD) {
 			const cdrom_track_info *cti = t->chdtrack;
 			ret = do_read (cdu, t, dst, sector, cti->datasize, cti->subsize);
 			if (ret)
 				ret = t->subcode;
-		} else if (t->subhandle) {
+		} else
+#endif
+		if (t->subhandle) {
 			int offset = 0;
 			int totalsize = SUB_CHANNEL_SIZE;
 			if (t->skipsize) {
@@ -319,7 +349,7 @@ static void dosub (struct cdunit *cdu, uae_u8 *subbuf)
 	cdu->cdda_subfunc (subbuf2, 1);
 }
 
-static int setstate (struct cdunit *cdu, int state)
+static int setplaystate (struct cdunit *cdu, int state)
 {
 	cdu->cdda_play_state = state;
 	if (cdu->cdda_statusfunc)
@@ -329,8 +359,11 @@ static int setstate (struct cdunit *cdu, int state)
 
 static void *cdda_unpack_func (void *v)
 {
-	cdimage_unpack_thread = 1;
+#if USE_MP3
 	mp3decoder *mp3dec = NULL;
+#endif
+
+	cdimage_unpack_thread = 1;
 
 	for (;;) {
 		uae_u32 cduidx = read_comm_pipe_u32_blocking (&unpack_pipe);
@@ -350,6 +383,7 @@ static void *cdda_unpack_func (void *v)
 				t->data = xcalloc (uae_u8, t->filesize + 2352);
 				cdimage_unpack_active = 1;
 				if (t->data) {
+#if USE_MP3
 					if (t->enctype == AUDENC_MP3) {
 						if (!mp3dec) {
 							try {
@@ -358,19 +392,32 @@ static void *cdda_unpack_func (void *v)
 						}
 						if (mp3dec)
 							t->data = mp3dec->get (t->handle, t->data, t->filesize);
-					} else if (t->enctype == AUDENC_FLAC) {
-						flac_get_data (t);
 					}
+#endif
+#if USE_FLAC
+					if (t->enctype == AUDENC_FLAC)
+						flac_get_data (t);
+#endif
 				}
 			}
 		}
 		cdimage_unpack_active = 2;
 	}
+#if USE_MP3
 	delete mp3dec;
+#endif
 	cdimage_unpack_thread = -1;
 	return 0;
 }
 
+/* Wait until the mixer is done with the buffer or playback is stopped,
+ * the mixer runs on the emulation thread which may be the one stopping us */
+static void cdda_wait (struct cdunit *cdu, struct cda_audio *cda, int bufnum)
+{
+	while (!cda_audio_done (cda, bufnum) && cdu->cdda_play > 0)
+		sleep_millis (5);
+}
+
 static void *cdda_play_func (void *v)
 {
 	int cdda_pos;
@@ -384,47 +431,52 @@ static void *cdda_play_func (void *v)
 	struct cdunit *cdu = (struct cdunit*)v;
 
 	while (cdu->cdda_play == 0)
-		Sleep (10);
+		sleep_millis (10);
 	oldplay = -1;
 
 	bufon[0] = bufon[1] = 0;
 	bufnum = 0;
 
-	cda_audio *cda = new cda_audio (num_sectors);
+	struct cda_audio *cda = cda_audio_new (num_sectors);
+	if (!cda) {
+		setplaystate (cdu, AUDIO_STATUS_PLAY_ERROR);
+		cdu->cdda_play = 0;
+		return NULL;
+	}
 
 	while (cdu->cdda_play > 0) {
 
 		if (oldplay != cdu->cdda_play) {
 			struct cdtoc *t;
 			int sector, diff;
-			struct _timeb tb1, tb2;
+			frame_time_t tb1, tb2;
 
 			idleframes = 0;
 			foundsub = false;
-			_ftime (&tb1);
+			tb1 = read_processor_time ();
 			cdda_pos = cdu->cdda_start;
 			oldplay = cdu->cdda_play;
 			sector = cdu->cd_last_pos = cdda_pos;
 			t = findtoc (cdu, &sector);
 			if (!t) {
 				write_log (_T("IMAGE CDDA: illegal sector number %d\n"), cdu->cdda_start);
-				setstate (cdu, AUDIO_STATUS_PLAY_ERROR);
+				setplaystate (cdu, AUDIO_STATUS_PLAY_ERROR);
 			} else {
 				write_log (_T("IMAGE CDDA: playing from %d to %d, track %d ('%s', offset %lld, secoffset %d)\n"),
 					cdu->cdda_start, cdu->cdda_end, t->track, t->fname, t->offset, sector);
 				// do this even if audio is not compressed, t->handle also could be
 				// compressed and we want to unpack it in background too
 				while (cdimage_unpack_active == 1)
-					Sleep (10);
+					sleep_millis (10);
 				cdimage_unpack_active = 0;
 				write_comm_pipe_u32 (&unpack_pipe, cdu - &cdunits[0], 0);
 				write_comm_pipe_u32 (&unpack_pipe, t - &cdu->toc[0], 1);
 				while (cdimage_unpack_active == 0)
-					Sleep (10);
+					sleep_millis (10);
 			}
 			idleframes = cdu->cdda_delay_frames;
 			while (cdu->cdda_paused && cdu->cdda_play > 0) {
-				Sleep (10);
+				sleep_millis (10);
 				idleframes = -1;
 			}
 
@@ -456,21 +508,21 @@ static void *cdda_play_func (void *v)
 			}
 			cdda_pos -= idleframes;
 
-			_ftime (&tb2);
-			diff = (tb2.time * (uae_s64)1000 + tb2.millitm) - (tb1.time * (uae_s64)1000 + tb1.millitm);
+			tb2 = read_processor_time ();
+			diff = (int)((tb2 - tb1) / 1000);
 			diff -= cdu->cdda_delay;
 			if (idleframes >= 0 && diff < 0 && cdu->cdda_play > 0)
-				Sleep (-diff);
-			setstate (cdu, AUDIO_STATUS_IN_PROGRESS);
+				sleep_millis (-diff);
+			setplaystate (cdu, AUDIO_STATUS_IN_PROGRESS);
 		}
 
-		cda->wait(bufnum);
+		cdda_wait (cdu, cda, bufnum);
 		bufon[bufnum] = 0;
 		if (!cdu->cdda_play)
 			goto end;
 
 		if (idleframes <= 0 && cdda_pos >= cdu->cdda_start && !isaudiotrack (&cdu->di.toc, cdda_pos)) {
-			setstate (cdu, AUDIO_STATUS_PLAY_ERROR);
+			setplaystate (cdu, AUDIO_STATUS_PLAY_ERROR);
 			write_log (_T("IMAGE CDDA: attempted to play data track %d\n"), cdda_pos);
 			goto end; // data track?
 		}
@@ -494,6 +546,7 @@ static void *cdda_play_func (void *v)
 				t = findtoc (cdu, &sector);
 				if (t) {
 					if (!(t->ctrl & 4)) {
+#if USE_CHD
 						if (t->enctype == ENC_CHD) {
 							do_read (cdu, t, dst, sector, 0, t->size);
 							for (int i = 0; i < 2352; i+=2) {
@@ -502,7 +555,9 @@ static void *cdda_play_func (void *v)
 								dst[i + 0] = dst[i + 1];
 								dst[i +1] = p;
 							}
-						} else if (t->handle) {
+						} else
+#endif
+						if (t->handle) {
 							int totalsize = t->size + t->skipsize;
 							if ((t->enctype == AUDENC_MP3 || t->enctype == AUDENC_FLAC) && t->data) {
 								if (t->filesize >= sector * totalsize + t->offset + t->size)
@@ -546,14 +601,14 @@ static void *cdda_play_func (void *v)
 				cdu->cd_last_pos = cdda_pos;
 
 			bufon[bufnum] = 1;
-			cda->setvolume (currprefs.sound_volume_cd >= 0 ? currprefs.sound_volume_cd : currprefs.sound_volume, cdu->cdda_volume[0], cdu->cdda_volume[1]);
-			if (!cda->play (bufnum)) {
-				setstate (cdu, AUDIO_STATUS_PLAY_ERROR);
+			cda_audio_setvolume (cda, currprefs.sound_volume_cd >= 0 ? currprefs.sound_volume_cd : currprefs.sound_volume, cdu->cdda_volume[0], cdu->cdda_volume[1]);
+			if (!cda_audio_play (cda, bufnum)) {
+				setplaystate (cdu, AUDIO_STATUS_PLAY_ERROR);
 				goto end;
 			}
 
 			if (dofinish) {
-				setstate (cdu, AUDIO_STATUS_PLAY_COMPLETE);
+				setplaystate (cdu, AUDIO_STATUS_PLAY_COMPLETE);
 				cdu->cdda_play = -1;
 				cdda_pos = cdu->cdda_end + 1;
 			}
@@ -562,20 +617,20 @@ static void *cdda_play_func (void *v)
 
 		if (bufon[0] == 0 && bufon[1] == 0) {
 			while (cdu->cdda_paused && cdu->cdda_play == oldplay)
-				Sleep (10);
+				sleep_millis (10);
 		}
 
 		bufnum = 1 - bufnum;
 	}
 
 end:
-	cda->wait (0);
-	cda->wait (1);
+	cdda_wait (cdu, cda, 0);
+	cdda_wait (cdu, cda, 1);
 
 	while (cdimage_unpack_active == 1)
-		Sleep (10);
+		sleep_millis (10);
 
-	delete cda;
+	cda_audio_free (cda);
 
 	cdu->cdda_play = 0;
 	write_log (_T("IMAGE CDDA: thread killed\n"));
@@ -588,7 +643,7 @@ static void cdda_stop (struct cdunit *cdu)
 	if (cdu->cdda_play != 0) {
 		cdu->cdda_play = -1;
 		while (cdu->cdda_play) {
-			Sleep (10);
+			sleep_millis (10);
 		}
 	}
 	cdu->cdda_paused = 0;
@@ -627,11 +682,11 @@ static int command_play (int unitnum, int startlsn, int endlsn, int scan, play_s
 	cdu->cdda_subfunc = subfunc;
 	cdu->cdda_statusfunc = statusfunc;
 	cdu->cdda_scan = scan > 0 ? 10 : (scan < 0 ? 10 : 0);
-	cdu->cdda_delay = setstate (cdu, -1);
-	cdu->cdda_delay_frames = setstate (cdu, -2);
-	setstate (cdu, AUDIO_STATUS_NOT_SUPPORTED);
+	cdu->cdda_delay = setplaystate (cdu, -1);
+	cdu->cdda_delay_frames = setplaystate (cdu, -2);
+	setplaystate (cdu, AUDIO_STATUS_NOT_SUPPORTED);
 	if (!isaudiotrack (&cdu->di.toc, startlsn)) {
-		setstate (cdu, AUDIO_STATUS_PLAY_ERROR);
+		setplaystate (cdu, AUDIO_STATUS_PLAY_ERROR);
 		return 0;
 	}
 	if (!cdu->cdda_play)
@@ -1033,6 +1088,24 @@ typedef struct {
 
 #pragma pack()
 
+/* Track files named by a cue or mds sheet are relative to the sheet, the
+ * process working directory belongs to the frontend. */
+static void image_path (TCHAR *path, const TCHAR *img, const TCHAR *fname)
+{
+	TCHAR *p;
+
+	path[0] = 0;
+	if (fname[0] != '/' && fname[0] != '\\' && !(fname[0] && fname[1] == ':')
+		&& _tcslen (img) + _tcslen (fname) < MAX_DPATH) {
+		_tcscpy (path, img);
+		p = path + _tcslen (path);
+		while (p > path && p[-1] != '/' && p[-1] != '\\')
+			p--;
+		*p = 0;
+	}
+	_tcscat (path, fname);
+}
+
 static int parsemds (struct cdunit *cdu, struct zfile *zmds, const TCHAR *img)
 {
 	MDS_Header *head;
@@ -1098,6 +1171,11 @@ static int parsemds (struct cdunit *cdu, struct zfile *zmds, const TCHAR *img)
 						_tcscpy (ext, fname + 1);
 					xfree (fname);
 					fname = my_strdup (newname);
+				} else {
+					TCHAR path[MAX_DPATH];
+					image_path (path, img, fname);
+					xfree (fname);
+					fname = my_strdup (path);
 				}
 
 				t->handle = zfile_fopen (fname, _T("rb"), ZFD_NORMAL);
@@ -1124,6 +1202,7 @@ end:
 	return cdu->tracks;
 }
 
+#if USE_CHD
 static int parsechd (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 {
 	chd_error err;
@@ -1210,7 +1289,7 @@ static int parsechd (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 	}
 	return cdu->tracks;
 }
-
+#endif
 
 static int parseccd (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 {
@@ -1350,9 +1429,11 @@ static int parsecue (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 	int newfile, secoffset;
 	uae_s64 offset, index0;
 	TCHAR *fname, *fnametype;
-	audenc fnametypeid;
+	enum audenc fnametypeid;
 	int ctrl;
+#if USE_MP3
 	mp3decoder *mp3dec = NULL;
+#endif
 
 	fname = NULL;
 	fnametype = NULL;
@@ -1437,6 +1518,7 @@ static int parsecue (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 			if (tracknum >= 1 && tracknum <= 99) {
 				struct cdtoc *t = &cdu->toc[tracknum - 1];
 				struct zfile *ztrack;
+				TCHAR path[MAX_DPATH];
 
 				if (tracknum > 1 && newfile) {
 					t--;
@@ -1445,17 +1527,22 @@ static int parsecue (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 				}
 
 				newfile = 0;
-				ztrack = zfile_fopen (fname, _T("rb"), ZFD_ARCHIVE | ZFD_DELAYEDOPEN);
-				if (!ztrack) {
+				image_path (path, img, fname);
+				ztrack = zfile_fopen (path, _T("rb"), ZFD_ARCHIVE | ZFD_DELAYEDOPEN);
+				if (ztrack) {
+					xfree (fname);
+					fname = my_strdup (path);
+				} else {
 					TCHAR tmp[MAX_DPATH];
 					_tcscpy (tmp, fname);
 					p = tmp + _tcslen (tmp);
 					while (p > tmp) {
 						if (*p == '/' || *p == '\\') {
-							ztrack = zfile_fopen (p + 1, _T("rb"), ZFD_ARCHIVE | ZFD_DELAYEDOPEN);
+							image_path (path, img, p + 1);
+							ztrack = zfile_fopen (path, _T("rb"), ZFD_ARCHIVE | ZFD_DELAYEDOPEN);
 							if (ztrack) {
 								xfree (fname);
-								fname = my_strdup (p + 1);
+								fname = my_strdup (path);
 							}
 							break;
 						}
@@ -1541,6 +1628,7 @@ static int parsecue (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 							t->filesize = size;
 						}
 						t->enctype = fnametypeid;
+#if USE_MP3
 					} else if (fnametypeid == AUDENC_MP3 && t->handle) {
 						if (!mp3dec) {
 							try {
@@ -1553,10 +1641,13 @@ static int parsecue (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 							if (t->filesize)
 								t->enctype = fnametypeid;
 						}
+#endif
+#if USE_FLAC
 					} else if (fnametypeid == AUDENC_FLAC && t->handle) {
 						flac_get_size (t);
 						if (t->filesize)
 							t->enctype = fnametypeid;
+#endif
 					}
 				}
 			}
@@ -1573,7 +1664,9 @@ static int parsecue (struct cdunit *cdu, struct zfile *zcue, const TCHAR *img)
 
 	xfree (fname);
 
+#if USE_MP3
 	delete mp3dec;
+#endif
 
 	return cdu->tracks;
 }
@@ -1595,22 +1688,7 @@ static int parse_image (struct cdunit *cdu, const TCHAR *img)
 
 	ext = _tcsrchr (zfile_getname (zcue), '.');
 	if (ext) {
-		TCHAR curdir[MAX_DPATH];
-		TCHAR oldcurdir[MAX_DPATH], *p;
-
 		ext++;
-		oldcurdir[0] = 0;
-		_tcscpy (curdir, img);
-		p = curdir + _tcslen (curdir);
-		while (p > curdir) {
-			if (*p == '/' || *p == '\\')
-				break;
-			p--;
-		}
-		*p = 0;
-		if (p > curdir)
-			my_setcurrentdir (curdir, oldcurdir);
-
 		if (!_tcsicmp (ext, _T("cue")))
 			parsecue (cdu, zcue, img);
 		else if (!_tcsicmp (ext, _T("ccd")))
@@ -1621,8 +1699,6 @@ static int parse_image (struct cdunit *cdu, const TCHAR *img)
 		else if (!_tcsicmp (ext, _T("chd")))
 			parsechd (cdu, zcue, img);
 #endif
-		if (oldcurdir[0])
-			my_setcurrentdir (oldcurdir, NULL);
 	}
 	if (!cdu->tracks) {
 		uae_u64 siz = zfile_size (zcue);
@@ -1737,11 +1813,13 @@ static void unload_image (struct cdunit *cdu)
 		xfree (t->subdata);
 		xfree (t->extrainfo);
 	}
+#if USE_CHD
 	cdrom_close (cdu->chd_cdf);
 	cdu->chd_cdf = NULL;
 	if (cdu->chd_f)
 		cdu->chd_f->close();
 	cdu->chd_f = NULL;
+#endif
 	memset (cdu->toc, 0, sizeof cdu->toc);
 	cdu->tracks = 0;
 	cdu->cdsize = 0;
@@ -1767,7 +1845,7 @@ static int open_device (int unitnum, const TCHAR *ident, int flags)
 			init_comm_pipe (&unpack_pipe, 10, 1);
 			uae_start_thread (_T("cdimage_unpack"), cdda_unpack_func, NULL, NULL);
 			while (cdimage_unpack_thread == 0)
-				Sleep (10);
+				sleep_millis (10);
 		}
 		ret = 1;
 	}
@@ -1786,7 +1864,7 @@ static void close_device (int unitnum)
 			write_comm_pipe_u32 (&unpack_pipe, -1, 0);
 			write_comm_pipe_u32 (&unpack_pipe, -1, 1);
 			while (cdimage_unpack_thread == 0)
-				Sleep (10);
+				sleep_millis (10);
 			cdimage_unpack_thread = 0;
 			destroy_comm_pipe (&unpack_pipe);
 		}
@@ -33,7 +33,7 @@
 #define MAX_VALUES 32
 #define IOBUFFERS 256
 
-static double parsedvalues[MAX_VALUES];
+static UAE_TLS double parsedvalues[MAX_VALUES];
 
 // operators
 // precedence   operators       associativity
@@ -275,7 +275,7 @@ static double docalc1(TCHAR op, struct calcstack *sv1, double v2)
 
 static TCHAR *stacktostr(struct calcstack *st)
 {
-	static TCHAR out[256];
+	static UAE_TLS TCHAR out[256];
 	if (st->s)
 		return st->s;
 	_stprintf(out, _T("%f"), st->val);
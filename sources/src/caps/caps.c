@@ -17,9 +17,9 @@
 #include "zfile.h"
 #include "caps/capsimage.h"
 
-static CapsLong caps_cont[4]= {-1, -1, -1, -1};
-static int caps_locked[4];
-static int caps_flags = DI_LOCK_DENVAR|DI_LOCK_DENNOISE|DI_LOCK_NOISE|DI_LOCK_UPDATEFD|DI_LOCK_TYPE;
+static UAE_TLS CapsLong caps_cont[4]= {-1, -1, -1, -1};
+static UAE_TLS int caps_locked[4];
+static UAE_TLS int caps_flags = DI_LOCK_DENVAR|DI_LOCK_DENNOISE|DI_LOCK_NOISE|DI_LOCK_UPDATEFD|DI_LOCK_TYPE;
 #define LIB_TYPE 1
 
 
@@ -29,8 +29,8 @@ static int caps_flags = DI_LOCK_DENVAR|DI_LOCK_DENNOISE|DI_LOCK_NOISE|DI_LOCK_UP
 
 #ifdef __LIBRETRO__
 #include "retro_files.h"
-extern char *retro_system_directory;
-char CAPSLIB_PATH[RETRO_PATH_MAX];
+extern UAE_TLS char *retro_system_directory;
+UAE_TLS char CAPSLIB_PATH[RETRO_PATH_MAX];
 #endif
 
 #ifdef _WIN32
@@ -48,7 +48,7 @@ char CAPSLIB_PATH[RETRO_PATH_MAX];
  * We don't symbolically link on the Amiga, so don't need
  * this there
  */
-struct {
+UAE_TLS struct {
   void *handle;
   CapsLong (*CAPSInit)(void);
   CapsLong (*CAPSExit)(void);
@@ -451,7 +451,7 @@ static int load_capslib (void)
  */
 int caps_init (void)
 {
-    static int init, noticed;
+    static UAE_TLS int init, noticed;
     unsigned int i;
     struct CapsVersionInfo cvi;
 
@@ -62,21 +62,21 @@
 #define A_CB_WRITE		19	//38
 #define A_CB_READ		20	//40
 
-static int fmv_mask;
-static uae_u8 *rom;
-static uae_u32 fmv_rom_size = 262144;
-static uaecptr fmv_start = 0x00200000;
-static uae_u32 fmv_size = 1048576;
-
-static uae_u16 l64111regs[32];
-static uae_u16 l64111intmask1, l64111intmask2, l64111intstatus1;
+static UAE_TLS int fmv_mask;
+static UAE_TLS uae_u8 *rom;
+static UAE_TLS uae_u32 fmv_rom_size = 262144;
+static UAE_TLS uaecptr fmv_start = 0x00200000;
+static UAE_TLS uae_u32 fmv_size = 1048576;
+
+static UAE_TLS uae_u16 l64111regs[32];
+static UAE_TLS uae_u16 l64111intmask1, l64111intmask2, l64111intstatus1;
 /* REMOVEME:
  * nowhere used
  */
 #if 0
 static uae_u16 l64111intstatus2;
 #endif
-static uae_u16 io_reg;
+static UAE_TLS uae_u16 io_reg;
 
 static int isdebug (uaecptr addr)
 {
@@ -374,7 +374,7 @@ static uae_u8 *REGPARAM2 fmv_xlate (uaecptr addr)
 	return rom + addr;
 }
 
-static addrbank fmv_bank = {
+static UAE_TLS addrbank fmv_bank = {
 	fmv_lget, fmv_wget, fmv_bget,
 	fmv_lput, fmv_wput, fmv_bput,
 	fmv_xlate, fmv_check, NULL, _T("CD32 FMV module"),
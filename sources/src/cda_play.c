@@ -0,0 +1,118 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * CD audio output
+  *
+  * Replaces the host audio device of the Windows version: queued CD
+  * buffers are mixed into the emulated sound output, so CD audio runs
+  * in sync with emulated time and at most two buffers are in flight.
+  * The sound output of this port runs at 44.1kHz, the same as CD audio,
+  * so no resampling is needed.
+  */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "options.h"
+#include "threaddep/thread.h"
+#include "cda_play.h"
+
+static UAE_TLS struct cda_audio *cda_current;
+static UAE_TLS uae_sem_t cda_sem;
+static UAE_TLS bool cda_sem_init;
+
+struct cda_audio *cda_audio_new (int num_sectors)
+{
+	struct cda_audio *cda;
+
+	if (!cda_sem_init) {
+		uae_sem_init (&cda_sem, 0, 1);
+		cda_sem_init = true;
+	}
+	cda = xcalloc (struct cda_audio, 1);
+	if (!cda)
+		return NULL;
+	cda->num_sectors = num_sectors;
+	cda->bufsize = num_sectors * 2352;
+	cda->buffers[0] = xcalloc (uae_u8, cda->bufsize);
+	cda->buffers[1] = xcalloc (uae_u8, cda->bufsize);
+	if (!cda->buffers[0] || !cda->buffers[1]) {
+		xfree (cda->buffers[0]);
+		xfree (cda->buffers[1]);
+		xfree (cda);
+		return NULL;
+	}
+	uae_sem_wait (&cda_sem);
+	cda_current = cda;
+	uae_sem_post (&cda_sem);
+	return cda;
+}
+
+void cda_audio_free (struct cda_audio *cda)
+{
+	if (!cda)
+		return;
+	uae_sem_wait (&cda_sem);
+	if (cda_current == cda)
+		cda_current = NULL;
+	uae_sem_post (&cda_sem);
+	xfree (cda->buffers[0]);
+	xfree (cda->buffers[1]);
+	xfree (cda);
+}
+
+/* master: 0 = full .. 100 = mute, left/right: 0 .. 0x7fff */
+void cda_audio_setvolume (struct cda_audio *cda, int master, int left, int right)
+{
+	cda->volume[0] = (100 - master) * left / 100;
+	cda->volume[1] = (100 - master) * right / 100;
+}
+
+bool cda_audio_play (struct cda_audio *cda, int bufnum)
+{
+	cda->queued[bufnum] = 1;
+	return true;
+}
+
+/* true when the buffer has been played and can be refilled */
+bool cda_audio_done (struct cda_audio *cda, int bufnum)
+{
+	return cda->queued[bufnum] == 0;
+}
+
+/* samples: interleaved stereo 16-bit samples, not frames,
+ * NULL sndbuffer consumes the samples without mixing */
+void cda_audio_mix (uae_s16 *sndbuffer, int samples)
+{
+	struct cda_audio *cda;
+	int i;
+
+	if (!cda_current)
+		return;
+	uae_sem_wait (&cda_sem);
+	cda = cda_current;
+	for (i = 0; cda && i < samples; i += 2) {
+		const uae_u8 *p;
+		int j;
+
+		if (!cda->queued[cda->playing])
+			break;
+		p = cda->buffers[cda->playing] + cda->offset;
+		for (j = 0; sndbuffer && j < 2; j++) {
+			int v = (uae_s16)(p[j * 2] | (p[j * 2 + 1] << 8));
+			v = sndbuffer[i + j] + ((v * cda->volume[j]) >> 15);
+			if (v > 32767)
+				v = 32767;
+			else if (v < -32768)
+				v = -32768;
+			sndbuffer[i + j] = v;
+		}
+		cda->offset += 4;
+		if (cda->offset >= cda->bufsize) {
+			cda->offset = 0;
+			cda->queued[cda->playing] = 0;
+			cda->playing ^= 1;
+		}
+	}
+	uae_sem_post (&cda_sem);
+}
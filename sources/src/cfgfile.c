@@ -38,11 +38,11 @@
 #include "sounddep/sound.h"
 #include "misc.h"
 
-static int config_newfilesystem;
-static struct strlist *temp_lines;
-static struct zfile *default_file, *configstore;
-static int uaeconfig;
-static int unicode_config = 0;
+static UAE_TLS int config_newfilesystem;
+static UAE_TLS struct strlist *temp_lines;
+static UAE_TLS struct zfile *default_file, *configstore;
+static UAE_TLS int uaeconfig;
+static UAE_TLS int unicode_config = 0;
 
 /* @@@ need to get rid of this... just cut part of the manual and print that
 * as a help text.  */
@@ -1243,8 +1243,12 @@ void cfgfile_save_options (struct zfile *f, struct uae_prefs *p, int type)
 	cfgfile_dwrite (f, _T("state_replay_rate"), _T("%d"), p->statecapturerate);
 	cfgfile_dwrite (f, _T("state_replay_buffers"), _T("%d"), p->statecapturebuffersize);
 	cfgfile_dwrite_bool (f, _T("state_replay_autoplay"), p->inprec_autoplay);
+	cfgfile_dwrite (f, _T("state_replay_snapshot_rate"), _T("%d"), p->inprec_snapshotrate);
 #endif
 	cfgfile_dwrite_bool (f, _T("warp"), p->turbo_emulation);
+	cfgfile_dwrite_bool (f, _T("headless"), p->headless);
+	cfgfile_dwrite_bool (f, _T("lockstep"), p->lockstep);
+	cfgfile_dwrite (f, _T("lockstep_seed"), _T("0x%x"), p->lockstep_seed);
 
 #ifdef FILESYS
 	write_filesys_config (p, f);
@@ -1656,6 +1660,8 @@ static int cfgfile_parse_host (struct uae_prefs *p, TCHAR *option, TCHAR *value)
 		|| cfgfile_intval (option, value, _T("state_replay_rate"), &p->statecapturerate, 1)
 		|| cfgfile_intval (option, value, _T("state_replay_buffers"), &p->statecapturebuffersize, 1)
 		|| cfgfile_yesno (option, value, _T("state_replay_autoplay"), &p->inprec_autoplay)
+		|| cfgfile_intval (option, value, _T("state_replay_snapshot_rate"), &p->inprec_snapshotrate, 1)
+		|| cfgfile_intval (option, value, _T("lockstep_seed"), (int*)&p->lockstep_seed, 1)
 		|| cfgfile_intval (option, value, _T("sound_frequency"), &p->sound_freq, 1)
 		|| cfgfile_intval (option, value, _T("sound_volume"), &p->sound_volume, 1)
 		|| cfgfile_intval (option, value, _T("sound_volume_cd"), &p->sound_volume_cd, 1)
@@ -1751,6 +1757,7 @@ cfgfile_path (option, value, _T("floppy0soundext"), p->floppyslots[0].dfxclickex
 		|| cfgfile_yesno (option, value, _T("magic_mouse"), &p->input_magic_mouse)
 		|| cfgfile_yesno (option, value, _T("warp"), &p->turbo_emulation)
 		|| cfgfile_yesno (option, value, _T("headless"), &p->headless)
+		|| cfgfile_yesno (option, value, _T("lockstep"), &p->lockstep)
 		|| cfgfile_yesno (option, value, _T("clipboard_sharing"), &p->clipboard_sharing)
 		|| cfgfile_yesno (option, value, _T("native_code"), &p->native_code)
 		|| cfgfile_yesno (option, value, _T("bsdsocket_emu"), &p->socket_emu))
@@ -3316,7 +3323,7 @@ static void calcformula (struct uae_prefs *prefs, TCHAR *in)
 	TCHAR *p = out;
 	double val;
 	int cnt1, cnt2;
-	static bool updatestore;
+	static UAE_TLS bool updatestore;
 
 	if (_tcslen (in) < 2 || in[0] != '[' || in[_tcslen (in) - 1] != ']')
 		return;
@@ -3741,7 +3748,7 @@ int cfgfile_load (struct uae_prefs *p, const TCHAR *filename, int *type, int ign
 	int v;
 	TCHAR tmp[MAX_DPATH];
 	int type2;
-	static int recursive;
+	static UAE_TLS int recursive;
 
 	memset(tmp, 0, MAX_DPATH * sizeof(TCHAR));
 
@@ -3831,7 +3838,7 @@ int cfgfile_get_description (const TCHAR *filename, TCHAR *description, TCHAR *h
 
 int cfgfile_configuration_change (int v)
 {
-	static int mode;
+	static UAE_TLS int mode;
 	if (v >= 0)
 		mode = v;
 	return mode;
@@ -4369,8 +4376,8 @@ uae_u32 cfgfile_modify (uae_u32 index, TCHAR *parms, uae_u32 size, TCHAR *out, u
 	uae_u32 err;
 	size_t argv = 0, i = 0, j = 0;
 	TCHAR zero = 0;
-	static TCHAR *configsearch;
-	static int configsearchfound;
+	static UAE_TLS TCHAR *configsearch;
+	static UAE_TLS int configsearchfound;
 
 	config_changed = 1;
 	err = 0;
@@ -4816,6 +4823,8 @@ void default_prefs (struct uae_prefs *p, int type)
 	p->cpu_idle = 0;
 	p->turbo_emulation = 0;
 	p->headless = 0;
+	p->lockstep = 0;
+	p->lockstep_seed = 0;
 	p->catweasel = 0;
 	p->tod_hack = 0;
 	p->maprom = 0;
@@ -4960,6 +4969,7 @@ void default_prefs (struct uae_prefs *p, int type)
 #ifdef SAVESTATE
 	p->statecapturebuffersize = 100;
 	p->statecapturerate = 5 * 50;
+	p->inprec_snapshotrate = 10 * 50;
 	p->inprec_autoplay = true;
 #endif
 
@@ -5075,6 +5085,9 @@ static void buildin_default_prefs (struct uae_prefs *p)
 	p->uaeserial = 0;
 	p->cpu_idle = 0;
 	p->turbo_emulation = 0;
+	p->headless = 0;
+	p->lockstep = 0;
+	p->lockstep_seed = 0;
 	p->catweasel = 0;
 	p->tod_hack = 0;
 	p->maprom = 0;
@@ -46,6 +46,8 @@
 #include "dongle.h"
 #include "inputrecord.h"
 #include "autoconf.h"
+#include "statehash.h"
+#include "lockstep.h"
 
 #define CIAA_DEBUG_R 0
 #define CIAA_DEBUG_W 0
@@ -70,36 +72,36 @@
 #define CIASTARTCYCLESHI 3
 #define CIASTARTCYCLESCRA 2
 
-static unsigned int ciaaicr, ciaaimask, ciabicr, ciabimask;
-static unsigned int ciaacra, ciaacrb, ciabcra, ciabcrb;
-static unsigned int ciaastarta, ciaastartb, ciabstarta, ciabstartb;
-static unsigned int ciaaicr_reg, ciabicr_reg;
+static UAE_TLS unsigned int ciaaicr, ciaaimask, ciabicr, ciabimask;
+static UAE_TLS unsigned int ciaacra, ciaacrb, ciabcra, ciabcrb;
+static UAE_TLS unsigned int ciaastarta, ciaastartb, ciabstarta, ciabstartb;
+static UAE_TLS unsigned int ciaaicr_reg, ciabicr_reg;
 
 /* Values of the CIA timers.  */
-static unsigned long ciaata, ciaatb, ciabta, ciabtb;
+static UAE_TLS unsigned long ciaata, ciaatb, ciabta, ciabtb;
 /* Computed by compute_passed_time.  */
-static unsigned long ciaata_passed, ciaatb_passed, ciabta_passed, ciabtb_passed;
+static UAE_TLS unsigned long ciaata_passed, ciaatb_passed, ciabta_passed, ciabtb_passed;
 
-static unsigned long ciaatod, ciabtod, ciaatol, ciabtol, ciaaalarm, ciabalarm;
-static int ciaatlatch, ciabtlatch;
-static bool oldled, oldovl, oldcd32mute;
-static bool led;
-static int led_old_brightness;
-static unsigned long led_cycles_on, led_cycles_off, led_cycle;
+static UAE_TLS unsigned long ciaatod, ciabtod, ciaatol, ciabtol, ciaaalarm, ciabalarm;
+static UAE_TLS int ciaatlatch, ciabtlatch;
+static UAE_TLS bool oldled, oldovl, oldcd32mute;
+static UAE_TLS bool led;
+static UAE_TLS int led_old_brightness;
+static UAE_TLS unsigned long led_cycles_on, led_cycles_off, led_cycle;
 
-unsigned int ciabpra;
+UAE_TLS unsigned int ciabpra;
 
-static unsigned long ciaala, ciaalb, ciabla, ciablb;
-static int ciaatodon, ciabtodon;
-static unsigned int ciaapra, ciaaprb, ciaadra, ciaadrb, ciaasdr, ciaasdr_cnt;
-static unsigned int ciabprb, ciabdra, ciabdrb, ciabsdr, ciabsdr_cnt;
-static int div10;
-static int kbstate, kblostsynccnt;
-static uae_u8 kbcode;
+static UAE_TLS unsigned long ciaala, ciaalb, ciabla, ciablb;
+static UAE_TLS int ciaatodon, ciabtodon;
+static UAE_TLS unsigned int ciaapra, ciaaprb, ciaadra, ciaadrb, ciaasdr, ciaasdr_cnt;
+static UAE_TLS unsigned int ciabprb, ciabdra, ciabdrb, ciabsdr, ciabsdr_cnt;
+static UAE_TLS int div10;
+static UAE_TLS int kbstate, kblostsynccnt;
+static UAE_TLS uae_u8 kbcode;
 
-static uae_u8 serbits;
-static int warned = 10;
-static int rtc_delayed_write;
+static UAE_TLS uae_u8 serbits;
+static UAE_TLS int warned = 10;
+static UAE_TLS int rtc_delayed_write;
 
 
 static void setclr (unsigned int *p, unsigned int val)
@@ -488,27 +490,18 @@ STATIC_INLINE void ciaa_checkalarm (int inc)
 
 #ifdef TOD_HACK
 
-#if defined(WIIU)
-#include <features_cpu.h>
-#endif
-static uae_u64 tod_hack_tv, tod_hack_tod, tod_hack_tod_last;
-static int tod_hack_enabled;
+static UAE_TLS uae_u64 tod_hack_tv, tod_hack_tod, tod_hack_tod_last;
+static UAE_TLS int tod_hack_enabled;
 #define TOD_HACK_TIME 312 * 50 * 10
 static void tod_hack_reset (void)
 {
-#ifdef WIIU
- 	tod_hack_tv = cpu_features_get_time_usec();
-#else
-	struct timeval tv;
-	gettimeofday (&tv, NULL);
-	tod_hack_tv = (uae_u64)tv.tv_sec * 1000000 + tv.tv_usec;
-#endif
+	tod_hack_tv = lockstep_usec ();
 	tod_hack_tod = ciaatod;
 	tod_hack_tod_last = tod_hack_tod;
 }
 #endif
 
-static int heartbeat_cnt;
+static UAE_TLS int heartbeat_cnt;
 void cia_heartbeat (void)
 {
 	heartbeat_cnt = 10;
@@ -516,8 +509,7 @@ void cia_heartbeat (void)
 
 static void do_tod_hack (int dotod)
 {
-	struct timeval tv;
-	static int oldrate;
+	static UAE_TLS int oldrate;
 	uae_u64 t;
 	int rate;
 	int docount = 0;
@@ -559,12 +551,7 @@ static void do_tod_hack (int dotod)
 	}
 	if (!dotod && currprefs.cs_ciaatod == 0)
 		return;
-#ifdef WIIU
- 	t = cpu_features_get_time_usec();
-#else
-	gettimeofday (&tv, NULL);
-	t = (uae_u64)tv.tv_sec * 1000000 + tv.tv_usec;
-#endif
+	t = lockstep_usec ();
 	if (t - tod_hack_tv >= (uae_u64)(1000000 / rate) ) {
 		tod_hack_tv += (uae_u64)(1000000 / rate);
 		docount = 1;
@@ -577,7 +564,7 @@ static void do_tod_hack (int dotod)
 	}
 }
 
-static int resetwarning_phase, resetwarning_timer;
+static UAE_TLS int resetwarning_phase, resetwarning_timer;
 
 static void setcode (uae_u8 keycode)
 {
@@ -1471,7 +1458,7 @@ static void REGPARAM3 cia_lput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 cia_wput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 cia_bput (uaecptr, uae_u32) REGPARAM;
 
-addrbank cia_bank = {
+UAE_TLS addrbank cia_bank = {
 	cia_lget, cia_wget, cia_bget,
 	cia_lput, cia_wput, cia_bput,
 	default_xlate, default_check, NULL, _T("CIA"),
@@ -1702,19 +1689,19 @@ static void REGPARAM3 clock_lput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 clock_wput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 clock_bput (uaecptr, uae_u32) REGPARAM;
 
-addrbank clock_bank = {
+UAE_TLS addrbank clock_bank = {
 	clock_lget, clock_wget, clock_bget,
 	clock_lput, clock_wput, clock_bput,
 	default_xlate, default_check, NULL, _T("Battery backed up clock (none)"),
 	dummy_lgeti, dummy_wgeti, ABFLAG_IO
 };
 
-static unsigned int clock_control_d;
-static unsigned int clock_control_e;
-static unsigned int clock_control_f;
+static UAE_TLS unsigned int clock_control_d;
+static UAE_TLS unsigned int clock_control_e;
+static UAE_TLS unsigned int clock_control_f;
 
 #define RF5C01A_RAM_SIZE 16
-static uae_u8 rtc_memory[RF5C01A_RAM_SIZE], rtc_alarm[RF5C01A_RAM_SIZE];
+static UAE_TLS uae_u8 rtc_memory[RF5C01A_RAM_SIZE], rtc_alarm[RF5C01A_RAM_SIZE];
 
 static uae_u8 getclockreg (int addr, struct tm *ct)
 {
@@ -1798,9 +1785,9 @@ static void write_battclock (void)
 	if (f) {
 //		uae_u8 zero[13] = { 0 };
 		struct tm *ct;
-		time_t t = time (0);
+		time_t t = lockstep_time ();
 		t += currprefs.cs_rtc_adjust;
-		ct = localtime (&t);
+		ct = lockstep_localtime (&t);
 		uae_u8 od = clock_control_d;
 		if (currprefs.cs_rtc == 2)
 			clock_control_d &= ~3;
@@ -1881,9 +1868,9 @@ static uae_u32 REGPARAM2 clock_bget (uaecptr addr)
 			v = regs.irc >> 8;
 		return v;
 	}
-	t = time (0);
+	t = lockstep_time ();
 	t += currprefs.cs_rtc_adjust;
-	ct = localtime (&t);
+	ct = lockstep_localtime (&t);
 	addr >>= 2;
 	return getclockreg (addr, ct);
 }
@@ -2179,3 +2166,19 @@ uae_u8 *restore_keyboard (uae_u8 *src)
 }
 
 #endif /* SAVESTATE */
+
+/* raw register values, save_cia () would bring the timers up to date first */
+uae_u64 hash_cia (uae_u64 h)
+{
+	h = statehash_mix (h, ((uae_u64)ciaapra << 48) | ((uae_u64)ciaaprb << 32) | (ciaadra << 16) | ciaadrb);
+	h = statehash_mix (h, ((uae_u64)ciaata << 32) | ciaatb);
+	h = statehash_mix (h, ((uae_u64)ciaala << 32) | ciaalb);
+	h = statehash_mix (h, ((uae_u64)ciaatod << 32) | ciaaalarm);
+	h = statehash_mix (h, ((uae_u64)ciaacra << 48) | ((uae_u64)ciaacrb << 32) | (ciaaicr << 16) | (ciaaimask << 8) | ciaasdr);
+	h = statehash_mix (h, ((uae_u64)ciabpra << 48) | ((uae_u64)ciabprb << 32) | (ciabdra << 16) | ciabdrb);
+	h = statehash_mix (h, ((uae_u64)ciabta << 32) | ciabtb);
+	h = statehash_mix (h, ((uae_u64)ciabla << 32) | ciablb);
+	h = statehash_mix (h, ((uae_u64)ciabtod << 32) | ciabalarm);
+	h = statehash_mix (h, ((uae_u64)ciabcra << 48) | ((uae_u64)ciabcrb << 32) | (ciabicr << 16) | (ciabimask << 8) | ciabsdr);
+	return h;
+}
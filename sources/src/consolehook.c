@@ -15,7 +15,7 @@
 
 #include "consolehook.h"
 
-static uaecptr beginio;
+static UAE_TLS uaecptr beginio;
 
 void consolehook_config (struct uae_prefs *p)
 {
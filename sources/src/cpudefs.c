@@ -382,4 +382,4 @@ struct instr_def defs68k[] = {
 {0xF588, 3,{15,15,15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},0xFFF8,5,0,2,{{1,1},{1,1},{1,1},{1,1},{1,1}}, 0,"PLPAW    Ara"},
 /* PLPAR  */
 {0xF5C8, 3,{15,15,15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},0xFFF8,5,0,2,{{1,1},{1,1},{1,1},{1,1},{1,1}}, 0,"PLPAR    Ara"}};
-int n_defs68k = 190;
+UAE_TLS int n_defs68k = 190;
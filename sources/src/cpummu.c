@@ -38,20 +38,20 @@
 #ifdef FULLMMU
 
 
-uae_u32 mmu_is_super;
-uae_u32 mmu_tagmask, mmu_pagemask, mmu_pagemaski;
-struct mmu_atc_line mmu_atc_array[ATC_TYPE][ATC_WAYS][ATC_SLOTS];
-bool mmu_pagesize_8k;
+UAE_TLS uae_u32 mmu_is_super;
+UAE_TLS uae_u32 mmu_tagmask, mmu_pagemask, mmu_pagemaski;
+UAE_TLS struct mmu_atc_line mmu_atc_array[ATC_TYPE][ATC_WAYS][ATC_SLOTS];
+UAE_TLS bool mmu_pagesize_8k;
 
-int mmu060_state;
-uae_u16 mmu_opcode;
-bool mmu_restart;
-static bool locked_rmw_cycle;
-static bool ismoves;
-bool mmu_ttr_enabled;
+UAE_TLS int mmu060_state;
+UAE_TLS uae_u16 mmu_opcode;
+UAE_TLS bool mmu_restart;
+static UAE_TLS bool locked_rmw_cycle;
+static UAE_TLS bool ismoves;
+UAE_TLS bool mmu_ttr_enabled;
 
-int mmu040_movem;
-uaecptr mmu040_movem_ea;
+UAE_TLS int mmu040_movem;
+UAE_TLS uaecptr mmu040_movem_ea;
 
 static void mmu_dump_ttr(const TCHAR * label, uae_u32 ttr)
 {
@@ -1283,11 +1283,11 @@ void REGPARAM2 mmu060_put_rmw_bitfield (uae_u32 dst, uae_u32 bdata[2], uae_u32 v
 
 
 #ifndef __cplusplus
-jmp_buf __exbuf;
-int     __exvalue;
+UAE_TLS jmp_buf __exbuf;
+UAE_TLS int     __exvalue;
 #define MAX_TRY_STACK 256
-static int s_try_stack_size=0;
-static jmp_buf s_try_stack[MAX_TRY_STACK];
+static UAE_TLS int s_try_stack_size=0;
+static UAE_TLS jmp_buf s_try_stack[MAX_TRY_STACK];
 jmp_buf* __poptry(void) {
 	if (s_try_stack_size>0) {
         s_try_stack_size--;
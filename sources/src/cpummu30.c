@@ -50,27 +50,27 @@
 #define TT_ADDR_MASK    0x00FF0000
 #define TT_ADDR_BASE    0xFF000000
 
-static int bBusErrorReadWrite;
-static int atcindextable[32];
-static int tt_enabled;
+static UAE_TLS int bBusErrorReadWrite;
+static UAE_TLS int atcindextable[32];
+static UAE_TLS int tt_enabled;
 
-int mmu030_idx;
+UAE_TLS int mmu030_idx;
 
-uae_u32 mm030_stageb_address;
-bool mmu030_retry;
-int mmu030_opcode;
-int mmu030_opcode_stageb;
-uae_u16 mmu030_state[3];
-uae_u32 mmu030_data_buffer;
-uae_u32 mmu030_disp_store[2];
-struct mmu030_access mmu030_ad[MAX_MMU030_ACCESS];
+UAE_TLS uae_u32 mm030_stageb_address;
+UAE_TLS bool mmu030_retry;
+UAE_TLS int mmu030_opcode;
+UAE_TLS int mmu030_opcode_stageb;
+UAE_TLS uae_u16 mmu030_state[3];
+UAE_TLS uae_u32 mmu030_data_buffer;
+UAE_TLS uae_u32 mmu030_disp_store[2];
+UAE_TLS struct mmu030_access mmu030_ad[MAX_MMU030_ACCESS];
 
 /* for debugging messages */
 char table_letter[4] = {'A','B','C','D'};
 
-uae_u64 srp_030, crp_030;
-uae_u32 tt0_030, tt1_030, tc_030;
-uae_u16 mmusr_030;
+UAE_TLS uae_u64 srp_030, crp_030;
+UAE_TLS uae_u32 tt0_030, tt1_030, tc_030;
+UAE_TLS uae_u16 mmusr_030;
 
 /* ATC struct */
 #define ATC030_NUM_ENTRIES  22
@@ -95,7 +95,7 @@ typedef struct {
 
 
 /* MMU struct for 68030 */
-struct {
+UAE_TLS struct {
     
     /* Translation tables */
     struct {
@@ -4,8 +4,8 @@
 
 #include "crc32.h"
 
-static unsigned long crc_table32[256];
-static unsigned short crc_table16[256];
+static UAE_TLS unsigned long crc_table32[256];
+static UAE_TLS unsigned short crc_table16[256];
 static void make_crc_table (void)
 {
 	unsigned long c;
@@ -337,7 +337,7 @@ void get_sha1 (uae_u8 *input, int len, uae_u8 *out)
 }
 const TCHAR *get_sha1_txt (uae_u8 *input, int len)
 {
-	static TCHAR outtxt[SHA1_SIZE * 2 + 1];
+	static UAE_TLS TCHAR outtxt[SHA1_SIZE * 2 + 1];
 	uae_u8 out[SHA1_SIZE];
 	int i;
 	TCHAR *p;
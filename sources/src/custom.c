@@ -58,6 +58,10 @@
 #include "hrtimer.h"
 #include "sleep.h"
 #include "misc.h"
+#include "hostprof.h"
+#include "statehash.h"
+#include "lockstep.h"
+#include "threaddep/thread.h"
 
 #define CUSTOM_DEBUG 0
 #define SPRITE_DEBUG 0
@@ -71,10 +75,6 @@
 
 #define SPRBORDER 0
 
-#ifdef WIIU
-#include <features_cpu.h>
-#endif
-
 #ifdef __LIBRETRO__
 #include "libretro-glue.h"
 #endif
@@ -95,7 +95,7 @@ STATIC_INLINE bool nocustom (void)
 
 void uae_abort (const TCHAR *format,...)
 {
-	static int nomore;
+	static UAE_TLS int nomore;
 	va_list parms;
 	TCHAR buffer[1000];
 
@@ -128,65 +128,68 @@ uae_u16 customhack_get (struct customhack *ch, int hpos)
 }
 #endif
 
-uae_u16 last_custom_value1;
+UAE_TLS uae_u16 last_custom_value1;
 
-static unsigned int n_consecutive_skipped = 0;
-static unsigned int total_skipped = 0;
+static UAE_TLS unsigned int n_consecutive_skipped = 0;
+static UAE_TLS unsigned int total_skipped = 0;
 
 STATIC_INLINE void sync_copper (int hpos);
 
 
 /* Events */
 
-unsigned long int vsync_cycles;
-static int extra_cycle;
-
-static int rpt_did_reset;
-struct ev eventtab[ev_max];
-struct ev2 eventtab2[ev2_max];
-
-
-int vpos;
-static int vpos_count, vpos_count_diff;
-int lof_store; // real bit in custom registers
-static int lof_current; // what display device thinks
-static bool lof_lastline, lof_prev_lastline;
-static int lol;
-static int next_lineno, prev_lineno;
-static enum nln_how nextline_how;
-static int lof_changed = 0, lof_changing = 0, interlace_changed = 0;
-static int lof_changed_previous_field;
-static int vposw_change;
-static bool lof_lace;
-static bool bplcon0_interlace_seen;
-static int scandoubled_line;
-static bool vsync_rendered, frame_rendered, frame_shown;
-static int vsynctimeperline;
-static int jitcount = 0;
-static int frameskiptime;
-static bool genlockhtoggle;
-static bool genlockvtoggle;
+UAE_TLS unsigned long int vsync_cycles;
+static UAE_TLS int extra_cycle;
+/* do_cycles_ce () can skip its per cycle decisions until ce_quiet_end,
+ * as long as nothing else moved the clock since ce_quiet_last */
+static UAE_TLS unsigned long ce_quiet_end, ce_quiet_last;
+
+static UAE_TLS int rpt_did_reset;
+UAE_TLS struct ev eventtab[ev_max];
+UAE_TLS struct ev2 eventtab2[ev2_max];
+
+
+UAE_TLS int vpos;
+static UAE_TLS int vpos_count, vpos_count_diff;
+UAE_TLS int lof_store; // real bit in custom registers
+static UAE_TLS int lof_current; // what display device thinks
+static UAE_TLS bool lof_lastline, lof_prev_lastline;
+static UAE_TLS int lol;
+static UAE_TLS int next_lineno, prev_lineno;
+static UAE_TLS enum nln_how nextline_how;
+static UAE_TLS int lof_changed = 0, lof_changing = 0, interlace_changed = 0;
+static UAE_TLS int lof_changed_previous_field;
+static UAE_TLS int vposw_change;
+static UAE_TLS bool lof_lace;
+static UAE_TLS bool bplcon0_interlace_seen;
+static UAE_TLS int scandoubled_line;
+static UAE_TLS bool vsync_rendered, frame_rendered, frame_shown;
+static UAE_TLS int vsynctimeperline;
+static UAE_TLS int jitcount = 0;
+static UAE_TLS int frameskiptime;
+static UAE_TLS bool genlockhtoggle;
+static UAE_TLS bool genlockvtoggle;
 
 #define LOF_TOGGLES_NEEDED 4
 #define NLACE_CNT_NEEDED 50
-static int lof_togglecnt_lace, lof_togglecnt_nlace, lof_previous, nlace_cnt;
+static UAE_TLS int lof_togglecnt_lace, lof_togglecnt_nlace, lof_previous, nlace_cnt;
 
 /* Stupid genlock-detection prevention hack.
 * We should stop calling vsync_handler() and
 * hstop_handler() completely but it is not
 * worth the trouble..
 */
-static int vpos_previous, hpos_previous;
-static int vpos_lpen, hpos_lpen, lightpen_triggered;
-int lightpen_x = -1, lightpen_y = -1, lightpen_cx, lightpen_cy, lightpen_active;
+static UAE_TLS int vpos_previous, hpos_previous;
+static UAE_TLS int vpos_lpen, hpos_lpen, lightpen_triggered;
+UAE_TLS int lightpen_x = -1, lightpen_y = -1, lightpen_cx, lightpen_cy, lightpen_active;
 
-static uae_u32 sprtaba[256],sprtabb[256];
-static uae_u32 sprite_ab_merge[256];
+static UAE_TLS uae_u32 sprtaba[256],sprtabb[256];
+static UAE_TLS uae_u32 sprite_ab_merge[256];
 /* Tables for collision detection.  */
-static uae_u32 sprclx[16], clxmask[16];
+static UAE_TLS uae_u32 sprclx[16], clxmask[16];
 
 /* AGA T genlock bit in color registers */
-static uae_u8 color_regs_aga_genlock[256];
+static UAE_TLS uae_u8 color_regs_aga_genlock[256];
 
 /*
 * Hardware registers of all sorts.
@@ -194,38 +197,38 @@ static uae_u8 color_regs_aga_genlock[256];
 
 static int REGPARAM3 custom_wput_1 (int, uaecptr, uae_u32, int) REGPARAM;
 
-static uae_u16 cregs[256];
-
-uae_u16 intena, intreq;
-uae_u16 dmacon;
-uae_u16 adkcon; /* used by audio code */
-
-static uae_u32 cop1lc, cop2lc, copcon;
-
-int maxhpos = MAXHPOS_PAL;
-int maxhpos_short = MAXHPOS_PAL;
-int maxvpos = MAXVPOS_PAL;
-int maxvpos_nom = MAXVPOS_PAL; // nominal value (same as maxvpos but "faked" maxvpos in fake 60hz modes)
-int hsyncendpos, hsyncstartpos;
-static int maxvpos_total = 511;
-int minfirstline = VBLANK_ENDLINE_PAL;
-static int equ_vblank_endline = EQU_ENDLINE_PAL;
-static bool equ_vblank_toggle = true;
-double vblank_hz = VBLANK_HZ_PAL, fake_vblank_hz, vblank_hz_stored;
-static int vblank_hz_mult, vblank_hz_state;
-static struct chipset_refresh *stored_chipset_refresh;
-int doublescan;
-bool programmedmode;
-int syncbase;
-static int fmode;
-uae_u16 beamcon0, new_beamcon0;
-static bool varsync_changed;
-uae_u16 vtotal = MAXVPOS_PAL, htotal = MAXHPOS_PAL;
-static int maxvpos_stored, maxhpos_stored;
-static uae_u16 hsstop, hbstrt, hbstop, vsstop, vbstrt, vbstop, hsstrt, vsstrt, hcenter;
-static int ciavsyncmode;
-static int diw_hstrt, diw_hstop;
-static int diw_hcounter;
+static UAE_TLS uae_u16 cregs[256];
+
+UAE_TLS uae_u16 intena, intreq;
+UAE_TLS uae_u16 dmacon;
+UAE_TLS uae_u16 adkcon; /* used by audio code */
+
+static UAE_TLS uae_u32 cop1lc, cop2lc, copcon;
+
+UAE_TLS int maxhpos = MAXHPOS_PAL;
+UAE_TLS int maxhpos_short = MAXHPOS_PAL;
+UAE_TLS int maxvpos = MAXVPOS_PAL;
+UAE_TLS int maxvpos_nom = MAXVPOS_PAL; // nominal value (same as maxvpos but "faked" maxvpos in fake 60hz modes)
+UAE_TLS int hsyncendpos, hsyncstartpos;
+static UAE_TLS int maxvpos_total = 511;
+UAE_TLS int minfirstline = VBLANK_ENDLINE_PAL;
+static UAE_TLS int equ_vblank_endline = EQU_ENDLINE_PAL;
+static UAE_TLS bool equ_vblank_toggle = true;
+UAE_TLS double vblank_hz = VBLANK_HZ_PAL, fake_vblank_hz, vblank_hz_stored;
+static UAE_TLS int vblank_hz_mult, vblank_hz_state;
+static UAE_TLS struct chipset_refresh *stored_chipset_refresh;
+UAE_TLS int doublescan;
+UAE_TLS bool programmedmode;
+UAE_TLS int syncbase;
+static UAE_TLS int fmode;
+UAE_TLS uae_u16 beamcon0, new_beamcon0;
+static UAE_TLS bool varsync_changed;
+UAE_TLS uae_u16 vtotal = MAXVPOS_PAL, htotal = MAXHPOS_PAL;
+static UAE_TLS int maxvpos_stored, maxhpos_stored;
+static UAE_TLS uae_u16 hsstop, hbstrt, hbstop, vsstop, vbstrt, vbstop, hsstrt, vsstrt, hcenter;
+static UAE_TLS int ciavsyncmode;
+static UAE_TLS int diw_hstrt, diw_hstop;
+static UAE_TLS int diw_hcounter;
 
 #define HSYNCTIME (maxhpos * CYCLE_UNIT);
 
@@ -243,49 +246,49 @@ struct sprite {
 	int ptxhpos;
 };
 
-static struct sprite spr[MAX_SPRITES];
-static int plfstrt_sprite;
+static UAE_TLS struct sprite spr[MAX_SPRITES];
+static UAE_TLS int plfstrt_sprite;
 
-uaecptr sprite_0;
-int sprite_0_width, sprite_0_height, sprite_0_doubled;
-uae_u32 sprite_0_colors[4];
-static uae_u8 magic_sprite_mask = 0xff;
+UAE_TLS uaecptr sprite_0;
+UAE_TLS int sprite_0_width, sprite_0_height, sprite_0_doubled;
+UAE_TLS uae_u32 sprite_0_colors[4];
+static UAE_TLS uae_u8 magic_sprite_mask = 0xff;
 
-static int sprite_vblank_endline = VBLANK_SPRITE_PAL;
+static UAE_TLS int sprite_vblank_endline = VBLANK_SPRITE_PAL;
 
-static unsigned int sprctl[MAX_SPRITES], sprpos[MAX_SPRITES];
+static UAE_TLS unsigned int sprctl[MAX_SPRITES], sprpos[MAX_SPRITES];
 #ifdef AGA
-static uae_u16 sprdata[MAX_SPRITES][4], sprdatb[MAX_SPRITES][4];
+static UAE_TLS uae_u16 sprdata[MAX_SPRITES][4], sprdatb[MAX_SPRITES][4];
 #else
 static uae_u16 sprdata[MAX_SPRITES][1], sprdatb[MAX_SPRITES][1];
 #endif
-static int sprite_last_drawn_at[MAX_SPRITES];
-static int last_sprite_point, nr_armed;
-static int sprite_width, sprres;
-int sprite_buffer_res;
+static UAE_TLS int sprite_last_drawn_at[MAX_SPRITES];
+static UAE_TLS int last_sprite_point, nr_armed;
+static UAE_TLS int sprite_width, sprres;
+UAE_TLS int sprite_buffer_res;
 
 #ifdef CPUEMU_12
-uae_u8 cycle_line[256];
+UAE_TLS uae_u8 cycle_line[256];
 #endif
 
-static uae_u16 bplxdat[8];
-static bool bpl1dat_written, bpl1dat_early, bpl1dat_written_at_least_once;
-static bool bpldmawasactive;
-static uae_s16 bpl1mod, bpl2mod;
-static uaecptr prevbpl[2][MAXVPOS][8];
-static uaecptr bplpt[8], bplptx[8];
+static UAE_TLS uae_u16 bplxdat[8];
+static UAE_TLS bool bpl1dat_written, bpl1dat_early, bpl1dat_written_at_least_once;
+static UAE_TLS bool bpldmawasactive;
+static UAE_TLS uae_s16 bpl1mod, bpl2mod;
+static UAE_TLS uaecptr prevbpl[2][MAXVPOS][8];
+static UAE_TLS uaecptr bplpt[8], bplptx[8];
 
 /*static int blitcount[256];  blitter debug */
 
-static struct color_entry current_colors;
-unsigned int bplcon0;
-static unsigned int bplcon1, bplcon2, bplcon3, bplcon4;
-static unsigned int bplcon0d, bplcon0dd, bplcon0_res, bplcon0_planes, bplcon0_planes_limit;
-static unsigned int diwstrt, diwstop, diwhigh;
-static int diwhigh_written;
-static unsigned int ddfstrt, ddfstop, ddfstrt_old_hpos;
-static int ddf_change, badmode, diw_change;
-static int bplcon1_hpos;
+static UAE_TLS struct color_entry current_colors;
+UAE_TLS unsigned int bplcon0;
+static UAE_TLS unsigned int bplcon1, bplcon2, bplcon3, bplcon4;
+static UAE_TLS unsigned int bplcon0d, bplcon0dd, bplcon0_res, bplcon0_planes, bplcon0_planes_limit;
+static UAE_TLS unsigned int diwstrt, diwstop, diwhigh;
+static UAE_TLS int diwhigh_written;
+static UAE_TLS unsigned int ddfstrt, ddfstop, ddfstrt_old_hpos;
+static UAE_TLS int ddf_change, badmode, diw_change;
+static UAE_TLS int bplcon1_hpos;
 
 /* The display and data fetch windows */
 
@@ -294,29 +297,29 @@ enum diw_states
 	DIW_waiting_start, DIW_waiting_stop
 };
 
-int plffirstline, plflastline;
-int plffirstline_total, plflastline_total;
-static int autoscale_bordercolors;
-static int plfstrt_start, plfstrt, plfstop;
-static int sprite_minx, sprite_maxx;
-static int first_bpl_vpos;
-static int last_ddf_pix_hpos;
-static int last_decide_line_hpos;
-static int last_fetch_hpos, last_sprite_hpos;
-static int diwfirstword, diwlastword;
-static int plfleft_real;
-static int last_hdiw;
-static enum diw_states diwstate, hdiwstate, ddfstate;
-int first_planes_vpos, last_planes_vpos;
-int diwfirstword_total, diwlastword_total;
-int ddffirstword_total, ddflastword_total;
-int firstword_bplcon1;
-
-static int last_copper_hpos;
-static int copper_access;
+UAE_TLS int plffirstline, plflastline;
+UAE_TLS int plffirstline_total, plflastline_total;
+static UAE_TLS int autoscale_bordercolors;
+static UAE_TLS int plfstrt_start, plfstrt, plfstop;
+static UAE_TLS int sprite_minx, sprite_maxx;
+static UAE_TLS int first_bpl_vpos;
+static UAE_TLS int last_ddf_pix_hpos;
+static UAE_TLS int last_decide_line_hpos;
+static UAE_TLS int last_fetch_hpos, last_sprite_hpos;
+static UAE_TLS int diwfirstword, diwlastword;
+static UAE_TLS int plfleft_real;
+static UAE_TLS int last_hdiw;
+static UAE_TLS enum diw_states diwstate, hdiwstate, ddfstate;
+UAE_TLS int first_planes_vpos, last_planes_vpos;
+UAE_TLS int diwfirstword_total, diwlastword_total;
+UAE_TLS int ddffirstword_total, ddflastword_total;
+UAE_TLS int firstword_bplcon1;
+
+static UAE_TLS int last_copper_hpos;
+static UAE_TLS int copper_access;
 
 /* Sprite collisions */
-static unsigned int clxdat, clxcon, clxcon2, clxcon_bpl_enable, clxcon_bpl_match;
+static UAE_TLS unsigned int clxdat, clxcon, clxcon2, clxcon_bpl_enable, clxcon_bpl_match;
 
 enum copper_states {
 	COP_stop,
@@ -353,42 +356,42 @@ struct copper {
 	int moveaddr, movedata, movedelay;
 };
 
-static struct copper cop_state;
-static int copper_enabled_thisline;
-static int cop_min_waittime;
+static UAE_TLS struct copper cop_state;
+static UAE_TLS int copper_enabled_thisline;
+static UAE_TLS int cop_min_waittime;
 
 /*
 * Statistics
 */
-unsigned long int frametime = 0, lastframetime = 0, timeframes = 0;
-unsigned long hsync_counter = 0, vsync_counter = 0;
-unsigned long int idletime;
-int bogusframe;
+UAE_TLS unsigned long int frametime = 0, lastframetime = 0, timeframes = 0;
+UAE_TLS unsigned long hsync_counter = 0, vsync_counter = 0;
+UAE_TLS unsigned long int idletime;
+UAE_TLS int bogusframe;
 
 /* Recording of custom chip register changes.  */
-static int current_change_set;
-static struct sprite_entry sprite_entries[2][MAX_SPR_PIXELS / 16];
-static struct color_change color_changes[2][MAX_REG_CHANGE];
+static UAE_TLS int current_change_set;
+static UAE_TLS struct sprite_entry sprite_entries[2][MAX_SPR_PIXELS / 16];
+static UAE_TLS struct color_change color_changes[2][MAX_REG_CHANGE];
 
-struct decision line_decisions[2 * (MAXVPOS + 2) + 1];
-static struct draw_info line_drawinfo[2][2 * (MAXVPOS + 2) + 1];
+UAE_TLS struct decision line_decisions[2 * (MAXVPOS + 2) + 1];
+static UAE_TLS struct draw_info line_drawinfo[2][2 * (MAXVPOS + 2) + 1];
 #define COLOR_TABLE_SIZE (MAXVPOS + 2) * 2
-static struct color_entry color_tables[2][COLOR_TABLE_SIZE];
+static UAE_TLS struct color_entry color_tables[2][COLOR_TABLE_SIZE];
 
-static int next_sprite_entry = 0;
-static int prev_next_sprite_entry;
-static int next_sprite_forced = 1;
+static UAE_TLS int next_sprite_entry = 0;
+static UAE_TLS int prev_next_sprite_entry;
+static UAE_TLS int next_sprite_forced = 1;
 
-struct sprite_entry *curr_sprite_entries, *prev_sprite_entries;
-struct color_change *curr_color_changes, *prev_color_changes;
-struct draw_info *curr_drawinfo, *prev_drawinfo;
-struct color_entry *curr_color_tables, *prev_color_tables;
+UAE_TLS struct sprite_entry *curr_sprite_entries, *prev_sprite_entries;
+UAE_TLS struct color_change *curr_color_changes, *prev_color_changes;
+UAE_TLS struct draw_info *curr_drawinfo, *prev_drawinfo;
+UAE_TLS struct color_entry *curr_color_tables, *prev_color_tables;
 
-static int next_color_change;
-static int next_color_entry, remembered_color_entry;
-static int color_src_match, color_dest_match, color_compare_result;
+static UAE_TLS int next_color_change;
+static UAE_TLS int next_color_entry, remembered_color_entry;
+static UAE_TLS int color_src_match, color_dest_match, color_compare_result;
 
-static uae_u32 thisline_changed;
+static UAE_TLS uae_u32 thisline_changed;
 
 #ifdef SMART_UPDATE
 #define MARK_LINE_CHANGED do { thisline_changed = 1; } while (0)
@@ -396,10 +399,10 @@ static uae_u32 thisline_changed;
 #define MARK_LINE_CHANGED do { ; } while (0)
 #endif
 
-static struct decision thisline_decision;
-static int fetch_cycle, fetch_modulo_cycle;
+static UAE_TLS struct decision thisline_decision;
+static UAE_TLS int fetch_cycle, fetch_modulo_cycle;
 
-enum plfstate
+UAE_TLS enum plfstate
 {
 	plf_idle,
 	plf_start,
@@ -410,7 +413,7 @@ enum plfstate
 	plf_finished
 } plf_state;
 
-enum fetchstate {
+UAE_TLS enum fetchstate {
 	fetch_not_started,
 	fetch_started,
 	fetch_was_plane0
@@ -427,7 +430,7 @@ STATIC_INLINE int ecsshres(void)
 
 STATIC_INLINE int nodraw (void)
 {
-	return !currprefs.cpu_cycle_exact && framecnt != 0;
+	return !currprefs.cpu_cycle_exact && !frame_headless && !currprefs.lockstep && framecnt != 0;
 }
 
 static int doflickerfix (void)
@@ -493,7 +496,7 @@ void alloc_cycle_ext(int hpos, int type)
 void alloc_cycle_blitter (int hpos, uaecptr *ptr, int chnum)
 {
 	if (cycle_line[hpos] & CYCLE_COPPER_SPECIAL) {
-		static int warned = 100;
+		static UAE_TLS int warned = 100;
 		uaecptr srcptr = cop_state.strobe == 1 ? cop1lc : cop2lc;
 		if (warned > 0) {
 			write_log (_T("buggy copper cycle conflict with blitter ch %c %08x <- %08x PC=%08x\n"), 'A' + (chnum - 1), *ptr, srcptr, m68k_getpc ());
@@ -514,7 +517,7 @@ static void update_mirrors (void)
 STATIC_INLINE uae_u8 *pfield_xlateptr (uaecptr plpt, int bytecount)
 {
 	if (!chipmem_check_indirect (plpt, bytecount)) {
-		static int count = 0;
+		static UAE_TLS int count = 0;
 		if (!count)
 			count++, write_log (_T("Warning: Bad playfield pointer\n"));
 		return NULL;
@@ -547,7 +550,7 @@ STATIC_INLINE void docols (struct color_entry *colentry)
 #endif
 }
 
-extern struct color_entry colors_for_drawing;
+extern UAE_TLS struct color_entry colors_for_drawing;
 
 void notice_new_xcolors (void)
 {
@@ -649,8 +652,8 @@ static void decide_diw (int hpos)
 	last_hdiw = hdiw;
 }
 
-static int fetchmode;
-static int real_bitplane_number[3][3][9];
+static UAE_TLS int fetchmode;
+static UAE_TLS int real_bitplane_number[3][3][9];
 
 /* Disable bitplane DMA if planes > available DMA slots. This is needed
 e.g. by the Sanity WOC demo (at the "Party Effect").  */
@@ -739,28 +742,28 @@ static void finish_playfield_line (void)
 are contained in an indivisible block during which ddf is active.  E.g.
 if DDF starts at 0x30, and fetchunit is 8, then possible DDF stops are
 0x30 + n * 8.  */
-static int fetchunit, fetchunit_mask;
+static UAE_TLS int fetchunit, fetchunit_mask;
 /* The delay before fetching the same bitplane again.  Can be larger than
 the number of bitplanes; in that case there are additional empty cycles
 with no data fetch (this happens for high fetchmodes and low
 resolutions).  */
-static int fetchstart, fetchstart_shift, fetchstart_mask;
+static UAE_TLS int fetchstart, fetchstart_shift, fetchstart_mask;
 /* fm_maxplane holds the maximum number of planes possible with the current
 fetch mode.  This selects the cycle diagram:
 8 planes: 73516240
 4 planes: 3120
 2 planes: 10.  */
-static int fm_maxplane, fm_maxplane_shift;
+static UAE_TLS int fm_maxplane, fm_maxplane_shift;
 
 /* The corresponding values, by fetchmode and display resolution.  */
 static const int fetchunits[] = { 8,8,8,0, 16,8,8,0, 32,16,8,0 };
 static const int fetchstarts[] = { 3,2,1,0, 4,3,2,0, 5,4,3,0 };
 static const int fm_maxplanes[] = { 3,2,1,0, 3,3,2,0, 3,3,3,0 };
 
-static int cycle_diagram_table[3][3][9][32];
-static int cycle_diagram_free_cycles[3][3][9];
-static int cycle_diagram_total_cycles[3][3][9];
-static int *curr_diagram;
+static UAE_TLS int cycle_diagram_table[3][3][9][32];
+static UAE_TLS int cycle_diagram_free_cycles[3][3][9];
+static UAE_TLS int cycle_diagram_total_cycles[3][3][9];
+static UAE_TLS int *curr_diagram;
 static const int cycle_sequences[3 * 8] = { 2,1,2,1,2,1,2,1, 4,2,3,1,4,2,3,1, 8,4,6,2,7,3,5,1 };
 
 static void debug_cycle_diagram (void)
@@ -832,8 +835,8 @@ static void create_cycle_diagram_table (void)
 
 
 /* Used by the copper.  */
-static int estimated_last_fetch_cycle;
-static int cycle_diagram_shift;
+static UAE_TLS int estimated_last_fetch_cycle;
+static UAE_TLS int cycle_diagram_shift;
 
 static void estimate_last_fetch_cycle (int hpos)
 {
@@ -855,18 +858,18 @@ static void estimate_last_fetch_cycle (int hpos)
 	}
 }
 
-static uae_u32 outword[MAX_PLANES];
-static int out_nbits, out_offs;
-static uae_u32 todisplay[MAX_PLANES][4];
-static uae_u32 fetched[MAX_PLANES];
+static UAE_TLS uae_u32 outword[MAX_PLANES];
+static UAE_TLS int out_nbits, out_offs;
+static UAE_TLS uae_u32 todisplay[MAX_PLANES][4];
+static UAE_TLS uae_u32 fetched[MAX_PLANES];
 #ifdef AGA
-static uae_u32 fetched_aga0[MAX_PLANES];
-static uae_u32 fetched_aga1[MAX_PLANES];
+static UAE_TLS uae_u32 fetched_aga0[MAX_PLANES];
+static UAE_TLS uae_u32 fetched_aga1[MAX_PLANES];
 #endif
 
 /* Expansions from bplcon0/bplcon1.  */
-static int toscr_res, toscr_nr_planes, toscr_nr_planes2, fetchwidth;
-static int toscr_delay1, toscr_delay2;
+static UAE_TLS int toscr_res, toscr_nr_planes, toscr_nr_planes2, fetchwidth;
+static UAE_TLS int toscr_delay1, toscr_delay2;
 
 /* The number of bits left from the last fetched words.
 This is an optimization - conceptually, we have to make sure the result is
@@ -874,10 +877,10 @@ the same as if toscr is called in each clock cycle.  However, to speed this
 up, we accumulate display data; this variable keeps track of how much.
 Thus, once we do call toscr_nbits (which happens at least every 16 bits),
 we can do more work at once.  */
-static int toscr_nbits;
+static UAE_TLS int toscr_nbits;
 
 /* undocumented bitplane delay hardware feature */
-static int delayoffset;
+static UAE_TLS int delayoffset;
 
 STATIC_INLINE void compute_delay_offset (void)
 {
@@ -970,8 +973,8 @@ static void update_denise (int hpos)
 	}
 }
 
-static int bpldmasetuphpos;
-static int bpldmasetupphase;
+static UAE_TLS int bpldmasetuphpos;
+static UAE_TLS int bpldmasetupphase;
 
 /* set currently active Agnus bitplane DMA sequence */
 static void setup_fmodes (int hpos)
@@ -1402,7 +1405,7 @@ STATIC_INLINE void beginning_of_plane_block (int hpos, int fm)
 {
 	int i;
 	int oleft = thisline_decision.plfleft;
-	static uae_u16 bplcon1t, bplcon1t2;
+	static UAE_TLS uae_u16 bplcon1t, bplcon1t2;
 
 	flush_display (fm);
 
@@ -1654,7 +1657,7 @@ static void finish_last_fetch (int pos, int fm)
  */
 static void maybe_finish_last_fetch (int pos, int fm)
 {
-	static int warned = 20;
+	static UAE_TLS int warned = 20;
 	bool done = false;
 
 	if (plf_state != plf_passed_stop2 || fetch_state != fetch_started || !dmaen (DMA_BITPLANE)) {
@@ -2357,10 +2360,13 @@ static void do_sprite_collisions (void)
 		clxdat |= 0x1FE;
 		return;
 	}
+	if (!collision_mask)
+		return;
 
 	for (i = 0; i < nr_sprites; i++) {
 		struct sprite_entry *e = curr_sprite_entries + first + i;
 		sprbuf_res_t j;
+		int p, pfirst, plast;
 		sprbuf_res_t minpos = e->pos;
 		sprbuf_res_t maxpos = e->max;
 		hwres_t minp1 = minpos >> sprite_buffer_res;
@@ -2375,59 +2381,72 @@ static void do_sprite_collisions (void)
 		if (minp1 < thisline_decision.plfleft * 2)
 			minpos = thisline_decision.plfleft * 2 << sprite_buffer_res;
 
-		for (j = minpos; j < maxpos; j++) {
-			int sprpix = spixels[e->first_pixel + j - e->pos] & collision_mask;
-			int k, offs, match = 1;
-
-			if (sprpix == 0)
-				continue;
+		/* Only pixels the sprites cover can collide, whole words of
+		   coverage outside the playfield window are never looked at.  */
+		pfirst = e->first_pixel + minpos - e->pos;
+		plast = e->first_pixel + maxpos - e->pos;
+		for (p = pfirst & ~31; p < plast; p += 32) {
+			uae_u32 m = spixmask[p >> 5];
+			if (p < pfirst)
+				m &= ~0u << (pfirst - p);
+			if (plast - p < 32)
+				m &= (1u << (plast - p)) - 1;
+			for (j = p - e->first_pixel + e->pos; m; j++, m >>= 1) {
+				int sprpix, k, offs, match = 1;
+
+				if (!(m & 1))
+					continue;
+				sprpix = spixels[e->first_pixel + j - e->pos] & collision_mask;
+				if (sprpix == 0)
+					continue;
 
-			offs = ((j << bplres) >> sprite_buffer_res) - ddf_left;
-			sprpix = sprite_ab_merge[sprpix & 255] | (sprite_ab_merge[sprpix >> 8] << 2);
-			sprpix <<= 1;
+				offs = ((j << bplres) >> sprite_buffer_res) - ddf_left;
+				sprpix = sprite_ab_merge[sprpix & 255] | (sprite_ab_merge[sprpix >> 8] << 2);
+				sprpix <<= 1;
 
-			/* Loop over number of playfields.  */
-			for (k = 1; k >= 0; k--) {
-				int l;
+				/* Loop over number of playfields.  */
+				for (k = 1; k >= 0; k--) {
+					int l;
 #ifdef AGA
-				int planes = (currprefs.chipset_mask & CSMASK_AGA) ? 8 : 6;
+					int planes = (currprefs.chipset_mask & CSMASK_AGA) ? 8 : 6;
 #else
-				int planes = 6;
-#endif
-				if (bplcon0 & 0x400)
-					match = 1;
-				for (l = k; match && l < planes; l += 2) {
-					unsigned int t = 0;
-					if (l < thisline_decision.nr_planes) {
-						uae_u32 *ldata = (uae_u32 *)(line_data[next_lineno] + 2 * l * MAX_WORDS_PER_LINE);
-						uae_u32 word = ldata[offs >> 5];
-						t = (word >> (31 - (offs & 31))) & 1;
+					int planes = 6;
+#endif
+					if (bplcon0 & 0x400)
+						match = 1;
+					for (l = k; match && l < planes; l += 2) {
+						unsigned int t = 0;
+						if (l < thisline_decision.nr_planes) {
+							uae_u32 *ldata = (uae_u32 *)(line_data[next_lineno] + 2 * l * MAX_WORDS_PER_LINE);
+							uae_u32 word = ldata[offs >> 5];
+							t = (word >> (31 - (offs & 31))) & 1;
 #if 0 /* debug: draw collision mask */
-						if (1) {
-							int m;
-							for (m = 0; m < 5; m++) {
-								ldata = (uae_u32 *)(line_data[next_lineno] + 2 * m * MAX_WORDS_PER_LINE);
-								ldata[(offs >> 5) + 1] |= 15 << (31 - (offs & 31));
+							if (1) {
+								int m;
+								for (m = 0; m < 5; m++) {
+									ldata = (uae_u32 *)(line_data[next_lineno] + 2 * m * MAX_WORDS_PER_LINE);
+									ldata[(offs >> 5) + 1] |= 15 << (31 - (offs & 31));
+								}
 							}
-						}
 #endif
+						}
+						if (clxcon_bpl_enable & (1 << l)) {
+							if (t != ((clxcon_bpl_match >> l) & 1))
+								match = 0;
+						}
 					}
-					if (clxcon_bpl_enable & (1 << l)) {
-						if (t != ((clxcon_bpl_match >> l) & 1))
-							match = 0;
-					}
-				}
-				if (match) {
+					if (match) {
 #if 0 /* debug: mark lines where collisions are detected */
-					if (0) {
-						int l;
-						for (l = 0; l < 5; l++) {
-							uae_u32 *ldata = (uae_u32 *)(line_data[next_lineno] + 2 * l * MAX_WORDS_PER_LINE);
-							ldata[(offs >> 5) + 1] |= 15 << (31 - (offs & 31));
+						if (0) {
+							int l;
+							for (l = 0; l < 5; l++) {
+								uae_u32 *ldata = (uae_u32 *)(line_data[next_lineno] + 2 * l * MAX_WORDS_PER_LINE);
+								ldata[(offs >> 5) + 1] |= 15 << (31 - (offs & 31));
+							}
 						}
-					}
 #endif
-					clxdat |= sprpix << (k * 4);
+						clxdat |= sprpix << (k * 4);
+					}
 				}
 			}
 		}
@@ -2442,6 +2461,26 @@ static void do_sprite_collisions (void)
 #endif
 }
 
+STATIC_INLINE void spixmask_set (uae_u16 *buf)
+{
+	int p = buf - spixels;
+	spixmask[p >> 5] |= 1u << (p & 31);
+}
+
+static void spixmask_clear (int first, int npixels)
+{
+	int last = first + npixels;
+
+	for (; first < last && (first & 31); first++)
+		spixmask[first >> 5] &= ~(1u << (first & 31));
+	if (last - first >= 32) {
+		memset (spixmask + (first >> 5), 0, ((last - first) >> 5) * sizeof *spixmask);
+		first += (last - first) & ~31;
+	}
+	for (; first < last; first++)
+		spixmask[first >> 5] &= ~(1u << (first & 31));
+}
+
 STATIC_INLINE void record_sprite_1 (int sprxp, uae_u16 *buf, uae_u32 datab, int num, int dbl,
 	unsigned int mask, int do_collisions, uae_u32 collision_mask)
 {
@@ -2458,6 +2497,8 @@ STATIC_INLINE void record_sprite_1 (int sprxp, uae_u16 *buf, uae_u32 datab, int
 #endif
 		if ((j & mask) == 0) {
 			unsigned int tmp = (*buf) | col;
+			if (col)
+				spixmask_set (buf);
 			*buf++ = tmp;
 			if (do_collisions)
 				coltmp |= tmp;
@@ -2465,6 +2506,8 @@ STATIC_INLINE void record_sprite_1 (int sprxp, uae_u16 *buf, uae_u32 datab, int
 		}
 		if (dbl > 0) {
 			unsigned int tmp = (*buf) | col;
+			if (col)
+				spixmask_set (buf);
 			*buf++ = tmp;
 			if (do_collisions)
 				coltmp |= tmp;
@@ -2473,10 +2516,14 @@ STATIC_INLINE void record_sprite_1 (int sprxp, uae_u16 *buf, uae_u32 datab, int
 		if (dbl > 1) {
 			unsigned int tmp;
 			tmp = (*buf) | col;
+			if (col)
+				spixmask_set (buf);
 			*buf++ = tmp;
 			if (do_collisions)
 				coltmp |= tmp;
 			tmp = (*buf) | col;
+			if (col)
+				spixmask_set (buf);
 			*buf++ = tmp;
 			if (do_collisions)
 				coltmp |= tmp;
@@ -2965,7 +3012,7 @@ static int islinetoggle (void)
 	return linetoggle;
 }
 
-int vsynctimebase_orig;
+UAE_TLS int vsynctimebase_orig;
 
 void compute_vsynctime (void)
 {
@@ -3007,7 +3054,7 @@ void compute_vsynctime (void)
 
 static void dumpsync (void)
 {
-	static int cnt = 100;
+	static UAE_TLS int cnt = 100;
 	if (cnt < 0)
 		return;
 	cnt--;
@@ -3452,25 +3499,19 @@ void init_custom (void)
 	calcdiw ();
 }
 
-static int timehack_alive = 0;
+static UAE_TLS int timehack_alive = 0;
 
 static uae_u32 REGPARAM2 timehack_helper (TrapContext *context)
 {
 #ifdef HAVE_GETTIMEOFDAY
-	struct timeval tv;
+	uae_u64 t;
 	if (m68k_dreg (regs, 0) == 0)
 		return timehack_alive;
 
 	timehack_alive = 10;
-#if defined(WIIU)
-        int64_t time = cpu_features_get_time_usec();
-    	tv.tv_sec  = time / 1000000;
-    	tv.tv_usec = time - (tv.tv_sec * 1000000);
-#else
-	gettimeofday (&tv, NULL);
-#endif
-	put_long (m68k_areg (regs, 0), tv.tv_sec - (((365 * 8 + 2) * 24) * 60 * 60));
-	put_long (m68k_areg (regs, 0) + 4, tv.tv_usec);
+	t = lockstep_usec ();
+	put_long (m68k_areg (regs, 0), (uae_u32)(t / 1000000) - (((365 * 8 + 2) * 24) * 60 * 60));
+	put_long (m68k_areg (regs, 0) + 4, (uae_u32)(t % 1000000));
 	return 0;
 #else
 	return 2;
@@ -3629,7 +3670,7 @@ static void VHPOSW (uae_u16 v)
 
 static uae_u16 VHPOSR (void)
 {
-	static uae_u16 oldhp;
+	static UAE_TLS uae_u16 oldhp;
 	uae_u16 vp = GETVPOS ();
 	uae_u16 hp = GETHPOS ();
 
@@ -3831,14 +3872,14 @@ static void DMACON (int hpos, uae_u16 v)
 	events_schedule();
 }
 
-static int irq_nmi;
+static UAE_TLS int irq_nmi;
 
 void NMI_delayed (void)
 {
 	irq_nmi = 1;
 }
 
-static uae_u16 intreq_internal, intena_internal;
+static UAE_TLS uae_u16 intreq_internal, intena_internal;
 
 int intlev (void)
 {
@@ -4281,7 +4322,7 @@ static void DDFSTRT (int hpos, uae_u16 v)
 	ddfstrt = v;
 	calcdiw ();
 	if (ddfstop > 0xD4 && (ddfstrt & 4) == 4) {
-		static int last_warned;
+		static UAE_TLS int last_warned;
 		last_warned = (last_warned + 1) & 4095;
 		if (last_warned == 0)
 			write_log (_T("WARNING! Very strange DDF values (%x %x).\n"), ddfstrt, ddfstop);
@@ -4304,7 +4345,7 @@ static void DDFSTOP (int hpos, uae_u16 v)
 	if (fetch_state != fetch_not_started)
 		estimate_last_fetch_cycle (hpos);
 	if (ddfstop > 0xD4 && (ddfstrt & 4) == 4) {
-		static int last_warned;
+		static UAE_TLS int last_warned;
 		if (last_warned == 0)
 			write_log (_T("WARNING! Very strange DDF values (%x).\n"), ddfstop);
 		last_warned = (last_warned + 1) & 4095;
@@ -4830,7 +4871,7 @@ static void copper_write (uae_u32 v)
 }
 #endif
 
-static void update_copper (int until_hpos)
+static void update_copper_1 (int until_hpos)
 {
 	int vp = vpos & (((cop_state.saved_i2 >> 8) & 0x7F) | 0x80);
 	int c_hpos = cop_state.hpos;
@@ -5145,6 +5186,13 @@ out:
 	last_copper_hpos = until_hpos;
 }
 
+static void update_copper (int until_hpos)
+{
+	hostprof_enter (HOSTPROF_COPPER);
+	update_copper_1 (until_hpos);
+	hostprof_leave ();
+}
+
 static void compute_spcflag_copper (int hpos)
 {
 	int wasenabled = copper_enabled_thisline;
@@ -5508,6 +5556,7 @@ void init_hardware_for_drawing_frame (void)
 		int npixels = prev_sprite_entries[prev_next_sprite_entry].first_pixel - first_pixel;
 		memset (spixels + first_pixel, 0, npixels * sizeof *spixels);
 		memset (spixstate.bytes + first_pixel, 0, npixels * sizeof *spixstate.bytes);
+		spixmask_clear (first_pixel, npixels);
 	}
 	prev_next_sprite_entry = next_sprite_entry;
 
@@ -5610,15 +5659,15 @@ static bool framewait (void)
 
 	is_syncline = 0;
 
-	static struct mavg_data ma_frameskipt;
+	static UAE_TLS struct mavg_data ma_frameskipt;
 	int frameskipt_avg = mavg (&ma_frameskipt, frameskiptime, MAVG_VSYNC_SIZE);
 
 	frameskiptime = 0;
 
 	if (vs > 0) {
 
-		static struct mavg_data ma_legacy;
-		static frame_time_t vsync_time;
+		static UAE_TLS struct mavg_data ma_legacy;
+		static UAE_TLS frame_time_t vsync_time;
 		int t;
 
 		curr_time = read_processor_time ();
@@ -5659,7 +5708,7 @@ static bool framewait (void)
 	} else if (vs < 0) {
 
 		int freetime;
-		extern int extraframewait;
+		extern UAE_TLS int extraframewait;
 		
 		if (!vblank_hz_state)
 			return status != 0;
@@ -5669,7 +5718,7 @@ static bool framewait (void)
 			// fastest possible
 			int max, adjust, flipdelay = 0, val;
 			frame_time_t now;
-			static struct mavg_data ma_skip, ma_adjust;
+			static UAE_TLS struct mavg_data ma_skip, ma_adjust;
 			
 			val = 0;
 
@@ -5726,7 +5775,7 @@ static bool framewait (void)
 		} else {
 
 			int max, adjust, flipdelay, flipdelay_avg;
-			static struct mavg_data ma_skip;
+			static UAE_TLS struct mavg_data ma_skip;
 			frame_time_t now;
 
 			flipdelay = 0;
@@ -5886,7 +5935,7 @@ static bool framewait (void)
 }
 
 #define FPSCOUNTER_MAVG_SIZE 10
-static struct mavg_data fps_mavg, idle_mavg;
+static UAE_TLS struct mavg_data fps_mavg, idle_mavg;
 
 void fpscounter_reset (void)
 {
@@ -5898,6 +5947,33 @@ void fpscounter_reset (void)
 }
 
 
+/* headless mode speed, as a multiple of real time */
+static UAE_TLS frame_time_t headless_start;
+static UAE_TLS int headless_frames;
+
+static void headless_report (void)
+{
+	frame_time_t now = read_processor_time ();
+	double secs = (now - headless_start) / 1000000.0;
+
+	if (headless_frames > 0 && secs > 0)
+		write_log (_T("Headless: %d frames in %.2fs, %.1fx real time\n"),
+			headless_frames, secs, headless_frames / (vblank_hz * secs));
+	headless_start = now;
+	headless_frames = 0;
+}
+
+static void headless_count (frame_time_t now)
+{
+	if (!currprefs.headless)
+		return;
+	if (!headless_frames && !headless_start)
+		headless_start = now;
+	headless_frames++;
+	if (now - headless_start >= 5 * 1000000)
+		headless_report ();
+}
+
 static void fpscounter (bool frameok)
 {
 	frame_time_t now, last;
@@ -5905,6 +5981,7 @@ static void fpscounter (bool frameok)
 	now = read_processor_time ();
 	last = now - lastframetime;
 	lastframetime = now;
+	headless_count (now);
 
 	if (bogusframe || (int)last < 0)
 		return;
@@ -5948,6 +6025,8 @@ static void fpscounter (bool frameok)
 // vsync functions that are not hardware timing related
 static void vsync_handler_pre (void)
 {
+	statehash_vsync ();
+
 	if (bogusframe > 0)
 		bogusframe--;
 
@@ -5986,6 +6065,7 @@ static void vsync_handler_pre (void)
 		end = read_processor_time ();
 		frameskiptime += end - start;
 	}
+	lockstep_vsync ();
 
 	bool frameok = framewait ();
 	
@@ -6033,7 +6113,7 @@ static void vsync_handler_pre (void)
 // emulated hardware vsync
 static void vsync_handler_post (void)
 {
-	static frame_time_t prevtime;
+	static UAE_TLS frame_time_t prevtime;
 
 	//write_log (_T("%d %d %d\n"), vsynctimebase, read_processor_time () - vsyncmintime, read_processor_time () - prevtime);
 	prevtime = read_processor_time ();
@@ -6245,7 +6325,7 @@ static void hsync_scandoubler (void)
 }
 
 static void events_dmal (int);
-static uae_u16 dmal, dmal_hpos;
+static UAE_TLS uae_u16 dmal, dmal_hpos;
 
 static void dmal_emu (uae_u32 v)
 {
@@ -6426,6 +6506,8 @@ static void hsync_handler_pre (bool onvsync)
 	CIA_hsync_prehandler ();
 
 	hsync_counter++;
+	if (currprefs.lockstep)
+		lockstep_hsync ();
 
 	if (islinetoggle ())
 		lol ^= 1;
@@ -6473,7 +6555,7 @@ static void hsync_handler_post (bool onvsync)
 
 	CIA_hsync_posthandler (ciahsyncs);
 	if (currprefs.cs_ciaatod > 0) {
-		static int cia_hsync;
+		static UAE_TLS int cia_hsync;
 		cia_hsync -= 256;
 		if (cia_hsync <= 0) {
 			CIA_vsync_posthandler (true);
@@ -6578,7 +6660,10 @@ static void hsync_handler_post (bool onvsync)
 		port_get_custom (1, out);
 			}
 #endif
-	if (currprefs.m68k_speed < 0) {
+	if (currprefs.lockstep) {
+		/* no extra cpu time from the host clock, the target paces the frames */
+		is_syncline = 0;
+	} else if (currprefs.m68k_speed < 0) {
 		if (is_last_line ()) {
 			/* really last line, just run the cpu emulation until whole vsync time has been used */
 			if (currprefs.m68k_speed_throttle) {
@@ -6590,7 +6675,7 @@ static void hsync_handler_post (bool onvsync)
 				is_syncline = 1;
 			}
 		} else {
-			static int linecounter;
+			static UAE_TLS int linecounter;
 			/* end of scanline, run cpu emulation as long as we still have time */
 			vsyncmintime += vsynctimeperline;
 			linecounter++;
@@ -6690,7 +6775,7 @@ static void hsync_handler_post (bool onvsync)
 #endif
 
 #ifdef GAYLE
-//	gayle_hsync ();
+	gayle_hsync ();
 #endif
 #ifdef A2091
 	scsi_hsync ();
@@ -6755,6 +6840,7 @@ static void hsync_handler_post (bool onvsync)
 	}
 
 	rtg_vsynccheck ();
+	uae_thread_run ();
 
 #if 0
 	{
@@ -6773,6 +6859,10 @@ static void hsync_handler_post (bool onvsync)
 static void hsync_handler (void)
 {
 	bool vs = is_custom_vsync ();
+#ifdef DEBUGGER
+	if (pcprof_enabled)
+		pcprof_sample ();
+#endif
 	hsync_handler_pre (vs);
 	if (vs) {
 		vsync_handler_pre ();
@@ -6829,10 +6919,13 @@ void custom_reset (bool hardreset, bool keyboardreset)
 	lightpen_active = -1;
 	lightpen_triggered = 0;
 	lightpen_cx = lightpen_cy = -1;
+	ce_quiet_end = ce_quiet_last = 0;
 	if (!savestate_state) {
 		extra_cycle = 0;
 		hsync_counter = 0;
 		vsync_counter = 0;
+		if (hardreset)
+			lockstep_reset ();
 		currprefs.chipset_mask = changed_prefs.chipset_mask;
 		update_mirrors ();
 		if (!aga_mode) {
@@ -6882,7 +6975,7 @@ void custom_reset (bool hardreset, bool keyboardreset)
 	}
 
 #ifdef GAYLE
-//	gayle_reset (hardreset);
+	gayle_reset (hardreset);
 #endif
 #ifdef AUTOCONFIG
 	expamem_reset ();
@@ -6918,6 +7011,7 @@ void custom_reset (bool hardreset, bool keyboardreset)
 	sprite_entries[1][1].first_pixel = MAX_SPR_PIXELS;
 	memset (spixels, 0, 2 * MAX_SPR_PIXELS * sizeof *spixels);
 	memset (&spixstate, 0, sizeof spixstate);
+	memset (spixmask, 0, sizeof spixmask);
 
 	cop_state.state = COP_stop;
 	diwstate = DIW_waiting_start;
@@ -7116,7 +7210,7 @@ static void REGPARAM3 custom_lput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 custom_wput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 custom_bput (uaecptr, uae_u32) REGPARAM;
 
-addrbank custom_bank = {
+UAE_TLS addrbank custom_bank = {
 	custom_lget, custom_wget, custom_bget,
 	custom_lput, custom_wput, custom_bput,
 	default_xlate, default_check, NULL, _T("Custom chipset"),
@@ -7290,6 +7384,8 @@ static int REGPARAM2 custom_wput_1 (int hpos, uaecptr addr, uae_u32 value, int n
 		last_custom_value1 = value;
 	addr &= 0x1FE;
 	value &= 0xffff;
+	/* any register may end a quiet stretch of do_cycles_ce () */
+	ce_quiet_end = ce_quiet_last;
 #ifdef ACTION_REPLAY
 #ifdef ACTION_REPLAY_COMMON
 	ar_custom[addr+0]=(uae_u8)(value>>8);
@@ -7523,7 +7619,7 @@ static void REGPARAM2 custom_wput (uaecptr addr, uae_u32 value)
 
 static void REGPARAM2 custom_bput (uaecptr addr, uae_u32 value)
 {
-	static int warned;
+	static UAE_TLS int warned;
 	uae_u16 rval;
 
 	if (currprefs.chipset_mask & CSMASK_AGA) {
@@ -7722,13 +7818,43 @@ uae_u8 *restore_custom (uae_u8 *src)
 
 #endif /* SAVESTATE */
 
+/* chipset registers for the frame digest, read without side effects */
+uae_u64 hash_custom (uae_u64 h)
+{
+	int i;
+
+	h = statehash_mix (h, ((uae_u64)vpos << 32) | (current_hpos () << 8) | lof_store);
+	h = statehash_mix (h, ((uae_u64)intena << 48) | ((uae_u64)intreq << 32) | ((uae_u32)dmacon << 16) | adkcon);
+	h = statehash_mix (h, ((uae_u64)bplcon0 << 48) | ((uae_u64)bplcon1 << 32) | (bplcon2 << 16) | bplcon3);
+	h = statehash_mix (h, ((uae_u64)bplcon4 << 48) | ((uae_u64)fmode << 32) | beamcon0);
+	h = statehash_mix (h, ((uae_u64)diwstrt << 48) | ((uae_u64)diwstop << 32) | (diwhigh << 16) | ddfstrt);
+	h = statehash_mix (h, ((uae_u64)ddfstop << 32) | ((uae_u32)(uae_u16)bpl1mod << 16) | (uae_u16)bpl2mod);
+	for (i = 0; i < 8; i++)
+		h = statehash_mix (h, bplpt[i]);
+	h = statehash_mix (h, ((uae_u64)cop1lc << 32) | cop2lc);
+	h = statehash_mix (h, ((uae_u64)cop_state.ip << 32) | (copcon << 8) | cop_state.state);
+	h = statehash_mix (h, ((uae_u64)cop_state.i1 << 32) | cop_state.i2);
+	for (i = 0; i < MAX_SPRITES; i++) {
+		h = statehash_mix (h, ((uae_u64)spr[i].pt << 32) | spr[i].armed);
+		h = statehash_mix (h, ((uae_u64)sprpos[i] << 32) | sprctl[i]);
+	}
+	/* bit 15 reads as one and is stored so in statefiles */
+	h = statehash_mix (h, ((uae_u64)clxcon << 32) | (clxdat & 0x7fff));
+	h = statehash_mem (h, current_colors.color_regs_ecs, sizeof current_colors.color_regs_ecs);
+#ifdef AGA
+	if (currprefs.chipset_mask & CSMASK_AGA)
+		h = statehash_mem (h, current_colors.color_regs_aga, sizeof current_colors.color_regs_aga);
+#endif
+	return h;
+}
+
 #if defined SAVESTATE || defined DEBUGGER
 
 #define SB save_u8
 #define SW save_u16
 #define SL save_u32
 
-extern uae_u16 serper;
+extern UAE_TLS uae_u16 serper;
 
 uae_u8 *save_custom (int *len, uae_u8 *dstptr, int full)
 {
@@ -8168,6 +8294,20 @@ void check_prefs_changed_custom (void)
 	currprefs.immediate_blits = changed_prefs.immediate_blits;
 	currprefs.waiting_blits = changed_prefs.waiting_blits;
 	currprefs.collision_level = changed_prefs.collision_level;
+	if (currprefs.lockstep != changed_prefs.lockstep) {
+		currprefs.lockstep = changed_prefs.lockstep;
+		write_log (_T("Lockstep mode %s\n"), currprefs.lockstep ? _T("on") : _T("off"));
+	}
+	currprefs.lockstep_seed = changed_prefs.lockstep_seed;
+	if (currprefs.headless != changed_prefs.headless) {
+		if (currprefs.headless)
+			headless_report ();
+		else
+			headless_start = read_processor_time ();
+		headless_frames = 0;
+		currprefs.headless = changed_prefs.headless;
+		write_log (_T("Headless mode %s\n"), currprefs.headless ? _T("on") : _T("off"));
+	}
 
 	currprefs.cs_ciaatod = changed_prefs.cs_ciaatod;
 	currprefs.cs_rtc = changed_prefs.cs_rtc;
@@ -8219,13 +8359,41 @@ STATIC_INLINE void decide_fetch_ce (int hpos)
 		decide_fetch (hpos);
 }
 
+/* Number of cycles after hpos in which the per cycle decisions of
+ * do_cycles_ce () would do nothing: copper and blitter idle, no fetch
+ * change on this line, sprite slots done and no bitplane DMA start to
+ * decide before the limit. None of this changes without a custom
+ * register write or an event, so the CPU can run through them and
+ * only catch up on the clock. */
+STATIC_INLINE int ce_quiet_cycles (int hpos)
+{
+	int limit = maxhpos;
+
+	if (copper_enabled_thisline || bltstate != BLT_done)
+		return 0;
+	if ((ddf_change == vpos || ddf_change + 1 == vpos) && vpos < current_maxvpos ())
+		return 0;
+#ifndef	CUSTOM_SIMPLE
+	if (vpos >= sprite_vblank_endline && last_sprite_hpos < SPR0_HPOS + 4 * MAX_SPRITES)
+		return 0;
+#endif
+	if (fetch_state == fetch_not_started && (diwstate == DIW_waiting_stop || (currprefs.chipset_mask & CSMASK_ECS_AGNUS))) {
+		int start = (currprefs.chipset_mask & CSMASK_ECS_AGNUS) ? plfstrt - 4 : HARD_DDF_START_REAL - 2;
+		if (start > hpos && start < limit)
+			limit = start;
+		if (plfstrt > hpos && plfstrt < limit)
+			limit = plfstrt;
+	}
+	return limit - 1 > hpos ? limit - 1 - hpos : 0;
+}
+
 #define BLIT_NASTY 4
 
 // blitter not in nasty mode = CPU gets one cycle if it has been waiting
 // at least 4 cycles (all DMA cycles count, not just blitter cycles, even
 // blitter idle cycles do count!)
 
-extern int cpu_tracer;
+extern UAE_TLS int cpu_tracer;
 STATIC_INLINE int dma_cycle (void)
 {
 	int hpos, hpos_old;
@@ -8416,14 +8584,31 @@ void do_cycles_ce (unsigned long cycles)
 
 	c = cycles + extra_cycle;
 	while (c >= CYCLE_UNIT) {
-		int hpos = current_hpos () + 1;
-		sync_copper (hpos);
-		decide_line (hpos);
-		decide_fetch_ce (hpos);
-		if (bltstate != BLT_done)
-			decide_blitter (hpos);
-		do_cycles (1 * CYCLE_UNIT);
-		c -= CYCLE_UNIT;
+		unsigned long n;
+		/* events change what is quiet, stop at the next one */
+		if ((long)(nextevent - ce_quiet_end) < 0)
+			ce_quiet_end = nextevent;
+		if (currcycle != ce_quiet_last || (long)(ce_quiet_end - currcycle) <= 0) {
+			int hpos = current_hpos () + 1;
+			sync_copper (hpos);
+			decide_line (hpos);
+			decide_fetch_ce (hpos);
+			if (bltstate != BLT_done)
+				decide_blitter (hpos);
+			/* end at the start of the first cycle that needs deciding */
+			ce_quiet_end = eventtab[ev_hsync].oldcycles + (hpos + ce_quiet_cycles (hpos)) * CYCLE_UNIT;
+			if ((long)(nextevent - ce_quiet_end) < 0)
+				ce_quiet_end = nextevent;
+		}
+		/* the cycle that starts before ce_quiet_end is still quiet */
+		n = (ce_quiet_end - currcycle + CYCLE_UNIT - 1) & ~(CYCLE_UNIT - 1);
+		if (n > (c & ~(CYCLE_UNIT - 1)))
+			n = c & ~(CYCLE_UNIT - 1);
+		if ((long)n < CYCLE_UNIT)
+			n = CYCLE_UNIT;
+		do_cycles (n);
+		ce_quiet_last = currcycle;
+		c -= n;
 	}
 	extra_cycle = c;
 }
@@ -21,6 +21,7 @@
 #include "newcpu.h"
 #include "cpu_prefetch.h"
 #include "debug.h"
+#include "blitter.h"
 #include "cia.h"
 #include "xwin.h"
 #include "identify.h"
@@ -41,33 +42,33 @@
 #include "misc.h"
 
 /* internal members */
-int debugger_active;
-static uaecptr skipaddr_start, skipaddr_end;
-static int skipaddr_doskip;
-static uae_u32 skipins;
-static int do_skip;
+UAE_TLS int debugger_active;
+static UAE_TLS uaecptr skipaddr_start, skipaddr_end;
+static UAE_TLS int skipaddr_doskip;
+static UAE_TLS uae_u32 skipins;
+static UAE_TLS int do_skip;
 #ifdef SAVESTATE
-static int debug_rewind;
+static UAE_TLS int debug_rewind;
 #endif
-static int memwatch_enabled, memwatch_triggered;
-static uae_u16 sr_bpmask, sr_bpvalue;
-int debugging;
-int exception_debugging;
-int no_trace_exceptions;
-int debug_copper = 0;
-int debug_dma = 0;
-int debug_sprite_mask = 0xff;
-int debug_illegal = 0;
-uae_u64 debug_illegal_mask;
-static int debug_mmu_mode;
-
-static uaecptr processptr;
-static uae_char *processname;
-
-static uaecptr debug_copper_pc;
-
-extern int audio_channel_mask;
-extern int inputdevice_logging;
+static UAE_TLS int memwatch_enabled, memwatch_triggered;
+static UAE_TLS uae_u16 sr_bpmask, sr_bpvalue;
+UAE_TLS int debugging;
+UAE_TLS int exception_debugging;
+UAE_TLS int no_trace_exceptions;
+UAE_TLS int debug_copper = 0;
+UAE_TLS int debug_dma = 0;
+UAE_TLS int debug_sprite_mask = 0xff;
+UAE_TLS int debug_illegal = 0;
+UAE_TLS uae_u64 debug_illegal_mask;
+static UAE_TLS int debug_mmu_mode;
+
+static UAE_TLS uaecptr processptr;
+static UAE_TLS uae_char *processname;
+
+static UAE_TLS uaecptr debug_copper_pc;
+
+extern UAE_TLS int audio_channel_mask;
+extern UAE_TLS int inputdevice_logging;
 
 #ifdef MMUEMU
 int safe_addr (uaecptr addr, int size);
@@ -99,9 +100,9 @@ void activate_debugger (void)
 	mmu_triggered = 0;
 }
 
-int firsthist = 0;
-int lasthist = 0;
-static struct regstruct history[MAX_HIST];
+UAE_TLS int firsthist = 0;
+UAE_TLS int lasthist = 0;
+static UAE_TLS struct regstruct history[MAX_HIST];
 
 static TCHAR help[] = {
 	"          HELP for UAE Debugger\n" 
@@ -170,7 +171,7 @@ void debug_help (void)
 	console_out (help);
 }
 
-static int debug_linecounter;
+static UAE_TLS int debug_linecounter;
 #define MAX_LINECOUNTER 1000
 
 static int debug_out (const TCHAR *format, ...)
@@ -306,7 +307,7 @@ int safe_addr (uaecptr addr, int size)
 
 static bool iscancel (int counter)
 {
-	static int cnt;
+	static UAE_TLS int cnt;
 
 	cnt++;
 	if (cnt < counter)
@@ -773,7 +774,7 @@ static uaecptr nextaddr2 (uaecptr addr, uaecptr *next)
 
 static uaecptr nextaddr (uaecptr addr, uaecptr last, uaecptr *end)
 {
-	static uaecptr old;
+	static UAE_TLS uaecptr old;
 	uaecptr next = 0;
 	if (last && 0) {
 		if (addr >= last)
@@ -972,13 +973,13 @@ struct cop_rec
 	int hpos, vpos;
 	uaecptr addr;
 };
-static struct cop_rec *cop_record[2];
-static int nr_cop_records[2], curr_cop_set;
+static UAE_TLS struct cop_rec *cop_record[2];
+static UAE_TLS int nr_cop_records[2], curr_cop_set;
 
 #define NR_DMA_REC_HPOS 256
 #define NR_DMA_REC_VPOS 1000
-static struct dma_rec *dma_record[2];
-static int dma_record_toggle;
+static UAE_TLS struct dma_rec *dma_record[2];
+static UAE_TLS int dma_record_toggle;
 
 void record_dma_reset (void)
 {
@@ -1364,7 +1365,7 @@ static uaecptr decode_copperlist (FILE* file, uaecptr address, int nolines)
 
 static int copper_debugger (TCHAR **c)
 {
-	static uaecptr nxcopper;
+	static UAE_TLS uaecptr nxcopper;
 	uae_u32 maddr;
 	int lines;
 
@@ -1413,8 +1414,8 @@ struct trainerstruct {
 	int size;
 };
 
-static struct trainerstruct *trainerdata;
-static int totaltrainers;
+static UAE_TLS struct trainerstruct *trainerdata;
+static UAE_TLS int totaltrainers;
 
 static void clearcheater(void)
 {
@@ -1462,13 +1463,13 @@ static void listcheater(int mode, int size)
 
 static void deepcheatsearch (TCHAR **c)
 {
-	static uae_u8 *memtmp;
-	static int memsize, memsize2;
+	static UAE_TLS uae_u8 *memtmp;
+	static UAE_TLS int memsize, memsize2;
 	uae_u8 *p1, *p2;
 	uaecptr addr, end;
 	int wasmodified, nonmodified;
-	static int size;
-	static int inconly, deconly, maxdiff;
+	static UAE_TLS int size;
+	static UAE_TLS int inconly, deconly, maxdiff;
 	int addrcnt, cnt;
 	TCHAR v;
 
@@ -1606,10 +1607,10 @@ static void deepcheatsearch (TCHAR **c)
 /* cheat-search by Toni Wilen (originally by Holger Jakob) */
 static void cheatsearch (TCHAR **c)
 {
-	static uae_u8 *vlist;
-	static int listsize;
-	static int first = 1;
-	static int size = 1;
+	static UAE_TLS uae_u8 *vlist;
+	static UAE_TLS int listsize;
+	static UAE_TLS int first = 1;
+	static UAE_TLS int size = 1;
 	uae_u32 val, memcnt, prevmemcnt;
 	int i, count, memsize;
 	uaecptr addr, end;
@@ -1696,14 +1697,14 @@ static void cheatsearch (TCHAR **c)
 	first = 0;
 }
 
-struct breakpoint_node bpnodes[BREAKPOINT_TOTAL];
-static addrbank **debug_mem_banks;
-static addrbank *debug_mem_area;
-struct memwatch_node mwnodes[MEMWATCH_TOTAL];
-static struct memwatch_node mwhit;
+UAE_TLS struct breakpoint_node bpnodes[BREAKPOINT_TOTAL];
+static UAE_TLS addrbank **debug_mem_banks;
+static UAE_TLS addrbank *debug_mem_area;
+UAE_TLS struct memwatch_node mwnodes[MEMWATCH_TOTAL];
+static UAE_TLS struct memwatch_node mwhit;
 
-static uae_u8 *illgdebug, *illghdebug;
-static int illgdebug_break;
+static UAE_TLS uae_u8 *illgdebug, *illghdebug;
+static UAE_TLS int illgdebug_break;
 
 static void illg_free (void)
 {
@@ -1830,8 +1831,8 @@ struct smc_item {
 	uae_u8 cnt;
 };
 
-static int smc_size, smc_mode;
-static struct smc_item *smc_table;
+static UAE_TLS int smc_size, smc_mode;
+static UAE_TLS struct smc_item *smc_table;
 
 static void smc_free (void)
 {
@@ -2326,7 +2327,7 @@ struct membank_store
 	addrbank store;
 };
 
-static struct membank_store *membank_stores;
+static UAE_TLS struct membank_store *membank_stores;
 
 static int deinitialize_memwatch (void)
 {
@@ -3020,12 +3021,396 @@ static void show_exec_lists (TCHAR *t)
 	}
 }
 
+/* Statistical 68k PC profiler
+ *
+ * The PC is sampled once per scanline from the hsync handler into an open
+ * addressing histogram. The report is resolved against the library jump
+ * tables (LibList, DeviceList, ResourceList) and the resident module list
+ * of the running system, so Kickstart hot spots show up as library/LVO
+ * pairs instead of raw ROM addresses.
+ */
+
+#define PCPROF_HASH_BITS 16
+#define PCPROF_HASH_SIZE (1 << PCPROF_HASH_BITS)
+#define PCPROF_REPORT_LINES 40
+#define PCPROF_MAX_NODES 256
+#define PCPROF_MAX_FUNCS 8192
+#define PCPROF_MAX_MODULES 256
+
+struct pcprof_entry {
+	uaecptr pc;
+	uae_u32 count;
+	uae_u32 blit;
+};
+
+struct pcprof_func {
+	uaecptr addr;
+	int lvo;
+	int name;
+};
+
+struct pcprof_module {
+	uaecptr start, end;
+	int name;
+};
+
+struct pcprof_agg {
+	uae_u64 key;
+	uaecptr pc;
+	uae_u32 count;
+	uae_u32 blit;
+};
+
+UAE_TLS int pcprof_enabled;
+static UAE_TLS struct pcprof_entry *pcprof_hash;
+static UAE_TLS int pcprof_used;
+static UAE_TLS uae_u32 pcprof_samples, pcprof_stopped, pcprof_dropped;
+static UAE_TLS TCHAR *pcprof_reportname;
+static UAE_TLS FILE *pcprof_file;
+
+static UAE_TLS struct pcprof_func *pcprof_funcs;
+static UAE_TLS int pcprof_numfuncs;
+static UAE_TLS struct pcprof_module *pcprof_modules;
+static UAE_TLS int pcprof_nummodules;
+static UAE_TLS TCHAR **pcprof_names;
+static UAE_TLS int pcprof_numnames;
+
+void pcprof_sample (void)
+{
+	struct pcprof_entry *e;
+	uaecptr pc;
+	uae_u32 h;
+
+	pcprof_samples++;
+	if (regs.stopped) {
+		pcprof_stopped++;
+		return;
+	}
+	pc = m68k_getpc ();
+	h = ((uae_u32)(pc >> 1) * 2654435761u) >> (32 - PCPROF_HASH_BITS);
+	for (;;) {
+		e = &pcprof_hash[h];
+		if (!e->count) {
+			if (pcprof_used >= PCPROF_HASH_SIZE * 3 / 4) {
+				pcprof_dropped++;
+				return;
+			}
+			pcprof_used++;
+			e->pc = pc;
+			break;
+		}
+		if (e->pc == pc)
+			break;
+		h = (h + 1) & (PCPROF_HASH_SIZE - 1);
+	}
+	e->count++;
+	if (bltstate != BLT_done)
+		e->blit++;
+}
+
+static bool pcprof_valid (uaecptr addr, int size)
+{
+	addrbank *b = &get_mem_bank (addr);
+	return b && b->check (addr, size) && (b->flags == ABFLAG_RAM || b->flags == ABFLAG_ROM || b->flags == ABFLAG_ROMIN);
+}
+
+static int pcprof_addname (uaecptr addr)
+{
+	uae_char tmp[64];
+	int i;
+
+	if (!pcprof_valid (addr, 1))
+		return -1;
+	for (i = 0; i < sizeof tmp - 1; i++) {
+		uae_u8 c = get_byte_debug (addr + i);
+		if (!c)
+			break;
+		tmp[i] = c >= 32 && c < 127 ? c : '.';
+	}
+	tmp[i] = 0;
+	while (i > 0 && (tmp[i - 1] == '\n' || tmp[i - 1] == '\r' || tmp[i - 1] == ' '))
+		tmp[--i] = 0;
+	pcprof_names = xrealloc (TCHAR*, pcprof_names, pcprof_numnames + 1);
+	pcprof_names[pcprof_numnames] = au (tmp);
+	return pcprof_numnames++;
+}
+
+static void pcprof_add_jumptables (uaecptr list)
+{
+	uaecptr node = get_long_debug (list);
+	int cnt = 0;
+
+	while (cnt++ < PCPROF_MAX_NODES && pcprof_valid (node, 34) && get_long_debug (node)) {
+		int negsize = get_word_debug (node + 16);
+		int name = -1;
+		for (int lvo = 6; lvo <= negsize && pcprof_numfuncs < PCPROF_MAX_FUNCS; lvo += 6) {
+			uaecptr vec = node - lvo;
+			if (!pcprof_valid (vec, 6) || get_word_debug (vec) != 0x4ef9)
+				continue;
+			if (name < 0)
+				name = pcprof_addname (get_long_debug (node + 10));
+			if (name < 0)
+				break;
+			pcprof_funcs[pcprof_numfuncs].addr = get_long_debug (vec + 2);
+			pcprof_funcs[pcprof_numfuncs].lvo = -lvo;
+			pcprof_funcs[pcprof_numfuncs].name = name;
+			pcprof_numfuncs++;
+		}
+		node = get_long_debug (node);
+	}
+}
+
+static void pcprof_add_residents (uaecptr list)
+{
+	int cnt = 0;
+
+	while (list && pcprof_valid (list, 4) && pcprof_nummodules < PCPROF_MAX_MODULES && cnt++ < PCPROF_MAX_NODES) {
+		uaecptr resident = get_long_debug (list);
+		uaecptr end;
+		if (!resident)
+			break;
+		if (resident & 0x80000000) {
+			list = resident & 0x7fffffff;
+			continue;
+		}
+		list += 4;
+		if (!pcprof_valid (resident, 26) || get_word_debug (resident) != 0x4afc)
+			continue;
+		end = get_long_debug (resident + 6);
+		if (end <= resident || end - resident > 0x100000)
+			continue;
+		pcprof_modules[pcprof_nummodules].start = resident;
+		pcprof_modules[pcprof_nummodules].end = end;
+		pcprof_modules[pcprof_nummodules].name = pcprof_addname (get_long_debug (resident + 14));
+		if (pcprof_modules[pcprof_nummodules].name >= 0)
+			pcprof_nummodules++;
+	}
+}
+
+static int pcprof_funccmp (const void *a, const void *b)
+{
+	uaecptr a1 = ((struct pcprof_func*)a)->addr;
+	uaecptr b1 = ((struct pcprof_func*)b)->addr;
+	return a1 < b1 ? -1 : (a1 > b1 ? 1 : 0);
+}
+
+static void pcprof_build_symbols (void)
+{
+	uaecptr execbase = get_long_debug (4);
+
+	pcprof_funcs = xcalloc (struct pcprof_func, PCPROF_MAX_FUNCS);
+	pcprof_modules = xcalloc (struct pcprof_module, PCPROF_MAX_MODULES);
+	if (!pcprof_valid (execbase, 400) || get_mem_bank (execbase).flags != ABFLAG_RAM)
+		return;
+	pcprof_add_jumptables (execbase + 378);
+	pcprof_add_jumptables (execbase + 350);
+	pcprof_add_jumptables (execbase + 336);
+	pcprof_add_residents (get_long_debug (execbase + 300));
+	qsort (pcprof_funcs, pcprof_numfuncs, sizeof (struct pcprof_func), pcprof_funccmp);
+}
+
+static void pcprof_free_symbols (void)
+{
+	for (int i = 0; i < pcprof_numnames; i++)
+		xfree (pcprof_names[i]);
+	xfree (pcprof_names);
+	xfree (pcprof_funcs);
+	xfree (pcprof_modules);
+	pcprof_names = NULL;
+	pcprof_funcs = NULL;
+	pcprof_modules = NULL;
+	pcprof_numnames = pcprof_numfuncs = pcprof_nummodules = 0;
+}
+
+static int pcprof_find_module (uaecptr pc)
+{
+	for (int i = 0; i < pcprof_nummodules; i++) {
+		if (pc >= pcprof_modules[i].start && pc < pcprof_modules[i].end)
+			return i;
+	}
+	return -1;
+}
+
+/* Key used to merge samples: nearest function entry, else resident module, else 256 byte block */
+static uae_u64 pcprof_resolve (uaecptr pc)
+{
+	int lo = 0, hi = pcprof_numfuncs - 1, f = -1;
+	int m = pcprof_find_module (pc);
+
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		if (pcprof_funcs[mid].addr <= pc) {
+			f = mid;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
+	}
+	if (f >= 0 && pc - pcprof_funcs[f].addr < 0x10000 && pcprof_find_module (pcprof_funcs[f].addr) == m)
+		return (1ULL << 32) | f;
+	if (m >= 0)
+		return (2ULL << 32) | m;
+	return (3ULL << 32) | (pc & ~0xff);
+}
+
+static void pcprof_symbol (uae_u64 key, uaecptr pc, TCHAR *out)
+{
+	uae_u32 v = (uae_u32)key;
+	switch (key >> 32)
+	{
+	case 1:
+		out += _stprintf (out, _T("%s %d"), pcprof_names[pcprof_funcs[v].name], pcprof_funcs[v].lvo);
+		if (pc != pcprof_funcs[v].addr)
+			_stprintf (out, _T("+$%x"), (uae_u32)(pc - pcprof_funcs[v].addr));
+		break;
+	case 2:
+		out += _stprintf (out, _T("%s"), pcprof_names[pcprof_modules[v].name]);
+		if (pc != pcprof_modules[v].start)
+			_stprintf (out, _T("+$%x"), (uae_u32)(pc - pcprof_modules[v].start));
+		break;
+	default:
+		_stprintf (out, _T("$%08x-$%08x"), v, v + 0xff);
+		break;
+	}
+}
+
+static void pcprof_out (const TCHAR *format, ...)
+{
+	TCHAR buffer[256];
+	va_list parms;
+
+	va_start (parms, format);
+	_vsntprintf (buffer, sizeof buffer / sizeof (TCHAR) - 1, format, parms);
+	buffer[sizeof buffer / sizeof (TCHAR) - 1] = 0;
+	va_end (parms);
+	write_log (_T("%s"), buffer);
+	if (pcprof_file)
+		fputs (buffer, pcprof_file);
+}
+
+static int pcprof_countcmp (const void *a, const void *b)
+{
+	uae_u32 a1 = ((struct pcprof_agg*)a)->count;
+	uae_u32 b1 = ((struct pcprof_agg*)b)->count;
+	return a1 > b1 ? -1 : (a1 < b1 ? 1 : 0);
+}
+
+static int pcprof_keycmp (const void *a, const void *b)
+{
+	uae_u64 a1 = ((struct pcprof_agg*)a)->key;
+	uae_u64 b1 = ((struct pcprof_agg*)b)->key;
+	return a1 < b1 ? -1 : (a1 > b1 ? 1 : 0);
+}
+
+static void pcprof_print (struct pcprof_agg *agg, int num, uae_u32 total, bool showpc)
+{
+	TCHAR sym[256];
+
+	pcprof_out (_T("  Samples      %%  Blit%%  %sSymbol\n"), showpc ? _T("PC        ") : _T(""));
+	for (int i = 0; i < num && i < PCPROF_REPORT_LINES; i++) {
+		pcprof_symbol (agg[i].key, agg[i].pc, sym);
+		if (showpc)
+			pcprof_out (_T("%9u %6.2f %6.1f  %08x  %s\n"), agg[i].count, agg[i].count * 100.0 / total,
+				agg[i].blit * 100.0 / agg[i].count, (uae_u32)agg[i].pc, sym);
+		else
+			pcprof_out (_T("%9u %6.2f %6.1f  %s\n"), agg[i].count, agg[i].count * 100.0 / total,
+				agg[i].blit * 100.0 / agg[i].count, sym);
+	}
+}
+
+void pcprof_report (void)
+{
+	struct pcprof_agg *agg;
+	uae_u32 total;
+	int i, num, merged;
+
+	if (!pcprof_hash || !pcprof_samples)
+		return;
+	total = pcprof_samples - pcprof_stopped - pcprof_dropped;
+	if (pcprof_reportname)
+		pcprof_file = _tfopen (pcprof_reportname, _T("w"));
+
+	pcprof_build_symbols ();
+	agg = xcalloc (struct pcprof_agg, pcprof_used + 1);
+	num = 0;
+	for (i = 0; i < PCPROF_HASH_SIZE; i++) {
+		struct pcprof_entry *e = &pcprof_hash[i];
+		if (!e->count)
+			continue;
+		agg[num].pc = e->pc;
+		agg[num].count = e->count;
+		agg[num].blit = e->blit;
+		agg[num].key = pcprof_resolve (e->pc);
+		num++;
+	}
+
+	pcprof_out (_T("PC profile: %u samples, %u stopped (%.1f%%), %u dropped, %d addresses, %d functions, %d modules\n"),
+		pcprof_samples, pcprof_stopped, pcprof_stopped * 100.0 / pcprof_samples, pcprof_dropped,
+		num, pcprof_numfuncs, pcprof_nummodules);
+	if (total) {
+		qsort (agg, num, sizeof (struct pcprof_agg), pcprof_countcmp);
+		pcprof_out (_T("\nBy address:\n"));
+		pcprof_print (agg, num, total, true);
+
+		qsort (agg, num, sizeof (struct pcprof_agg), pcprof_keycmp);
+		merged = 0;
+		for (i = 0; i < num; i++) {
+			if (merged > 0 && agg[merged - 1].key == agg[i].key) {
+				agg[merged - 1].count += agg[i].count;
+				agg[merged - 1].blit += agg[i].blit;
+				continue;
+			}
+			agg[merged] = agg[i];
+			/* report the entry point, not the first sampled address */
+			if ((agg[i].key >> 32) == 1)
+				agg[merged].pc = pcprof_funcs[(uae_u32)agg[i].key].addr;
+			else if ((agg[i].key >> 32) == 2)
+				agg[merged].pc = pcprof_modules[(uae_u32)agg[i].key].start;
+			else
+				agg[merged].pc = (uae_u32)agg[i].key;
+			merged++;
+		}
+		qsort (agg, merged, sizeof (struct pcprof_agg), pcprof_countcmp);
+		pcprof_out (_T("\nBy function:\n"));
+		pcprof_print (agg, merged, total, false);
+	}
+
+	xfree (agg);
+	pcprof_free_symbols ();
+	if (pcprof_file)
+		fclose (pcprof_file);
+	pcprof_file = NULL;
+}
+
+void pcprof_free (void)
+{
+	pcprof_report ();
+	pcprof_enabled = 0;
+	xfree (pcprof_hash);
+	xfree (pcprof_reportname);
+	pcprof_hash = NULL;
+	pcprof_reportname = NULL;
+	pcprof_used = 0;
+	pcprof_samples = pcprof_stopped = pcprof_dropped = 0;
+}
+
+void pcprof_init (bool enable, const TCHAR *reportname)
+{
+	pcprof_free ();
+	if (!enable)
+		return;
+	pcprof_hash = xcalloc (struct pcprof_entry, PCPROF_HASH_SIZE);
+	if (reportname && reportname[0])
+		pcprof_reportname = my_strdup (reportname);
+	pcprof_enabled = 1;
+}
+
 #if 0
 static int trace_same_insn_count;
 static uae_u8 trace_insn_copy[10];
 static struct regstruct trace_prev_regs;
 #endif
-static uaecptr nextpc;
+static UAE_TLS uaecptr nextpc;
 
 int instruction_breakpoint (TCHAR **c)
 {
@@ -3296,7 +3681,7 @@ static int staterecorder (TCHAR **cc)
 	return 0;
 }
 
-static int debugtest_modes[DEBUGTEST_MAX];
+static UAE_TLS int debugtest_modes[DEBUGTEST_MAX];
 static const TCHAR *debugtest_names[] = {
 	_T("Blitter"), _T("Keyboard"), _T("Floppy")
 };
@@ -3616,7 +4001,7 @@ static void m68k_modify (TCHAR **inptr)
 	}
 }
 
-static uaecptr nxdis, nxmem;
+static UAE_TLS uaecptr nxdis, nxmem;
 
 static bool debug_line (TCHAR *input)
 {
@@ -4171,7 +4556,7 @@ void debug (void)
 
 const TCHAR *debuginfo (int mode)
 {
-	static TCHAR txt[100];
+	static UAE_TLS TCHAR txt[100];
 	uae_u32 pc = M68K_GETPC;
 	_stprintf (txt, _T("PC=%08X INS=%04X %04X %04X"),
 		pc, get_word_debug (pc), get_word_debug (pc + 2), get_word_debug (pc + 4));
@@ -4185,7 +4570,7 @@ void mmu_disasm (uaecptr pc, int lines)
 	m68k_disasm (pc, NULL, lines);
 }
 
-static int mmu_logging;
+static UAE_TLS int mmu_logging;
 
 #define MMU_PAGE_SHIFT 16
 
@@ -4197,19 +4582,19 @@ struct mmudata {
 	uae_u32 p_addr;
 };
 
-static struct mmudata *mmubanks;
-static uae_u32 mmu_struct, mmu_callback, mmu_regs;
-static uae_u32 mmu_fault_bank_addr, mmu_fault_addr;
-static int mmu_fault_size, mmu_fault_rw;
-static int mmu_slots;
-static struct regstruct mmur;
+static UAE_TLS struct mmudata *mmubanks;
+static UAE_TLS uae_u32 mmu_struct, mmu_callback, mmu_regs;
+static UAE_TLS uae_u32 mmu_fault_bank_addr, mmu_fault_addr;
+static UAE_TLS int mmu_fault_size, mmu_fault_rw;
+static UAE_TLS int mmu_slots;
+static UAE_TLS struct regstruct mmur;
 
 struct mmunode {
 	struct mmudata *mmubank;
 	struct mmunode *next;
 };
-static struct mmunode **mmunl;
-extern struct regstruct mmu_backup_regs;
+static UAE_TLS struct mmunode **mmunl;
+extern UAE_TLS struct regstruct mmu_backup_regs;
 
 #define MMU_READ_U (1 << 0)
 #define MMU_WRITE_U (1 << 1)
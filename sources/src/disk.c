@@ -20,9 +20,9 @@
 #define daylight 0
 #endif
 
-int disk_debug_logging = 0;
-int disk_debug_mode = 0;
-int disk_debug_track = -1;
+UAE_TLS int disk_debug_logging = 0;
+UAE_TLS int disk_debug_mode = 0;
+UAE_TLS int disk_debug_track = -1;
 
 #define MFM_VALIDATOR 0
 
@@ -57,6 +57,8 @@ int disk_debug_track = -1;
 #endif
 #include "misc.h"
 #include "inputrecord.h"
+#include "hostprof.h"
+#include "lockstep.h"
 #include <ctype.h>
 
 #undef CATWEASEL
@@ -65,7 +67,7 @@ int disk_debug_track = -1;
 extern uae_u32 uaerand (void);
 
 /* internal members */
-static int longwritemode = 0;
+static UAE_TLS int longwritemode = 0;
 
 /* support HD floppies */
 #define FLOPPY_DRIVE_HD
@@ -98,10 +100,10 @@ static int longwritemode = 0;
  * L track length in bits
  */
 
-static int side, direction;
-static uae_u8 selected = 15, disabled;
+static UAE_TLS int side, direction;
+static UAE_TLS uae_u8 selected = 15, disabled;
 
-static uae_u8 writebuffer[544 * MAX_SECTORS];
+static UAE_TLS uae_u8 writebuffer[544 * MAX_SECTORS];
 
 #define DISK_INDEXSYNC 1
 #define DISK_WORDSYNC 2
@@ -115,23 +117,23 @@ static uae_u8 writebuffer[544 * MAX_SECTORS];
 #define DSKDMA_READ 2
 #define DSKDMA_WRITE 3
 
-static int dskdmaen, dsklength, dsklength2, dsklen;
-static uae_u16 dskbytr_val;
-static uae_u32 dskpt;
-static bool fifo_filled;
-static uae_u16 fifo[3];
-static int fifo_inuse[3];
-static int dma_enable, bitoffset; //, syncoffset;
-static uae_u16 word, dsksync;
-static unsigned long dsksync_cycles;
+static UAE_TLS int dskdmaen, dsklength, dsklength2, dsklen;
+static UAE_TLS uae_u16 dskbytr_val;
+static UAE_TLS uae_u32 dskpt;
+static UAE_TLS bool fifo_filled;
+static UAE_TLS uae_u16 fifo[3];
+static UAE_TLS int fifo_inuse[3];
+static UAE_TLS int dma_enable, bitoffset; //, syncoffset;
+static UAE_TLS uae_u16 word, dsksync;
+static UAE_TLS unsigned long dsksync_cycles;
 #define WORDSYNC_TIME 11
 /* Always carried through to the next line.  */
-int disk_hpos;
-static int disk_jitter;
-static int indexdecay;
+UAE_TLS int disk_hpos;
+static UAE_TLS int disk_jitter;
+static UAE_TLS int indexdecay;
 
-static uae_u8 prev_data;
-static int prev_step;
+static UAE_TLS uae_u8 prev_data;
+static UAE_TLS int prev_step;
 
 typedef enum { TRACK_AMIGADOS, TRACK_RAW, TRACK_RAW1, TRACK_PCDOS, TRACK_DISKSPARE, TRACK_NONE } image_tracktype;
 typedef struct {
@@ -176,6 +178,9 @@ typedef struct {
 	bool forcedwrprot;
 	uae_u16 bigmfmbuf[0x4000 * DDHDMULT];
 	uae_u16 tracktiming[0x4000 * DDHDMULT];
+	uae_u16 syncmap[0x4000 * DDHDMULT]; /* bit set where a word equal to syncmap_sync ends */
+	int syncmap_len; /* 0 = not built */
+	uae_u16 syncmap_sync;
 	int multi_revolution;
 	int skipoffset;
 	int mfmpos;
@@ -217,9 +222,12 @@ typedef struct {
 
 #define MIN_STEPLIMIT_CYCLE (CYCLE_UNIT * 210)
 
-static uae_u16 bigmfmbufw[0x4000 * DDHDMULT];
-static drive floppy[MAX_FLOPPY_DRIVES];
-static TCHAR dfxhistory[2][MAX_PREVIOUS_FLOPPIES][MAX_DPATH];
+static UAE_TLS uae_u16 bigmfmbufw[0x4000 * DDHDMULT];
+static UAE_TLS drive floppy[MAX_FLOPPY_DRIVES];
+/* the last word_bits bits of word were read in order from word_drv, up to word_pos */
+static UAE_TLS drive *word_drv;
+static UAE_TLS int word_pos, word_bits;
+static UAE_TLS TCHAR dfxhistory[2][MAX_PREVIOUS_FLOPPIES][MAX_DPATH];
 
 static uae_u8 exeheader[]={0x00,0x00,0x03,0xf3,0x00,0x00,0x00,0x00};
 static uae_u8 bootblock_ofs[]={
@@ -276,15 +284,15 @@ static int dirhash (const uae_char *name)
 
 static void disk_date (uae_u8 *p)
 {
-	static int pdays, pmins, pticks;
+	static UAE_TLS int pdays, pmins, pticks;
 	int days, mins, ticks;
-	struct timeval tv;
 	struct mytimeval mtv;
+	uae_u64 t = lockstep_usec ();
 
-	gettimeofday (&tv, NULL);
-	tv.tv_sec -= timezone;
-	mtv.tv_sec = tv.tv_sec;
-	mtv.tv_usec = tv.tv_usec;
+	mtv.tv_sec = t / 1000000;
+	mtv.tv_usec = t % 1000000;
+	if (!currprefs.lockstep)
+		mtv.tv_sec -= timezone;
 	timeval_to_amiga (&mtv, &days, &mins, &ticks);
 	if (days == pdays && mins == pmins && ticks == pticks) {
 		ticks++;
@@ -792,6 +800,14 @@ static void updatemfmpos (drive *drv)
 	drv->prevtracklen = drv->tracklen;
 }
 
+/* bigmfmbuf has changed */
+static void drive_syncmap_reset (drive *drv)
+{
+	drv->syncmap_len = 0;
+	if (word_drv == drv)
+		word_bits = 0;
+}
+
 static void track_reset (drive *drv)
 {
 	drv->tracklen = FLOPPY_WRITE_LEN * drv->ddhd * 2 * 8;
@@ -801,6 +817,7 @@ static void track_reset (drive *drv)
 	drv->skipoffset = -1;
 	drv->tracktiming[0] = 0;
 	memset (drv->bigmfmbuf, 0xaa, FLOPPY_WRITE_LEN * 2 * drv->ddhd);
+	drive_syncmap_reset (drv);
 	updatemfmpos (drv);
 }
 
@@ -837,7 +854,7 @@ static int read_header_ext2 (struct zfile *diskfile, trackid *trackdata, int *nu
 
 TCHAR *DISK_get_saveimagepath (const TCHAR *name)
 {
-	static TCHAR name1[MAX_DPATH];
+	static UAE_TLS TCHAR name1[MAX_DPATH];
 	TCHAR name2[MAX_DPATH];
 	TCHAR path[MAX_DPATH];
 	int i;
@@ -1787,6 +1804,7 @@ static void drive_fill_bigbuf (drive * drv, int force)
 	}
 
 	drv->trackspeed = get_floppy_speed2 (drv);
+	drive_syncmap_reset (drv);
 	updatemfmpos (drv);
 }
 
@@ -2194,7 +2212,7 @@ static void drive_write_data (drive * drv)
 			if (currprefs.floppy_auto_ext2) {
 				convert_adf_to_ext2 (drv, currprefs.floppy_auto_ext2);
 			} else {
-				static int warned;
+				static UAE_TLS int warned;
 				if (!warned)
 					notify_user (NUMSG_NEEDEXT2);
 				warned = 1;
@@ -2651,7 +2669,7 @@ int disk_empty (int num)
 static TCHAR *tobin (uae_u8 v)
 {
 	int i;
-	static TCHAR buf[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	static UAE_TLS TCHAR buf[9] = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 	for( i = 7; i >= 0; i--)
 		buf[7 - i] = v & (1 << i) ? '1' : '0';
 	// buf[-1] is invalid! buf[i] = 0;
@@ -2842,6 +2860,71 @@ STATIC_INLINE uae_u32 getonebit (uae_u16 * mfmbuf, int mfmpos)
 	return (buf[0] & (1 << (15 - (mfmpos & 15)))) ? 1 : 0;
 }
 
+/* get 1 to 16 bits from MFM bit stream, mfmpos + n must not pass the end of the track */
+STATIC_INLINE uae_u32 getbits (uae_u16 *mfmbuf, int mfmpos, int n)
+{
+	uae_u16 *buf = &mfmbuf[mfmpos >> 4];
+	uae_u32 v = buf[0] << 16;
+
+	if ((mfmpos & 15) + n > 16)
+		v |= buf[1];
+	return (v << (mfmpos & 15)) >> (32 - n);
+}
+
+static void drive_build_syncmap (drive *drv)
+{
+	int len = drv->tracklen;
+	uae_u16 w = 0;
+	int i;
+
+	memset (drv->syncmap, 0, (len + 15) / 16 * 2);
+	/* the word at the start of the track ends with the bits before the index */
+	for (i = len - 15; i < len; i++)
+		w = (w << 1) | getonebit (drv->bigmfmbuf, i);
+	for (i = 0; i < len; i++) {
+		w = (w << 1) | getonebit (drv->bigmfmbuf, i);
+		if (w == dsksync)
+			drv->syncmap[i >> 4] |= 0x8000 >> (i & 15);
+	}
+	drv->syncmap_len = len;
+	drv->syncmap_sync = dsksync;
+}
+
+/* Word level reading: returns how many bits from mfmpos on, at most maxbits,
+ * go by without a sync match, index, skip point or end of track. The sync map
+ * only holds when the word being shifted ends with the 15 track bits before
+ * mfmpos, callers read bit by bit until it does. */
+static int disk_fastbits (drive *drv, int mfmpos, int maxbits)
+{
+	int n, i;
+
+	if (drv->tracktiming[0] || drv->tracklen < 16)
+		return 0;
+	if (drv->syncmap_len != drv->tracklen || drv->syncmap_sync != dsksync)
+		drive_build_syncmap (drv);
+	/* bit at mfmpos moves the drive to mfmpos + 1 */
+	n = drv->tracklen - 1 - mfmpos;
+	if (drv->indexoffset > mfmpos && drv->indexoffset - 1 - mfmpos < n)
+		n = drv->indexoffset - 1 - mfmpos;
+	if (drv->skipoffset > mfmpos && drv->skipoffset - 1 - mfmpos < n)
+		n = drv->skipoffset - 1 - mfmpos;
+	if (n > maxbits)
+		n = maxbits;
+	for (i = 0; i < n; ) {
+		int p = mfmpos + i;
+		uae_u16 m = drv->syncmap[p >> 4] & (0xffff >> (p & 15));
+		if (m) {
+			int b = p & 15;
+			while (!(m & (0x8000 >> b)))
+				b++;
+			i += b - (p & 15);
+			return i < n ? i : n;
+		}
+		i += 16 - (p & 15);
+	}
+	return n;
+}
+
 void dumpdisk (void)
 {
 	int i, j, k;
@@ -2896,6 +2979,7 @@ static void fetchnextrevolution (drive *drv)
 	drv->trackspeed = get_floppy_speed2 (drv);
 	if (!drv->multi_revolution)
 		return;
+	drive_syncmap_reset (drv);
 	switch (drv->filetype)
 	{
 	case ADF_IPF:
@@ -2991,6 +3075,7 @@ static void disk_doupdate_write (drive * drv, int floppybits)
 						drv2->bigmfmbuf[drv2->mfmpos >> 4] = w;
 						drv2->bigmfmbuf[(drv2->mfmpos >> 4) + 1] = 0x5555;
 						drv2->writtento = 1;
+						drive_syncmap_reset (drv2);
 					}
 #ifdef AMAX
 					if (currprefs.amaxromfile[0])
@@ -3031,7 +3116,7 @@ static void updatetrackspeed (drive *drv, int mfmpos)
 		int t = drv->tracktiming[mfmpos / 8];
 		drv->trackspeed = get_floppy_speed2 (drv) * t / 1000;
 		if (drv->trackspeed < 700 || drv->trackspeed > 3000) {
-			static int warned;
+			static UAE_TLS int warned;
 			warned++;
 			if (warned < 50)
 				write_log (_T("corrupted trackspeed value %d\n"), drv->trackspeed);
@@ -3057,7 +3142,23 @@ static void disk_doupdate_predict (int startcycle)
 		uae_u32 tword = word;
 		int countcycle = startcycle + (drv->floppybitcounter % drv->trackspeed);
 		int mfmpos = drv->mfmpos;
+		bool readable = !drive_empty (drv) && !unformatted (drv) && (dskdmaen != DSKDMA_WRITE || !dma_enable);
+		int tbits = (word_drv == drv && word_pos == mfmpos) ? word_bits : 0;
 		while (countcycle < (maxhpos << 8)) {
+			if (readable && tbits >= 15) {
+				int n = disk_fastbits (drv, mfmpos, ((maxhpos << 8) - countcycle + drv->trackspeed - 1) / drv->trackspeed);
+				if (n > 0) {
+					if (n >= 16)
+						tword = getbits (drv->bigmfmbuf, mfmpos + n - 16, 16);
+					else
+						tword = (tword << n) | getbits (drv->bigmfmbuf, mfmpos, n);
+					mfmpos += n;
+					tbits += n;
+					countcycle += n * drv->trackspeed;
+					continue;
+				}
+			}
+			tbits++;
 			if (drv->tracktiming[0])
 				updatetrackspeed (drv, mfmpos);
 			if (dskdmaen != DSKDMA_WRITE || (dskdmaen == DSKDMA_WRITE && !dma_enable)) {
@@ -3080,6 +3181,8 @@ static void disk_doupdate_predict (int startcycle)
 			if (dskdmaen != DSKDMA_WRITE && mfmpos == drv->skipoffset) {
 				update_jitter ();
 				int skipcnt = disk_jitter;
+				if (skipcnt > 0)
+					tbits = 0;
 				while (skipcnt-- > 0) {
 					mfmpos++;
 					mfmpos %= drv->tracklen;
@@ -3155,6 +3258,7 @@ static void disk_doupdate_read_nothing (int floppybits)
 
 	while (floppybits >= get_floppy_speed ()) {
 		word <<= 1;
+		word_bits = 0;
 		doreaddma ();
 		if ((bitoffset & 7) == 7) {
 			dskbytr_val = word & 0xff;
@@ -3188,8 +3292,41 @@ static void disk_doupdate_read (drive * drv, int floppybits)
 	mfmbuf[6] = 0x4444;
 	mfmbuf[7] = 0x4444;
 	*/
+	bool readable = !drive_empty (drv) && !unformatted (drv);
 	while (floppybits >= drv->trackspeed) {
 		int oldmfmpos = drv->mfmpos;
+		int n = 0;
+		if (readable && word_drv == drv && word_pos == drv->mfmpos && word_bits >= 15)
+			n = disk_fastbits (drv, drv->mfmpos, 16 - bitoffset);
+		if (n > floppybits / drv->trackspeed)
+			n = floppybits / drv->trackspeed;
+		if (n > 0) {
+			/* n bits up to the end of the current word at most, nothing but DMA happens in them */
+			int last = bitoffset + n - 1;
+			word = (word << n) | getbits (drv->bigmfmbuf, drv->mfmpos, n);
+			drv->mfmpos += n;
+			word_pos = drv->mfmpos;
+			word_bits += n;
+			if (last == 15) {
+				bitoffset = 15;
+				if (doreaddma () < 0) {
+					drv->mfmpos--;
+					if (n > 8) {
+						dskbytr_val = (word >> 8) & 0xff;
+						dskbytr_val |= 0x8000;
+					}
+					return;
+				}
+				dskbytr_val = word & 0xff;
+				dskbytr_val |= 0x8000;
+			} else if (bitoffset <= 7 && last >= 7) {
+				dskbytr_val = (word >> (last - 7)) & 0xff;
+				dskbytr_val |= 0x8000;
+			}
+			bitoffset = (last + 1) & 15;
+			floppybits -= n * drv->trackspeed;
+			continue;
+		}
 		if (drv->tracktiming[0])
 			updatetrackspeed (drv, drv->mfmpos);
 		word <<= 1;
@@ -3199,6 +3336,13 @@ static void disk_doupdate_read (drive * drv, int floppybits)
 			else
 				word |= getonebit (drv->bigmfmbuf, drv->mfmpos);
 		}
+		if (readable && word_drv == drv && word_pos == drv->mfmpos) {
+			word_bits++;
+		} else {
+			word_drv = drv;
+			word_bits = readable ? 1 : 0;
+		}
+		word_pos = (drv->mfmpos + 1) % drv->tracklen;
 		//write_log (_T("%08X bo=%d so=%d mfmpos=%d dma=%d\n"), (word & 0xffffff), bitoffset, syncoffset, drv->mfmpos, dma_enable);
 		drv->mfmpos++;
 		drv->mfmpos %= drv->tracklen;
@@ -3315,7 +3459,7 @@ static void DISK_start (void)
 	dma_enable = (adkcon & 0x400) ? 0 : 1;
 }
 
-static int linecounter;
+static UAE_TLS int linecounter;
 
 void DISK_hsync (void)
 {
@@ -3362,6 +3506,7 @@ void DISK_update (int tohpos)
 #endif
 	if (cycles <= 0)
 		return;
+	hostprof_enter (HOSTPROF_DISK);
 	disk_hpos += cycles;
 	if (disk_hpos >= (maxhpos << 8))
 		disk_hpos %= 1 << 8;
@@ -3408,6 +3553,7 @@ void DISK_update (int tohpos)
 		disk_dmafinished ();
 
 	disk_doupdate_predict (disk_hpos);
+	hostprof_leave ();
 }
 
 void DSKLEN (uae_u16 v, int hpos)
@@ -4046,6 +4192,7 @@ uae_u8 *save_disk2 (int num, int *len, uae_u8 *dstptr)
 uae_u8 *restore_floppy (uae_u8 *src)
 {
 	word = restore_u16 ();
+	word_bits = 0;
 	bitoffset = restore_u8 ();
 	dma_enable = restore_u8 ();
 	disk_hpos = restore_u8 () & 0xff;
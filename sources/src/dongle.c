@@ -26,8 +26,8 @@
 #define LEVIATHAN 8
 #define LOGISTIX 10
 
-static int flag;
-static unsigned int cycles;
+static UAE_TLS int flag;
+static UAE_TLS unsigned int cycles;
 
 /* internal prototypes */
 void dongle_reset (void);
@@ -89,7 +89,7 @@ Logistix/SuperBase
 
 */
 
-static uae_u8 oldcia[2][16];
+static UAE_TLS uae_u8 oldcia[2][16];
 
 void dongle_reset (void)
 {
@@ -49,6 +49,10 @@
 #include "statusline.h"
 #include "inputdevice.h"
 #include "debug.h"
+#include "hostprof.h"
+#ifdef __LIBRETRO__
+#include "libretro-glue.h"
+#endif
 
 /* internal prototypes */
 void get_custom_mouse_limits (int *pw, int *ph, int *pdx, int *pdy, int dbl);
@@ -60,10 +64,10 @@ void reset_decision_table (void);
 
 // extern bool emulate_specialmonitors(struct vidbuffer*, struct vidbuffer*);
 
-extern int sprite_buffer_res;
-int lores_factor, lores_shift;
+extern UAE_TLS int sprite_buffer_res;
+UAE_TLS int lores_factor, lores_shift;
 
-int debug_bpl_mask = 0xff, debug_bpl_mask_one;
+UAE_TLS int debug_bpl_mask = 0xff, debug_bpl_mask_one;
 
 static void lores_reset (void)
 {
@@ -79,21 +83,21 @@ static void lores_reset (void)
 		sprite_buffer_res++;
 }
 
-bool aga_mode; /* mirror of chipset_mask & CSMASK_AGA */
-bool direct_rgb;
+UAE_TLS bool aga_mode; /* mirror of chipset_mask & CSMASK_AGA */
+UAE_TLS bool direct_rgb;
 
 /* The shift factor to apply when converting between Amiga coordinates and window
    coordinates.  Zero if the resolution is the same, positive if window coordinates
    have a higher resolution (i.e. we're stretching the image), negative if window
    coordinates have a lower resolution (i.e. we're shrinking the image).  */
-static int res_shift;
+static UAE_TLS int res_shift;
 
-static int linedbl, linedbld;
+static UAE_TLS int linedbl, linedbld;
 
-int interlace_seen = 0;
+UAE_TLS int interlace_seen = 0;
 #define AUTO_LORES_FRAMES 10
-static int can_use_lores = 0, frame_res, frame_res_lace, last_max_ypos;
-static bool center_reset;
+static UAE_TLS int can_use_lores = 0, frame_res, frame_res_lace, last_max_ypos;
+static UAE_TLS bool center_reset;
 
 /* Lookup tables for dual playfields.  The dblpf_*1 versions are for the case
    that playfield 1 has the priority, dbplpf_*2 are used if playfield 2 has
@@ -103,51 +107,51 @@ static bool center_reset;
    foreground being at bit offset 0, the one used if pf2 is in front being at
    offset 16.  */
 
-static int dblpf_ms1[256], dblpf_ms2[256], dblpf_ms[256];
-static int dblpf_ind1[256], dblpf_ind2[256];
+static UAE_TLS int dblpf_ms1[256], dblpf_ms2[256], dblpf_ms[256];
+static UAE_TLS int dblpf_ind1[256], dblpf_ind2[256];
 
-static int dblpf_2nd1[256], dblpf_2nd2[256];
+static UAE_TLS int dblpf_2nd1[256], dblpf_2nd2[256];
 
 static const int dblpfofs[] = { 0, 2, 4, 8, 16, 32, 64, 128 };
 
-static int sprite_offs[256];
+static UAE_TLS int sprite_offs[256];
 
-static uae_u32 clxtab[256];
+static UAE_TLS uae_u32 clxtab[256];
 
 /* Video buffer description structure. Filled in by the graphics system
  * dependent code. */
 
-struct vidbuf_description gfxvidinfo;
+UAE_TLS struct vidbuf_description gfxvidinfo;
 
 /* OCS/ECS color lookup table. */
-xcolnr xcolors[4096];
+UAE_TLS xcolnr xcolors[4096];
 
 struct spritepixelsbuf {
 	uae_u8 attach;
 	uae_u8 stdata;
 	uae_u16 data;
 };
-static struct spritepixelsbuf spritepixels[MAX_PIXELS_PER_LINE];
-static int sprite_first_x, sprite_last_x;
+static UAE_TLS struct spritepixelsbuf spritepixels[MAX_PIXELS_PER_LINE];
+static UAE_TLS int sprite_first_x, sprite_last_x;
 
 #ifdef AGA
 /* AGA mode color lookup tables */
-unsigned int xredcolors[256], xgreencolors[256], xbluecolors[256];
-static int dblpf_ind1_aga[256], dblpf_ind2_aga[256];
+UAE_TLS unsigned int xredcolors[256], xgreencolors[256], xbluecolors[256];
+static UAE_TLS int dblpf_ind1_aga[256], dblpf_ind2_aga[256];
 #else
 static uae_u8 spriteagadpfpixels[1];
 static int dblpf_ind1_aga[1], dblpf_ind2_aga[1];
 #endif
-int xredcolor_s, xredcolor_b, xredcolor_m;
-int xgreencolor_s, xgreencolor_b, xgreencolor_m;
-int xbluecolor_s, xbluecolor_b, xbluecolor_m;
+UAE_TLS int xredcolor_s, xredcolor_b, xredcolor_m;
+UAE_TLS int xgreencolor_s, xgreencolor_b, xgreencolor_m;
+UAE_TLS int xbluecolor_s, xbluecolor_b, xbluecolor_m;
 
-struct color_entry colors_for_drawing;
+UAE_TLS struct color_entry colors_for_drawing;
 
 /* The size of these arrays is pretty arbitrary; it was chosen to be "more
    than enough".  The coordinates used for indexing into these arrays are
    almost, but not quite, Amiga coordinates (there's a constant offset).  */
-union {
+UAE_TLS union {
 	/* Let's try to align this thing. */
 	double uupzuq;
 	long int cruxmedo;
@@ -159,24 +163,25 @@ union {
 #ifdef OS_WITHOUT_MEMORY_MANAGEMENT
 uae_u16 *spixels;
 #else
-uae_u16 spixels[2 * MAX_SPR_PIXELS];
+UAE_TLS uae_u16 spixels[2 * MAX_SPR_PIXELS];
 #endif
+UAE_TLS uae_u32 spixmask[SPIXMASK_WORDS];
 
 /* Eight bits for every pixel.  */
-union sps_union spixstate;
+UAE_TLS union sps_union spixstate;
 
-static uae_u32 ham_linebuf[MAX_PIXELS_PER_LINE * 2];
-static uae_u8 *real_bplpt[8];
+static UAE_TLS uae_u32 ham_linebuf[MAX_PIXELS_PER_LINE * 2];
+static UAE_TLS uae_u8 *real_bplpt[8];
 
-static uae_u8 all_ones[MAX_PIXELS_PER_LINE];
-static uae_u8 all_zeros[MAX_PIXELS_PER_LINE];
+static UAE_TLS uae_u8 all_ones[MAX_PIXELS_PER_LINE];
+static UAE_TLS uae_u8 all_zeros[MAX_PIXELS_PER_LINE];
 
-uae_u8 *xlinebuffer;
+UAE_TLS uae_u8 *xlinebuffer;
 
-static int *amiga2aspect_line_map, *native2amiga_line_map;
-static uae_u8 **row_map;
-static uae_u8 row_tmp[MAX_PIXELS_PER_LINE * 32 / 8];
-static int max_drawn_amiga_line;
+static UAE_TLS int *amiga2aspect_line_map, *native2amiga_line_map;
+static UAE_TLS uae_u8 **row_map;
+static UAE_TLS uae_u8 row_tmp[MAX_PIXELS_PER_LINE * 32 / 8];
+static UAE_TLS int max_drawn_amiga_line;
 
 /* line_draw_funcs: pfield_do_linetoscr, pfield_do_fill_line, decode_ham */
 typedef void (*line_draw_func)(int, int, bool);
@@ -193,62 +198,63 @@ typedef void (*line_draw_func)(int, int, bool);
 
 #define LINESTATE_SIZE ((MAXVPOS + 2) * 2 + 1)
 
-static uae_u8 linestate[LINESTATE_SIZE];
+static UAE_TLS uae_u8 linestate[LINESTATE_SIZE];
 
-uae_u8 line_data[(MAXVPOS + 2) * 2][MAX_PLANES * MAX_WORDS_PER_LINE * 2];
+UAE_TLS uae_u8 line_data[(MAXVPOS + 2) * 2][MAX_PLANES * MAX_WORDS_PER_LINE * 2];
 
 /* Centering variables.  */
-static int min_diwstart, max_diwstop;
+static UAE_TLS int min_diwstart, max_diwstop;
 /* The visible window: VISIBLE_LEFT_BORDER contains the left border of the visible
    area, VISIBLE_RIGHT_BORDER the right border.  These are in window coordinates.  */
-int visible_left_border, visible_right_border;
+UAE_TLS int visible_left_border, visible_right_border;
 /* Pixels outside of visible_start and visible_stop are always black */
-static int visible_left_start, visible_right_stop;
-static int visible_top_start, visible_bottom_stop;
+static UAE_TLS int visible_left_start, visible_right_stop;
+static UAE_TLS int visible_top_start, visible_bottom_stop;
 /* same for hblank */
-static int hblank_left_start, hblank_right_stop;
+static UAE_TLS int hblank_left_start, hblank_right_stop;
 
-static int linetoscr_x_adjust_bytes;
+static UAE_TLS int linetoscr_x_adjust_bytes;
 #ifdef __LIBRETRO__
-int thisframe_y_adjust;
+UAE_TLS int thisframe_y_adjust;
 #else
 static int thisframe_y_adjust;
 #endif
-static int thisframe_y_adjust_real, max_ypos_thisframe, min_ypos_for_screen;
-static int extra_y_adjust;
-int thisframe_first_drawn_line, thisframe_last_drawn_line;
+static UAE_TLS int thisframe_y_adjust_real, max_ypos_thisframe, min_ypos_for_screen;
+static UAE_TLS int extra_y_adjust;
+UAE_TLS int thisframe_first_drawn_line, thisframe_last_drawn_line;
 
 /* A frame counter that forces a redraw after at least one skipped frame in
    interlace mode.  */
-static int last_redraw_point;
+static UAE_TLS int last_redraw_point;
 
 #define MAX_STOP 30000
-static int first_drawn_line, last_drawn_line;
-static int first_block_line, last_block_line;
+static UAE_TLS int first_drawn_line, last_drawn_line;
+static UAE_TLS int first_block_line, last_block_line;
 
 #define NO_BLOCK -3
 
 /* These are generated by the drawing code from the line_decisions array for
    each line that needs to be drawn.  These are basically extracted out of
    bit fields in the hardware registers.  */
-static int bplehb, bplham, bpldualpf, bpldualpfpri, bpldualpf2of, bplplanecnt, ecsshres;
-static bool issprites;
-static int bplres;
-static int plf1pri, plf2pri, bplxor;
-static uae_u32 plf_sprite_mask;
-static int sbasecol[2] = { 16, 16 };
-static int hposblank;
-static bool specialmonitoron;
-
-bool picasso_requested_on;
-bool picasso_on;
-
-uae_sem_t gui_sem;
-int inhibit_frame;
-
-int framecnt = 0;
-static int frame_redraw_necessary;
-static int picasso_redraw_necessary;
+static UAE_TLS int bplehb, bplham, bpldualpf, bpldualpfpri, bpldualpf2of, bplplanecnt, ecsshres;
+static UAE_TLS bool issprites;
+static UAE_TLS int bplres;
+static UAE_TLS int plf1pri, plf2pri, bplxor;
+static UAE_TLS uae_u32 plf_sprite_mask;
+static UAE_TLS int sbasecol[2] = { 16, 16 };
+static UAE_TLS int hposblank;
+static UAE_TLS bool specialmonitoron;
+
+UAE_TLS bool picasso_requested_on;
+UAE_TLS bool picasso_on;
+
+UAE_TLS uae_sem_t gui_sem;
+UAE_TLS int inhibit_frame;
+
+UAE_TLS int framecnt = 0;
+UAE_TLS bool frame_headless;
+static UAE_TLS int frame_redraw_necessary;
+static UAE_TLS int picasso_redraw_necessary;
 
 #ifdef XLINECHECK
 static void xlinecheck (unsigned int start, unsigned int end)
@@ -308,6 +314,21 @@ void reset_decision_table (void)
 
 STATIC_INLINE void count_frame (void)
 {
+	/* Headless: never render, decisions are still made for collisions */
+	frame_headless = currprefs.headless;
+	if (frame_headless) {
+		framecnt = 1;
+		return;
+	}
+#ifdef __LIBRETRO__
+	/* Automatic frameskip decides per frame from the frontend audio buffer */
+	if (retro_frameskip_auto ()) {
+		framecnt = retro_frameskip_check () ? 1 : 0;
+		if (inhibit_frame)
+			framecnt = 1;
+		return;
+	}
+#endif
 	framecnt++;
 	if (framecnt >= currprefs.gfx_framerate)
 		framecnt = 0;
@@ -360,19 +381,19 @@ bool isnativevidbuf (void)
 	return true;
 }
 
-extern int plffirstline_total, plflastline_total;
-extern int first_planes_vpos, last_planes_vpos;
-extern int diwfirstword_total, diwlastword_total;
-extern int ddffirstword_total, ddflastword_total;
-extern int firstword_bplcon1;
-extern int lof_store;
+extern UAE_TLS int plffirstline_total, plflastline_total;
+extern UAE_TLS int first_planes_vpos, last_planes_vpos;
+extern UAE_TLS int diwfirstword_total, diwlastword_total;
+extern UAE_TLS int ddffirstword_total, ddflastword_total;
+extern UAE_TLS int firstword_bplcon1;
+extern UAE_TLS int lof_store;
 
 #define MIN_DISPLAY_W 256
 #define MIN_DISPLAY_H 192
 #define MAX_DISPLAY_W 362
 #define MAX_DISPLAY_H 283
 
-static int gclow, gcloh, gclox, gcloy, gclorealh;
+static UAE_TLS int gclow, gcloh, gclox, gcloy, gclorealh;
 
 void get_custom_topedge (int *xp, int *yp, bool max)
 {
@@ -463,7 +484,7 @@ int get_custom_limits (int *pw, int *ph, int *pdx, int *pdy, int *prealh)
 		ret = -1;
 
 	if (interlace_seen) {
-		static int interlace_count;
+		static UAE_TLS int interlace_count;
 		// interlace = only use long frames
 		if (lof_store && (interlace_count & 1) == 0)
 			interlace_count++;
@@ -669,8 +690,8 @@ void get_custom_mouse_limits (int *pw, int *ph, int *pdx, int *pdy, int dbl)
 	*pdx = dx; *pdy = dy;
 }
 
-static struct decision *dp_for_drawing;
-static struct draw_info *dip_for_drawing;
+static UAE_TLS struct decision *dp_for_drawing;
+static UAE_TLS struct draw_info *dip_for_drawing;
 
 /* Record DIW of the current line for use by centering code.  */
 void record_diw_line (int plfstrt, int first, int last)
@@ -694,18 +715,18 @@ void record_diw_line (int plfstrt, int first, int last)
    where do we start drawing the playfield, where do we start drawing the right border.
    All of these are forced into the visible window (VISIBLE_LEFT_BORDER .. VISIBLE_RIGHT_BORDER).
    PLAYFIELD_START and PLAYFIELD_END are in window coordinates.  */
-static int playfield_start, playfield_end;
-static int real_playfield_start, real_playfield_end;
-static int linetoscr_diw_start, linetoscr_diw_end;
-static int native_ddf_left, native_ddf_right;
+static UAE_TLS int playfield_start, playfield_end;
+static UAE_TLS int real_playfield_start, real_playfield_end;
+static UAE_TLS int linetoscr_diw_start, linetoscr_diw_end;
+static UAE_TLS int native_ddf_left, native_ddf_right;
 #if 0
 static bool can_have_bordersprite;
 #endif
 
-static int pixels_offset;
-static int src_pixel, ham_src_pixel;
+static UAE_TLS int pixels_offset;
+static UAE_TLS int src_pixel, ham_src_pixel;
 /* How many pixels in window coordinates which are to the left of the left border.  */
-static int unpainted;
+static UAE_TLS int unpainted;
 
 STATIC_INLINE xcolnr getbgc (bool blank)
 {
@@ -1524,8 +1545,8 @@ static void dummy_worker (int start, int stop, bool blank)
 {
 }
 
-static int ham_decode_pixel;
-static unsigned int ham_lastcolor;
+static UAE_TLS int ham_decode_pixel;
+static UAE_TLS unsigned int ham_lastcolor;
 
 /* Decode HAM in the invisible portion of the display (left of VISIBLE_LEFT_BORDER),
  * but don't draw anything in.  This is done to prepare HAM_LASTCOLOR for later,
@@ -1696,28 +1717,35 @@ static void gen_pfield_tables (void)
    that many of the if statements will go away completely after inlining.  */
 STATIC_INLINE void draw_sprites_1 (struct sprite_entry *e, int dualpf, int has_attach)
 {
-	uae_u16 *buf = spixels + e->first_pixel;
-	uae_u8 *stbuf = spixstate.bytes + e->first_pixel;
-	int spr_pos, pos;
-
-	buf -= e->pos;
-	stbuf -= e->pos;
-
-	spr_pos = e->pos + ((DIW_DDF_OFFSET - DISPLAY_LEFT_SHIFT) << sprite_buffer_res);
-
-	if (spr_pos < sprite_first_x)
-		sprite_first_x = spr_pos;
-
-	for (pos = e->pos; pos < e->max; pos++, spr_pos++) {
-		if (spr_pos >= 0 && spr_pos < MAX_PIXELS_PER_LINE) {
-			spritepixels[spr_pos].data = buf[pos];
-			spritepixels[spr_pos].stdata = stbuf[pos];
-			spritepixels[spr_pos].attach = has_attach;
+	int first = e->first_pixel;
+	int last = first + e->max - e->pos;
+	/* spritepixels index minus spixels index */
+	int spr_offs = e->pos + ((DIW_DDF_OFFSET - DISPLAY_LEFT_SHIFT) << sprite_buffer_res) - first;
+	int p;
+
+	if (first + spr_offs < sprite_first_x)
+		sprite_first_x = first + spr_offs;
+
+	/* spritepixels was cleared up to sprite_last_x and a zero pixel
+	   renders nothing, so only the covered pixels are copied.  */
+	for (p = first & ~31; p < last; p += 32) {
+		uae_u32 m = spixmask[p >> 5];
+		int q;
+		if (p < first)
+			m &= ~0u << (first - p);
+		if (last - p < 32)
+			m &= (1u << (last - p)) - 1;
+		for (q = p + spr_offs; m; q++, m >>= 1) {
+			if ((m & 1) && q >= 0 && q < MAX_PIXELS_PER_LINE) {
+				spritepixels[q].data = spixels[q - spr_offs];
+				spritepixels[q].stdata = spixstate.bytes[q - spr_offs];
+				spritepixels[q].attach = has_attach;
+			}
 		}
 	}
 
-	if (spr_pos > sprite_last_x)
-		sprite_last_x = spr_pos;
+	if (last + spr_offs > sprite_last_x)
+		sprite_last_x = last + spr_offs;
 }
 
 /* See comments above.  Do not touch if you don't know what's going on.
@@ -2403,8 +2431,8 @@ static __inline__ void pfield_doline (int lineno)
 
 void init_row_map (void)
 {
-	static uae_u8 *oldbufmem;
-	static int oldheight, oldpitch;
+	static UAE_TLS uae_u8 *oldbufmem;
+	static UAE_TLS int oldheight, oldpitch;
 	int i, j;
 
 	if (gfxvidinfo.height_allocated > MAX_UAE_HEIGHT) {
@@ -2639,8 +2667,8 @@ static void pfield_expand_dp_bplconx (int regno, int v)
 	res_shift = lores_shift - bplres;
 }
 
-static int drawing_color_matches;
-static enum { color_match_acolors, color_match_full } color_match_type;
+static UAE_TLS int drawing_color_matches;
+static UAE_TLS enum { color_match_acolors, color_match_full } color_match_type;
 
 /* Set up colors_for_drawing to the state at the beginning of the currently drawn
    line.  Try to avoid copying color tables around whenever possible.  */
@@ -3042,12 +3070,12 @@ static void center_image (void)
 	center_reset = false;
 }
 
-static int frame_res_cnt;
+static UAE_TLS int frame_res_cnt;
 static void init_drawing_frame (void)
 {
 	int i, maxline;
 #if 1
-	static int frame_res_old;
+	static UAE_TLS int frame_res_old;
 
 	if (currprefs.gfx_autoresolution && frame_res >= 0 && frame_res_lace >= 0) {
 		if (frame_res_cnt > 0 && frame_res_old == frame_res * 2 + frame_res_lace) {
@@ -3278,7 +3306,7 @@ static void draw_lightpen_cursor (int x, int y, int line, int onscreen)
 }
 #endif
 
-static int lightpen_y1, lightpen_y2;
+static UAE_TLS int lightpen_y1, lightpen_y2;
 
 /* UNUSED:
  * the only call is in finish_drawing_frame(), but
@@ -3428,6 +3456,7 @@ void finish_drawing_frame (void)
 	return;
 #endif
 
+	hostprof_enter (HOSTPROF_DRAWING);
 	draw_frame2 ();
 
 	if (currprefs.leds_on_screen) {
@@ -3483,6 +3512,7 @@ void finish_drawing_frame (void)
 		}
         }*/
 
+	hostprof_leave ();
 	if (!didflush)
 		do_flush_screen (first_drawn_line, last_drawn_line);
 }
@@ -3571,6 +3601,10 @@ void vsync_handle_redraw (int long_frame, int lof_changed, uae_u16 bplcon0p, uae
 
 		if (framecnt == 0)
 			finish_drawing_frame ();
+#ifdef __LIBRETRO__
+		else if ((retro_frameskip_auto () || picasso_on || frame_headless) && !(inhibit_frame & (1 << IHF_INPREC)))
+			flush_screen (0, 0); /* still hand the skipped or RTG frame back to the frontend */
+#endif
 #if 0
 		if (interlace_seen > 0) {
 			interlace_seen = -1;
@@ -3600,7 +3634,7 @@ void vsync_handle_redraw (int long_frame, int lof_changed, uae_u16 bplcon0p, uae
 
 		if (framecnt == 0)
 			init_drawing_frame ();
-		else if (currprefs.cpu_cycle_exact)
+		else if (currprefs.cpu_cycle_exact || frame_headless || currprefs.lockstep)
 			init_hardware_for_drawing_frame ();
 	} else {
 		if (isvsync_chipset ())
@@ -3623,6 +3657,8 @@ void hsync_record_line_state (int lineno, enum nln_how how, int changed)
 
 	state = linestate + lineno;
 	changed += frame_redraw_necessary + ((lineno >= lightpen_y1 && lineno <= lightpen_y2) ? 1 : 0);
+	/* an unchanged line is left as drawn in the output buffer, pfield_draw_line () skips it */
+	hostprof_lines[changed ? HOSTPROF_LINES_DRAWN : HOSTPROF_LINES_REUSED]++;
 
 	switch (how) {
 	case nln_normal:
@@ -3739,6 +3775,7 @@ void reset_drawing (void)
 
 	memset (spixels, 0, sizeof spixels);
 	memset (&spixstate, 0, sizeof spixstate);
+	memset (spixmask, 0, sizeof spixmask);
 
 	init_drawing_frame ();
 
@@ -20,16 +20,16 @@
 #include "events.h"
 #include "driveclick.h"
 
-static struct drvsample drvs[4][DS_END];
-static int freq = 44100;
+static UAE_TLS struct drvsample drvs[4][DS_END];
+static UAE_TLS int freq = 44100;
 
-static int drv_starting[4], drv_spinning[4], drv_has_spun[4], drv_has_disk[4];
+static UAE_TLS int drv_starting[4], drv_spinning[4], drv_has_spun[4], drv_has_disk[4];
 
-static int click_initialized, wave_initialized;
+static UAE_TLS int click_initialized, wave_initialized;
 #define DS_SHIFT 10
-static int sample_step;
-static uae_s16 *clickbuffer;
-static int clickcnt;
+static UAE_TLS int sample_step;
+static UAE_TLS uae_s16 *clickbuffer;
+static UAE_TLS int clickcnt;
 
 uae_s16 *decodewav (uae_u8 *s, int *lenp)
 {
@@ -196,7 +196,7 @@ void driveclick_init (void)
 				for (int j = 0; j < CLICK_TRACKS; j++)
 					drvs[i][DS_CLICK].lengths[j] = drvs[i][DS_CLICK].len;
 #ifdef __LIBRETRO__
-				extern char *retro_system_directory;
+				extern UAE_TLS char *retro_system_directory;
 				_stprintf (path2, "%s%cuae_data%c", retro_system_directory, FSDB_DIR_SEPARATOR, FSDB_DIR_SEPARATOR);
 #else
 				get_plugin_path (path2, sizeof path2 / sizeof (TCHAR), _T("floppysounds"));
@@ -438,7 +438,7 @@ static void dr_audio_activate (void)
 
 void driveclick_click (int drive, int cyl)
 {
-	static int prevcyl[4];
+	static UAE_TLS int prevcyl[4];
 
 	if (!click_initialized)
 		return;
@@ -14,15 +14,15 @@
 #include "options.h"
 #include "events.h"
 
-unsigned long int event_cycles, nextevent, currcycle;
-int is_syncline, is_syncline_end;
-long cycles_to_next_event;
-long max_cycles_to_next_event;
-long cycles_to_hsync_event;
-unsigned long start_cycles;
+UAE_TLS unsigned long int event_cycles, nextevent, currcycle;
+UAE_TLS int is_syncline, is_syncline_end;
+UAE_TLS long cycles_to_next_event;
+UAE_TLS long max_cycles_to_next_event;
+UAE_TLS long cycles_to_hsync_event;
+UAE_TLS unsigned long start_cycles;
 
-frame_time_t vsyncmintime, vsyncmaxtime, vsyncwaittime;
-int vsynctimebase;
+UAE_TLS frame_time_t vsyncmintime, vsyncmaxtime, vsyncwaittime;
+UAE_TLS int vsynctimebase;
 
 void events_schedule (void)
 {
@@ -89,12 +89,12 @@ void do_cycles_slow (unsigned long cycles_to_add)
 
 void MISC_handler (void)
 {
-	static bool dorecheck;
+	static UAE_TLS bool dorecheck;
 	bool recheck;
 	int i;
 	evt mintime;
 	evt ct = get_cycles ();
-	static int recursive;
+	static UAE_TLS int recursive;
 
 	if (recursive) {
 		dorecheck = true;
@@ -136,7 +136,7 @@ void MISC_handler (void)
 void event2_newevent_xx (int no, evt t, uae_u32 data, evfunc2 func)
 {
 	evt et;
-	static int next = ev2_misc;
+	static UAE_TLS int next = ev2_misc;
 
 	et = t + get_cycles ();
 	if (no < 0) {
@@ -31,6 +31,7 @@
 #include "ncr_scsi.h"
 #include "debug.h"
 #include "gayle.h"
+#include "statehash.h"
 
 #define MAX_EXPANSION_BOARDS 8
 
@@ -129,23 +130,23 @@
 #define rom_install	(0x01<<12) /* run code at install time */
 #define rom_binddrv	(0x02<<12) /* run code with binddrivers */
 
-uaecptr ROM_filesys_resname, ROM_filesys_resid;
-uaecptr ROM_filesys_diagentry;
-uaecptr ROM_hardfile_resname, ROM_hardfile_resid;
-uaecptr ROM_hardfile_init;
-bool uae_boot_rom;
-int uae_boot_rom_size; /* size = code size only */
-static bool chipdone;
+UAE_TLS uaecptr ROM_filesys_resname, ROM_filesys_resid;
+UAE_TLS uaecptr ROM_filesys_diagentry;
+UAE_TLS uaecptr ROM_hardfile_resname, ROM_hardfile_resid;
+UAE_TLS uaecptr ROM_hardfile_init;
+UAE_TLS bool uae_boot_rom;
+UAE_TLS int uae_boot_rom_size; /* size = code size only */
+static UAE_TLS bool chipdone;
 
 /* ********************************************************** */
 
-static void (*card_init[MAX_EXPANSION_BOARDS]) (void);
-static void (*card_map[MAX_EXPANSION_BOARDS]) (void);
-static TCHAR *card_name[MAX_EXPANSION_BOARDS];
+static UAE_TLS void (*card_init[MAX_EXPANSION_BOARDS]) (void);
+static UAE_TLS void (*card_map[MAX_EXPANSION_BOARDS]) (void);
+static UAE_TLS TCHAR *card_name[MAX_EXPANSION_BOARDS];
 
-static int ecard, cardno, z3num;
+static UAE_TLS int ecard, cardno, z3num;
 
-static uae_u16 uae_id;
+static UAE_TLS uae_u16 uae_id;
 
 /* ********************************************************** */
 
@@ -169,10 +170,10 @@ static uae_u16 uae_id;
  */
 
 /* Autoconfig address space at 0xE80000 */
-static uae_u8 expamem[65536];
+static UAE_TLS uae_u8 expamem[65536];
 
-static uae_u8 expamem_lo;
-static uae_u16 expamem_hi;
+static UAE_TLS uae_u8 expamem_lo;
+static UAE_TLS uae_u16 expamem_hi;
 
 /* Ugly hack for >2M chip RAM in single pool
  * We can't add it any later or early boot menu
@@ -238,7 +239,7 @@ static void REGPARAM3 expamem_bput (uaecptr, uae_u32) REGPARAM;
 
 void p96memstart (void);
 
-addrbank expamem_bank = {
+UAE_TLS addrbank expamem_bank = {
 	expamem_lget, expamem_wget, expamem_bget,
 	expamem_lput, expamem_wput, expamem_bput,
 	default_xlate, default_check, NULL, _T("Autoconfig"),
@@ -481,7 +482,7 @@ static void expamem_init_cd32fmv (void)
  *  Fast Memory
  */
 
-static uae_u32 fastmem_mask;
+static UAE_TLS uae_u32 fastmem_mask;
 
 static uae_u32 REGPARAM3 fastmem_lget (uaecptr) REGPARAM;
 static uae_u32 REGPARAM3 fastmem_wget (uaecptr) REGPARAM;
@@ -492,8 +493,8 @@ static void REGPARAM3 fastmem_bput (uaecptr, uae_u32) REGPARAM;
 static int REGPARAM3 fastmem_check (uaecptr addr, uae_u32 size) REGPARAM;
 static uae_u8 *REGPARAM3 fastmem_xlate (uaecptr addr) REGPARAM;
 
-uaecptr fastmem_start; /* Determined by the OS */
-static uae_u8 *fastmemory;
+UAE_TLS uaecptr fastmem_start; /* Determined by the OS */
+static UAE_TLS uae_u8 *fastmemory;
 
 static uae_u32 REGPARAM2 fastmem_lget (uaecptr addr)
 {
@@ -527,6 +528,7 @@ static void REGPARAM2 fastmem_lput (uaecptr addr, uae_u32 l)
 	addr &= fastmem_mask;
 	m = fastmemory + addr;
 	do_put_mem_long ((uae_u32 *)m, l);
+	statehash_write (STATEHASH_FAST, addr, 4);
 }
 
 static void REGPARAM2 fastmem_wput (uaecptr addr, uae_u32 w)
@@ -536,6 +538,7 @@ static void REGPARAM2 fastmem_wput (uaecptr addr, uae_u32 w)
 	addr &= fastmem_mask;
 	m = fastmemory + addr;
 	do_put_mem_word ((uae_u16 *)m, w);
+	statehash_write (STATEHASH_FAST, addr, 2);
 }
 
 static void REGPARAM2 fastmem_bput (uaecptr addr, uae_u32 b)
@@ -543,6 +546,7 @@ static void REGPARAM2 fastmem_bput (uaecptr addr, uae_u32 b)
 	addr -= fastmem_start & fastmem_mask;
 	addr &= fastmem_mask;
 	fastmemory[addr] = b;
+	statehash_write (STATEHASH_FAST, addr, 1);
 }
 
 static int REGPARAM2 fastmem_check (uaecptr addr, uae_u32 size)
@@ -559,7 +563,7 @@ static uae_u8 *REGPARAM2 fastmem_xlate (uaecptr addr)
 	return fastmemory + addr;
 }
 
-addrbank fastmem_bank = {
+UAE_TLS addrbank fastmem_bank = {
 	fastmem_lget, fastmem_wget, fastmem_bget,
 	fastmem_lput, fastmem_wput, fastmem_bput,
 	fastmem_xlate, fastmem_check, NULL, _T("Fast memory"),
@@ -711,8 +715,8 @@ static void REGPARAM3 filesys_lput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 filesys_wput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 filesys_bput (uaecptr, uae_u32) REGPARAM;
 
-static uae_u32 filesys_start; /* Determined by the OS */
-uae_u8 *filesysory;
+static UAE_TLS uae_u32 filesys_start; /* Determined by the OS */
+UAE_TLS uae_u8 *filesysory;
 
 static uae_u32 REGPARAM2 filesys_lget (uaecptr addr)
 {
@@ -783,7 +787,7 @@ static void REGPARAM2 filesys_bput (uaecptr addr, uae_u32 b)
 #endif
 }
 
-static addrbank filesys_bank = {
+static UAE_TLS addrbank filesys_bank = {
 	filesys_lget, filesys_wget, filesys_bget,
 	filesys_lput, filesys_wput, filesys_bput,
 	default_xlate, default_check, NULL, _T("Filesystem Autoconfig Area"),
@@ -796,9 +800,9 @@ static addrbank filesys_bank = {
  *  Z3fastmem Memory
  */
 
-static uae_u32 z3fastmem_mask, z3fastmem2_mask, z3chipmem_mask;
-uaecptr z3fastmem_start, z3fastmem2_start, z3chipmem_start;
-static uae_u8 *z3fastmem, *z3fastmem2, *z3chipmem;
+static UAE_TLS uae_u32 z3fastmem_mask, z3fastmem2_mask, z3chipmem_mask;
+UAE_TLS uaecptr z3fastmem_start, z3fastmem2_start, z3chipmem_start;
+static UAE_TLS uae_u8 *z3fastmem, *z3fastmem2, *z3chipmem;
 
 static uae_u32 REGPARAM2 z3fastmem_lget (uaecptr addr)
 {
@@ -830,6 +834,7 @@ static void REGPARAM2 z3fastmem_lput (uaecptr addr, uae_u32 l)
 	addr &= z3fastmem_mask;
 	m = z3fastmem + addr;
 	do_put_mem_long ((uae_u32 *)m, l);
+	statehash_write (STATEHASH_Z3FAST, addr, 4);
 }
 static void REGPARAM2 z3fastmem_wput (uaecptr addr, uae_u32 w)
 {
@@ -838,12 +843,14 @@ static void REGPARAM2 z3fastmem_wput (uaecptr addr, uae_u32 w)
 	addr &= z3fastmem_mask;
 	m = z3fastmem + addr;
 	do_put_mem_word ((uae_u16 *)m, w);
+	statehash_write (STATEHASH_Z3FAST, addr, 2);
 }
 static void REGPARAM2 z3fastmem_bput (uaecptr addr, uae_u32 b)
 {
 	addr -= z3fastmem_start & z3fastmem_mask;
 	addr &= z3fastmem_mask;
 	z3fastmem[addr] = b;
+	statehash_write (STATEHASH_Z3FAST, addr, 1);
 }
 static int REGPARAM2 z3fastmem_check (uaecptr addr, uae_u32 size)
 {
@@ -973,19 +980,19 @@ static uae_u8 *REGPARAM2 z3chipmem_xlate (uaecptr addr)
 }
 
 
-addrbank z3fastmem_bank = {
+UAE_TLS addrbank z3fastmem_bank = {
 	z3fastmem_lget, z3fastmem_wget, z3fastmem_bget,
 	z3fastmem_lput, z3fastmem_wput, z3fastmem_bput,
 	z3fastmem_xlate, z3fastmem_check, NULL, _T("ZorroIII Fast RAM"),
 	z3fastmem_lget, z3fastmem_wget, ABFLAG_RAM
 };
-addrbank z3fastmem2_bank = {
+UAE_TLS addrbank z3fastmem2_bank = {
 	z3fastmem2_lget, z3fastmem2_wget, z3fastmem2_bget,
 	z3fastmem2_lput, z3fastmem2_wput, z3fastmem2_bput,
 	z3fastmem2_xlate, z3fastmem2_check, NULL, _T("ZorroIII Fast RAM #2"),
 	z3fastmem2_lget, z3fastmem2_wget, ABFLAG_RAM
 };
-addrbank z3chipmem_bank = {
+UAE_TLS addrbank z3chipmem_bank = {
 	z3chipmem_lget, z3chipmem_wget, z3chipmem_bget,
 	z3chipmem_lput, z3chipmem_wput, z3chipmem_bput,
 	z3chipmem_xlate, z3chipmem_check, NULL, _T("MegaChipRAM"),
@@ -993,9 +1000,9 @@ addrbank z3chipmem_bank = {
 };
 
 /* Z3-based UAEGFX-card */
-uae_u32 gfxmem_mask; /* for memory.c */
-uae_u8 *gfxmemory;
-uae_u32 gfxmem_start;
+UAE_TLS uae_u32 gfxmem_mask; /* for memory.c */
+UAE_TLS uae_u8 *gfxmemory;
+UAE_TLS uae_u32 gfxmem_start;
 
 /* ********************************************************** */
 
@@ -1197,7 +1204,7 @@ static void expamem_init_z3fastmem2 (void)
 }
 
 #ifdef __LIBRETRO__
-uaecptr p96ram_start;
+UAE_TLS uaecptr p96ram_start;
 #endif
 
 #ifdef PICASSO96
@@ -1205,7 +1212,7 @@ uaecptr p96ram_start;
  *  Fake Graphics Card (ZORRO III) - BDK
  */
 
-uaecptr p96ram_start;
+UAE_TLS uaecptr p96ram_start;
 
 static void expamem_map_gfxcard (void)
 {
@@ -1269,7 +1276,7 @@ static void expamem_init_gfxcard_z2 (void)
 
 
 #ifdef SAVESTATE
-static size_t fast_filepos, z3_filepos, z3_filepos2, z3_fileposchip, p96_filepos;
+static UAE_TLS size_t fast_filepos, z3_filepos, z3_filepos2, z3_fileposchip, p96_filepos;
 #endif
 
 void free_fastmemory (void)
@@ -1384,6 +1391,7 @@ static void allocate_expamem (void)
 #ifdef PICASSO96
 	gfxmem_bank.baseaddr = gfxmemory;
 #endif
+	statehash_reset ();
 
 #ifdef SAVESTATE
 	if (savestate_state == STATE_RESTORE) {
@@ -1792,7 +1800,7 @@ void restore_pram (int len, size_t filepos)
 
 uae_u8 *save_expansion (int *len, uae_u8 *dstptr)
 {
-	static uae_u8 t[20];
+	static UAE_TLS uae_u8 t[20];
 	uae_u8 *dst = t, *dstbak = t;
 	if (dstptr)
 		dst = dstbak = dstptr;
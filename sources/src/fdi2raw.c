@@ -90,7 +90,7 @@ static TCHAR *datalog (uae_u8 *src, int len) { return _T(""); }
 #define outlog(...) { }
 #endif
 
-static int fdi_allocated;
+static UAE_TLS int fdi_allocated;
 #ifdef DEBUG
 static void fdi_free (void *p)
 {
@@ -179,7 +179,7 @@ struct node {
 };
 typedef struct node NODE;
 
-static uae_u8 temp, temp2;
+static UAE_TLS uae_u8 temp, temp2;
 
 static const uae_u8 *expand_tree (const uae_u8 *stream, NODE *node)
 {
@@ -595,7 +595,7 @@ static void rotateonebit (uae_u8 *start, uae_u8 *end, int shift)
 	}
 }
 
-static int check_offset;
+static UAE_TLS int check_offset;
 static uae_u16 getmfmword (uae_u8 *mbuf)
 {
 	uae_u32 v;
@@ -951,7 +951,7 @@ static void s27 (FDI *fdi)
 
 static uae_u16 ibm_crc (uae_u8 byte, int reset)
 {
-	static uae_u16 crc;
+	static UAE_TLS uae_u16 crc;
 	int i;
 
 	if (reset) crc = 0xcdb4;
@@ -1386,7 +1386,7 @@ static void dumpstream(int track, uae_u8 *stream, int len)
 #endif
 }
 
-static int bitoffset;
+static UAE_TLS int bitoffset;
 
 STATIC_INLINE void addbit (uae_u8 *p, int bit)
 {
@@ -1404,11 +1404,11 @@ struct pulse_sample {
 
 
 #define FDI_MAX_ARRAY 10 /* change this value as you want */
-static int pulse_limitval = 15; /* tolerance of 15% */
-static struct pulse_sample psarray[FDI_MAX_ARRAY];
-static int array_index;
-static unsigned long total;
-static int totaldiv;
+static UAE_TLS int pulse_limitval = 15; /* tolerance of 15% */
+static UAE_TLS struct pulse_sample psarray[FDI_MAX_ARRAY];
+static UAE_TLS int array_index;
+static UAE_TLS unsigned long total;
+static UAE_TLS int totaldiv;
 
 static void init_array(unsigned long standard_MFM_2_bit_cell_size, int nb_of_bits)
 {
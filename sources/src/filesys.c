@@ -54,6 +54,7 @@
 #include "consolehook.h"
 #include "blkdev.h"
 #include "isofs_api.h"
+#include "picasso96.h"
 
 #ifdef VITA
 #include <psp2/types.h>
@@ -68,7 +69,7 @@
 #endif
 
 #define TRACING_ENABLED 1
-int log_filesys = 0;
+UAE_TLS int log_filesys = 0;
 
 #if TRACING_ENABLED
 #if 0
@@ -91,9 +92,9 @@ int log_filesys = 0;
 
 #define RTAREA_HEARTBEAT 0xFFFC
 
-static uae_sem_t test_sem;
+static UAE_TLS uae_sem_t test_sem;
 
-static int bootrom_header;
+static UAE_TLS int bootrom_header;
 
 static uae_u32 dlg (uae_u32 a)
 {
@@ -130,13 +131,13 @@ static void aino_test_init (a_inode *aino)
 }
 
 
-uaecptr filesys_initcode;
-static uae_u32 fsdevname, fshandlername, filesys_configdev;
-static uae_u32 cdfs_devname, cdfs_handlername;
-static int filesys_in_interrupt;
-static uae_u32 mountertask;
-static int automountunit = -1;
-static int cd_unit_offset, cd_unit_number;
+UAE_TLS uaecptr filesys_initcode;
+static UAE_TLS uae_u32 fsdevname, fshandlername, filesys_configdev;
+static UAE_TLS uae_u32 cdfs_devname, cdfs_handlername;
+static UAE_TLS int filesys_in_interrupt;
+static UAE_TLS uae_u32 mountertask;
+static UAE_TLS int automountunit = -1;
+static UAE_TLS int cd_unit_offset, cd_unit_number;
 
 #define FS_STARTUP 0
 #define FS_GO_DOWN 1
@@ -200,7 +201,7 @@ struct uaedev_mount_info {
 	UnitInfo ui[MAX_FILESYSTEM_UNITS];
 };
 
-static struct uaedev_mount_info mountinfo;
+static UAE_TLS struct uaedev_mount_info mountinfo;
 
 int nr_units (void)
 {
@@ -1087,7 +1088,7 @@ typedef struct _unit {
 
 } Unit;
 
-static uae_u32 a_uniq, key_uniq;
+static UAE_TLS uae_u32 a_uniq, key_uniq;
 
 typedef uaecptr dpacket;
 #define PUT_PCK_RES1(p,v) do { put_long ((p) + dp_Res1, (v)); } while (0)
@@ -1118,8 +1119,8 @@ static int flush_cache (Unit *unit, int num);
 
 static TCHAR *char1 (uaecptr addr)
 {
-	static uae_char buf[1024];
-	static TCHAR bufx[1024];
+	static UAE_TLS uae_char buf[1024];
+	static UAE_TLS TCHAR bufx[1024];
 	unsigned int i = 0;
 	do {
 		buf[i] = get_byte (addr);
@@ -1130,8 +1131,8 @@ static TCHAR *char1 (uaecptr addr)
 
 static TCHAR *bstr1 (uaecptr addr)
 {
-	static TCHAR bufx[257];
-	static uae_char buf[257];
+	static UAE_TLS TCHAR bufx[257];
+	static UAE_TLS uae_char buf[257];
 	int i;
 	int n = get_byte (addr);
 	addr++;
@@ -1233,7 +1234,7 @@ void amiga_to_timeval (struct mytimeval *tv, int days, int mins, int ticks)
 	tv->tv_usec = (t % 1000) * 1000;
 }
 
-static Unit *units = 0;
+static UAE_TLS Unit *units = 0;
 
 static Unit*
 	find_unit (uaecptr port)
@@ -1467,9 +1468,9 @@ int filesys_eject (int nr)
 	return 1;
 }
 
-static uae_u32 heartbeat;
-static int heartbeat_count;
-static int heartbeat_task;
+static UAE_TLS uae_u32 heartbeat;
+static UAE_TLS int heartbeat_count;
+static UAE_TLS int heartbeat_task;
 
 // This uses filesystem process to reduce resource usage
 void setsystime (void)
@@ -5861,14 +5862,14 @@ static void action_get_file_size64 (Unit *unit, dpacket packet)
 
 /* We don't want multiple interrupts to be active at the same time. I don't
 * know whether AmigaOS takes care of that, but this does. */
-static uae_sem_t singlethread_int_sem;
+static UAE_TLS uae_sem_t singlethread_int_sem;
 
 static uae_u32 REGPARAM2 exter_int_helper (TrapContext *context)
 {
 	UnitInfo *uip = mountinfo.ui;
 	uaecptr port;
 	int n = m68k_dreg (regs, 0);
-	static int unit_no;
+	static UAE_TLS int unit_no;
 
 	switch (n) {
 	case 0:
@@ -6613,7 +6614,7 @@ static TCHAR *device_dupfix (uaecptr expbase, TCHAR *devname)
 
 static const TCHAR *dostypes (uae_u32 dostype)
 {
-	static TCHAR dt[32];
+	static UAE_TLS TCHAR dt[32];
 	int j;
 
 	j = 0;
@@ -29,7 +29,7 @@ extern int ftime(struct timeb*  timebuf);
 #endif
 
 typedef int BOOL;
-extern int log_filesys;
+extern UAE_TLS int log_filesys;
 
 #ifndef _WIN32
 
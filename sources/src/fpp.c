@@ -100,32 +100,32 @@ static uae_u32 dhex_1e128[] ={0xF9301D32, 0x5A827748};
 static uae_u32 dhex_1e256[] ={0x7F73BF3C, 0x75154FDD};
 static uae_u32 dhex_inf[]   ={0x00000000, 0x7ff00000};
 static uae_u32 dhex_nan[]   ={0xffffffff, 0x7fffffff};
-static double *fp_pi     = (double *)dhex_pi;
-static double *fp_exp_1  = (double *)dhex_exp_1;
-static double *fp_l2_e   = (double *)dhex_l2_e;
-static double *fp_ln_2   = (double *)dhex_ln_2;
-static double *fp_ln_10  = (double *)dhex_ln_10;
-static double *fp_l10_2  = (double *)dhex_l10_2;
-static double *fp_l10_e  = (double *)dhex_l10_e;
-static double *fp_1e16   = (double *)dhex_1e16;
-static double *fp_1e32   = (double *)dhex_1e32;
-static double *fp_1e64   = (double *)dhex_1e64;
-static double *fp_1e128  = (double *)dhex_1e128;
-static double *fp_1e256  = (double *)dhex_1e256;
-static double *fp_1e512  = (double *)dhex_inf;
-static double *fp_1e1024 = (double *)dhex_inf;
-static double *fp_1e2048 = (double *)dhex_inf;
-static double *fp_1e4096 = (double *)dhex_inf;
+static UAE_TLS double *fp_pi     = (double *)dhex_pi;
+static UAE_TLS double *fp_exp_1  = (double *)dhex_exp_1;
+static UAE_TLS double *fp_l2_e   = (double *)dhex_l2_e;
+static UAE_TLS double *fp_ln_2   = (double *)dhex_ln_2;
+static UAE_TLS double *fp_ln_10  = (double *)dhex_ln_10;
+static UAE_TLS double *fp_l10_2  = (double *)dhex_l10_2;
+static UAE_TLS double *fp_l10_e  = (double *)dhex_l10_e;
+static UAE_TLS double *fp_1e16   = (double *)dhex_1e16;
+static UAE_TLS double *fp_1e32   = (double *)dhex_1e32;
+static UAE_TLS double *fp_1e64   = (double *)dhex_1e64;
+static UAE_TLS double *fp_1e128  = (double *)dhex_1e128;
+static UAE_TLS double *fp_1e256  = (double *)dhex_1e256;
+static UAE_TLS double *fp_1e512  = (double *)dhex_inf;
+static UAE_TLS double *fp_1e1024 = (double *)dhex_inf;
+static UAE_TLS double *fp_1e2048 = (double *)dhex_inf;
+static UAE_TLS double *fp_1e4096 = (double *)dhex_inf;
 /* REMOVEME:
  * nowhere used
  */
 #if 0
 static double *fp_inf    = (double *)dhex_inf;
 #endif
-static double *fp_nan    = (double *)dhex_nan;
+static UAE_TLS double *fp_nan    = (double *)dhex_nan;
 #endif
-double fp_1e8 = 1.0e8;
-float  fp_1e0 = 1, fp_1e1 = 10, fp_1e2 = 100, fp_1e4 = 10000;
+UAE_TLS double fp_1e8 = 1.0e8;
+UAE_TLS float  fp_1e0 = 1, fp_1e1 = 10, fp_1e2 = 100, fp_1e4 = 10000;
 
 #define FFLAG_Z	    0x4000
 #define FFLAG_N	    0x0100
@@ -189,7 +189,7 @@ static void fpu_op_unimp (uae_u16 opcode, uae_u32 ea, uaecptr oldpc, int type)
 	* Line F exception with different stack frame.. */
 	int vector = 11;
 	uaecptr newpc = m68k_getpc ();
-	static int warned = 20;
+	static UAE_TLS int warned = 20;
 
 	regs.t0 = regs.t1 = 0;
 	MakeSR ();
@@ -1420,7 +1420,7 @@ static uaecptr fmovem2fpp (uaecptr ad, uae_u32 list, int incr)
 {
 	int reg;
 	if (currprefs.mmu_model == 68030) {
-		static uae_u32 wrd1, wrd2, wrd3;
+		static UAE_TLS uae_u32 wrd1, wrd2, wrd3;
 		int idx = 0;
 		if (incr < 0) {
 			for (reg = 7; reg >= 0; reg--) {
@@ -78,8 +78,8 @@ int dos_errno (void)
 static int fsdb_name_invalid_2 (const TCHAR *n, int dir)
 {
         int i;
-        static char s1[MAX_DPATH];
-        static TCHAR s2[MAX_DPATH];
+        static UAE_TLS char s1[MAX_DPATH];
+        static UAE_TLS TCHAR s2[MAX_DPATH];
         TCHAR a = n[0];
         TCHAR b = (a == '\0' ? a : n[1]);
         TCHAR c = (b == '\0' ? b : n[2]);
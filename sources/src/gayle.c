@@ -30,6 +30,7 @@
 #include "blkdev.h"
 #include "scsi.h"
 #include "threaddep/thread.h"
+#include "misc.h"
 
 #define PCMCIA_SRAM 1
 #define PCMCIA_IDE 2
@@ -189,6 +190,8 @@ struct ide_hdf
 	struct ide_hdf *pair;
 
 	uae_u8 secbuf[SECBUF_SIZE];
+	int data_base; // secbuf offset of the current DRQ block
+	int read_left; // bytes read ahead after the current DRQ block
 	int data_offset;
 	int data_size;
 	int data_multi;
@@ -218,22 +221,22 @@ struct ide_hdf
 #define GAYLE_IDE_ID 0
 #define PCMCIA_IDE_ID 2
 
-static struct ide_hdf *idedrive[TOTAL_IDE * 2];
-static struct ide_registers ideregs[TOTAL_IDE * 2];
-struct hd_hardfiledata *pcmcia_sram;
+static UAE_TLS struct ide_hdf *idedrive[TOTAL_IDE * 2];
+static UAE_TLS struct ide_registers ideregs[TOTAL_IDE * 2];
+UAE_TLS struct hd_hardfiledata *pcmcia_sram;
 
-static int pcmcia_card;
-static int pcmcia_readonly;
-static int pcmcia_type;
-static uae_u8 pcmcia_configuration[20];
-static int pcmcia_configured;
+static UAE_TLS int pcmcia_card;
+static UAE_TLS int pcmcia_readonly;
+static UAE_TLS int pcmcia_type;
+static UAE_TLS uae_u8 pcmcia_configuration[20];
+static UAE_TLS int pcmcia_configured;
 
-static int gayle_id_cnt;
-static uae_u8 gayle_irq, gayle_int, gayle_cs, gayle_cs_mask, gayle_cfg;
-static int ide_splitter;
+static UAE_TLS int gayle_id_cnt;
+static UAE_TLS uae_u8 gayle_irq, gayle_int, gayle_cs, gayle_cs_mask, gayle_cfg;
+static UAE_TLS int ide_splitter;
 
-static smp_comm_pipe requests;
-static volatile int gayle_thread_running;
+static UAE_TLS smp_comm_pipe requests;
+static UAE_TLS volatile int gayle_thread_running;
 
 STATIC_INLINE void pw (struct ide_hdf *ide, int offset, uae_u16 w)
 {
@@ -480,6 +483,8 @@ static void ide_fail (struct ide_hdf *ide)
 static void ide_data_ready (struct ide_hdf *ide)
 {
 	memset (ide->secbuf, 0, ide->blocksize);
+	ide->data_base = 0;
+	ide->read_left = 0;
 	ide->data_offset = 0;
 	ide->data_size = ide->blocksize;
 	ide->data_multi = 1;
@@ -761,9 +766,16 @@ static void setbsy (struct ide_hdf *ide)
 	ide->regs.ide_status &= ~IDE_STATUS_DRQ;
 }
 
+static void do_process_rw_command (struct ide_hdf *ide);
+
 static void process_rw_command (struct ide_hdf *ide)
 {
 	setbsy (ide);
+	// next block of a multi block read is already in secbuf, no host I/O needed
+	if (!ide->direction && ide->read_left >= ide->blocksize) {
+		do_process_rw_command (ide);
+		return;
+	}
 	write_comm_pipe_u32 (&requests, ide->num, 1);
 }
 static void process_packet_command (struct ide_hdf *ide)
@@ -892,7 +904,7 @@ static void do_process_packet_command (struct ide_hdf *ide)
 
 static void do_process_rw_command (struct ide_hdf *ide)
 {
-	unsigned int cyl, head, sec, nsec;
+	unsigned int cyl, head, sec, nsec, total;
 	uae_u64 lba;
 	bool last;
 
@@ -909,6 +921,7 @@ static void do_process_rw_command (struct ide_hdf *ide)
 		ide_fail_err (ide, IDE_ERR_IDNF);
 		return;
 	}
+	total = nsec;
 	if (nsec > ide->data_multi)
 		nsec = ide->data_multi;
 
@@ -916,10 +929,19 @@ static void do_process_rw_command (struct ide_hdf *ide)
 		hdf_write (&ide->hdhfd.hfd, ide->secbuf, lba * ide->blocksize, nsec * ide->blocksize);
 		if (IDE_LOG > 1)
 			write_log (_T("IDE%d write, %d bytes written\n"), ide->num, nsec * ide->blocksize);
+	} else if (ide->read_left >= nsec * ide->blocksize) {
+		// rest of the command was read with the first block
+		ide->data_base += ide->data_multi * ide->blocksize;
+		ide->read_left -= nsec * ide->blocksize;
 	} else {
-		hdf_read (&ide->hdhfd.hfd, ide->secbuf, lba * ide->blocksize, nsec * ide->blocksize);
+		// read all remaining sectors of the command at once
+		if (total > SECBUF_SIZE / ide->blocksize)
+			total = SECBUF_SIZE / ide->blocksize;
+		hdf_read (&ide->hdhfd.hfd, ide->secbuf, lba * ide->blocksize, total * ide->blocksize);
 		if (IDE_LOG > 1)
-			write_log (_T("IDE%d read, read %d bytes\n"), ide->num, nsec * ide->blocksize);
+			write_log (_T("IDE%d read, read %d bytes\n"), ide->num, total * ide->blocksize);
+		ide->data_base = 0;
+		ide->read_left = (total - nsec) * ide->blocksize;
 	}
 	ide->intdrq = true;
 	last = dec_nsec (ide, nsec) == 0;
@@ -1005,6 +1027,8 @@ static void ide_do_command (struct ide_hdf *ide, uae_u8 cmd)
 		write_log (_T("**** IDE%d command %02X\n"), ide->num, cmd);
 	ide->regs.ide_status &= ~ (IDE_STATUS_DRDY | IDE_STATUS_DRQ | IDE_STATUS_ERR);
 	ide->regs.ide_error = 0;
+	ide->data_base = 0;
+	ide->read_left = 0;
 
 	if (ide->atapi) {
 
@@ -1109,7 +1133,7 @@ static uae_u16 ide_get_data (struct ide_hdf *ide)
 			}
 		}
 	} else {
-		v = ide->secbuf[ide->data_offset + 1] | (ide->secbuf[ide->data_offset + 0] << 8);
+		v = ide->secbuf[ide->data_base + ide->data_offset + 1] | (ide->secbuf[ide->data_base + ide->data_offset + 0] << 8);
 		ide->data_offset += 2;
 		if (ide->data_size < 0) {
 			ide->data_size += 2;
@@ -1502,13 +1526,14 @@ static void REGPARAM3 gayle_lput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 gayle_wput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 gayle_bput (uaecptr, uae_u32) REGPARAM;
 
-addrbank gayle_bank = {
+UAE_TLS addrbank gayle_bank = {
 	gayle_lget, gayle_wget, gayle_bget,
 	gayle_lput, gayle_wput, gayle_bput,
 	default_xlate, default_check, NULL, _T("Gayle (low)"),
 	dummy_lgeti, dummy_wgeti, ABFLAG_IO
 };
 
+#ifdef NCR
 static int isa4000t (uaecptr addr)
 {
 	if (currprefs.cs_mbdmac != 2)
@@ -1517,6 +1542,7 @@ static int isa4000t (uaecptr addr)
 		return 0;
 	return 1;
 }
+#endif
 
 static uae_u32 REGPARAM2 gayle_lget (uaecptr addr)
 {
@@ -1544,10 +1570,12 @@ static uae_u32 REGPARAM2 gayle_wget (uaecptr addr)
 #ifdef JIT
 	special_mem |= S_READ;
 #endif
+#ifdef NCR
 	if (isa4000t (addr)) {
 		addr -= NCR_OFFSET;
 		return (ncr_bget2 (addr) << 8) | ncr_bget2 (addr + 1);
 	}
+#endif
 	ide_reg = get_gayle_ide_reg (addr, &ide);
 	if (ide_reg == IDE_DATA)
 		return ide_get_data (ide);
@@ -1560,10 +1588,12 @@ static uae_u32 REGPARAM2 gayle_bget (uaecptr addr)
 #ifdef JIT
 	special_mem |= S_READ;
 #endif
+#ifdef NCR
 	if (isa4000t (addr)) {
 		addr -= NCR_OFFSET;
 		return ncr_bget2 (addr);
 	}
+#endif
 	return gayle_read (addr);
 }
 
@@ -1590,12 +1620,14 @@ static void REGPARAM2 gayle_wput (uaecptr addr, uae_u32 value)
 #ifdef JIT
 	special_mem |= S_WRITE;
 #endif
+#ifdef NCR
 	if (isa4000t (addr)) {
 		addr -= NCR_OFFSET;
 		ncr_bput2 (addr, value >> 8);
 		ncr_bput2 (addr + 1, value);
 		return;
 	}
+#endif
 	ide_reg = get_gayle_ide_reg (addr, &ide);
 	if (ide_reg == IDE_DATA) {
 		ide_put_data (ide, value);
@@ -1610,11 +1642,13 @@ static void REGPARAM2 gayle_bput (uaecptr addr, uae_u32 value)
 #ifdef JIT
 	special_mem |= S_WRITE;
 #endif
+#ifdef NCR
 	if (isa4000t (addr)) {
 		addr -= NCR_OFFSET;
 		ncr_bput2 (addr, value);
 		return;
 	}
+#endif
 	gayle_write (addr, value);
 }
 
@@ -1646,7 +1680,7 @@ static void REGPARAM3 gayle2_lput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 gayle2_wput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 gayle2_bput (uaecptr, uae_u32) REGPARAM;
 
-addrbank gayle2_bank = {
+UAE_TLS addrbank gayle2_bank = {
 	gayle2_lget, gayle2_wget, gayle2_bget,
 	gayle2_lput, gayle2_wput, gayle2_bput,
 	default_xlate, default_check, NULL, _T("Gayle (high)"),
@@ -1707,9 +1741,9 @@ static void REGPARAM2 gayle2_bput (uaecptr addr, uae_u32 value)
 	gayle2_write (addr, value);
 }
 
-static uae_u8 ramsey_config;
-static int gary_coldboot, gary_toenb, gary_timeout;
-static int garyidoffset;
+static UAE_TLS uae_u8 ramsey_config;
+static UAE_TLS int gary_coldboot, gary_toenb, gary_timeout;
+static UAE_TLS int garyidoffset;
 
 static void mbres_write (uaecptr addr, uae_u32 val, int size)
 {
@@ -1842,7 +1876,7 @@ static void REGPARAM2 mbres_bput (uaecptr addr, uae_u32 value)
 	mbres_write (addr, value, 1);
 }
 
-addrbank mbres_bank = {
+UAE_TLS addrbank mbres_bank = {
 	mbres_lget, mbres_wget, mbres_bget,
 	mbres_lput, mbres_wput, mbres_bput,
 	default_xlate, default_check, NULL, _T("Motherboard Resources"),
@@ -1918,13 +1952,13 @@ static struct ide_hdf *add_ide_unit (int ch, struct uaedev_config_info *ci)
 	return ide;
 }
 
-static int pcmcia_common_size, pcmcia_attrs_size;
-static int pcmcia_common_mask;
-static uae_u8 *pcmcia_common;
-static uae_u8 *pcmcia_attrs;
-static int pcmcia_write_min, pcmcia_write_max;
-static int pcmcia_oddevenflip;
-static uae_u16 pcmcia_idedata;
+static UAE_TLS int pcmcia_common_size, pcmcia_attrs_size;
+static UAE_TLS int pcmcia_common_mask;
+static UAE_TLS uae_u8 *pcmcia_common;
+static UAE_TLS uae_u8 *pcmcia_attrs;
+static UAE_TLS int pcmcia_write_min, pcmcia_write_max;
+static UAE_TLS int pcmcia_oddevenflip;
+static UAE_TLS uae_u16 pcmcia_idedata;
 
 static int get_pcmcmia_ide_reg (uaecptr addr, int width, struct ide_hdf **ide)
 {
@@ -2422,7 +2456,7 @@ static uae_u8 *REGPARAM2 gayle_common_xlate (uaecptr addr)
 	return pcmcia_common + addr;
 }
 
-static addrbank gayle_common_bank = {
+static UAE_TLS addrbank gayle_common_bank = {
 	gayle_common_lget, gayle_common_wget, gayle_common_bget,
 	gayle_common_lput, gayle_common_wput, gayle_common_bput,
 	gayle_common_xlate, gayle_common_check, NULL, _T("Gayle PCMCIA Common"),
@@ -2437,7 +2471,7 @@ static void REGPARAM3 gayle_attr_lput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 gayle_attr_wput (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM3 gayle_attr_bput (uaecptr, uae_u32) REGPARAM;
 
-addrbank gayle_attr_bank = {
+UAE_TLS addrbank gayle_attr_bank = {
 	gayle_attr_lget, gayle_attr_wget, gayle_attr_bget,
 	gayle_attr_lput, gayle_attr_wput, gayle_attr_bput,
 	default_xlate, default_check, NULL, _T("Gayle PCMCIA Attribute/Misc"),
@@ -2737,7 +2771,7 @@ void gayle_free (void)
 
 void gayle_reset (int hardreset)
 {
-	static TCHAR bankname[100];
+	static UAE_TLS TCHAR bankname[100];
 
 	initide ();
 	if (hardreset) {
@@ -2749,10 +2783,12 @@ void gayle_reset (int hardreset)
 	_tcscpy (bankname, _T("Gayle (low)"));
 	if (currprefs.cs_ide == IDE_A4000)
 		_tcscpy (bankname, _T("A4000 IDE"));
+#ifdef NCR
 	if (currprefs.cs_mbdmac == 2) {
 		_tcscat (bankname, _T(" + NCR53C710 SCSI"));
 		ncr_reset ();
 	}
+#endif
 	gayle_bank.name = bankname;
 }
 
@@ -15,6 +15,11 @@
  *
  * The source for the insn timings is Markt & Technik's Amiga Magazin 8/1992.
  *
+ * A frequent.68k profile in the current directory, written by a core built
+ * with COUNT_INSTRS=2, orders the handlers by how often they ran so the hot
+ * ones share cache lines and pages. Handlers the profile never saw are
+ * marked UAE_COLD and end up out of the way in the cold text.
+ *
  * Copyright 1995, 1996, 1997, 1998, 1999, 2000 Bernd Schmidt
  */
 
@@ -103,6 +108,9 @@ static char *srcld, *dstld;
 static char *srcwd, *dstwd;
 static char *do_cycles, *disp000, *disp020;
 
+/* set when frequent.68k was read, counts[] then tells hot from cold */
+static int have_counts;
+
 static void read_counts (void)
 {
 	FILE *file;
@@ -111,17 +119,23 @@ static void read_counts (void)
 	int nr = 0;
 	memset (counts, 0, 65536 * sizeof *counts);
 
-	count = 0;
 	file = fopen ("frequent.68k", "r");
-	if (file && (1 == fscanf (file, "Total: %lu\n", &total))) {
-		while (fscanf (file, "%lx: %lu %s\n", &opcode, &count, name) == 3) {
-			opcode_next_clev[nr] = 5;
-			opcode_last_postfix[nr] = -1;
-			opcode_map[nr++] = opcode;
-			counts[opcode] = count;
+	if (file) {
+		if (1 == fscanf (file, "Total: %lu\n", &total)) {
+			while (fscanf (file, "%lx: %lu %s\n", &opcode, &count, name) == 3) {
+				/* only opcodes with a handler of their own, once each */
+				if (opcode > 0xffff || table68k[opcode].handler != -1
+					|| table68k[opcode].mnemo == i_ILLG || counts[opcode] || !count)
+					continue;
+				opcode_next_clev[nr] = 5;
+				opcode_last_postfix[nr] = -1;
+				opcode_map[nr++] = opcode;
+				counts[opcode] = count;
+			}
 		}
 		fclose (file);
 	}
+	have_counts = nr > 0;
 	if (nr == nr_cpuop_funcs)
 		return;
 	for (opcode = 0; opcode < 0x10000; opcode++) {
@@ -131,7 +145,6 @@ static void read_counts (void)
 			opcode_next_clev[nr] = 5;
 			opcode_last_postfix[nr] = -1;
 			opcode_map[nr++] = opcode;
-			counts[opcode] = count;
 		}
 	}
 	if (nr != nr_cpuop_funcs)
@@ -4214,7 +4227,8 @@ static void generate_one_opcode (int rp, char *extra)
 	printf ("/* %s */\n", outopcode (opcode));
 	if (i68000)
 		printf("#ifndef CPUEMU_68000_ONLY\n");
-	printf ("%s REGPARAM2 CPUFUNC(op_%04lx_%d%s)(uae_u32 opcode)\n{\n", (using_ce || using_ce020) ? "void" : "uae_u32", opcode, postfix, extra);
+	printf ("%s%s REGPARAM2 CPUFUNC(op_%04lx_%d%s)(uae_u32 opcode)\n{\n", have_counts && !counts[opcode] ? "UAE_COLD " : "",
+		(using_ce || using_ce020) ? "void" : "uae_u32", opcode, postfix, extra);
 
 	switch (table68k[opcode].stype) {
 	case 0: smsk = 7; break;
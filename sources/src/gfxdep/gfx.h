@@ -8,5 +8,5 @@
 
 #define GFX_NAME "sdl"
 #define USE_SDL_GFX
-//#define PICASSO96_SUPPORTED
-//#define PICASSO96
+#define PICASSO96_SUPPORTED
+#define PICASSO96
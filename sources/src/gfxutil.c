@@ -147,8 +147,8 @@ static float video_gamma (float value, float gamma, float bri, float con)
 /* Update: renamed gamma to gfx_gamma, because math-finite.h
  * already defines the global value "gamma". - Sven
 */
-static uae_u32 gfx_gamma[256 * 3];
-static int lf, hf;
+static UAE_TLS uae_u32 gfx_gamma[256 * 3];
+static UAE_TLS int lf, hf;
 
 static void video_calc_gammatable (void)
 {
@@ -226,7 +226,7 @@ extern uae_s32 tyhrgb[65536];
 extern uae_s32 tylrgb[65536];
 extern uae_s32 tcbrgb[65536];
 extern uae_s32 tcrrgb[65536];
-extern uae_u32 redc[3 * 256], grec[3 * 256], bluc[3 * 256];
+extern UAE_TLS uae_u32 redc[3 * 256], grec[3 * 256], bluc[3 * 256];
 
 static uae_u32 lowbits (int v, int shift, int lsize)
 {
@@ -470,8 +470,8 @@ void alloc_colors64k (int rw, int gw, int bw, int rs, int gs, int bs, int aw, in
 	xbluecolor_m = ((1 << bw) - 1) << xbluecolor_s;
 }
 
-static int color_diff[4096];
-static int newmaxcol = 0;
+static UAE_TLS int color_diff[4096];
+static UAE_TLS int newmaxcol = 0;
 
 void setup_maxcol (int max)
 {
@@ -625,7 +625,7 @@ void alloc_colors256 (allocfunc_type allocfunc)
  * far more reasonable (I am thinking about the one that is used in DJPEG).
  */
 
-uae_u8 cidx[4][8*4096]; /* fast, but memory hungry =:-( */
+UAE_TLS uae_u8 cidx[4][8*4096]; /* fast, but memory hungry =:-( */
 
 /*
  * Compute dithering structures
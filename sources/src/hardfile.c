@@ -79,11 +79,11 @@ STATIC_INLINE uae_u32 gl (uae_u8 *p)
 	return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | (p[3] << 0);
 }
 
-static uae_sem_t change_sem;
+static UAE_TLS uae_sem_t change_sem;
 
-static struct hardfileprivdata hardfpd[MAX_FILESYSTEM_UNITS];
+static UAE_TLS struct hardfileprivdata hardfpd[MAX_FILESYSTEM_UNITS];
 
-static uae_u32 nscmd_cmd;
+static UAE_TLS uae_u32 nscmd_cmd;
 
 static void wl (uae_u8 *p, int v)
 {
@@ -60,13 +60,13 @@ struct uae_driveinfo {
 * - block 0 is zeroed
 */
 
-int harddrive_dangerous, do_rdbdump;
-static struct uae_driveinfo uae_drives[MAX_FILESYSTEM_UNITS];
-static int num_drives = 0;
+UAE_TLS int harddrive_dangerous, do_rdbdump;
+static UAE_TLS struct uae_driveinfo uae_drives[MAX_FILESYSTEM_UNITS];
+static UAE_TLS int num_drives = 0;
 
 static void rdbdump (FILE *h, uae_u64 offset, uae_u8 *buf, int blocksize)
 {
-	static int cnt = 1;
+	static UAE_TLS int cnt = 1;
 	int i, blocks;
 	char name[100];
 	FILE *f;
@@ -600,7 +600,7 @@ static int hdf_init2 (int force)
 	int errormode;
 	int dwDriveMask;
 #endif
-	static int done = 0;
+	static UAE_TLS int done = 0;
 
 	if (done && !force)
 		return num_drives;
@@ -621,7 +621,7 @@ int hdf_getnumharddrives (void)
 
 TCHAR *hdf_getnameharddrive (int index, int flags, int *sectorsize, int *dangerousdrive)
 {
-	static char name[512];
+	static UAE_TLS char name[512];
 	char tmp[32];
 	uae_u64 size = uae_drives[index].size;
 	int nomedia = uae_drives[index].nomedia;
@@ -0,0 +1,151 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Host time accounting per emulated subsystem
+  *
+  * Probes in the subsystem entry points accumulate host timer ticks into
+  * per-frame buckets. At the end of each frame the buckets are converted
+  * to microseconds, optionally appended to a CSV file and averaged for
+  * the on-screen display.
+  */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "options.h"
+#include "hostprof.h"
+
+UAE_TLS int hostprof_enabled;
+UAE_TLS int hostprof_depth;
+UAE_TLS int hostprof_overflow;
+UAE_TLS uae_u8 hostprof_stack[HOSTPROF_STACK];
+UAE_TLS uae_u64 hostprof_last;
+UAE_TLS uae_u64 hostprof_ticks[HOSTPROF_MAX];
+UAE_TLS uae_u32 hostprof_avg_us[HOSTPROF_MAX + 1];
+UAE_TLS uae_u32 hostprof_lines[2];
+UAE_TLS uae_u32 hostprof_avg_reuse;
+
+const TCHAR *hostprof_names[HOSTPROF_MAX] = {
+	_T("cpu"), _T("blitter"), _T("copper"), _T("audio"), _T("disk"), _T("drawing")
+};
+
+static UAE_TLS FILE *hostprof_csv;
+static UAE_TLS uae_u32 hostprof_frame;
+static UAE_TLS uae_u64 frame_start_ticks;
+static UAE_TLS frame_time_t frame_start_us;
+/* Running tick to microsecond calibration, the tick source may be a TSC */
+static UAE_TLS uae_u64 cal_ticks, cal_us;
+static UAE_TLS uae_u64 sum_us[HOSTPROF_MAX + 1];
+static UAE_TLS uae_u64 sum_lines[2];
+static UAE_TLS int sum_frames;
+/* whole run, for the summary in the log */
+static UAE_TLS uae_u64 total_lines[2];
+
+void hostprof_free (void)
+{
+	uae_u64 lines = total_lines[HOSTPROF_LINES_DRAWN] + total_lines[HOSTPROF_LINES_REUSED];
+
+	if (hostprof_enabled && lines)
+		write_log (_T("HOSTPROF: %llu of %llu lines reused from the previous frame (%u%%)\n"),
+			total_lines[HOSTPROF_LINES_REUSED], lines, (uae_u32)(total_lines[HOSTPROF_LINES_REUSED] * 100 / lines));
+	if (hostprof_csv)
+		fclose (hostprof_csv);
+	hostprof_csv = NULL;
+	hostprof_enabled = 0;
+}
+
+void hostprof_init (bool enable, const TCHAR *csvname)
+{
+	int i;
+
+	hostprof_free ();
+	hostprof_frame = 0;
+	hostprof_depth = hostprof_overflow = 0;
+	cal_ticks = cal_us = 0;
+	sum_frames = 0;
+	for (i = 0; i <= HOSTPROF_MAX; i++) {
+		sum_us[i] = 0;
+		hostprof_avg_us[i] = 0;
+	}
+	for (i = 0; i < HOSTPROF_MAX; i++)
+		hostprof_ticks[i] = 0;
+	for (i = 0; i < 2; i++)
+		hostprof_lines[i] = sum_lines[i] = total_lines[i] = 0;
+	hostprof_avg_reuse = 0;
+	if (!enable)
+		return;
+
+	if (csvname && csvname[0]) {
+		hostprof_csv = fopen (csvname, "w");
+		if (hostprof_csv) {
+			fprintf (hostprof_csv, "frame,total_us");
+			for (i = 0; i < HOSTPROF_MAX; i++)
+				fprintf (hostprof_csv, ",%s_us", hostprof_names[i]);
+			fprintf (hostprof_csv, ",lines_drawn,lines_reused\n");
+		} else {
+			write_log (_T("HOSTPROF: could not create '%s'\n"), csvname);
+		}
+	}
+	hostprof_enabled = 1;
+}
+
+void hostprof_frame_begin (void)
+{
+	if (!hostprof_enabled)
+		return;
+	hostprof_depth = hostprof_overflow = 0;
+	hostprof_stack[0] = HOSTPROF_CPU;
+	hostprof_lines[HOSTPROF_LINES_DRAWN] = hostprof_lines[HOSTPROF_LINES_REUSED] = 0;
+	frame_start_us = read_processor_time ();
+	hostprof_last = frame_start_ticks = hostprof_gettime ();
+}
+
+void hostprof_frame_end (void)
+{
+	uae_u64 t, frame_ticks;
+	uae_u32 us[HOSTPROF_MAX + 1];
+	int i;
+
+	if (!hostprof_enabled)
+		return;
+
+	t = hostprof_gettime ();
+	hostprof_switch (t);
+	frame_ticks = t - frame_start_ticks;
+	cal_ticks += frame_ticks;
+	cal_us += read_processor_time () - frame_start_us;
+	if (!cal_ticks)
+		return;
+
+	us[HOSTPROF_MAX] = 0;
+	for (i = 0; i < HOSTPROF_MAX; i++) {
+		us[i] = (uae_u32)((double)hostprof_ticks[i] * cal_us / cal_ticks);
+		us[HOSTPROF_MAX] += us[i];
+		hostprof_ticks[i] = 0;
+	}
+
+	if (hostprof_csv) {
+		fprintf (hostprof_csv, "%u,%u", hostprof_frame, us[HOSTPROF_MAX]);
+		for (i = 0; i < HOSTPROF_MAX; i++)
+			fprintf (hostprof_csv, ",%u", us[i]);
+		fprintf (hostprof_csv, ",%u,%u\n", hostprof_lines[HOSTPROF_LINES_DRAWN], hostprof_lines[HOSTPROF_LINES_REUSED]);
+	}
+
+	for (i = 0; i <= HOSTPROF_MAX; i++)
+		sum_us[i] += us[i];
+	for (i = 0; i < 2; i++) {
+		sum_lines[i] += hostprof_lines[i];
+		total_lines[i] += hostprof_lines[i];
+	}
+	if (++sum_frames >= HOSTPROF_AVG_FRAMES) {
+		uae_u64 lines = sum_lines[HOSTPROF_LINES_DRAWN] + sum_lines[HOSTPROF_LINES_REUSED];
+		for (i = 0; i <= HOSTPROF_MAX; i++) {
+			hostprof_avg_us[i] = (uae_u32)(sum_us[i] / sum_frames);
+			sum_us[i] = 0;
+		}
+		hostprof_avg_reuse = lines ? (uae_u32)(sum_lines[HOSTPROF_LINES_REUSED] * 100 / lines) : 0;
+		sum_lines[HOSTPROF_LINES_DRAWN] = sum_lines[HOSTPROF_LINES_REUSED] = 0;
+		sum_frames = 0;
+	}
+	hostprof_frame++;
+}
@@ -15,7 +15,7 @@
 #include "inputdevice.h"
 #include "hotkeys.h"
 
-static struct uae_hotkeyseq *hotkey_table;
+static UAE_TLS struct uae_hotkeyseq *hotkey_table;
 
 void set_default_hotkeys (struct uae_hotkeyseq *keys)
 {
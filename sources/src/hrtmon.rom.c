@@ -1,4 +1,4 @@
-unsigned char hrtrom[] = {
+const unsigned char hrtrom[] = {
 	0x1f, 0x8b, 0x08, 0x08, 0xa8, 0xba, 0x39, 0x4d,
 	0x02, 0x03, 0x68, 0x72, 0x74, 0x6d, 0x6f, 0x6e,
 	0x2e, 0x72, 0x6f, 0x6d, 0x00, 0xec, 0xfd, 0x0f,
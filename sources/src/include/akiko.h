@@ -10,6 +10,6 @@ extern void akiko_free (void);
 extern void AKIKO_hsync_handler (void);
 extern void akiko_mute (int);
 
-extern uae_u8 *extendedkickmemory;
+extern UAE_TLS uae_u8 *extendedkickmemory;
 
 extern void rethink_akiko (void);
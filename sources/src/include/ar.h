@@ -27,9 +27,9 @@
 
 extern int action_replay_freeze (void);
 
-extern uaecptr wait_for_pc;
-extern int action_replay_flag;
-extern int armodel;
+extern UAE_TLS uaecptr wait_for_pc;
+extern UAE_TLS int action_replay_flag;
+extern UAE_TLS int armodel;
 
 extern int is_ar_pc_in_rom(void);
 extern int is_ar_pc_in_ram(void);
@@ -51,7 +51,7 @@ extern void REGPARAM3 chipmem_lput_actionreplay1 (uaecptr addr, uae_u32 l) REGPA
 
 extern void action_replay_version (void);
 
-extern int hrtmon_flag;
+extern UAE_TLS int hrtmon_flag;
 
 extern void hrtmon_enter (void);
 extern void hrtmon_breakenter (void);
@@ -62,8 +62,8 @@ extern int hrtmon_load (void);
 extern void hrtmon_map_banks (void);
 
 /*extern uae_u8 *hrtmemory;*/
-extern uae_u32 hrtmem_start, hrtmem_size;
+extern UAE_TLS uae_u32 hrtmem_start, hrtmem_size;
 
-extern uae_u8 ar_custom[2*256], ar_ciaa[16], ar_ciab[16];
+extern UAE_TLS uae_u8 ar_custom[2*256], ar_ciaa[16], ar_ciab[16];
 
-extern int hrtmon_lang;
+extern UAE_TLS int hrtmon_lang;
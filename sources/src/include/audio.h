@@ -42,10 +42,10 @@ extern int audio_activate (void);
 extern void audio_vsync (void);
 
 void switch_audio_interpol (void);
-extern int sound_available;
+extern UAE_TLS int sound_available;
 
 extern void audio_sampleripper(int);
-extern int sampleripper_enabled;
+extern UAE_TLS int sampleripper_enabled;
 extern void write_wavheader (struct zfile *wavfile, uae_u32 size, uae_u32 freq);
 
 enum {
@@ -50,21 +50,21 @@ uaecptr makedatatable (uaecptr resid, uaecptr resname, uae_u8 type, uae_s8 prior
 
 void align (int);
 
-extern volatile int uae_int_requested;
+extern UAE_TLS volatile int uae_int_requested;
 void set_uae_int_flag (void);
 
 #define RTS 0x4e75
 #define RTE 0x4e73
 
-extern uaecptr EXPANSION_explibname, EXPANSION_doslibname, EXPANSION_uaeversion;
-extern uaecptr EXPANSION_explibbase, EXPANSION_uaedevname, EXPANSION_haveV36;
-extern uaecptr EXPANSION_bootcode, EXPANSION_nullfunc;
+extern UAE_TLS uaecptr EXPANSION_explibname, EXPANSION_doslibname, EXPANSION_uaeversion;
+extern UAE_TLS uaecptr EXPANSION_explibbase, EXPANSION_uaedevname, EXPANSION_haveV36;
+extern UAE_TLS uaecptr EXPANSION_bootcode, EXPANSION_nullfunc;
 
-extern uaecptr ROM_filesys_resname, ROM_filesys_resid;
-extern uaecptr ROM_filesys_diagentry;
-extern uaecptr ROM_hardfile_resname, ROM_hardfile_resid;
-extern uaecptr ROM_hardfile_init;
-extern uaecptr filesys_initcode;
+extern UAE_TLS uaecptr ROM_filesys_resname, ROM_filesys_resid;
+extern UAE_TLS uaecptr ROM_filesys_diagentry;
+extern UAE_TLS uaecptr ROM_hardfile_resname, ROM_hardfile_resid;
+extern UAE_TLS uaecptr ROM_hardfile_init;
+extern UAE_TLS uaecptr filesys_initcode;
 
 int is_hardfile (int unit_no);
 int nr_units (void);
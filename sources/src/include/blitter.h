@@ -16,17 +16,17 @@ struct bltinfo {
     int got_cycle;
 };
 
-extern enum blitter_states {
+extern UAE_TLS enum blitter_states {
     BLT_done, BLT_init, BLT_read, BLT_work, BLT_write, BLT_next
 } bltstate;
 
-extern struct bltinfo blt_info;
+extern UAE_TLS struct bltinfo blt_info;
 
-extern int blitter_nasty, blit_interrupt;
+extern UAE_TLS int blitter_nasty, blit_interrupt;
 
 extern uae_u16 bltsize;
-extern uae_u16 bltcon0, bltcon1;
-extern uae_u32 bltapt, bltbpt, bltcpt, bltdpt;
+extern UAE_TLS uae_u16 bltcon0, bltcon1;
+extern UAE_TLS uae_u32 bltapt, bltbpt, bltcpt, bltdpt;
 extern int blit_singlechannel;
 
 extern void maybe_blit (int, int);
@@ -49,7 +49,7 @@ typedef void blitter_func(uaecptr, uaecptr, uaecptr, uaecptr, struct bltinfo *);
 
 extern blitter_func * const blitfunc_dofast[256];
 extern blitter_func * const blitfunc_dofast_desc[256];
-extern uae_u32 blit_masktable[BLITTER_MAX_WORDS];
+extern UAE_TLS uae_u32 blit_masktable[BLITTER_MAX_WORDS];
 
 #define BLIT_MODE_IMMEDIATE -1
 #define BLIT_MODE_APPROXIMATE 0
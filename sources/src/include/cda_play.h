@@ -0,0 +1,34 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * CD audio output
+  *
+  * The CD image player thread fills two buffers of raw 44.1kHz stereo
+  * sectors in turn and queues them, the sound code pulls queued buffers
+  * at the emulated sample rate and mixes them into the Paula output.
+  */
+
+#ifndef UAE_CDA_PLAY_H
+#define UAE_CDA_PLAY_H
+
+#include "uae_types.h"
+
+struct cda_audio
+{
+	uae_u8 *buffers[2];
+	int bufsize;
+	int num_sectors;
+	volatile int queued[2];
+	int playing;
+	int offset;
+	int volume[2];
+};
+
+extern struct cda_audio *cda_audio_new (int num_sectors);
+extern void cda_audio_free (struct cda_audio *cda);
+extern void cda_audio_setvolume (struct cda_audio *cda, int master, int left, int right);
+extern bool cda_audio_play (struct cda_audio *cda, int bufnum);
+extern bool cda_audio_done (struct cda_audio *cda, int bufnum);
+extern void cda_audio_mix (uae_s16 *sndbuffer, int samples);
+
+#endif /* UAE_CDA_PLAY_H */
@@ -43,15 +43,15 @@
 
 static __inline void flush_internals (void) { }
 
-extern int mmu060_state;
+extern UAE_TLS int mmu060_state;
 
-extern int mmu040_movem;
-extern uaecptr mmu040_movem_ea;
+extern UAE_TLS int mmu040_movem;
+extern UAE_TLS uaecptr mmu040_movem_ea;
 
-extern bool mmu_pagesize_8k;
-extern uae_u16 mmu_opcode;
-extern bool mmu_restart;
-extern bool mmu_ttr_enabled;
+extern UAE_TLS bool mmu_pagesize_8k;
+extern UAE_TLS uae_u16 mmu_opcode;
+extern UAE_TLS bool mmu_restart;
+extern UAE_TLS bool mmu_ttr_enabled;
 
 //typedef uae_u8 flagtype;
 
@@ -185,9 +185,9 @@ struct mmu_atc_line {
 #define ATC_SLOTS 16
 #define ATC_TYPE 2
 
-extern uae_u32 mmu_is_super;
-extern uae_u32 mmu_tagmask, mmu_pagemask;
-extern struct mmu_atc_line mmu_atc_array[ATC_TYPE][ATC_WAYS][ATC_SLOTS];
+extern UAE_TLS uae_u32 mmu_is_super;
+extern UAE_TLS uae_u32 mmu_tagmask, mmu_pagemask;
+extern UAE_TLS struct mmu_atc_line mmu_atc_array[ATC_TYPE][ATC_WAYS][ATC_SLOTS];
 
 /*
  * mmu access is a 4 step process:
@@ -200,7 +200,7 @@ static ALWAYS_INLINE bool mmu_lookup(uaecptr addr, bool data, bool write,
 									  struct mmu_atc_line **cl)
 {
 	int way,index;
-	static int way_miss=0;
+	static UAE_TLS int way_miss=0;
 
 	uae_u32 tag = (mmu_is_super | (addr >> 1)) & mmu_tagmask;
 	if (mmu_pagesize_8k)
@@ -230,7 +230,7 @@ static ALWAYS_INLINE bool mmu_user_lookup(uaecptr addr, bool super, bool data,
 										   bool write, struct mmu_atc_line **cl)
 {
 	int way,index;
-	static int way_miss=0;
+	static UAE_TLS int way_miss=0;
 
 	uae_u32 tag = ((super ? 0x80000000 : 0x00000000) | (addr >> 1)) & mmu_tagmask;
 	if (mmu_pagesize_8k)
@@ -3,18 +3,18 @@
 
 #include "mmu_common.h"
 
-extern uae_u64 srp_030, crp_030;
-extern uae_u32 tt0_030, tt1_030, tc_030;
-extern uae_u16 mmusr_030;
+extern UAE_TLS uae_u64 srp_030, crp_030;
+extern UAE_TLS uae_u32 tt0_030, tt1_030, tc_030;
+extern UAE_TLS uae_u16 mmusr_030;
 
 #define MAX_MMU030_ACCESS 10
-extern uae_u32 mm030_stageb_address;
-extern int mmu030_idx;
-extern bool mmu030_retry;
-extern int mmu030_opcode, mmu030_opcode_stageb;
-extern uae_u16 mmu030_state[3];
-extern uae_u32 mmu030_data_buffer;
-extern uae_u32 mmu030_disp_store[2];
+extern UAE_TLS uae_u32 mm030_stageb_address;
+extern UAE_TLS int mmu030_idx;
+extern UAE_TLS bool mmu030_retry;
+extern UAE_TLS int mmu030_opcode, mmu030_opcode_stageb;
+extern UAE_TLS uae_u16 mmu030_state[3];
+extern UAE_TLS uae_u32 mmu030_data_buffer;
+extern UAE_TLS uae_u32 mmu030_disp_store[2];
 
 #define MMU030_STATEFLAG1_MOVEM1 0x4000
 #define MMU030_STATEFLAG1_MOVEM2 0x8000
@@ -26,7 +26,7 @@ struct mmu030_access
 	bool done;
 	uae_u32 val;
 };
-extern struct mmu030_access mmu030_ad[MAX_MMU030_ACCESS];
+extern UAE_TLS struct mmu030_access mmu030_ad[MAX_MMU030_ACCESS];
 
 uae_u32 REGPARAM3 get_disp_ea_020_mmu030 (uae_u32 base, int idx) REGPARAM;
 
@@ -39,19 +39,19 @@ extern void init_row_map (void);
 extern void init_hz_normal (void);
 extern void init_custom (void);
 
-extern bool picasso_requested_on;
-extern bool picasso_on;
+extern UAE_TLS bool picasso_requested_on;
+extern UAE_TLS bool picasso_on;
 extern void set_picasso_hack_rate (int hz);
 
 /* Set to 1 to leave out the current frame in average frame time calculation.
  * Useful if the debugger was active.  */
-extern int bogusframe;
-extern unsigned long int hsync_counter, vsync_counter;
+extern UAE_TLS int bogusframe;
+extern UAE_TLS unsigned long int hsync_counter, vsync_counter;
 
-extern uae_u16 dmacon;
-extern uae_u16 intena, intreq, intreqr;
+extern UAE_TLS uae_u16 dmacon;
+extern UAE_TLS uae_u16 intena, intreq, intreqr;
 
-extern int vpos;
+extern UAE_TLS int vpos;
 
 //extern int find_copper_record (uaecptr, int *, int *);
 
@@ -78,7 +78,7 @@ STATIC_INLINE int dmaen (unsigned int dmamask)
 #define SPCFLAG_END_COMPILE 16384
 #endif
 
-extern uae_u16 adkcon;
+extern UAE_TLS uae_u16 adkcon;
 
 extern unsigned int joy0dir, joy1dir;
 extern int joy0button, joy1button;
@@ -117,13 +117,13 @@ extern uae_u16 INTREQR (void);
 #define EQU_ENDLINE_PAL 8
 #define EQU_ENDLINE_NTSC 10
 
-extern int maxhpos, maxhpos_short;
-extern int maxvpos, maxvpos_nom;
-extern int hsyncstartpos, hsyncendpos;
-extern int minfirstline, vblank_endline, numscrlines;
-extern double vblank_hz, fake_vblank_hz;
-extern int vblank_skip, doublescan;
-extern bool programmedmode;
+extern UAE_TLS int maxhpos, maxhpos_short;
+extern UAE_TLS int maxvpos, maxvpos_nom;
+extern UAE_TLS int hsyncstartpos, hsyncendpos;
+extern UAE_TLS int minfirstline, vblank_endline, numscrlines;
+extern UAE_TLS double vblank_hz, fake_vblank_hz;
+extern UAE_TLS int vblank_skip, doublescan;
+extern UAE_TLS bool programmedmode;
 
 #define DMA_AUD0      0x0001
 #define DMA_AUD1      0x0002
@@ -149,8 +149,8 @@ extern bool programmedmode;
 
 #define CYCLE_MASK 0x0f
 
-extern unsigned long frametime, timeframes;
-extern uae_u16 htotal, vtotal, beamcon0;
+extern UAE_TLS unsigned long frametime, timeframes;
+extern UAE_TLS uae_u16 htotal, vtotal, beamcon0;
 
 /* 100 words give you 1600 horizontal pixels. Should be more than enough for
  * superhires. Don't forget to update the definition in genp2c.c as well.
@@ -169,11 +169,11 @@ extern uae_u32 lorestab_l[256][2];
 
 #ifdef AGA
 /* AGA mode color lookup tables */
-extern unsigned int xredcolors[256], xgreencolors[256], xbluecolors[256];
+extern UAE_TLS unsigned int xredcolors[256], xgreencolors[256], xbluecolors[256];
 #endif
-extern int xredcolor_s, xredcolor_b, xredcolor_m;
-extern int xgreencolor_s, xgreencolor_b, xgreencolor_m;
-extern int xbluecolor_s, xbluecolor_b, xbluecolor_m;
+extern UAE_TLS int xredcolor_s, xredcolor_b, xredcolor_m;
+extern UAE_TLS int xgreencolor_s, xgreencolor_b, xgreencolor_m;
+extern UAE_TLS int xbluecolor_s, xbluecolor_b, xbluecolor_m;
 
 #define RES_LORES 0
 #define RES_HIRES 1
@@ -213,8 +213,8 @@ STATIC_INLINE int GET_PLANES(uae_u16 bplcon0)
 }
 
 extern void fpscounter_reset (void);
-extern unsigned long idletime;
-extern int lightpen_x, lightpen_y, lightpen_cx, lightpen_cy, lightpen_active;
+extern UAE_TLS unsigned long idletime;
+extern UAE_TLS int lightpen_x, lightpen_y, lightpen_cx, lightpen_cy, lightpen_active;
 
 struct customhack {
 	uae_u16 v;
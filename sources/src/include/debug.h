@@ -12,15 +12,15 @@
 #define	MAX_HIST 500
 #define MAX_LINEWIDTH 100
 
-extern int debugging;
-extern int exception_debugging;
-extern int debug_copper;
-extern int debug_dma;
-extern int debug_sprite_mask;
-extern int debug_bpl_mask, debug_bpl_mask_one;
-extern int debugger_active;
-extern int debug_illegal;
-extern uae_u64 debug_illegal_mask;
+extern UAE_TLS int debugging;
+extern UAE_TLS int exception_debugging;
+extern UAE_TLS int debug_copper;
+extern UAE_TLS int debug_dma;
+extern UAE_TLS int debug_sprite_mask;
+extern UAE_TLS int debug_bpl_mask, debug_bpl_mask_one;
+extern UAE_TLS int debugger_active;
+extern UAE_TLS int debug_illegal;
+extern UAE_TLS uae_u64 debug_illegal_mask;
 
 extern void debug (void);
 extern void debugger_change (int mode);
@@ -48,7 +48,7 @@ struct breakpoint_node {
     uaecptr addr;
     int enabled;
 };
-extern struct breakpoint_node bpnodes[BREAKPOINT_TOTAL];
+extern UAE_TLS struct breakpoint_node bpnodes[BREAKPOINT_TOTAL];
 
 #define MEMWATCH_TOTAL 20
 struct memwatch_node {
@@ -63,7 +63,7 @@ struct memwatch_node {
 	int frozen;
 	uaecptr pc;
 };
-extern struct memwatch_node mwnodes[MEMWATCH_TOTAL];
+extern UAE_TLS struct memwatch_node mwnodes[MEMWATCH_TOTAL];
 
 extern void memwatch_dump2 (TCHAR *buf, int bufsize, int num);
 
@@ -118,6 +118,13 @@ struct dma_rec
 extern struct dma_rec *record_dma (uae_u16 reg, uae_u16 dat, uae_u32 addr, int hpos, int vpos, int type);
 extern void record_dma_reset (void);
 extern void record_dma_event (int evt, int hpos, int vpos);
+
+extern UAE_TLS int pcprof_enabled;
+extern void pcprof_init (bool enable, const TCHAR *reportname);
+extern void pcprof_free (void);
+extern void pcprof_sample (void);
+extern void pcprof_report (void);
+
 extern void debug_draw_cycles (uae_u8 *buf, int bpp, int line, int width, int height, uae_u32 *xredcolors, uae_u32 *xgreencolors, uae_u32 *xbluescolors);
 
 #else
@@ -50,9 +50,9 @@ extern uae_u16 disk_dmal (void);
 extern uaecptr disk_getpt (void);
 extern int disk_fifostatus (void);
 
-extern int disk_debug_logging;
-extern int disk_debug_mode;
-extern int disk_debug_track;
+extern UAE_TLS int disk_debug_logging;
+extern UAE_TLS int disk_debug_mode;
+extern UAE_TLS int disk_debug_track;
 #define DISK_DEBUG_DMA_READ 1
 #define DISK_DEBUG_DMA_WRITE 2
 #define DISK_DEBUG_PIO 4
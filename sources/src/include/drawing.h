@@ -43,8 +43,8 @@
 #define min_diwlastword (0)
 #define max_diwlastword (PIXEL_XPOS(0x1d4 >> 1))
 
-extern int lores_factor, lores_shift, interlace_seen;
-extern bool aga_mode, direct_rgb;
+extern UAE_TLS int lores_factor, lores_shift, interlace_seen;
+extern UAE_TLS bool aga_mode, direct_rgb;
 
 STATIC_INLINE int coord_hw_to_window_x (int x)
 {
@@ -69,7 +69,9 @@ STATIC_INLINE int coord_window_to_diw_x (int x)
 	return x - DIW_DDF_OFFSET;
 }
 
-extern int framecnt;
+extern UAE_TLS int framecnt;
+/* current frame is emulated without rendering (headless mode) */
+extern UAE_TLS bool frame_headless;
 
 
 /* color values in two formats: 12 (OCS/ECS) or 24 (AGA) bit Amiga RGB (color_regs),
@@ -196,22 +198,27 @@ union sps_union {
 	uae_u8 bytes[2 * MAX_SPR_PIXELS];
 	uae_u32 words[2 * MAX_SPR_PIXELS / 4];
 };
-extern union sps_union spixstate;
+extern UAE_TLS union sps_union spixstate;
 
 #ifdef OS_WITHOUT_MEMORY_MANAGEMENT
-extern uae_u16 *spixels;
+extern UAE_TLS uae_u16 *spixels;
 #else
-extern uae_u16 spixels[MAX_SPR_PIXELS * 2];
+extern UAE_TLS uae_u16 spixels[MAX_SPR_PIXELS * 2];
 #endif
 
+/* Sprite coverage, one bit for every pixel in spixels that is not zero,
+   lowest bit first.  Lets the line passes step over empty words. */
+#define SPIXMASK_WORDS ((MAX_SPR_PIXELS * 2 + 31) / 32)
+extern UAE_TLS uae_u32 spixmask[SPIXMASK_WORDS];
+
 /* Way too much... */
 #define MAX_REG_CHANGE ((MAXVPOS + 1) * 2 * MAXHPOS)
 
-extern struct color_entry *curr_color_tables, *prev_color_tables;
+extern UAE_TLS struct color_entry *curr_color_tables, *prev_color_tables;
 
-extern struct sprite_entry *curr_sprite_entries, *prev_sprite_entries;
-extern struct color_change *curr_color_changes, *prev_color_changes;
-extern struct draw_info *curr_drawinfo, *prev_drawinfo;
+extern UAE_TLS struct sprite_entry *curr_sprite_entries, *prev_sprite_entries;
+extern UAE_TLS struct color_change *curr_color_changes, *prev_color_changes;
+extern UAE_TLS struct draw_info *curr_drawinfo, *prev_drawinfo;
 
 /* struct decision contains things we save across drawing frames for
  * comparison (smart update stuff). */
@@ -242,9 +249,9 @@ struct draw_info {
 	int nr_color_changes, nr_sprites;
 };
 
-extern struct decision line_decisions[2 * (MAXVPOS + 2) + 1];
+extern UAE_TLS struct decision line_decisions[2 * (MAXVPOS + 2) + 1];
 
-extern uae_u8 line_data[(MAXVPOS + 2) * 2][MAX_PLANES * MAX_WORDS_PER_LINE * 2];
+extern UAE_TLS uae_u8 line_data[(MAXVPOS + 2) * 2][MAX_PLANES * MAX_WORDS_PER_LINE * 2];
 
 /* Functions in drawing.c.  */
 extern int coord_native_to_amiga_y (int);
@@ -284,13 +291,14 @@ extern void putpixel (uae_u8 *buf, int bpp, int x, xcolnr c8, int opaq);
 
 /* Finally, stuff that shouldn't really be shared.  */
 
-extern int thisframe_first_drawn_line, thisframe_last_drawn_line;
+extern UAE_TLS int thisframe_first_drawn_line, thisframe_last_drawn_line;
 
 #define IHF_SCROLLLOCK 0
 #define IHF_QUIT_PROGRAM 1
 #define IHF_PICASSO 2
+#define IHF_INPREC 3
 
-extern int inhibit_frame;
+extern UAE_TLS int inhibit_frame;
 
 STATIC_INLINE void set_inhibit_frame (int bit)
 {
@@ -33,11 +33,11 @@
  */
 #define OFFICIAL_CYCLE_UNIT 512
 
-extern frame_time_t vsyncmintime, vsyncmaxtime, vsyncwaittime;
-extern int vsynctimebase, syncbase;
+extern UAE_TLS frame_time_t vsyncmintime, vsyncmaxtime, vsyncwaittime;
+extern UAE_TLS int vsynctimebase, syncbase;
 extern void reset_frame_rate_hack (void);
-extern unsigned long int vsync_cycles;
-extern unsigned long start_cycles;
+extern UAE_TLS unsigned long int vsync_cycles;
+extern UAE_TLS unsigned long start_cycles;
 
 extern void compute_vsynctime (void);
 extern void init_eventtab (void);
@@ -48,8 +48,8 @@ extern void do_cycles_fast (unsigned long cycles_to_add);
 
 extern int is_cycle_ce (void);
 
-extern unsigned long currcycle, nextevent;
-extern int is_syncline, is_syncline_end;
+extern UAE_TLS unsigned long currcycle, nextevent;
+extern UAE_TLS int is_syncline, is_syncline_end;
 typedef void (*evfunc)(void);
 typedef void (*evfunc2)(uae_u32);
 
@@ -80,14 +80,14 @@ enum {
     ev2_max = 12
 };
 
-extern int pissoff_value;
-extern signed long pissoff;
+extern UAE_TLS int pissoff_value;
+extern UAE_TLS signed long pissoff;
 
 #define countdown pissoff
 #define do_cycles do_cycles_slow
 
-extern struct ev eventtab[ev_max];
-extern struct ev2 eventtab2[ev2_max];
+extern UAE_TLS struct ev eventtab[ev_max];
+extern UAE_TLS struct ev2 eventtab2[ev2_max];
 
 STATIC_INLINE void cycles_do_special (void)
 {
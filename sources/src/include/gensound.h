@@ -7,11 +7,11 @@
   * Copyright 1997 Bernd Schmidt
   */
 
-extern int sound_available;
+extern UAE_TLS int sound_available;
 
-extern void (*sample_handler) (void);
+extern UAE_TLS void (*sample_handler) (void);
 
-extern unsigned int obtainedfreq;
+extern UAE_TLS unsigned int obtainedfreq;
 
 /* Determine if we can produce any sound at all.  This can be only a guess;
  * if unsure, say yes.  Any call to init_sound may change the value.  */
@@ -24,7 +24,7 @@ extern void gui_display (int shortcut);
 extern void gui_gameport_button_change (int port, int button, int onoff);
 extern void gui_gameport_axis_change (int port, int axis, int state, int max);
 
-extern bool no_gui, quit_to_gui;
+extern UAE_TLS bool no_gui, quit_to_gui;
 
 #define LED_CD_ACTIVE 1
 #define LED_CD_ACTIVE2 2
@@ -68,7 +68,7 @@ struct gui_info
 #define NUM_LEDS (LED_MAX)
 #define VISIBLE_LEDS (LED_MAX - 1)
 
-extern struct gui_info gui_data;
+extern UAE_TLS struct gui_info gui_data;
 
 /* Functions to be called when prefs are changed by non-gui code.  */
 extern void gui_update_gfx (void);
@@ -0,0 +1,101 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Host time accounting per emulated subsystem
+  *
+  * Each instrumented entry point switches the "current" bucket, so time
+  * is attributed exclusively: a blit started by a copper write is charged
+  * to the blitter, not to both. Whatever is not covered by a probe (CPU
+  * core, events, CIA...) stays in HOSTPROF_CPU.
+  */
+
+#ifndef UAE_HOSTPROF_H
+#define UAE_HOSTPROF_H
+
+#include "uae_types.h"
+#include <time.h>
+#include "machdep/rpt.h"
+
+enum {
+	HOSTPROF_CPU,
+	HOSTPROF_BLITTER,
+	HOSTPROF_COPPER,
+	HOSTPROF_AUDIO,
+	HOSTPROF_DISK,
+	HOSTPROF_DRAWING,
+	HOSTPROF_MAX
+};
+
+#define HOSTPROF_STACK 8
+/* Frames averaged for the on-screen display */
+#define HOSTPROF_AVG_FRAMES 50
+
+extern UAE_TLS int hostprof_enabled;
+extern UAE_TLS int hostprof_depth;
+/* enters past the top of the stack, their leaves pop nothing */
+extern UAE_TLS int hostprof_overflow;
+extern UAE_TLS uae_u8 hostprof_stack[HOSTPROF_STACK];
+extern UAE_TLS uae_u64 hostprof_last;
+extern UAE_TLS uae_u64 hostprof_ticks[HOSTPROF_MAX];
+/* Per-bucket host time in microseconds, averaged over HOSTPROF_AVG_FRAMES */
+extern UAE_TLS uae_u32 hostprof_avg_us[HOSTPROF_MAX + 1];
+
+/* Emulated lines rendered and lines left as drawn in the previous frame
+ * because nothing on them changed, counted by hsync_record_line_state () */
+enum {
+	HOSTPROF_LINES_DRAWN,
+	HOSTPROF_LINES_REUSED
+};
+extern UAE_TLS uae_u32 hostprof_lines[2];
+/* Percentage of reused lines, averaged like hostprof_avg_us */
+extern UAE_TLS uae_u32 hostprof_avg_reuse;
+
+extern const TCHAR *hostprof_names[HOSTPROF_MAX];
+
+STATIC_INLINE uae_u64 hostprof_gettime (void)
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	return __builtin_ia32_rdtsc ();
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uae_u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+	return read_processor_time ();
+#endif
+}
+
+STATIC_INLINE void hostprof_switch (uae_u64 t)
+{
+	hostprof_ticks[hostprof_stack[hostprof_depth]] += t - hostprof_last;
+	hostprof_last = t;
+}
+
+STATIC_INLINE void hostprof_enter (int bucket)
+{
+	if (hostprof_enabled) {
+		hostprof_switch (hostprof_gettime ());
+		if (hostprof_depth < HOSTPROF_STACK - 1)
+			hostprof_stack[++hostprof_depth] = bucket;
+		else
+			hostprof_overflow++;
+	}
+}
+
+STATIC_INLINE void hostprof_leave (void)
+{
+	if (hostprof_enabled) {
+		hostprof_switch (hostprof_gettime ());
+		if (hostprof_overflow > 0)
+			hostprof_overflow--;
+		else if (hostprof_depth > 0)
+			hostprof_depth--;
+	}
+}
+
+extern void hostprof_init (bool enable, const TCHAR *csvname);
+extern void hostprof_free (void);
+extern void hostprof_frame_begin (void);
+extern void hostprof_frame_end (void);
+
+#endif /* UAE_HOSTPROF_H */
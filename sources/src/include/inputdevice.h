@@ -47,10 +47,10 @@ struct inputdevice_functions {
 	int	(*get_widget_first)	(int,int);
 	int	(*get_flags)		(int);
 };
-extern struct inputdevice_functions inputdevicefunc_joystick;
-extern struct inputdevice_functions inputdevicefunc_mouse;
-extern struct inputdevice_functions inputdevicefunc_keyboard;
-extern int pause_emulation;
+extern UAE_TLS struct inputdevice_functions inputdevicefunc_joystick;
+extern UAE_TLS struct inputdevice_functions inputdevicefunc_mouse;
+extern UAE_TLS struct inputdevice_functions inputdevicefunc_keyboard;
+extern UAE_TLS int pause_emulation;
 
 struct uae_input_device_default_node
 {
@@ -219,7 +219,7 @@ void inputdevice_compa_clear (struct uae_prefs *prefs, int index);
 int intputdevice_compa_get_eventtype (int evt, const int **axistable);
 void inputdevice_sparecopy (struct uae_input_device *uid, int num, int sub);
 
-uae_u16 potgo_value;
+extern UAE_TLS uae_u16 potgo_value;
 uae_u16 POTGOR (void);
 void POTGO (uae_u16 v);
 uae_u16 POT0DAT (void);
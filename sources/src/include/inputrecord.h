@@ -6,7 +6,7 @@
   * Copyright 2010 Toni Wilen
   */
 
-extern int inputrecord_debug;
+extern UAE_TLS int inputrecord_debug;
 
 //#define INPREC_JOYPORT 1
 //#define INPREC_JOYBUTTON 2
@@ -16,9 +16,11 @@ extern int inputrecord_debug;
 //#define INPREC_VSYNC 6
 //#define INPREC_CIAVSYNC 7
 #define INPREC_EVENT 8
+#define INPREC_SNAPSHOT 9
 #define INPREC_CIADEBUG 0x61
 #define INPREC_DEBUG 0x62
 #define INPREC_DEBUG2 0x63
+#define INPREC_INDEX 0x7c
 #define INPREC_STOP 0x7d
 #define INPREC_END 0x7e
 #define INPREC_QUIT 0x7f
@@ -30,11 +32,12 @@ extern int inputrecord_debug;
 #define INPREC_PLAY_NORMAL 1
 #define INPREC_PLAY_RERECORD 2
 
-extern int input_record, input_play;
+extern UAE_TLS int input_record, input_play;
 extern void inprec_close (bool);
 //extern void inprec_save (const TCHAR*, const TCHAR*);
 extern int inprec_open (const TCHAR*, const TCHAR*);
 extern bool inprec_prepare_record (const TCHAR*);
+extern void inprec_start (const TCHAR *fname, bool record);
 extern void inprec_playtorecord (void);
 extern void inprec_startup (void);
 
@@ -52,6 +55,8 @@ extern void inprec_playdebug_cia (uae_u32, uae_u32, uae_u32);
 
 extern int inprec_getposition (void);
 extern void inprec_setposition (int offset, int replaycounter);
+extern bool inprec_seek (uae_u32 hsync);
+extern void inprec_vsync (void);
 extern bool inprec_realtimev (void);
 extern void inprec_getstatus (TCHAR*);
 
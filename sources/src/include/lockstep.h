@@ -0,0 +1,51 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Deterministic lockstep mode
+  *
+  * With lockstep on, nothing the host does reaches the emulated machine
+  * except its input: wall clock reads come from a clock that counts
+  * emulated scanlines, random numbers from a private generator seeded
+  * with the line counter and a fixed seed, and the CPU gets no extra
+  * time when the host is fast. Two runs fed the same input produce the
+  * same frames, so netplay peers and replays only exchange input.
+  */
+
+#ifndef UAE_LOCKSTEP_H
+#define UAE_LOCKSTEP_H
+
+#include <time.h>
+
+#include "uae_types.h"
+
+/* 2000-01-01 00:00:00 UTC, the emulated clock starts here at hard reset */
+#define LOCKSTEP_EPOCH 946684800
+
+#define LOCKSTEP_SELFTEST_FRAMES 250
+
+enum {
+	LOCKSTEP_MOUSE,
+	LOCKSTEP_MOUSE_BUTTON,
+	LOCKSTEP_JOY,
+	LOCKSTEP_JOY_BUTTON,
+	LOCKSTEP_KEY
+};
+
+extern void lockstep_reset (void);
+extern void lockstep_hsync (void);
+extern void lockstep_vsync (void);
+
+/* microseconds since 1970, emulated in lockstep mode */
+extern uae_u64 lockstep_usec (void);
+extern time_t lockstep_time (void);
+/* lockstep mode has no time zone */
+extern struct tm *lockstep_localtime (const time_t *t);
+/* restarts the sequence whenever seed changes */
+extern uae_u32 lockstep_rand (uae_u32 seed);
+
+/* target input goes through here first, true drops it */
+extern bool lockstep_input (int type, int port, int a, int b);
+/* runs frames twice from one snapshot with the same input, compares digests */
+extern void lockstep_selftest (int frames);
+
+#endif /* UAE_LOCKSTEP_H */
@@ -0,0 +1,24 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Fast LZ77 block compressor
+  *
+  * Byte oriented, 64k window, no entropy coding. Compresses several
+  * hundred megabytes per second, used where zlib would stall the
+  * emulation (memory chunks of quick statefiles).
+  */
+
+#ifndef UAE_LZFAST_H
+#define UAE_LZFAST_H
+
+#include "uae_types.h"
+
+/* worst case compressed size of len bytes */
+#define LZFAST_BOUND(len) ((len) + (len) / 255 + 16)
+
+/* returns compressed size, 0 if it does not fit in dstlen */
+extern int lzfast_compress (const uae_u8 *src, int srclen, uae_u8 *dst, int dstlen);
+/* returns decompressed size, -1 if the data is corrupt */
+extern int lzfast_decompress (const uae_u8 *src, int srclen, uae_u8 *dst, int dstlen);
+
+#endif /* UAE_LZFAST_H */
@@ -27,8 +27,8 @@ void free_shm (void);
 bool preinit_shm (void);
 #endif
 
-extern bool canbang;
-extern int candirect;
+extern UAE_TLS bool canbang;
+extern UAE_TLS int candirect;
 #endif
 
 #ifdef ADDRESS_SPACE_24BIT
@@ -45,16 +45,16 @@ typedef uae_u8 *(REGPARAM3 *xlate_func)(uaecptr) REGPARAM;
 typedef int (REGPARAM3 *check_func)(uaecptr, uae_u32) REGPARAM;
 
 extern uae_u8 *address_space, *good_address_map;
-extern uae_u8 *chipmemory;
-
-extern uae_u32 allocated_chipmem;
-extern uae_u32 allocated_fastmem;
-extern uae_u32 allocated_bogomem;
-extern uae_u32 allocated_gfxmem;
-extern uae_u32 allocated_z3fastmem, allocated_z3fastmem2, allocated_z3chipmem;
-extern uae_u32 max_z3fastmem;
+extern UAE_TLS uae_u8 *chipmemory;
+
+extern UAE_TLS uae_u32 allocated_chipmem;
+extern UAE_TLS uae_u32 allocated_fastmem;
+extern UAE_TLS uae_u32 allocated_bogomem;
+extern UAE_TLS uae_u32 allocated_gfxmem;
+extern UAE_TLS uae_u32 allocated_z3fastmem, allocated_z3fastmem2, allocated_z3chipmem;
+extern UAE_TLS uae_u32 max_z3fastmem;
 extern uae_u32 allocated_a3000mem;
-extern uae_u32 allocated_cardmem;
+extern UAE_TLS uae_u32 allocated_cardmem;
 
 extern uae_u32 wait_cpu_cycle_read (uaecptr addr, int mode);
 extern void wait_cpu_cycle_write (uaecptr addr, int mode, uae_u32 v);
@@ -74,19 +74,19 @@ extern void wait_cpu_cycle_write_ce020 (uaecptr addr, int mode, uae_u32 v);
 #define bogomem_start 0x00C00000
 #define cardmem_start 0x00E00000
 #define kickmem_start 0x00F80000
-extern uaecptr z3fastmem_start, z3fastmem2_start, z3chipmem_start;
-extern uaecptr p96ram_start;
-extern uaecptr fastmem_start;
-extern uaecptr a3000lmem_start, a3000hmem_start;
+extern UAE_TLS uaecptr z3fastmem_start, z3fastmem2_start, z3chipmem_start;
+extern UAE_TLS uaecptr p96ram_start;
+extern UAE_TLS uaecptr fastmem_start;
+extern UAE_TLS uaecptr a3000lmem_start, a3000hmem_start;
 
 extern bool ersatzkickfile;
-extern bool cloanto_rom, kickstart_rom;
-extern uae_u16 kickstart_version;
-extern bool uae_boot_rom;
-extern int uae_boot_rom_size;
-extern uaecptr rtarea_base;
+extern UAE_TLS bool cloanto_rom, kickstart_rom;
+extern UAE_TLS uae_u16 kickstart_version;
+extern UAE_TLS bool uae_boot_rom;
+extern UAE_TLS int uae_boot_rom_size;
+extern UAE_TLS uaecptr rtarea_base;
 
-extern uae_u8* baseaddr[];
+extern UAE_TLS uae_u8* baseaddr[];
 
 enum { ABFLAG_UNK = 0, ABFLAG_RAM = 1, ABFLAG_ROM = 2, ABFLAG_ROMIN = 4, ABFLAG_IO = 8, ABFLAG_NONE = 16, ABFLAG_SAFE = 32 };
 typedef struct {
@@ -118,29 +118,31 @@ typedef struct {
 #define CE_MEMBANK_CHIP 1
 #define CE_MEMBANK_CIA 2
 #define CE_MEMBANK_FAST16BIT 3
-extern uae_u8 ce_banktype[65536], ce_cachable[65536];
+extern UAE_TLS uae_u8 ce_banktype[65536], ce_cachable[65536];
 
-extern uae_u8 *filesysory;
-extern uae_u8 *rtarea;
+extern UAE_TLS uae_u8 *filesysory;
+extern UAE_TLS uae_u8 *rtarea;
 
-extern addrbank chipmem_bank;
+extern UAE_TLS addrbank chipmem_bank;
 extern addrbank chipmem_agnus_bank;
-extern addrbank chipmem_bank_ce2;
-extern addrbank kickmem_bank;
-extern addrbank custom_bank;
-extern addrbank clock_bank;
-extern addrbank cia_bank;
-extern addrbank rtarea_bank;
-extern addrbank expamem_bank;
-extern addrbank fastmem_bank;
-extern addrbank gfxmem_bank;
+extern UAE_TLS addrbank chipmem_bank_ce2;
+extern UAE_TLS addrbank kickmem_bank;
+extern UAE_TLS addrbank custom_bank;
+extern UAE_TLS addrbank clock_bank;
+extern UAE_TLS addrbank cia_bank;
+extern UAE_TLS addrbank rtarea_bank;
+extern UAE_TLS addrbank expamem_bank;
+extern UAE_TLS addrbank fastmem_bank;
+extern UAE_TLS addrbank bogomem_bank;
+extern UAE_TLS addrbank z3fastmem_bank;
+extern UAE_TLS addrbank gfxmem_bank;
 #ifdef GAYLE
-extern addrbank gayle_bank;
-extern addrbank gayle2_bank;
+extern UAE_TLS addrbank gayle_bank;
+extern UAE_TLS addrbank gayle2_bank;
 #endif // GAYLE
-extern addrbank mbres_bank;
-extern addrbank akiko_bank;
-extern addrbank cardmem_bank;
+extern UAE_TLS addrbank mbres_bank;
+extern UAE_TLS addrbank akiko_bank;
+extern UAE_TLS addrbank cardmem_bank;
 
 extern void rtarea_init (void);
 extern void rtarea_init_mem (void);
@@ -149,10 +151,10 @@ extern void expamem_init (void);
 extern void expamem_reset (void);
 extern void expamem_next (void);
 
-extern uae_u32 gfxmem_start;
-extern uae_u8 *gfxmemory;
-extern uae_u32 gfxmem_mask;
-extern uae_u16 last_custom_value1;
+extern UAE_TLS uae_u32 gfxmem_start;
+extern UAE_TLS uae_u8 *gfxmemory;
+extern UAE_TLS uae_u32 gfxmem_mask;
+extern UAE_TLS uae_u16 last_custom_value1;
 
 /* Default memory access functions */
 
@@ -164,10 +166,10 @@ extern uae_u32 REGPARAM3 dummy_wgeti (uaecptr addr) REGPARAM;
 
 #define bankindex(addr) (((uaecptr)(addr)) >> 16)
 
-extern addrbank *mem_banks[MEMORY_BANKS];
+extern UAE_TLS addrbank *mem_banks[MEMORY_BANKS];
 
 #ifdef JIT
-extern uae_u8 *baseaddr[MEMORY_BANKS];
+extern UAE_TLS uae_u8 *baseaddr[MEMORY_BANKS];
 #endif
 
 #define get_mem_bank(addr) (*mem_banks[bankindex(addr)])
@@ -325,22 +327,22 @@ extern void REGPARAM3 chipmem_bput (uaecptr, uae_u32) REGPARAM;
 extern uae_u32 REGPARAM3 chipmem_agnus_wget (uaecptr) REGPARAM;
 extern void REGPARAM3 chipmem_agnus_wput (uaecptr, uae_u32) REGPARAM;
 
-extern uae_u32 chipmem_mask, kickmem_mask;
-extern uae_u8 *kickmemory;
-extern uae_u32 kickmem_size;
-extern addrbank dummy_bank;
+extern UAE_TLS uae_u32 chipmem_mask, chipmem_full_size, kickmem_mask;
+extern UAE_TLS uae_u8 *kickmemory;
+extern UAE_TLS uae_u32 kickmem_size;
+extern UAE_TLS addrbank dummy_bank;
 
 /* 68020+ Chip RAM DMA contention emulation */
 extern void REGPARAM3 chipmem_bput_c2 (uaecptr, uae_u32) REGPARAM;
 
-extern uae_u32 (REGPARAM3 *chipmem_lget_indirect)(uaecptr) REGPARAM;
-extern uae_u32 (REGPARAM3 *chipmem_wget_indirect)(uaecptr) REGPARAM;
-extern uae_u32 (REGPARAM3 *chipmem_bget_indirect)(uaecptr) REGPARAM;
-extern void (REGPARAM3 *chipmem_lput_indirect)(uaecptr, uae_u32) REGPARAM;
-extern void (REGPARAM3 *chipmem_wput_indirect)(uaecptr, uae_u32) REGPARAM;
-extern void (REGPARAM3 *chipmem_bput_indirect)(uaecptr, uae_u32) REGPARAM;
-extern int (REGPARAM3 *chipmem_check_indirect)(uaecptr, uae_u32) REGPARAM;
-extern uae_u8 *(REGPARAM3 *chipmem_xlate_indirect)(uaecptr) REGPARAM;
+extern UAE_TLS uae_u32 (REGPARAM3 *chipmem_lget_indirect)(uaecptr) REGPARAM;
+extern UAE_TLS uae_u32 (REGPARAM3 *chipmem_wget_indirect)(uaecptr) REGPARAM;
+extern UAE_TLS uae_u32 (REGPARAM3 *chipmem_bget_indirect)(uaecptr) REGPARAM;
+extern UAE_TLS void (REGPARAM3 *chipmem_lput_indirect)(uaecptr, uae_u32) REGPARAM;
+extern UAE_TLS void (REGPARAM3 *chipmem_wput_indirect)(uaecptr, uae_u32) REGPARAM;
+extern UAE_TLS void (REGPARAM3 *chipmem_bput_indirect)(uaecptr, uae_u32) REGPARAM;
+extern UAE_TLS int (REGPARAM3 *chipmem_check_indirect)(uaecptr, uae_u32) REGPARAM;
+extern UAE_TLS uae_u8 *(REGPARAM3 *chipmem_xlate_indirect)(uaecptr) REGPARAM;
 
 #ifdef NATMEM_OFFSET
 
@@ -24,8 +24,8 @@ struct m68k_exception {
 #else
 /* we are in plain C, just use a stack of long jumps */
 #include <setjmp.h>
-extern jmp_buf __exbuf;
-extern int     __exvalue;
+extern UAE_TLS jmp_buf __exbuf;
+extern UAE_TLS int     __exvalue;
 /*
 #define TRY(DUMMY)       __exvalue=setjmp(__exbuf);       \
                   if (__exvalue==0) { __pushtry(&__exbuf);
@@ -44,7 +44,7 @@ void native2amiga_startup (void);
  * by PutMsg() with (uae_u32)1/(uaecptr)port/(uaecptr)msg and by
  * ReplyMsg() with (uae_u32)2/(uaecptr)msg.
  * It's emptied via exter_int_helper by the EXTER interrupt. */
-extern smp_comm_pipe native2amiga_pending;
+extern UAE_TLS smp_comm_pipe native2amiga_pending;
 #endif
 
 STATIC_INLINE void do_uae_int_requested (void)
@@ -37,9 +37,9 @@
 extern const int areg_byteinc[];
 extern const int imm8_table[];
 
-extern int movem_index1[256];
-extern int movem_index2[256];
-extern int movem_next[256];
+extern UAE_TLS int movem_index1[256];
+extern UAE_TLS int movem_index2[256];
+extern UAE_TLS int movem_next[256];
 
 #ifdef FPUEMU
 extern int fpp_movem_index1[256];
@@ -65,7 +65,7 @@ struct comptbl {
 };
 #endif
 
-extern uae_u32 REGPARAM3 op_illg (uae_u32) REGPARAM;
+extern uae_u32 REGPARAM3 op_illg (uae_u32) REGPARAM UAE_COLD;
 extern void REGPARAM3 op_unimpl (uae_u16) REGPARAM;
 
 typedef uae_u8 flagtype;
@@ -123,7 +123,7 @@ struct mmufixup
     int reg;
     uae_u32 value;
 };
-extern struct mmufixup mmufixup[2];
+extern UAE_TLS struct mmufixup mmufixup[2];
 
 struct regstruct
 {
@@ -186,7 +186,7 @@ struct regstruct
 	int ce020tmpcycles;
 };
 
-extern struct regstruct regs;
+extern UAE_TLS struct regstruct regs;
 
 #define MAX_CPUTRACESIZE 128
 struct cputracememory
@@ -224,9 +224,9 @@ STATIC_INLINE uae_u32 munge24 (uae_u32 x)
 	return x & regs.address_space_mask;
 }
 
-extern int mmu_enabled, mmu_triggered;
-extern int cpu_cycles;
-extern int cpucycleunit;
+extern UAE_TLS int mmu_enabled, mmu_triggered;
+extern UAE_TLS int cpu_cycles;
+extern UAE_TLS int cpucycleunit;
 STATIC_INLINE void set_special (uae_u32 x)
 {
 	regs.spcflags |= x;
@@ -346,34 +346,34 @@ STATIC_INLINE uae_u32 next_ilongi (void)
 	return r;
 }
 
-uae_u32 (*x_prefetch)(int);
-uae_u32 (*x_prefetch_long)(int);
-uae_u32 (*x_get_byte)(uaecptr addr);
-uae_u32 (*x_get_word)(uaecptr addr);
-uae_u32 (*x_get_long)(uaecptr addr);
-void (*x_put_byte)(uaecptr addr, uae_u32 v);
-void (*x_put_word)(uaecptr addr, uae_u32 v);
-void (*x_put_long)(uaecptr addr, uae_u32 v);
-uae_u32 (*x_next_iword)(void);
-uae_u32 (*x_next_ilong)(void);
-uae_u32 (*x_get_ilong)(int);
-uae_u32 (*x_get_iword)(int);
-uae_u32 (*x_get_ibyte)(int);
-
-uae_u32 (*x_cp_get_byte)(uaecptr addr);
-uae_u32 (*x_cp_get_word)(uaecptr addr);
-uae_u32 (*x_cp_get_long)(uaecptr addr);
-void (*x_cp_put_byte)(uaecptr addr, uae_u32 v);
-void (*x_cp_put_word)(uaecptr addr, uae_u32 v);
-void (*x_cp_put_long)(uaecptr addr, uae_u32 v);
-uae_u32 (*x_cp_next_iword)(void);
-uae_u32 (*x_cp_next_ilong)(void);
-
-uae_u32 (REGPARAM3 *x_cp_get_disp_ea_020)(uae_u32 base, int idx) REGPARAM;
-
-void (*x_do_cycles)(unsigned long);
-void (*x_do_cycles_pre)(unsigned long);
-void (*x_do_cycles_post)(unsigned long, uae_u32);
+extern UAE_TLS uae_u32 (*x_prefetch)(int);
+extern UAE_TLS uae_u32 (*x_prefetch_long)(int);
+extern UAE_TLS uae_u32 (*x_get_byte)(uaecptr addr);
+extern UAE_TLS uae_u32 (*x_get_word)(uaecptr addr);
+extern UAE_TLS uae_u32 (*x_get_long)(uaecptr addr);
+extern UAE_TLS void (*x_put_byte)(uaecptr addr, uae_u32 v);
+extern UAE_TLS void (*x_put_word)(uaecptr addr, uae_u32 v);
+extern UAE_TLS void (*x_put_long)(uaecptr addr, uae_u32 v);
+extern UAE_TLS uae_u32 (*x_next_iword)(void);
+extern UAE_TLS uae_u32 (*x_next_ilong)(void);
+extern UAE_TLS uae_u32 (*x_get_ilong)(int);
+extern UAE_TLS uae_u32 (*x_get_iword)(int);
+extern UAE_TLS uae_u32 (*x_get_ibyte)(int);
+
+extern UAE_TLS uae_u32 (*x_cp_get_byte)(uaecptr addr);
+extern UAE_TLS uae_u32 (*x_cp_get_word)(uaecptr addr);
+extern UAE_TLS uae_u32 (*x_cp_get_long)(uaecptr addr);
+extern UAE_TLS void (*x_cp_put_byte)(uaecptr addr, uae_u32 v);
+extern UAE_TLS void (*x_cp_put_word)(uaecptr addr, uae_u32 v);
+extern UAE_TLS void (*x_cp_put_long)(uaecptr addr, uae_u32 v);
+extern UAE_TLS uae_u32 (*x_cp_next_iword)(void);
+extern UAE_TLS uae_u32 (*x_cp_next_ilong)(void);
+
+extern UAE_TLS uae_u32 (REGPARAM3 *x_cp_get_disp_ea_020)(uae_u32 base, int idx) REGPARAM;
+
+extern UAE_TLS void (*x_do_cycles)(unsigned long);
+extern UAE_TLS void (*x_do_cycles_pre)(unsigned long);
+extern UAE_TLS void (*x_do_cycles_post)(unsigned long, uae_u32);
 
 uae_u32 REGPARAM3 x_get_disp_ea_020 (uae_u32 base, int idx) REGPARAM;
 uae_u32 REGPARAM3 x_get_disp_ea_ce020 (uae_u32 base, int idx) REGPARAM;
@@ -400,7 +400,7 @@ int get_cpu_model (void);
 void REGPARAM3 MakeSR (void) REGPARAM;
 //void SetSR (uae_u16 sr);
 void REGPARAM3 MakeFromSR (void) REGPARAM;
-void REGPARAM3 Exception (int) REGPARAM;
+void REGPARAM3 Exception (int) REGPARAM UAE_COLD;
 void NMI (void);
 void NMI_delayed (void);
 void prepare_interrupt (uae_u32);
@@ -437,10 +437,11 @@ void fpu_reset (void);
 void fpux_save (int*);
 void fpux_restore (int*);
 
-void exception3 (uae_u32 opcode, uaecptr addr);
-void exception3i (uae_u32 opcode, uaecptr addr);
-extern void exception3pc (uae_u32 opcode, uaecptr addr, bool w, bool i, uaecptr pc);
-void exception2 (uaecptr addr);
+/* address and bus errors, the generated handlers keep their calls out of line */
+void exception3 (uae_u32 opcode, uaecptr addr) UAE_COLD;
+void exception3i (uae_u32 opcode, uaecptr addr) UAE_COLD;
+extern void exception3pc (uae_u32 opcode, uaecptr addr, bool w, bool i, uaecptr pc) UAE_COLD;
+void exception2 (uaecptr addr) UAE_COLD;
 void cpureset (void);
 void cpu_halt (int id);
 
@@ -471,7 +472,7 @@ extern const struct cputbl op_smalltbl_5_ff[];
 extern const struct cputbl op_smalltbl_11_ff[]; // prefetch
 extern const struct cputbl op_smalltbl_12_ff[]; // CE
 
-extern cpuop_func *cpufunctbl[65536] ASM_SYM_FOR_FUNC ("cpufunctbl");
+extern UAE_TLS cpuop_func *cpufunctbl[65536] ASM_SYM_FOR_FUNC ("cpufunctbl");
 
 #ifdef JIT
 void flush_icache (uaecptr, int);
@@ -19,7 +19,7 @@
 
 typedef enum { KBD_LANG_US, KBD_LANG_DK, KBD_LANG_DE, KBD_LANG_SE, KBD_LANG_FR, KBD_LANG_IT, KBD_LANG_ES, KBD_LANG_FI, KBD_LANG_TR } KbdLang;
 
-extern long int version;
+extern UAE_TLS long int version;
 struct uaedev_mount_info;
 struct zfile;
 
@@ -410,6 +410,8 @@ struct uae_prefs {
 	bool rom_readwrite;
 	int turbo_emulation;
 	bool headless;
+	bool lockstep;
+	uae_u32 lockstep_seed;
 	int filesys_limit;
 
 	int cs_compatible;
@@ -467,6 +469,7 @@ struct uae_prefs {
 	TCHAR statefile[MAX_DPATH];
 	TCHAR inprecfile[MAX_DPATH];
 	bool inprec_autoplay;
+	int inprec_snapshotrate;
 	char scsi_device[256];
 
 	struct multipath path_floppy;
@@ -588,11 +591,11 @@ struct uae_prefs {
 	int input_contact_bounce;
 };
 
-extern int config_changed;
+extern UAE_TLS int config_changed;
 extern void config_check_vsync (void);
 
 /* Contains the filename of .uaerc */
-extern TCHAR optionsfile[];
+extern UAE_TLS TCHAR optionsfile[];
 extern void save_options (struct zfile *, struct uae_prefs *, int);
 
 extern void cfgfile_write (struct zfile *, const TCHAR *option, const TCHAR *format,...);
@@ -661,7 +664,7 @@ extern void check_prefs_changed_audio (void);
 extern void check_prefs_changed_cd (void);
 extern int check_prefs_changed_gfx (void);
 
-extern struct uae_prefs currprefs, changed_prefs;
+extern UAE_TLS struct uae_prefs currprefs, changed_prefs;
 
 extern int machdep_init (void);
 extern void machdep_free (void);
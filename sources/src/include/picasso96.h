@@ -106,7 +106,7 @@ struct MultiDisplay {
         struct PicassoResolution *DisplayModes;
  //       RECT rect;
 };
-extern struct MultiDisplay Displays[MAX_DISPLAYS];
+extern UAE_TLS struct MultiDisplay Displays[MAX_DISPLAYS];
 
 /* Types for RGBFormat used */
 typedef enum {
@@ -712,12 +712,12 @@ struct picasso96_state_struct
 
 void InitPicasso96 (void);
 
-extern uae_u32 gfxmem_mask;
-extern uae_u8 *gfxmemory;
+extern UAE_TLS uae_u32 gfxmem_mask;
+extern UAE_TLS uae_u8 *gfxmemory;
 
 extern int uaegfx_card_found;
 
-extern struct picasso96_state_struct picasso96_state;
+extern UAE_TLS struct picasso96_state_struct picasso96_state;
 extern uae_u16 picasso96_pixel_format;
 
 #include "traps.h"
@@ -731,6 +731,9 @@ void picasso_trigger_vblank (void);
 void picasso_reset (void);
 int picasso_setwincursor (void);
 int picasso_palette (void);
+#ifdef __LIBRETRO__
+uae_u8 *picasso_direct_screen (int *width, int *height, int *pitch);
+#endif
 void uaegfx_install_code (uaecptr start);
 int createwindowscursor (uaecptr, int, int, int, int, int);
 int DX_Fill (int, int, int, int, uae_u32, RGBFTYPE);
@@ -752,7 +755,7 @@ struct picasso_vidbuf_description {
     uae_u32 clut[256];
 };
 
-extern struct picasso_vidbuf_description picasso_vidinfo;
+extern UAE_TLS struct picasso_vidbuf_description picasso_vidinfo;
 
 void gfx_set_picasso_modeinfo (uae_u32 w, uae_u32 h, uae_u32 d, RGBFTYPE rgbfmt);
 void gfx_set_picasso_colors (RGBFTYPE rgbfmt);
@@ -766,8 +769,8 @@ extern int picasso_is_special;
 extern int picasso_is_special_read;
 
 extern int p96hack_vpos2;
-extern int p96refresh_active;
-extern int p96hsync_counter;
+extern UAE_TLS int p96refresh_active;
+extern UAE_TLS int p96hsync_counter;
 
 #define LIB_SIZE 34
 #define CARD_FLAGS LIB_SIZE
@@ -76,9 +76,9 @@ struct instr_def {
 };
 
 extern struct instr_def defs68k[];
-extern int n_defs68k;
+extern UAE_TLS int n_defs68k;
 
-extern struct instr {
+extern UAE_TLS struct instr {
     long int handler;
     unsigned char dreg;
     unsigned char sreg;
@@ -104,5 +104,5 @@ extern struct instr {
 extern void read_table68k (void);
 extern void do_merges (void);
 extern int get_no_mismatches (void);
-extern int nr_cpuop_funcs;
+extern UAE_TLS int nr_cpuop_funcs;
 
@@ -0,0 +1,39 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * ROM and table pages shared between processes
+  *
+  * ROM images are mapped from their files and precomputed tables from a
+  * cache directory, so many emulator processes on one host keep a single
+  * copy of them in the page cache. All mappings are private: a page that
+  * gets patched becomes a copy of its own, the other pages stay shared.
+  */
+
+#ifndef UAE_ROMSHARE_H
+#define UAE_ROMSHARE_H
+
+#include "uae_types.h"
+
+#if !defined(_WIN32) && !defined(WIIU) && !defined(VITA) && !defined(__CELLOS_LV2__) && !defined(__SWITCH__) && !defined(EMSCRIPTEN)
+#define ROMSHARE
+#endif
+
+struct zfile;
+
+/* cachedir NULL or empty maps ROMs only, tables are then built privately */
+extern void romshare_init (bool enable, const TCHAR *cachedir);
+extern bool romshare_enabled (void);
+
+/* Maps len bytes of f at pos, repeated to fill size bytes. Returns NULL
+ * unless f is a plain file and the mapping is identical to mem. */
+extern uae_u8 *romshare_map_rom (struct zfile *f, uae_u64 pos, int len, const uae_u8 *mem, int size);
+
+/* Maps the cached copy of a table, fill () builds it when the cache is
+ * missing or its key does not match. key covers the table's inputs. */
+typedef bool (*romshare_fill)(uae_u8 *p, int len);
+extern uae_u8 *romshare_map_table (const TCHAR *name, uae_u32 key, int len, romshare_fill fill, bool writable);
+
+/* false if p is not a romshare mapping */
+extern bool romshare_unmap (void *p);
+
+#endif /* UAE_ROMSHARE_H */
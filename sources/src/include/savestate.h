@@ -180,6 +180,9 @@ extern void restore_debug_memwatch_finish (void);
 extern uae_u8 *save_cycles (int *len, uae_u8 *dstptr);
 extern uae_u8 *restore_cycles (uae_u8 *src);
 
+extern uae_u8 *save_lockstep (int *len, uae_u8 *dstptr);
+extern uae_u8 *restore_lockstep (uae_u8 *src);
+
 extern void restore_cram (int, size_t);
 extern void restore_bram (int, size_t);
 extern void restore_fram (int, size_t);
@@ -209,10 +212,13 @@ extern uae_u8 *restore_hrtmon (uae_u8 *);
 extern uae_u8 *save_hrtmon (int *, uae_u8 *);
 
 extern void savestate_initsave (const TCHAR *filename, int docompress, int nodialogs, bool save);
+extern void savestate_setcompress (int mode);
 extern int save_state (const TCHAR *filename, const TCHAR *description);
 extern void restore_state (const TCHAR *filename);
 extern void savestate_restore_finish (void);
 extern void savestate_memorysave (void);
+extern struct zfile *savestate_snapshot (void);
+extern void savestate_restore_snapshot (struct zfile *f, uae_u32 hsync, uae_u32 vsync);
 
 
 extern void custom_save_state (void);
@@ -227,9 +233,9 @@ extern bool savestate_check (void);
 #define STATE_REWIND 16
 #define STATE_DOREWIND 32
 
-extern int savestate_state;
-extern TCHAR savestate_fname[MAX_DPATH];
-extern struct zfile *savestate_file;
+extern UAE_TLS int savestate_state;
+extern UAE_TLS TCHAR savestate_fname[MAX_DPATH];
+extern UAE_TLS struct zfile *savestate_file;
 
 STATIC_INLINE bool isrestore (void)
 {
@@ -240,6 +246,7 @@ extern void savestate_quick (int slot, int save);
 
 extern void savestate_capture (int);
 extern void savestate_free (void);
+extern void savestate_cleanup (void);
 extern void savestate_init (void);
 extern void savestate_rewind (void);
 extern int savestate_dorewind (int);
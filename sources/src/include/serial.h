@@ -19,9 +19,9 @@ extern void  SERDAT (uae_u16 w);
 
 extern uae_u8 serial_writestatus (uae_u8, uae_u8);
 extern uae_u8 serial_readstatus (uae_u8);
-extern uae_u16 serdat;
+extern UAE_TLS uae_u16 serdat;
 
-extern int doreadser, serstat;
+extern UAE_TLS int doreadser, serstat;
 
 extern void serial_flush_buffer (void);
 
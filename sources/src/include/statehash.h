@@ -0,0 +1,65 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Per-frame machine state digest
+  *
+  * A cheap hash of the emulated machine taken at every vsync, so netplay
+  * and replay tools can spot a desync without comparing statefiles. RAM
+  * is tracked in pages: the memory bank write handlers mark the pages
+  * they touch and only those are rehashed at the end of the frame.
+  * Writes that bypass the handlers (DMA through real pointers, statefile
+  * restore) are picked up by a full RAM pass every checkpoint frames.
+  */
+
+#ifndef UAE_STATEHASH_H
+#define UAE_STATEHASH_H
+
+#include "uae_types.h"
+
+#define STATEHASH_PAGE_SHIFT 12
+
+enum {
+	STATEHASH_CHIP,
+	STATEHASH_BOGO,
+	STATEHASH_FAST,
+	STATEHASH_Z3FAST,
+	STATEHASH_REGIONS
+};
+
+/* one byte per page of each region, NULL while tracking is off */
+extern UAE_TLS uae_u8 *statehash_dirty[STATEHASH_REGIONS];
+
+/* offset is relative to the start of the region */
+STATIC_INLINE void statehash_write (int region, uaecptr offset, int size)
+{
+	uae_u8 *d = statehash_dirty[region];
+	if (d) {
+		d[offset >> STATEHASH_PAGE_SHIFT] = 1;
+		d[(offset + size - 1) >> STATEHASH_PAGE_SHIFT] = 1;
+	}
+}
+
+STATIC_INLINE uae_u64 statehash_mix (uae_u64 h, uae_u64 v)
+{
+	h ^= v;
+	h *= 0x9e3779b97f4a7c15ULL;
+	return h ^ (h >> 29);
+}
+
+extern uae_u64 statehash_mem (uae_u64 h, const void *p, int len);
+
+/* checkpoint: frames between full RAM passes, 0 turns tracking off */
+extern void statehash_enable (int checkpoint);
+/* RAM was rewritten behind the handlers or reallocated, rehash all of it next frame */
+extern void statehash_reset (void);
+extern void statehash_vsync (void);
+/* digest of the last completed frame, 0 while tracking is off */
+extern uae_u64 statehash_get (void);
+
+/* side effect free hashes of each module's registers */
+extern uae_u64 hash_cpu (uae_u64 h);
+extern uae_u64 hash_custom (uae_u64 h);
+extern uae_u64 hash_cia (uae_u64 h);
+extern uae_u64 hash_blitter (uae_u64 h);
+
+#endif /* UAE_STATEHASH_H */
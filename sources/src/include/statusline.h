@@ -24,7 +24,7 @@
 #define TD_BORDER 0x333333
 #endif
 
-static int td_pos = (TD_RIGHT | TD_BOTTOM);
+static UAE_TLS int td_pos = (TD_RIGHT | TD_BOTTOM);
 
 #define TD_NUM_WIDTH 7
 #define TD_NUM_HEIGHT 7
@@ -491,7 +491,13 @@ extern int gui_message_multibutton (int flags, const char *format,...);
 #endif
 #define _tcstod strtod
 #define _T
+#ifdef UAE_MULTI_INSTANCE
+/* lets the other cothreads of this machine run, see threaddep/thread.h */
+extern void uae_thread_sleep (int ms);
+#define sleep_millis uae_thread_sleep
+#else
 #define sleep_millis uae_msleep
+#endif
 
 #define _istalnum iswalnum
 #ifndef _WIN32
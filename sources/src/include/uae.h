@@ -41,11 +41,11 @@ extern void getpathpart (TCHAR *outpath, int size, const TCHAR *inpath);
 extern void getfilepart (TCHAR *out, int size, const TCHAR *path);
 extern uae_u32 getlocaltime (void);
 
-extern int quit_program;
-extern bool console_emulation;
+extern UAE_TLS int quit_program;
+extern UAE_TLS bool console_emulation;
 
-extern TCHAR warning_buffer[256];
-extern TCHAR start_path_data[];
+extern UAE_TLS TCHAR warning_buffer[256];
+extern UAE_TLS TCHAR start_path_data[];
 extern TCHAR start_path_data_exe[];
 extern TCHAR start_path_plugins[];
 
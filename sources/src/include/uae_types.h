@@ -171,5 +171,26 @@ typedef unsigned int      uae_uintptr;
 # endif
 #endif
 
+/* Rarely run code: the compiler moves it, and any branch that leads to
+ * it, out of the hot text so the common paths stay dense. */
+#ifndef UAE_COLD
+# if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3)
+#  define UAE_COLD __attribute__((cold))
+# else
+#  define UAE_COLD
+# endif
+#endif
+
+/* Mutable emulator state. A UAE_MULTI_INSTANCE build keeps one copy per
+ * thread, so several emulated machines can run in one process, each on its
+ * own thread. Read only tables are left without it and stay shared. */
+#ifndef UAE_TLS
+# ifdef UAE_MULTI_INSTANCE
+#  define UAE_TLS __thread
+# else
+#  define UAE_TLS
+# endif
+#endif
+
 
 #endif /* UAE_TYPES_H */
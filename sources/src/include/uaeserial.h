@@ -15,6 +15,6 @@ void uaeserialdev_install (void);
 void uaeserialdev_reset (void);
 void uaeserialdev_start_threads (void);
 
-extern int log_uaeserial;
+extern UAE_TLS int log_uaeserial;
 
 #endif // SRC_INCLUDE_UAESERIAL_H_INCLUDED
@@ -18,12 +18,12 @@ typedef uae_u32 xcolnr;
 
 typedef int (*allocfunc_type)(int, int, int, xcolnr *);
 
-extern xcolnr xcolors[4096];
+extern UAE_TLS xcolnr xcolors[4096];
 extern xcolnr xcolors_16[4096];
 extern xcolnr xcolors_32[4096];
-extern uae_u32 p96_rgbx16[65536];
+extern UAE_TLS uae_u32 p96_rgbx16[65536];
 
-extern int flashscreen;
+extern UAE_TLS int flashscreen;
 void updatedisplayarea (void);
 int isvsync_chipset (void);
 int isvsync_rtg (void);
@@ -120,7 +120,7 @@ bool isnativevidbuf (void);
 
 #define MAXBLOCKLINES_MAX INT_MAX;
 
-extern struct vidbuf_description gfxvidinfo;
+extern UAE_TLS struct vidbuf_description gfxvidinfo;
 
 STATIC_INLINE void flush_line (int line_no)
 {
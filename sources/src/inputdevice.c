@@ -71,7 +71,7 @@ extern TCHAR *my_strdup_trim (const TCHAR *s);
 // 16 = potgo
 // 32 = vsync
 
-int inputdevice_logging = 0;
+UAE_TLS int inputdevice_logging = 0;
 
 #define COMPA_RESERVED_FLAGS ID_FLAG_INVERT
 
@@ -108,14 +108,14 @@ int inputdevice_logging = 0;
 #define JOYMOUSE_CDTV 8
 
 #define DEFEVENT(A, B, C, D, E, F) {_T(#A), B, C, D, E, F },
-static struct inputevent events[] = {
+static UAE_TLS struct inputevent events[] = {
 	{0, 0, AM_K,0,0,0},
 #include "inputevents.def"
 	{0, 0, 0, 0, 0, 0}
 };
 #undef DEFEVENT
 
-static int sublevdir[2][MAX_INPUT_SUB_EVENT];
+static UAE_TLS int sublevdir[2][MAX_INPUT_SUB_EVENT];
 
 static const int slotorder1[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
 static const int slotorder2[] = { 8, 1, 2, 3, 4, 5, 6, 7 };
@@ -125,20 +125,20 @@ struct uae_input_device2 {
 	int states[MAX_INPUT_DEVICE_EVENTS / 2][MAX_INPUT_SUB_EVENT + 1];
 };
 
-static struct uae_input_device2 joysticks2[MAX_INPUT_DEVICES];
-static struct uae_input_device2 mice2[MAX_INPUT_DEVICES];
-static uae_u8 scancodeused[MAX_INPUT_DEVICES][256];
-static uae_u64 qualifiers, qualifiers_r;
-static uae_s16 *qualifiers_evt[MAX_INPUT_QUALIFIERS];
+static UAE_TLS struct uae_input_device2 joysticks2[MAX_INPUT_DEVICES];
+static UAE_TLS struct uae_input_device2 mice2[MAX_INPUT_DEVICES];
+static UAE_TLS uae_u8 scancodeused[MAX_INPUT_DEVICES][256];
+static UAE_TLS uae_u64 qualifiers, qualifiers_r;
+static UAE_TLS uae_s16 *qualifiers_evt[MAX_INPUT_QUALIFIERS];
 
 // fire/left mouse button pullup resistors enabled?
-static bool mouse_pullup = true;
+static UAE_TLS bool mouse_pullup = true;
 
-static int joymodes[MAX_JPORTS];
-static int *joyinputs[MAX_JPORTS];
+static UAE_TLS int joymodes[MAX_JPORTS];
+static UAE_TLS int *joyinputs[MAX_JPORTS];
 
-static int input_acquired;
-static int testmode;
+static UAE_TLS int input_acquired;
+static UAE_TLS int testmode;
 struct teststore
 {
 	int testmode_type;
@@ -149,16 +149,16 @@ struct teststore
 	int testmode_max;
 };
 #define TESTMODE_MAX 2
-static int testmode_count;
-static struct teststore testmode_data[TESTMODE_MAX];
-static struct teststore testmode_wait[TESTMODE_MAX];
+static UAE_TLS int testmode_count;
+static UAE_TLS struct teststore testmode_data[TESTMODE_MAX];
+static UAE_TLS struct teststore testmode_wait[TESTMODE_MAX];
 
-static int bouncy;
-static unsigned long bouncy_cycles;
+static UAE_TLS int bouncy;
+static UAE_TLS unsigned long bouncy_cycles;
 
 int handle_input_event (int nr, int state, int max, int autofire, bool canstoprecord, bool playbackevent);
 
-static struct inputdevice_functions idev[IDTYPE_MAX];
+static UAE_TLS struct inputdevice_functions idev[IDTYPE_MAX];
 
 static int isdevice (struct uae_input_device *id)
 {
@@ -185,12 +185,12 @@ int inputdevice_uaelib (const TCHAR *s, const TCHAR *parm)
 	return 0;
 }
 
-static struct uae_input_device *joysticks;
-static struct uae_input_device *mice;
-static struct uae_input_device *keyboards;
-static struct uae_input_device *internalevents;
-static struct uae_input_device_kbr_default *keyboard_default, **keyboard_default_table;
-static int default_keyboard_layout[MAX_JPORTS];
+static UAE_TLS struct uae_input_device *joysticks;
+static UAE_TLS struct uae_input_device *mice;
+static UAE_TLS struct uae_input_device *keyboards;
+static UAE_TLS struct uae_input_device *internalevents;
+static UAE_TLS struct uae_input_device_kbr_default *keyboard_default, **keyboard_default_table;
+static UAE_TLS int default_keyboard_layout[MAX_JPORTS];
 
 #define KBR_DEFAULT_MAP_FIRST 0
 #define KBR_DEFAULT_MAP_LAST 5
@@ -211,57 +211,57 @@ static int default_keyboard_layout[MAX_JPORTS];
 #define KBR_DEFAULT_MAP_ARCADIA 11
 #define KBR_DEFAULT_MAP_ARCADIA_XA 12
 #define KBR_DEFAULT_MAP_CDTV 13
-static int **keyboard_default_kbmaps;
+static UAE_TLS int **keyboard_default_kbmaps;
 
-static int mouse_axis[MAX_INPUT_DEVICES][MAX_INPUT_DEVICE_EVENTS];
-static int oldm_axis[MAX_INPUT_DEVICES][MAX_INPUT_DEVICE_EVENTS];
+static UAE_TLS int mouse_axis[MAX_INPUT_DEVICES][MAX_INPUT_DEVICE_EVENTS];
+static UAE_TLS int oldm_axis[MAX_INPUT_DEVICES][MAX_INPUT_DEVICE_EVENTS];
 
 #define MOUSE_AXIS_TOTAL 4
 
-static uae_s16 mouse_x[MAX_JPORTS], mouse_y[MAX_JPORTS];
-static uae_s16 mouse_delta[MAX_JPORTS][MOUSE_AXIS_TOTAL];
-static uae_s16 mouse_deltanoreset[MAX_JPORTS][MOUSE_AXIS_TOTAL];
-static int joybutton[MAX_JPORTS];
-static int joydir[MAX_JPORTS];
-static int joydirpot[MAX_JPORTS][2];
-static uae_s16 mouse_frame_x[MAX_JPORTS], mouse_frame_y[MAX_JPORTS];
+static UAE_TLS uae_s16 mouse_x[MAX_JPORTS], mouse_y[MAX_JPORTS];
+static UAE_TLS uae_s16 mouse_delta[MAX_JPORTS][MOUSE_AXIS_TOTAL];
+static UAE_TLS uae_s16 mouse_deltanoreset[MAX_JPORTS][MOUSE_AXIS_TOTAL];
+static UAE_TLS int joybutton[MAX_JPORTS];
+static UAE_TLS int joydir[MAX_JPORTS];
+static UAE_TLS int joydirpot[MAX_JPORTS][2];
+static UAE_TLS uae_s16 mouse_frame_x[MAX_JPORTS], mouse_frame_y[MAX_JPORTS];
 
 #ifdef __LIBRETRO__
-int mouse_port[NORMAL_JPORTS];
+UAE_TLS int mouse_port[NORMAL_JPORTS];
 #else
 static int mouse_port[NORMAL_JPORTS];
 #endif
-static int cd32_shifter[NORMAL_JPORTS];
+static UAE_TLS int cd32_shifter[NORMAL_JPORTS];
 #ifdef __LIBRETRO__
-int cd32_pad_enabled[NORMAL_JPORTS];
+UAE_TLS int cd32_pad_enabled[NORMAL_JPORTS];
 #else
 static int cd32_pad_enabled[NORMAL_JPORTS];
 #endif
-static int parport_joystick_enabled;
-static int oldmx[MAX_JPORTS], oldmy[MAX_JPORTS];
-static int oleft[MAX_JPORTS], oright[MAX_JPORTS], otop[MAX_JPORTS], obot[MAX_JPORTS];
-static int horizclear[MAX_JPORTS], vertclear[MAX_JPORTS];
-
-uae_u16 potgo_value;
-static int pot_cap[NORMAL_JPORTS][2];
-static uae_u8 pot_dat[NORMAL_JPORTS][2];
-static int pot_dat_act[NORMAL_JPORTS][2];
-static int analog_port[NORMAL_JPORTS][2];
-static int digital_port[NORMAL_JPORTS][2];
-static int lightpen;
+static UAE_TLS int parport_joystick_enabled;
+static UAE_TLS int oldmx[MAX_JPORTS], oldmy[MAX_JPORTS];
+static UAE_TLS int oleft[MAX_JPORTS], oright[MAX_JPORTS], otop[MAX_JPORTS], obot[MAX_JPORTS];
+static UAE_TLS int horizclear[MAX_JPORTS], vertclear[MAX_JPORTS];
+
+UAE_TLS uae_u16 potgo_value;
+static UAE_TLS int pot_cap[NORMAL_JPORTS][2];
+static UAE_TLS uae_u8 pot_dat[NORMAL_JPORTS][2];
+static UAE_TLS int pot_dat_act[NORMAL_JPORTS][2];
+static UAE_TLS int analog_port[NORMAL_JPORTS][2];
+static UAE_TLS int digital_port[NORMAL_JPORTS][2];
+static UAE_TLS int lightpen;
 #define POTDAT_DELAY_PAL 8
 #define POTDAT_DELAY_NTSC 7
 
-static int use_joysticks[MAX_INPUT_DEVICES];
-static int use_mice[MAX_INPUT_DEVICES];
-static int use_keyboards[MAX_INPUT_DEVICES];
+static UAE_TLS int use_joysticks[MAX_INPUT_DEVICES];
+static UAE_TLS int use_mice[MAX_INPUT_DEVICES];
+static UAE_TLS int use_keyboards[MAX_INPUT_DEVICES];
 
 #define INPUT_QUEUE_SIZE 16
 struct input_queue_struct {
 	int evt, storedstate, state, max, linecnt, nextlinecnt;
 	TCHAR *custom;
 };
-static struct input_queue_struct input_queue[INPUT_QUEUE_SIZE];
+static UAE_TLS struct input_queue_struct input_queue[INPUT_QUEUE_SIZE];
 
 uae_u8 *restore_input (uae_u8 *src)
 {
@@ -676,7 +676,7 @@ static int getnum (const TCHAR **pp)
 static TCHAR *getstring (const TCHAR **pp)
 {
 	int i;
-	static TCHAR str[CONFIG_BLEN];
+	static UAE_TLS TCHAR str[CONFIG_BLEN];
 	const TCHAR *p = *pp;
 	bool quoteds = false;
 	bool quotedd = false;
@@ -1103,12 +1103,12 @@ void read_inputdevice_config (struct uae_prefs *pr, const TCHAR *option, TCHAR *
 	xfree (custom);
 }
 
-static int mouseedge_alive, mousehack_alive_cnt;
-static int lastmx, lastmy;
-static uaecptr magicmouse_ibase, magicmouse_gfxbase;
-static int dimensioninfo_width, dimensioninfo_height, dimensioninfo_dbl;
-static int vp_xoffset, vp_yoffset, mouseoffset_x, mouseoffset_y;
-static int tablet_maxx, tablet_maxy, tablet_data;
+static UAE_TLS int mouseedge_alive, mousehack_alive_cnt;
+static UAE_TLS int lastmx, lastmy;
+static UAE_TLS uaecptr magicmouse_ibase, magicmouse_gfxbase;
+static UAE_TLS int dimensioninfo_width, dimensioninfo_height, dimensioninfo_dbl;
+static UAE_TLS int vp_xoffset, vp_yoffset, mouseoffset_x, mouseoffset_y;
+static UAE_TLS int tablet_maxx, tablet_maxy, tablet_data;
 
 int mousehack_alive (void)
 {
@@ -1218,8 +1218,8 @@ int inputdevice_is_tablet (void)
 	return 0;
 }
 
-static uaecptr mousehack_address;
-static bool mousehack_enabled;
+static UAE_TLS uaecptr mousehack_address;
+static UAE_TLS bool mousehack_enabled;
 
 static void mousehack_reset (void)
 {
@@ -1657,7 +1657,7 @@ static void mousehack_helper (uae_u32 buttonmask)
 #endif
 }
 
-static int mouseedge_x, mouseedge_y, mouseedge_time;
+static UAE_TLS int mouseedge_x, mouseedge_y, mouseedge_time;
 #define MOUSEEDGE_RANGE 100
 #define MOUSEEDGE_TIME 2
 
@@ -1667,8 +1667,8 @@ static int mouseedge (void)
 {
 	int x, y, dir;
 	uaecptr ib;
-	static int melast_x, melast_y;
-	static int isnonzero;
+	static UAE_TLS int melast_x, melast_y;
+	static UAE_TLS int isnonzero;
 
 	if (currprefs.input_magic_mouse == 0 || currprefs.input_tablet > 0)
 		return 0;
@@ -1789,7 +1789,7 @@ static void mouseupdate (int pct, bool vsync)
 {
 	int v, i;
 	int max = 120;
-	static int mxd, myd;
+	static UAE_TLS int mxd, myd;
 
 	if (vsync) {
 		if (mxd < 0) {
@@ -1890,8 +1890,8 @@ static void mouseupdate (int pct, bool vsync)
 	}
 }
 
-static int input_vpos, input_frame;
-extern int vpos;
+static UAE_TLS int input_vpos, input_frame;
+extern UAE_TLS int vpos;
 static void readinput (void)
 {
 	uae_u32 totalvpos;
@@ -2229,7 +2229,7 @@ uae_u8 handle_joystick_buttons (uae_u8 pra, uae_u8 dra)
 	}
 
 	if (inputdevice_logging & 4) {
-		static uae_u8 old;
+		static UAE_TLS uae_u8 old;
 		if (but != old)
 			write_log (_T("BFE001 R: %02X:%02X %x\n"), dra, but, M68K_GETPC);
 		old = but;
@@ -2240,7 +2240,7 @@ uae_u8 handle_joystick_buttons (uae_u8 pra, uae_u8 dra)
 /* joystick 1 button 1 is used as a output for incrementing shift register */
 void handle_cd32_joystick_cia (uae_u8 pra, uae_u8 dra)
 {
-	static int oldstate[2];
+	static UAE_TLS int oldstate[2];
 	int i;
 
 	if (inputdevice_logging & 4) {
@@ -2313,7 +2313,7 @@ static uae_u16 handle_joystick_potgor (uae_u16 potgor)
 }
 
 
-static int inputdelay;
+static UAE_TLS int inputdelay;
 
 static void inputdevice_read (void)
 {
@@ -2466,7 +2466,7 @@ static int handle_custom_event (const TCHAR *custom)
 
 void inputdevice_hsync (void)
 {
-	static int cnt;
+	static UAE_TLS int cnt;
 	cap_check ();
 
 #ifdef CATWEASEL
@@ -2647,8 +2647,8 @@ static void queue_input_event (int evt, const TCHAR *custom, int state, int max,
 	}
 }
 
-static uae_u8 keybuf[256];
-static int inputcode_pending, inputcode_pending_state;
+static UAE_TLS uae_u8 keybuf[256];
+static UAE_TLS int inputcode_pending, inputcode_pending_state;
 
 void inputdevice_release_all_keys (void)
 {
@@ -2730,10 +2730,10 @@ static bool needcputrace (int code)
 
 void inputdevice_handle_inputcode (void)
 {
-	static int swapperslot;
+	static UAE_TLS int swapperslot;
 	int code = inputcode_pending;
 	int state = inputcode_pending_state;
-	static int tracer_enable;
+	static UAE_TLS int tracer_enable;
 
 	if (code == 0)
 		goto end;
@@ -3754,7 +3754,7 @@ static bool process_custom_event (struct uae_input_device *id, int offset, int s
 
 static void setbuttonstateall (struct uae_input_device *id, struct uae_input_device2 *id2, int button, int buttonstate)
 {
-	static frame_time_t switchdevice_timeout;
+	static UAE_TLS frame_time_t switchdevice_timeout;
 	int i;
 	uae_u32 mask = 1 << button;
 	uae_u32 omask = id2 ? id2->buttonmask & mask : 0;
@@ -5771,7 +5771,7 @@ static int get_int_flags (int num)
 	return 0;
 }
 
-struct inputdevice_functions inputdevicefunc_internalevent = {
+UAE_TLS struct inputdevice_functions inputdevicefunc_internalevent = {
 	init_int, close_int, acquire_int, unacquire_int, read_int,
 	get_int_num, get_int_friendlyname, get_int_uniquename,
 	get_int_widget_num, get_int_widget_type,
@@ -6079,7 +6079,7 @@ bool inputdevice_get_eventname (const struct inputevent *ie, TCHAR *out)
 int inputdevice_iterate (int devnum, int num, TCHAR *name, int *af)
 {
 	const struct inputdevice_functions *idf = getidf (devnum);
-	static int id_iterator;
+	static UAE_TLS int id_iterator;
 	struct inputevent *ie;
 	int mask, data, type;
 	uae_u64 flags;
@@ -6241,7 +6241,7 @@ int inputdevice_get_widget_type (int devnum, int num, TCHAR *name)
 	return idf->get_widget_type (inputdevice_get_device_index (devnum), num, name, 0);
 }
 
-static int config_change;
+static UAE_TLS int config_change;
 
 void inputdevice_config_change (void)
 {
@@ -6765,7 +6765,7 @@ void setmousestate (int mouse, int axis, int data, int isabs)
 	int *mouse_p, *oldm_p;
 	float d;
 	struct uae_input_device *id = &mice[mouse];
-	static float fract[MAX_INPUT_DEVICES][MAX_INPUT_DEVICE_EVENTS];
+	static UAE_TLS float fract[MAX_INPUT_DEVICES][MAX_INPUT_DEVICE_EVENTS];
 
 	if (testmode) {
 		inputdevice_testrecord (IDTYPE_MOUSE, mouse, IDEV_WIDGET_AXIS, axis, data, -1);
@@ -26,36 +26,49 @@
 #include "disk.h"
 #include "misc.h"
 #include "fsdb.h"
+#include "xwin.h"
+#include "drawing.h"
 
 #if INPUTRECORD_DEBUG > 0
 #include "memory_uae.h"
 #include "newcpu.h"
 #endif
 
-int inputrecord_debug = 3;
+UAE_TLS int inputrecord_debug = 3;
 
-extern int inputdevice_logging;
+extern UAE_TLS int inputdevice_logging;
 
 #define INPREC_BUFFER_SIZE 10000
 
-static uae_u8 *inprec_buffer, *inprec_p;
-static struct zfile *inprec_zf;
-static int inprec_size;
-int input_record = 0;
-int input_play = 0;
-static uae_u8 *inprec_plast, *inprec_plastptr;
-static int header_end, header_end2;
-static int replaypos;
-static int lasthsync, endhsync;
-static TCHAR inprec_path[MAX_DPATH];
-static uae_u32 seed;
-static uae_u32 lastcycle;
-static uae_u32 cycleoffset;
-
-static uae_u32 pcs[16];
-static uae_u32 pcs2[16];
+static UAE_TLS uae_u8 *inprec_buffer, *inprec_p;
+static UAE_TLS struct zfile *inprec_zf;
+static UAE_TLS int inprec_size;
+UAE_TLS int input_record = 0;
+UAE_TLS int input_play = 0;
+static UAE_TLS uae_u8 *inprec_plast, *inprec_plastptr;
+static UAE_TLS int header_end, header_end2;
+static UAE_TLS int replaypos;
+static UAE_TLS int lasthsync, endhsync;
+static UAE_TLS TCHAR inprec_path[MAX_DPATH];
+static UAE_TLS uae_u32 seed;
+static UAE_TLS uae_u32 lastcycle;
+static UAE_TLS uae_u32 cycleoffset;
+
+struct inprec_snapshot
+{
+	uae_u32 hsync;
+	uae_u32 offset;
+};
+static UAE_TLS struct inprec_snapshot *snapshots;
+static UAE_TLS int snapshots_num, snapshots_max;
+static UAE_TLS uae_u32 seek_hsync;
+static UAE_TLS uae_u32 seekseed;
+static UAE_TLS bool seekseed_valid;
+
+static UAE_TLS uae_u32 pcs[16];
+static UAE_TLS uae_u32 pcs2[16];
 extern void activate_debugger (void);
-static int warned;
+static UAE_TLS int warned;
 
 /* external prototypes */
 extern void refreshtitle (void);
@@ -72,6 +85,33 @@ static void setlasthsync (void)
 	}
 }
 
+STATIC_INLINE uae_u32 getu32 (const uae_u8 *p)
+{
+	return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+/* snapshot and index records are followed by a payload that does not
+ * fit in the 16-bit record size, its length is the last field */
+static int inprec_reclen (const uae_u8 *p)
+{
+	int len = (p[1] << 8) | p[2];
+	int type = p[0] & 0x7f;
+	if (type == INPREC_SNAPSHOT || type == INPREC_INDEX)
+		len += getu32 (p + len - 4);
+	return len;
+}
+
+static void addsnapshot (uae_u32 hsync, uae_u32 offset)
+{
+	if (snapshots_num >= snapshots_max) {
+		snapshots_max = snapshots_max ? snapshots_max * 2 : 64;
+		snapshots = xrealloc (struct inprec_snapshot, snapshots, snapshots_max);
+	}
+	snapshots[snapshots_num].hsync = hsync;
+	snapshots[snapshots_num].offset = offset;
+	snapshots_num++;
+}
+
 static void flush (void)
 {
 	if (inprec_p > inprec_buffer) {
@@ -156,6 +196,8 @@ static bool inprec_realtime (bool stopstart)
 	int offset = inprec_p - inprec_buffer;
 	zfile_fseek (inprec_zf, offset, SEEK_SET);
 	zfile_truncate (inprec_zf, offset);
+	while (snapshots_num > 0 && snapshots[snapshots_num - 1].offset >= offset)
+		snapshots_num--;
 	xfree (inprec_buffer);
 	inprec_size = INPREC_BUFFER_SIZE;
 	inprec_buffer = inprec_p = xmalloc (uae_u8, inprec_size);
@@ -169,7 +211,7 @@ static int inprec_pstart (uae_u8 type)
 	uae_u32 hc = hsync_counter;
 	uae_u8 hpos = current_hpos ();
 	uae_u32 cycles = get_cycles ();
-	static uae_u8 *lastp;
+	static UAE_TLS uae_u8 *lastp;
 	uae_u32 hc_orig, hc2_orig;
 	int mvp = current_maxvpos ();
 
@@ -190,7 +232,10 @@ static int inprec_pstart (uae_u8 type)
 		write_log (_T("INPREC: buffer error\n"));
 		gui_message (_T("INPREC error"));
 	}
-	if (p[0] == INPREC_END) {
+	if (p[0] == INPREC_END || p[0] == INPREC_INDEX) {
+		/* written at close, the recording runs up to there */
+		if (hsync_counter < getu32 (p + 3))
+			return 0;
 		inprec_close (true);
 		return 0;
 	} else if (p[0] == INPREC_QUIT) {
@@ -255,9 +300,9 @@ static int inprec_pstart (uae_u8 type)
 			setlasthsync ();
 			return 1;
 		}
-		if (type2 == INPREC_END || type2 == INPREC_QUIT)
+		if (type2 == INPREC_END || type2 == INPREC_QUIT || type2 == INPREC_INDEX)
 			break;
-		p += (p[1] << 8) | (p[2] << 0);
+		p += inprec_reclen (p);
 	}
 	inprec_plast = NULL;
 	return 0;
@@ -283,7 +328,7 @@ static void inprec_pend (void)
 			break;
 		if ((p[0] & 0x80) == 0)
 			return;
-		p += (p[1] << 8) | (p[2] << 0);
+		p += inprec_reclen (p);
 		inprec_p = p;
 	}
 }
@@ -338,13 +383,70 @@ static void findlast (void)
 	uae_u32 hsync = 0;
 	uae_u8 *p = inprec_p;
 	while (p < inprec_buffer + inprec_size) {
-		hsync = (p[3] << 24) | (p[4] << 16) | (p[5] << 8) | p[6];
-		uae_u16 len = (p[1] << 8) | (p[2] << 0);
-		p += len;
+		hsync = getu32 (p + 3);
+		p += inprec_reclen (p);
 	}
 	endhsync = hsync;
 }
 
+/* snapshot table of contents, rebuilt by scanning if the recording was not closed */
+static void loadindex (void)
+{
+	uae_u8 *end = inprec_buffer + inprec_size;
+	uae_u8 *p = end - (HEADERSIZE + 4);
+
+	snapshots_num = 0;
+	if (p >= inprec_buffer + header_end2 && (p[0] & 0x7f) == INPREC_END && inprec_reclen (p) == HEADERSIZE + 4) {
+		uae_u32 offset = getu32 (p + HEADERSIZE);
+		uae_u8 *ip = inprec_buffer + offset;
+		if (offset >= header_end2 && ip + HEADERSIZE + 4 <= p && (ip[0] & 0x7f) == INPREC_INDEX && ip + inprec_reclen (ip) == p) {
+			int num = getu32 (ip + HEADERSIZE) / 8;
+			ip += HEADERSIZE + 4;
+			for (int i = 0; i < num; i++, ip += 8)
+				addsnapshot (getu32 (ip), getu32 (ip + 4));
+			write_log (_T("INPREC: %d snapshots in index\n"), snapshots_num);
+			return;
+		}
+	}
+	for (p = inprec_buffer + header_end2; p + HEADERSIZE <= end; p += inprec_reclen (p)) {
+		if ((p[0] & 0x7f) == INPREC_SNAPSHOT)
+			addsnapshot (getu32 (p + 3), p - inprec_buffer);
+	}
+	write_log (_T("INPREC: no index, %d snapshots found\n"), snapshots_num);
+}
+
+static void putu32 (uae_u8 *p, uae_u32 v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+/* index record and END record pointing to it, terminates the recording */
+static void writeindex (struct zfile *zf, const struct inprec_snapshot *list, int num)
+{
+	uae_u8 tmp[HEADERSIZE + 4];
+	int offset = zfile_ftell (zf);
+
+	for (int i = 0; i < 2; i++) {
+		tmp[0] = i ? INPREC_END : INPREC_INDEX;
+		tmp[1] = 0;
+		tmp[2] = HEADERSIZE + 4;
+		putu32 (tmp + 3, hsync_counter);
+		tmp[7] = current_hpos ();
+		putu32 (tmp + 8, get_cycles ());
+		putu32 (tmp + HEADERSIZE, i ? offset : num * 8);
+		zfile_fwrite (tmp, sizeof tmp, 1, zf);
+		for (int j = 0; !i && j < num; j++) {
+			uae_u8 e[8];
+			putu32 (e, list[j].hsync);
+			putu32 (e + 4, list[j].offset);
+			zfile_fwrite (e, sizeof e, 1, zf);
+		}
+	}
+}
+
 
 int inprec_open (const TCHAR *fname, const TCHAR *statefilename)
 {
@@ -370,6 +472,9 @@ int inprec_open (const TCHAR *fname, const TCHAR *statefilename)
 	warned = 10;
 	cycleoffset = 0;
 	header_end2 = 0;
+	snapshots_num = 0;
+	seek_hsync = 0;
+	seekseed_valid = false;
 	if (input_play) {
 		uae_u32 id;
 		zfile_fseek (inprec_zf, 0, SEEK_END);
@@ -384,7 +489,7 @@ int inprec_open (const TCHAR *fname, const TCHAR *statefilename)
 			return 0;
 		}
 		int v = inprec_pu8 ();
-		if (v != 2) {
+		if (v != 2 && v != 3) {
 			inprec_close (true);
 			return 0;
 		}
@@ -444,11 +549,12 @@ int inprec_open (const TCHAR *fname, const TCHAR *statefilename)
 		inprec_p = inprec_plastptr;
 		header_end2 = inprec_plastptr - inprec_buffer;
 		findlast ();
+		loadindex ();
 	} else if (input_record) {
 		seed = uaesrand (seed);
 		inprec_buffer = inprec_p = xmalloc (uae_u8, inprec_size);
 		inprec_ru32 (0x55414500 /* 'UAE\0' */);
-		inprec_ru8 (2);
+		inprec_ru8 (3);
 		inprec_ru8 (UAEMAJOR);
 		inprec_ru8 (UAEMINOR);
 		inprec_ru8 (UAESUBREV);
@@ -457,7 +563,11 @@ int inprec_open (const TCHAR *fname, const TCHAR *statefilename)
 		inprec_ru32 (hsync_counter);
 		inprec_ru32 (0); // extra header size
 		flush ();
-		header_end2 = header_end = zfile_ftell (inprec_zf);
+		header_end = zfile_ftell (inprec_zf);
+		/* the linked statefile as inprec_save () writes it, so the file plays as it is */
+		inprec_rstr (statefilename ? statefilename : _T(""));
+		flush ();
+		header_end2 = zfile_ftell (inprec_zf);
 	} else {
 		input_record = input_play = 0;
 		return 0;
@@ -473,7 +583,12 @@ int inprec_open (const TCHAR *fname, const TCHAR *statefilename)
 
 void inprec_startup (void)
 {
-	uaesrand (seed);
+	if (seekseed_valid) {
+		uaesrand (seekseed);
+		seekseed_valid = false;
+	} else {
+		uaesrand (seed);
+	}
 }
 
 bool inprec_prepare_record (const TCHAR *statefilename)
@@ -484,6 +599,10 @@ bool inprec_prepare_record (const TCHAR *statefilename)
 	if (statefilename)
 		_tcscpy (state, statefilename);
 	if (hsync_counter > 0 && savestate_state == 0) {
+#ifdef __LIBRETRO__
+		/* no statefile path here, inprec_open () looks next to the recording first */
+		_tcscpy (state, changed_prefs.inprecfile);
+#else
 		TCHAR *s = _tcsrchr (changed_prefs.inprecfile, '\\');
 		if (!s)
 			s = _tcsrchr (changed_prefs.inprecfile, '/');
@@ -493,10 +612,14 @@ bool inprec_prepare_record (const TCHAR *statefilename)
 		} else {
 			_tcscpy (state, changed_prefs.inprecfile);
 		}
+#endif
 		_tcscat (state, _T(".uss"));
 		savestate_initsave (state, 1, 1, true); 
 		save_state (state, _T("input recording test"));
 		mode = 2;
+		/* playback restores the statefile after a reset */
+		hsync_counter = 0;
+		vsync_counter = 0;
 	}
 	input_record = INPREC_RECORD_NORMAL;
 	inprec_open (changed_prefs.inprecfile, state);
@@ -505,20 +628,41 @@ bool inprec_prepare_record (const TCHAR *statefilename)
 }
 
 
+/* m68k_go () opens fname at the next instruction, a recording starts
+ * from a statefile of the running machine */
+void inprec_start (const TCHAR *fname, bool record)
+{
+	inprec_close (true);
+	_tcscpy (changed_prefs.inprecfile, fname);
+	_tcscpy (currprefs.inprecfile, fname);
+	if (record)
+		input_record = INPREC_RECORD_NORMAL;
+	else
+		input_play = INPREC_PLAY_NORMAL;
+	set_special (SPCFLAG_MODE_CHANGE);
+}
+
 void inprec_close (bool clear)
 {
+	if (inprec_zf && inprec_buffer && input_record) {
+		if (input_record != INPREC_RECORD_PLAYING)
+			writeindex (inprec_zf, snapshots, snapshots_num);
+	}
 	if (clear)
 		input_play = input_record = 0;
 	if (!inprec_zf)
 		return;
-	if (inprec_buffer && input_record) {
-		if (inprec_rstart (INPREC_END))
-			inprec_rend ();
-	}
 	zfile_fclose (inprec_zf);
 	inprec_zf = NULL;
 	xfree (inprec_buffer);
 	inprec_buffer = NULL;
+	xfree (snapshots);
+	snapshots = NULL;
+	snapshots_num = snapshots_max = 0;
+	if (seek_hsync) {
+		seek_hsync = 0;
+		clear_inhibit_frame (IHF_INPREC);
+	}
 	input_play = input_record = 0;
 	write_log (_T("inprec finished\n"));
 	refreshtitle ();
@@ -680,7 +824,7 @@ void inprec_playdebug (uae_u32 val)
 {
 #if INPUTRECORD_DEBUG > 0
 	extern void activate_debugger (void);
-	static uae_u32 pcs[16];
+	static UAE_TLS uae_u32 pcs[16];
 	int err = 0;
 	if (inprec_pstart (INPREC_DEBUG)) {
 		uae_u32 seed1 = uaerandgetseed ();
@@ -772,7 +916,7 @@ void inprec_playtorecord (void)
 	uae_u8 *p = inprec_buffer + header_end2;
 	uae_u8 *end = inprec_buffer + inprec_size;
 	while (p < end) {
-		int len = (p[1] << 8) | (p[2] << 0);
+		int len = inprec_reclen (p);
 		p[0] &= ~0x80;
 		p += len;
 	}
@@ -804,6 +948,98 @@ void inprec_setposition (int offset, int replaycounter)
 		inprec_realtime (false);
 }
 
+static void recordsnapshot (void)
+{
+	struct zfile *f;
+	uae_u8 *data;
+	int len, offset;
+
+	f = savestate_snapshot ();
+	if (!f)
+		return;
+	len = zfile_size (f);
+	data = zfile_getdata (f, 0, len);
+	zfile_fclose (f);
+	offset = zfile_ftell (inprec_zf) + (inprec_p - inprec_buffer);
+	if (data && inprec_rstart (INPREC_SNAPSHOT)) {
+		inprec_ru32 (vsync_counter);
+		inprec_ru32 (uaerandgetseed ());
+		inprec_ru32 (len);
+		inprec_rend ();
+		zfile_fwrite (data, len, 1, inprec_zf);
+		addsnapshot (hsync_counter, offset);
+	}
+	xfree (data);
+}
+
+void inprec_vsync (void)
+{
+	if (input_play) {
+		while (inprec_pstart (INPREC_SNAPSHOT))
+			inprec_pend ();
+		if (seek_hsync && hsync_counter >= seek_hsync) {
+			write_log (_T("INPREC: seek to %d done\n"), seek_hsync);
+			seek_hsync = 0;
+			clear_inhibit_frame (IHF_INPREC);
+		} else if (seek_hsync) {
+			/* snapshot restore resets the display */
+			set_inhibit_frame (IHF_INPREC);
+		}
+	} else if (input_record == INPREC_RECORD_NORMAL || input_record == INPREC_RECORD_RERECORD) {
+		int rate = currprefs.inprec_snapshotrate;
+		if (rate > 0 && vsync_counter > 0 && vsync_counter % rate == 0)
+			recordsnapshot ();
+	}
+}
+
+// restore nearest snapshot and replay to hsync without drawing
+bool inprec_seek (uae_u32 hsync)
+{
+	struct inprec_snapshot *sn = NULL;
+	uae_u8 *p, *end;
+	int i;
+
+	if (input_play != INPREC_PLAY_NORMAL || input_record || !inprec_buffer || savestate_state)
+		return false;
+	for (i = 0; i < snapshots_num && snapshots[i].hsync <= hsync; i++)
+		sn = &snapshots[i];
+	if (hsync >= hsync_counter && (!sn || sn->hsync <= hsync_counter)) {
+		write_log (_T("INPREC: fast forward %d -> %d\n"), hsync_counter, hsync);
+		seek_hsync = hsync;
+		set_inhibit_frame (IHF_INPREC);
+		return true;
+	}
+	if (!sn) {
+		write_log (_T("INPREC: no snapshot before %d\n"), hsync);
+		return false;
+	}
+	p = inprec_buffer + sn->offset;
+	if ((p[0] & 0x7f) != INPREC_SNAPSHOT || p + inprec_reclen (p) > inprec_buffer + inprec_size) {
+		write_log (_T("INPREC: snapshot at offset %d corrupt\n"), sn->offset);
+		return false;
+	}
+	struct zfile *f = zfile_fopen_data (_T("snapshot.uss"), getu32 (p + HEADERSIZE + 8), p + HEADERSIZE + 12);
+	savestate_restore_snapshot (f, sn->hsync, getu32 (p + HEADERSIZE));
+	seekseed = getu32 (p + HEADERSIZE + 4);
+	seekseed_valid = true;
+	write_log (_T("INPREC: seek %d -> snapshot %d\n"), hsync, sn->hsync);
+
+	// events after the snapshot are played again
+	inprec_p = p + inprec_reclen (p);
+	end = inprec_buffer + inprec_size;
+	for (p = inprec_p; p < end; p += inprec_reclen (p))
+		p[0] &= ~0x80;
+	inprec_plast = NULL;
+	inprec_plastptr = NULL;
+	lasthsync = sn->hsync;
+	seek_hsync = hsync > sn->hsync ? hsync : 0;
+	if (seek_hsync)
+		set_inhibit_frame (IHF_INPREC);
+	else
+		clear_inhibit_frame (IHF_INPREC);
+	return true;
+}
+
 static void savelog (const TCHAR *path, const TCHAR *file)
 {
 	TCHAR tmp[MAX_DPATH];
@@ -888,11 +1124,18 @@ void inprec_save (const TCHAR *filename, const TCHAR *statefilename)
 		data = zfile_getdata (inprec_zf, header_end2, len);
 		uae_u8 *p = data;
 		uae_u8 *end = data + len;
+		struct inprec_snapshot *list = xcalloc (struct inprec_snapshot, snapshots_num + 1);
+		int num = 0;
 		while (p < end) {
 			uae_u8 tmp[MAX_DPATH];
-			int plen = (p[1] << 8) | (p[2] << 0);
-			int wlen = plen - HEADERSIZE;
-			memcpy (tmp, p + HEADERSIZE, wlen);
+			int plen = inprec_reclen (p);
+			int wlen = 0;
+			if ((p[0] & 0x7f) == INPREC_INDEX || (p[0] & 0x7f) == INPREC_END)
+				break;
+			if ((p[0] & 0x7f) == INPREC_SNAPSHOT && num <= snapshots_num) {
+				list[num].hsync = getu32 (p + 3);
+				list[num++].offset = zfile_ftell (zf);
+			}
 			if (p[0] == INPREC_DISKINSERT) {
 				wlen = savedisk (path, file, p + HEADERSIZE, tmp);
 			}
@@ -907,6 +1150,8 @@ void inprec_save (const TCHAR *filename, const TCHAR *statefilename)
 			}
 			p += plen;
 		}
+		writeindex (zf, list, num);
+		xfree (list);
 		xfree (data);
 		zfile_fclose (zf);
 		savelog (path, file);
@@ -23,10 +23,10 @@
 #include "custom.h"
 #include "savestate.h"
 
-static int kpb_first, kpb_last;
+static UAE_TLS int kpb_first, kpb_last;
 
 #define KEYBUF_SIZE 256
-static int keybuf[KEYBUF_SIZE];
+static UAE_TLS int keybuf[KEYBUF_SIZE];
 
 int keys_available (void)
 {
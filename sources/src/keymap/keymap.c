@@ -322,8 +322,8 @@ static int ctrlpressed (void)
 	return input_getqualifiers () & ID_FLAG_QUALIFIER_CONTROL;
 }
 
-static int capslockstate;
-static int host_capslockstate, host_numlockstate, host_scrolllockstate;
+static UAE_TLS int capslockstate;
+static UAE_TLS int host_capslockstate, host_numlockstate, host_scrolllockstate;
 
 /*int getcapslockstate (void)
 {
@@ -370,7 +370,7 @@ void my_kbd_handler (int keyboard, int scancode, int newstate)
         int defaultguikey;
         bool amode = currprefs.input_keyboard_type == 0;
         bool special = false;
-        static int swapperdrive = 0;
+        static UAE_TLS int swapperdrive = 0;
 
 	scancode_new = scancode;
 	if (!specialpressed () && inputdevice_iskeymapped (keyboard, scancode))
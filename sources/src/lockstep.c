@@ -0,0 +1,323 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Deterministic lockstep mode
+  *
+  * The emulated clock counts colour clocks per scanline and converts
+  * them at the chipset crystal rate, so an emulated second is the same
+  * number of lines on every host. It is kept across keyboard resets and
+  * statefiles, like a battery backed clock, and only starts over at a
+  * hard reset.
+  *
+  * The self-test takes a snapshot, restores it and records every target
+  * input event together with the state digest of each frame, then
+  * restores the snapshot again and feeds the recorded input back while
+  * live input is dropped. Both runs start from a restore, so whatever
+  * the restore itself does is the same on both.
+  */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "options.h"
+#include "custom.h"
+#include "inputdevice.h"
+#include "zfile.h"
+#include "savestate.h"
+#include "statehash.h"
+#include "lockstep.h"
+
+#if defined(WIIU)
+#include <features_cpu.h>
+#endif
+
+extern uae_u32 uaesrand (uae_u32 seed);
+extern uae_u32 uaerandgetseed (void);
+
+static UAE_TLS uae_u64 clock_usec, clock_cck;
+static UAE_TLS uae_u32 clock_rate;
+
+static UAE_TLS uae_u64 rand_state;
+static UAE_TLS uae_u32 rand_seed;
+static UAE_TLS bool rand_valid;
+
+struct lockstep_event {
+	int frame;
+	int type, port, a, b;
+};
+
+enum { ST_OFF, ST_START, ST_RECORD, ST_REPLAY };
+
+static UAE_TLS int st_mode, st_frames;
+static UAE_TLS uae_u32 st_hsync, st_vsync;
+static UAE_TLS uae_u8 *st_snapshot;
+static UAE_TLS int st_snapshot_len;
+static UAE_TLS uae_u64 *st_digest;
+static UAE_TLS struct lockstep_event *st_log;
+static UAE_TLS int st_log_num, st_log_max, st_log_pos;
+static UAE_TLS bool st_statehash;
+
+void lockstep_reset (void)
+{
+	clock_usec = 0;
+	clock_cck = 0;
+	clock_rate = 0;
+	rand_valid = false;
+}
+
+void lockstep_hsync (void)
+{
+	uae_u32 rate = currprefs.ntscmode ? CHIPSET_CLOCK_NTSC : CHIPSET_CLOCK_PAL;
+
+	if (rate != clock_rate) {
+		if (clock_rate)
+			clock_usec += clock_cck * 1000000 / clock_rate;
+		clock_cck = 0;
+		clock_rate = rate;
+	}
+	clock_cck += maxhpos;
+}
+
+uae_u64 lockstep_usec (void)
+{
+	if (currprefs.lockstep) {
+		uae_u64 t = clock_usec;
+		if (clock_rate)
+			t += clock_cck * 1000000 / clock_rate;
+		return (uae_u64)LOCKSTEP_EPOCH * 1000000 + t;
+	}
+#ifdef WIIU
+	return cpu_features_get_time_usec ();
+#else
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return (uae_u64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+time_t lockstep_time (void)
+{
+	if (currprefs.lockstep)
+		return (time_t)(lockstep_usec () / 1000000);
+	return time (0);
+}
+
+struct tm *lockstep_localtime (const time_t *t)
+{
+	if (currprefs.lockstep)
+		return gmtime (t);
+	return localtime (t);
+}
+
+/* xorshift64*, libc rand () differs between hosts and is shared with them */
+uae_u32 lockstep_rand (uae_u32 seed)
+{
+	if (!rand_valid || seed != rand_seed) {
+		rand_state = statehash_mix (currprefs.lockstep_seed, seed) | 1;
+		rand_seed = seed;
+		rand_valid = true;
+	}
+	rand_state ^= rand_state >> 12;
+	rand_state ^= rand_state << 25;
+	rand_state ^= rand_state >> 27;
+	return (uae_u32)(((rand_state * 0x2545f4914f6cdd1dULL) >> 32) % ((uae_u64)UAE_RAND_MAX + 1));
+}
+
+static void selftest_free (void)
+{
+	if (st_statehash)
+		statehash_enable (0);
+	st_statehash = false;
+	xfree (st_snapshot);
+	st_snapshot = NULL;
+	xfree (st_digest);
+	st_digest = NULL;
+	xfree (st_log);
+	st_log = NULL;
+	st_log_num = st_log_max = st_log_pos = 0;
+	st_mode = ST_OFF;
+}
+
+static void selftest_restore (void)
+{
+	struct zfile *f = zfile_fopen_data (_T("lockstep.uss"), st_snapshot_len, st_snapshot);
+	savestate_restore_snapshot (f, st_hsync, st_vsync);
+}
+
+static void selftest_start (void)
+{
+	struct zfile *f;
+
+	if (!statehash_get ()) {
+		statehash_enable (50);
+		st_statehash = true;
+	}
+	f = savestate_snapshot ();
+	if (f) {
+		st_snapshot_len = zfile_size (f);
+		st_snapshot = zfile_getdata (f, 0, st_snapshot_len);
+		zfile_fclose (f);
+	}
+	st_digest = xcalloc (uae_u64, st_frames + 1);
+	if (!st_snapshot || !st_digest) {
+		write_log (_T("LOCKSTEP: self-test could not take a snapshot\n"));
+		selftest_free ();
+		return;
+	}
+	st_hsync = hsync_counter;
+	st_vsync = vsync_counter;
+	st_mode = ST_RECORD;
+	write_log (_T("LOCKSTEP: self-test, %d frames from vsync %d\n"), st_frames, st_vsync);
+	selftest_restore ();
+}
+
+static void selftest_play (int frame)
+{
+	while (st_log_pos < st_log_num && st_log[st_log_pos].frame <= frame) {
+		struct lockstep_event *e = &st_log[st_log_pos++];
+		switch (e->type)
+		{
+		case LOCKSTEP_MOUSE:
+			setmousestate (e->port, 0, e->a, 0);
+			setmousestate (e->port, 1, e->b, 0);
+			break;
+		case LOCKSTEP_MOUSE_BUTTON:
+			setmousebuttonstate (e->port, e->a, e->b);
+			break;
+		case LOCKSTEP_JOY:
+			setjoystickstate (e->port, e->a, e->b, 1);
+			break;
+		case LOCKSTEP_JOY_BUTTON:
+			setjoybuttonstate (e->port, e->a, e->b);
+			break;
+		case LOCKSTEP_KEY:
+			inputdevice_do_keyboard (e->a, e->b);
+			break;
+		}
+	}
+}
+
+/* after the frame is handed to the target and its input is in */
+void lockstep_vsync (void)
+{
+	int frame;
+
+	if (st_mode == ST_OFF)
+		return;
+	if (!currprefs.lockstep) {
+		/* the option was just switched on, check_prefs_changed_custom ()
+		 * has not copied it yet: start once it has */
+		if (st_mode == ST_START && changed_prefs.lockstep)
+			return;
+		write_log (_T("LOCKSTEP: self-test needs lockstep mode\n"));
+		selftest_free ();
+		return;
+	}
+	if (st_mode == ST_START) {
+		selftest_start ();
+		return;
+	}
+	frame = vsync_counter - st_vsync;
+	if (frame <= 0 || frame > st_frames)
+		return;
+	if (st_mode == ST_RECORD) {
+		st_digest[frame] = statehash_get ();
+		if (frame == st_frames) {
+			write_log (_T("LOCKSTEP: self-test, %d input events recorded\n"), st_log_num);
+			st_mode = ST_REPLAY;
+			st_log_pos = 0;
+			selftest_restore ();
+		}
+		return;
+	}
+	if (statehash_get () != st_digest[frame]) {
+		write_log (_T("LOCKSTEP: self-test failed at frame %d, digest %016llx, first run %016llx\n"),
+			frame, statehash_get (), st_digest[frame]);
+		selftest_free ();
+		return;
+	}
+	if (frame == st_frames) {
+		write_log (_T("LOCKSTEP: self-test passed, %d frames\n"), st_frames);
+		selftest_free ();
+		return;
+	}
+	selftest_play (frame);
+}
+
+bool lockstep_input (int type, int port, int a, int b)
+{
+	struct lockstep_event *e;
+
+	if (st_mode == ST_REPLAY)
+		return true;
+	if (st_mode != ST_RECORD)
+		return false;
+	if (st_log_num >= st_log_max) {
+		int max = st_log_max ? st_log_max * 2 : 256;
+		e = xrealloc (struct lockstep_event, st_log, max);
+		if (!e)
+			return false;
+		st_log = e;
+		st_log_max = max;
+	}
+	e = &st_log[st_log_num++];
+	e->frame = vsync_counter - st_vsync;
+	e->type = type;
+	e->port = port;
+	e->a = a;
+	e->b = b;
+	return false;
+}
+
+void lockstep_selftest (int frames)
+{
+	selftest_free ();
+	if (frames <= 0)
+		return;
+	st_frames = frames;
+	st_mode = ST_START;
+}
+
+#ifdef SAVESTATE
+
+uae_u8 *save_lockstep (int *len, uae_u8 *dstptr)
+{
+	uae_u8 *dstbak, *dst;
+
+	if (!currprefs.lockstep)
+		return NULL;
+	if (dstptr)
+		dstbak = dst = dstptr;
+	else
+		dstbak = dst = xmalloc (uae_u8, 100);
+	save_u32 (1);
+	save_u32 (hsync_counter);
+	save_u32 (vsync_counter);
+	save_u32 (uaerandgetseed ());
+	save_u32 (rand_valid ? 1 : 0);
+	save_u32 (rand_seed);
+	save_u64 (rand_state);
+	save_u32 (clock_rate);
+	save_u64 (clock_usec);
+	save_u64 (clock_cck);
+	*len = dst - dstbak;
+	return dstbak;
+}
+
+uae_u8 *restore_lockstep (uae_u8 *src)
+{
+	if (restore_u32 () != 1)
+		return src;
+	hsync_counter = restore_u32 ();
+	vsync_counter = restore_u32 ();
+	uaesrand (restore_u32 ());
+	rand_valid = restore_u32 () != 0;
+	rand_seed = restore_u32 ();
+	rand_state = restore_u64 ();
+	clock_rate = restore_u32 ();
+	clock_usec = restore_u64 ();
+	clock_cck = restore_u64 ();
+	return src;
+}
+
+#endif /* SAVESTATE */
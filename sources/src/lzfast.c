@@ -0,0 +1,162 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Fast LZ77 block compressor
+  *
+  * Stream of sequences: token byte (literal count << 4 | match length - 4),
+  * 255-continued literal count, literals, 16-bit little endian match
+  * offset, 255-continued match length. The last sequence has literals
+  * only, the decoder stops when the output block is full.
+  */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "lzfast.h"
+
+#define HASH_BITS 13
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+
+STATIC_INLINE uae_u32 read32 (const uae_u8 *p)
+{
+	uae_u32 v;
+	memcpy (&v, p, 4);
+	return v;
+}
+
+STATIC_INLINE int lzhash (uae_u32 v)
+{
+	return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static uae_u8 *put_length (uae_u8 *op, int len)
+{
+	while (len >= 255) {
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = len;
+	return op;
+}
+
+static uae_u8 *put_sequence (uae_u8 *op, uae_u8 *oend, const uae_u8 *lit, int litlen, int matchlen, int offset)
+{
+	int mlen = matchlen - MIN_MATCH;
+
+	if (litlen + litlen / 255 + (mlen > 0 ? mlen / 255 : 0) + 8 > oend - op)
+		return NULL;
+	*op++ = ((litlen < 15 ? litlen : 15) << 4) | (mlen < 0 ? 0 : (mlen < 15 ? mlen : 15));
+	if (litlen >= 15)
+		op = put_length (op, litlen - 15);
+	memcpy (op, lit, litlen);
+	op += litlen;
+	if (mlen < 0)
+		return op;
+	*op++ = offset;
+	*op++ = offset >> 8;
+	if (mlen >= 15)
+		op = put_length (op, mlen - 15);
+	return op;
+}
+
+int lzfast_compress (const uae_u8 *src, int srclen, uae_u8 *dst, int dstlen)
+{
+	uae_u32 table[1 << HASH_BITS];
+	const uae_u8 *ip = src, *anchor = src, *end = src + srclen;
+	uae_u8 *op = dst, *oend = dst + dstlen;
+	int misses = 0;
+
+	memset (table, 0, sizeof table);
+	while (end - ip >= MIN_MATCH) {
+		int h = lzhash (read32 (ip));
+		const uae_u8 *ref = src + table[h];
+
+		table[h] = ip - src;
+		if (ref < ip && ip - ref <= MAX_OFFSET && read32 (ref) == read32 (ip)) {
+			const uae_u8 *m = ip + MIN_MATCH, *r = ref + MIN_MATCH;
+			while (end - m >= 4 && read32 (m) == read32 (r)) {
+				m += 4;
+				r += 4;
+			}
+			while (m < end && *m == *r) {
+				m++;
+				r++;
+			}
+			op = put_sequence (op, oend, anchor, ip - anchor, m - ip, ip - ref);
+			if (!op)
+				return 0;
+			ip = anchor = m;
+			misses = 0;
+		} else {
+			/* skip faster through data that does not compress */
+			ip += 1 + (misses++ >> 5);
+		}
+	}
+	if (anchor < end) {
+		op = put_sequence (op, oend, anchor, end - anchor, 0, 0);
+		if (!op)
+			return 0;
+	}
+	return op - dst;
+}
+
+static int get_length (const uae_u8 **ipp, const uae_u8 *iend, int len)
+{
+	const uae_u8 *ip = *ipp;
+	int c;
+
+	do {
+		if (ip >= iend)
+			return -1;
+		c = *ip++;
+		len += c;
+	} while (c == 255);
+	*ipp = ip;
+	return len;
+}
+
+int lzfast_decompress (const uae_u8 *src, int srclen, uae_u8 *dst, int dstlen)
+{
+	const uae_u8 *ip = src, *iend = src + srclen;
+	uae_u8 *op = dst, *oend = dst + dstlen;
+
+	while (op < oend) {
+		const uae_u8 *ref;
+		int token, len, offset;
+
+		if (ip >= iend)
+			return -1;
+		token = *ip++;
+		len = token >> 4;
+		if (len == 15 && (len = get_length (&ip, iend, len)) < 0)
+			return -1;
+		if (len > iend - ip || len > oend - op)
+			return -1;
+		memcpy (op, ip, len);
+		op += len;
+		ip += len;
+		if (op >= oend)
+			break;
+
+		if (iend - ip < 2)
+			return -1;
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		len = token & 15;
+		if (len == 15 && (len = get_length (&ip, iend, len)) < 0)
+			return -1;
+		len += MIN_MATCH;
+		if (offset == 0 || offset > op - dst || len > oend - op)
+			return -1;
+		ref = op - offset;
+		if (offset >= len) {
+			memcpy (op, ref, len);
+			op += len;
+		} else {
+			while (len-- > 0)
+				*op++ = *ref++;
+		}
+	}
+	return op - dst;
+}
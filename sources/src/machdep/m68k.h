@@ -15,7 +15,7 @@ struct flag_struct {
     unsigned int x;
 };
 
-extern struct flag_struct regflags;
+extern UAE_TLS struct flag_struct regflags;
 
 /*
  * The bits in the cznv field in the above structure are assigned to
@@ -52,7 +52,7 @@ STATIC_INLINE uae_s64 read_processor_time(void)
     return (secs - start_sec) * (osd_ticks_t) 1000000 + usecs;
 #else
    struct timeval    tp;
-   static osd_ticks_t start_sec = 0;
+   static UAE_TLS osd_ticks_t start_sec = 0;
 
    gettimeofday(&tp, NULL);
    if (start_sec==0)
@@ -23,7 +23,7 @@
 #define LARGE_ALIGNMENT ".align 4,0x90\n"
 #endif
 
-struct flag_struct regflags;
+UAE_TLS struct flag_struct regflags;
 
 #if defined(__CELLOS_LV2__) || defined(_WIN32) || defined(WIIU)
 
@@ -152,10 +152,10 @@ frame_time_t apple_get_tsc_freq (void)
 }
 #endif
 
-static volatile frame_time_t last_time, best_time;
-static frame_time_t timebase;
+static UAE_TLS volatile frame_time_t last_time, best_time;
+static UAE_TLS frame_time_t timebase;
 
-static volatile int loops_to_go;
+static UAE_TLS volatile int loops_to_go;
 
 #if defined HAVE_SETITIMER || defined HAVE_ALARM
 # define USE_ALARM
@@ -188,7 +188,7 @@ static void set_the_alarm (void)
 # endif
 }
 
-static int first_loop = 1;
+static UAE_TLS int first_loop = 1;
 
 #ifdef __cplusplus
 static RETSIGTYPE alarmhandler(...)
@@ -213,7 +213,7 @@ static RETSIGTYPE alarmhandler(int foo)
 #endif /* USE_ALARM */
 
 #include <setjmp.h>
-static jmp_buf catch_test;
+static UAE_TLS jmp_buf catch_test;
 
 #ifdef __cplusplus
 static RETSIGTYPE illhandler (...)
@@ -227,7 +227,7 @@ static RETSIGTYPE illhandler (int foo)
 
 int machdep_inithrtimer (void)
 {
-    static int done = 0;
+    static UAE_TLS int done = 0;
 
     if (!done) {
 //		rpt_available = 1;
@@ -58,12 +58,16 @@
 #include "gayle.h"
 #include "misc.h"
 #include "keyboard.h"
+#include "lockstep.h"
 #ifdef RETROPLATFORM
 #include "rp.h"
 #endif
 #ifdef USE_SDL
 #include "SDL.h"
 #endif
+#ifdef __LIBRETRO__
+#include "retro_prefs.h"
+#endif
 
 /* internal prototypes */
 uae_u32 uaerand (void);
@@ -73,27 +77,27 @@ void my_trim (TCHAR *s);
 TCHAR *my_strdup_trim (const TCHAR *s);
 
 /* internal members */
-long int version = 256 * 65536L * UAEMAJOR + 65536L * UAEMINOR + UAESUBREV;
+UAE_TLS long int version = 256 * 65536L * UAEMAJOR + 65536L * UAEMINOR + UAESUBREV;
 
-struct uae_prefs currprefs, changed_prefs;
-int config_changed;
+UAE_TLS struct uae_prefs currprefs, changed_prefs;
+UAE_TLS int config_changed;
 
-int pissoff_value = 15000 * CYCLE_UNIT;
-int pause_emulation;
-char start_path_data[MAX_DPATH];
-bool no_gui = 0, quit_to_gui = 0;
-bool cloanto_rom = 0;
-bool kickstart_rom = 1;
-bool console_emulation = 0;
+UAE_TLS int pissoff_value = 15000 * CYCLE_UNIT;
+UAE_TLS int pause_emulation;
+UAE_TLS char start_path_data[MAX_DPATH];
+UAE_TLS bool no_gui = 0, quit_to_gui = 0;
+UAE_TLS bool cloanto_rom = 0;
+UAE_TLS bool kickstart_rom = 1;
+UAE_TLS bool console_emulation = 0;
 
-struct gui_info gui_data;
+UAE_TLS struct gui_info gui_data;
 
-TCHAR warning_buffer[256];
+UAE_TLS TCHAR warning_buffer[256];
 
-TCHAR optionsfile[256];
+UAE_TLS TCHAR optionsfile[256];
 
-static unsigned long randseed;
-static unsigned long oldhcounter;
+static UAE_TLS unsigned long randseed;
+static UAE_TLS unsigned long oldhcounter;
 
 #ifndef _WIN32
 // Prototype in sysdeps.h
@@ -141,6 +145,8 @@ uae_u32 uaesrand (uae_u32 seed)
 
 uae_u32 uaerand (void)
 {
+	if (currprefs.lockstep)
+		return lockstep_rand (hsync_counter ^ randseed);
 	if (oldhcounter != hsync_counter) {
 		srand (hsync_counter ^ randseed);
 		oldhcounter = hsync_counter;
@@ -580,10 +586,10 @@ void fixup_prefs (struct uae_prefs *p)
 	target_fixup_options (p);
 }
 
-int quit_program = 0;
-static int restart_program;
-static TCHAR restart_config[MAX_DPATH];
-static int default_config;
+UAE_TLS int quit_program = 0;
+static UAE_TLS int restart_program;
+static UAE_TLS TCHAR restart_config[MAX_DPATH];
+static UAE_TLS int default_config;
 
 void uae_reset (int hardreset, int keyboardreset)
 {
@@ -810,6 +816,13 @@ _tcscat (optionsfile, _T("/"));
 	_tcscat (optionsfile, restart_config);
 
 
+#ifdef __LIBRETRO__
+	/* the core builds its configuration in memory, see retro_prefs.c */
+	if (argc <= 1) {
+		if (!retro_prefs_load (&currprefs))
+			write_log (_T("failed to load libretro config\n"));
+	} else
+#endif
 	if (argc > 1 && ! target_cfgfile_load (&currprefs, argv[1], 0, default_config)) {
 		write_log (_T("failed to load config '%s'\n"), optionsfile);
 #ifdef OPTIONS_IN_HOME
@@ -917,6 +930,9 @@ void do_leave_program (void)
 {
 #ifdef SAMPLER
 	sampler_free ();
+#endif
+#ifdef DEBUGGER
+	pcprof_free ();
 #endif
 	graphics_leave ();
 	inputdevice_close ();
@@ -959,6 +975,7 @@ void do_leave_program (void)
 	device_func_reset ();
 #endif
 	savestate_free ();
+	savestate_cleanup ();
 	memory_cleanup ();
 #ifdef NATMEM_OFFSET
 	free_shm ();
@@ -1162,11 +1179,11 @@ void real_main (int argc, TCHAR **argv)
 #endif
 
 	write_log (_T("Enumerating display devices.. \n"));
-#ifndef __LIBRETRO__
+#if !defined(__LIBRETRO__) || defined(PICASSO96)
 	enumeratedisplays ();
 #endif
 	write_log (_T("Sorting devices and modes..\n"));
-#ifndef __LIBRETRO__
+#if !defined(__LIBRETRO__) || defined(PICASSO96)
 	sortdisplays ();
 #endif
 //	write_log (_T("Display buffer mode = %d\n"), ddforceram);
@@ -17,6 +17,8 @@
 #include "rommgr.h"
 #include "ersatz.h"
 #include "zfile.h"
+#include "romshare.h"
+#include "statehash.h"
 #include "custom.h"
 #include "events.h"
 #include "newcpu.h"
@@ -41,14 +43,14 @@ extern uae_u8 *natmem_offset, *natmem_offset_end;
 #include <sys/mman.h>
 #endif
 
-bool canbang;
-int candirect = -1;
-static bool rom_write_enabled;
+UAE_TLS bool canbang;
+UAE_TLS int candirect = -1;
+static UAE_TLS bool rom_write_enabled;
 #ifdef JIT
 /* Set by each memory handler that does not simply access real memory. */
 int special_mem;
 #endif
-static int mem_hardreset;
+static UAE_TLS int mem_hardreset;
 
 #define IPC_PRIVATE 1
 #define IPC_RMID    2
@@ -123,29 +125,29 @@ static void nocanbang (void)
 	canbang = 0;
 }
 
-uae_u32 allocated_chipmem;
-uae_u32 allocated_fastmem;
-uae_u32 allocated_bogomem;
-uae_u32 allocated_gfxmem;
-uae_u32 allocated_z3fastmem, allocated_z3fastmem2, allocated_z3chipmem;
-uae_u32 allocated_a3000lmem;
-uae_u32 allocated_a3000hmem;
-uae_u32 allocated_cardmem;
-uae_u8 ce_banktype[65536];
-uae_u8 ce_cachable[65536];
+UAE_TLS uae_u32 allocated_chipmem;
+UAE_TLS uae_u32 allocated_fastmem;
+UAE_TLS uae_u32 allocated_bogomem;
+UAE_TLS uae_u32 allocated_gfxmem;
+UAE_TLS uae_u32 allocated_z3fastmem, allocated_z3fastmem2, allocated_z3chipmem;
+UAE_TLS uae_u32 allocated_a3000lmem;
+UAE_TLS uae_u32 allocated_a3000hmem;
+UAE_TLS uae_u32 allocated_cardmem;
+UAE_TLS uae_u8 ce_banktype[65536];
+UAE_TLS uae_u8 ce_cachable[65536];
 
-static size_t bootrom_filepos, chip_filepos, bogo_filepos, rom_filepos, a3000lmem_filepos, a3000hmem_filepos;
+static UAE_TLS size_t bootrom_filepos, chip_filepos, bogo_filepos, rom_filepos, a3000lmem_filepos, a3000hmem_filepos;
 
 /* Set if we notice during initialization that settings changed,
 and we must clear all memory to prevent bogus contents from confusing
 the Kickstart.  */
-static bool need_hardreset;
-static bool bogomem_aliasing;
+static UAE_TLS bool need_hardreset;
+static UAE_TLS bool bogomem_aliasing;
 
 /* The address space setting used during the last reset.  */
-static bool last_address_space_24;
+static UAE_TLS bool last_address_space_24;
 
-addrbank *mem_banks[MEMORY_BANKS];
+UAE_TLS addrbank *mem_banks[MEMORY_BANKS];
 
 /* This has two functions. It either holds a host address that, when added
    to the 68k address, gives the host address corresponding to that 68k
@@ -153,7 +155,7 @@ addrbank *mem_banks[MEMORY_BANKS];
    same value as mem_banks, for those banks that have baseaddr==0. In that
    case, bit 0 is set (the memory access routines will take care of it).  */
 
-uae_u8 *baseaddr[MEMORY_BANKS];
+UAE_TLS uae_u8 *baseaddr[MEMORY_BANKS];
 
 #ifdef NO_INLINE_MEMORY_ACCESS
 __inline__ uae_u32 longget (uaecptr addr)
@@ -192,11 +194,11 @@ int addr_valid (const TCHAR *txt, uaecptr addr, uae_u32 len)
 	return 1;
 }
 
-uae_u32	chipmem_mask, chipmem_full_mask, chipmem_full_size;
-uae_u32 kickmem_mask, extendedkickmem_mask, extendedkickmem2_mask, bogomem_mask;
-uae_u32 a3000lmem_mask, a3000hmem_mask, cardmem_mask;
+UAE_TLS uae_u32	chipmem_mask, chipmem_full_mask, chipmem_full_size;
+UAE_TLS uae_u32 kickmem_mask, extendedkickmem_mask, extendedkickmem2_mask, bogomem_mask;
+UAE_TLS uae_u32 a3000lmem_mask, a3000hmem_mask, cardmem_mask;
 
-static int illegal_count;
+static UAE_TLS int illegal_count;
 /* A dummy bank that only contains zeros */
 
 static uae_u32 REGPARAM3 dummy_lget (uaecptr) REGPARAM;
@@ -359,7 +361,7 @@ static uae_u32 REGPARAM2 ones_get (uaecptr addr)
 
 /* Chip memory */
 
-uae_u8 *chipmemory;
+UAE_TLS uae_u8 *chipmemory;
 
 static int REGPARAM3 chipmem_check (uaecptr addr, uae_u32 size) REGPARAM;
 static uae_u8 *REGPARAM3 chipmem_xlate (uaecptr addr) REGPARAM;
@@ -421,6 +423,7 @@ void REGPARAM2 chipmem_lput_ce2 (uaecptr addr, uae_u32 l)
 	m = (uae_u32 *)(chipmemory + addr);
 	ce2_timeout ();
 	do_put_mem_long (m, l);
+	statehash_write (STATEHASH_CHIP, addr, 4);
 }
 
 void REGPARAM2 chipmem_wput_ce2 (uaecptr addr, uae_u32 w)
@@ -434,6 +437,7 @@ void REGPARAM2 chipmem_wput_ce2 (uaecptr addr, uae_u32 w)
 	m = (uae_u16 *)(chipmemory + addr);
 	ce2_timeout ();
 	do_put_mem_word (m, w);
+	statehash_write (STATEHASH_CHIP, addr, 2);
 }
 
 void REGPARAM2 chipmem_bput_ce2 (uaecptr addr, uae_u32 b)
@@ -444,6 +448,7 @@ void REGPARAM2 chipmem_bput_ce2 (uaecptr addr, uae_u32 b)
 	addr &= chipmem_mask;
 	ce2_timeout ();
 	chipmemory[addr] = b;
+	statehash_write (STATEHASH_CHIP, addr, 1);
 }
 
 #endif
@@ -482,6 +487,7 @@ void REGPARAM2 chipmem_lput (uaecptr addr, uae_u32 l)
 	addr &= chipmem_mask;
 	m = (uae_u32 *)(chipmemory + addr);
 	do_put_mem_long (m, l);
+	statehash_write (STATEHASH_CHIP, addr, 4);
 }
 
 void REGPARAM2 chipmem_wput (uaecptr addr, uae_u32 w)
@@ -491,12 +497,14 @@ void REGPARAM2 chipmem_wput (uaecptr addr, uae_u32 w)
 	addr &= chipmem_mask;
 	m = (uae_u16 *)(chipmemory + addr);
 	do_put_mem_word (m, w);
+	statehash_write (STATEHASH_CHIP, addr, 2);
 }
 
 void REGPARAM2 chipmem_bput (uaecptr addr, uae_u32 b)
 {
 	addr &= chipmem_mask;
 	chipmemory[addr] = b;
+	statehash_write (STATEHASH_CHIP, addr, 1);
 }
 
 /* cpu chipmem access inside agnus addressable ram but no ram available */
@@ -584,6 +592,7 @@ void REGPARAM2 chipmem_agnus_lput (uaecptr addr, uae_u32 l)
 		return;
 	m = (uae_u32 *)(chipmemory + addr);
 	do_put_mem_long (m, l);
+	statehash_write (STATEHASH_CHIP, addr, 4);
 }
 
 void REGPARAM2 chipmem_agnus_wput (uaecptr addr, uae_u32 w)
@@ -595,6 +604,7 @@ void REGPARAM2 chipmem_agnus_wput (uaecptr addr, uae_u32 w)
 		return;
 	m = (uae_u16 *)(chipmemory + addr);
 	do_put_mem_word (m, w);
+	statehash_write (STATEHASH_CHIP, addr, 2);
 }
 
 void REGPARAM2 chipmem_agnus_bput (uaecptr addr, uae_u32 b)
@@ -603,6 +613,7 @@ void REGPARAM2 chipmem_agnus_bput (uaecptr addr, uae_u32 b)
 	if (addr >= chipmem_full_size)
 		return;
 	chipmemory[addr] = b;
+	statehash_write (STATEHASH_CHIP, addr, 1);
 }
 
 static int REGPARAM2 chipmem_check (uaecptr addr, uae_u32 size)
@@ -650,14 +661,14 @@ STATIC_INLINE uae_u8* REGPARAM2 chipmem_xlate_bigmem (uaecptr addr)
 	return get_real_address (addr);
 }
 
-uae_u32 (REGPARAM2 *chipmem_lget_indirect)(uaecptr);
-uae_u32 (REGPARAM2 *chipmem_wget_indirect)(uaecptr);
-uae_u32 (REGPARAM2 *chipmem_bget_indirect)(uaecptr);
-void (REGPARAM2 *chipmem_lput_indirect)(uaecptr, uae_u32);
-void (REGPARAM2 *chipmem_wput_indirect)(uaecptr, uae_u32);
-void (REGPARAM2 *chipmem_bput_indirect)(uaecptr, uae_u32);
-int (REGPARAM2 *chipmem_check_indirect)(uaecptr, uae_u32);
-uae_u8 *(REGPARAM2 *chipmem_xlate_indirect)(uaecptr);
+UAE_TLS uae_u32 (REGPARAM2 *chipmem_lget_indirect)(uaecptr);
+UAE_TLS uae_u32 (REGPARAM2 *chipmem_wget_indirect)(uaecptr);
+UAE_TLS uae_u32 (REGPARAM2 *chipmem_bget_indirect)(uaecptr);
+UAE_TLS void (REGPARAM2 *chipmem_lput_indirect)(uaecptr, uae_u32);
+UAE_TLS void (REGPARAM2 *chipmem_wput_indirect)(uaecptr, uae_u32);
+UAE_TLS void (REGPARAM2 *chipmem_bput_indirect)(uaecptr, uae_u32);
+UAE_TLS int (REGPARAM2 *chipmem_check_indirect)(uaecptr, uae_u32);
+UAE_TLS uae_u8 *(REGPARAM2 *chipmem_xlate_indirect)(uaecptr);
 
 static void chipmem_setindirect (void)
 {
@@ -684,8 +695,8 @@ static void chipmem_setindirect (void)
 
 /* Slow memory */
 
-static uae_u8 *bogomemory;
-static int bogomemory_allocated;
+static UAE_TLS uae_u8 *bogomemory;
+static UAE_TLS int bogomemory_allocated;
 
 static uae_u32 REGPARAM3 bogomem_lget (uaecptr) REGPARAM;
 static uae_u32 REGPARAM3 bogomem_wget (uaecptr) REGPARAM;
@@ -724,6 +735,7 @@ static void REGPARAM2 bogomem_lput (uaecptr addr, uae_u32 l)
 	addr &= bogomem_mask;
 	m = (uae_u32 *)(bogomemory + addr);
 	do_put_mem_long (m, l);
+	statehash_write (STATEHASH_BOGO, addr, 4);
 }
 
 static void REGPARAM2 bogomem_wput (uaecptr addr, uae_u32 w)
@@ -732,12 +744,14 @@ static void REGPARAM2 bogomem_wput (uaecptr addr, uae_u32 w)
 	addr &= bogomem_mask;
 	m = (uae_u16 *)(bogomemory + addr);
 	do_put_mem_word (m, w);
+	statehash_write (STATEHASH_BOGO, addr, 2);
 }
 
 static void REGPARAM2 bogomem_bput (uaecptr addr, uae_u32 b)
 {
 	addr &= bogomem_mask;
 	bogomemory[addr] = b;
+	statehash_write (STATEHASH_BOGO, addr, 1);
 }
 
 static int REGPARAM2 bogomem_check (uaecptr addr, uae_u32 size)
@@ -754,7 +768,7 @@ static uae_u8 *REGPARAM2 bogomem_xlate (uaecptr addr)
 
 /* CDTV expension memory card memory */
 
-uae_u8 *cardmemory;
+UAE_TLS uae_u8 *cardmemory;
 
 static uae_u32 REGPARAM3 cardmem_lget (uaecptr) REGPARAM;
 static uae_u32 REGPARAM3 cardmem_wget (uaecptr) REGPARAM;
@@ -822,8 +836,8 @@ static uae_u8 *REGPARAM2 cardmem_xlate (uaecptr addr)
 }
 
 /* A3000 motherboard fast memory */
-static uae_u8 *a3000lmemory, *a3000hmemory;
-uaecptr a3000lmem_start, a3000hmem_start;
+static UAE_TLS uae_u8 *a3000lmemory, *a3000hmemory;
+UAE_TLS uaecptr a3000lmem_start, a3000hmem_start;
 
 static uae_u32 REGPARAM3 a3000lmem_lget (uaecptr) REGPARAM;
 static uae_u32 REGPARAM3 a3000lmem_wget (uaecptr) REGPARAM;
@@ -957,9 +971,9 @@ static uae_u8 *REGPARAM2 a3000hmem_xlate (uaecptr addr)
 
 /* Kick memory */
 
-uae_u8 *kickmemory;
-uae_u16 kickstart_version;
-uae_u32 kickmem_size;
+UAE_TLS uae_u8 *kickmemory;
+UAE_TLS uae_u16 kickstart_version;
+UAE_TLS uae_u32 kickmem_size;
 
 /*
  * A1000 kickstart RAM handling
@@ -968,8 +982,8 @@ uae_u32 kickmem_size;
  * write access to boot ROM hides boot ROM and enables write protection
  *
  */
-static int a1000_kickstart_mode;
-static uae_u8 *a1000_bootrom;
+static UAE_TLS int a1000_kickstart_mode;
+static UAE_TLS uae_u8 *a1000_bootrom;
 static void a1000_handle_kickstart (int mode)
 {
 	if (!a1000_bootrom)
@@ -1133,10 +1147,10 @@ uae_u8 *REGPARAM2 kickmem_xlate (uaecptr addr)
 
 /* CD32/CDTV extended kick memory */
 
-uae_u8 *extendedkickmemory, *extendedkickmemory2;
-static uae_u32 extendedkickmem_size, extendedkickmem2_size;
-static uae_u32 extendedkickmem_start, extendedkickmem2_start;
-static int extendedkickmem_type;
+UAE_TLS uae_u8 *extendedkickmemory, *extendedkickmemory2;
+static UAE_TLS uae_u32 extendedkickmem_size, extendedkickmem2_size;
+static UAE_TLS uae_u32 extendedkickmem_start, extendedkickmem2_start;
+static UAE_TLS int extendedkickmem_type;
 
 #define EXTENDED_ROM_CD32 1
 #define EXTENDED_ROM_CDTV 2
@@ -1285,7 +1299,7 @@ int REGPARAM2 default_check (uaecptr a, uae_u32 b)
 	return 0;
 }
 
-static int be_cnt;
+static UAE_TLS int be_cnt;
 
 uae_u8 *REGPARAM2 default_xlate (uaecptr a)
 {
@@ -1332,28 +1346,28 @@ uae_u8 *REGPARAM2 default_xlate (uaecptr a)
 
 /* Address banks */
 
-addrbank dummy_bank = {
+UAE_TLS addrbank dummy_bank = {
 	dummy_lget, dummy_wget, dummy_bget,
 	dummy_lput, dummy_wput, dummy_bput,
 	default_xlate, dummy_check, NULL, NULL,
 	dummy_lgeti, dummy_wgeti, ABFLAG_NONE
 };
 
-addrbank ones_bank = {
+UAE_TLS addrbank ones_bank = {
 	ones_get, ones_get, ones_get,
 	none_put, none_put, none_put,
 	default_xlate, dummy_check, NULL, _T("Ones"),
 	dummy_lgeti, dummy_wgeti, ABFLAG_NONE
 };
 
-addrbank chipmem_bank = {
+UAE_TLS addrbank chipmem_bank = {
 	chipmem_lget, chipmem_wget, chipmem_bget,
 	chipmem_lput, chipmem_wput, chipmem_bput,
 	chipmem_xlate, chipmem_check, NULL, _T("Chip memory"),
 	chipmem_lget, chipmem_wget, ABFLAG_RAM
 };
 
-addrbank chipmem_dummy_bank = {
+UAE_TLS addrbank chipmem_dummy_bank = {
 	chipmem_dummy_lget, chipmem_dummy_wget, chipmem_dummy_bget,
 	chipmem_dummy_lput, chipmem_dummy_wput, chipmem_dummy_bput,
 	default_xlate, dummy_check, NULL, _T("Dummy Chip memory"),
@@ -1362,7 +1376,7 @@ addrbank chipmem_dummy_bank = {
 
 
 #ifdef AGA
-addrbank chipmem_bank_ce2 = {
+UAE_TLS addrbank chipmem_bank_ce2 = {
 	chipmem_lget_ce2, chipmem_wget_ce2, chipmem_bget_ce2,
 	chipmem_lput_ce2, chipmem_wput_ce2, chipmem_bput_ce2,
 	chipmem_xlate, chipmem_check, NULL, _T("Chip memory (68020 'ce')"),
@@ -1370,55 +1384,55 @@ addrbank chipmem_bank_ce2 = {
 };
 #endif
 
-addrbank bogomem_bank = {
+UAE_TLS addrbank bogomem_bank = {
 	bogomem_lget, bogomem_wget, bogomem_bget,
 	bogomem_lput, bogomem_wput, bogomem_bput,
 	bogomem_xlate, bogomem_check, NULL, _T("Slow memory"),
 	bogomem_lget, bogomem_wget, ABFLAG_RAM
 };
 
-addrbank cardmem_bank = {
+UAE_TLS addrbank cardmem_bank = {
 	cardmem_lget, cardmem_wget, cardmem_bget,
 	cardmem_lput, cardmem_wput, cardmem_bput,
 	cardmem_xlate, cardmem_check, NULL, _T("CDTV memory card"),
 	cardmem_lget, cardmem_wget, ABFLAG_RAM
 };
 
-addrbank a3000lmem_bank = {
+UAE_TLS addrbank a3000lmem_bank = {
 	a3000lmem_lget, a3000lmem_wget, a3000lmem_bget,
 	a3000lmem_lput, a3000lmem_wput, a3000lmem_bput,
 	a3000lmem_xlate, a3000lmem_check, NULL, _T("RAMSEY memory (low)"),
 	a3000lmem_lget, a3000lmem_wget, ABFLAG_RAM
 };
 
-addrbank a3000hmem_bank = {
+UAE_TLS addrbank a3000hmem_bank = {
 	a3000hmem_lget, a3000hmem_wget, a3000hmem_bget,
 	a3000hmem_lput, a3000hmem_wput, a3000hmem_bput,
 	a3000hmem_xlate, a3000hmem_check, NULL, _T("RAMSEY memory (high)"),
 	a3000hmem_lget, a3000hmem_wget, ABFLAG_RAM
 };
 
-addrbank kickmem_bank = {
+UAE_TLS addrbank kickmem_bank = {
 	kickmem_lget, kickmem_wget, kickmem_bget,
 	kickmem_lput, kickmem_wput, kickmem_bput,
 	kickmem_xlate, kickmem_check, NULL, _T("Kickstart ROM"),
 	kickmem_lget, kickmem_wget, ABFLAG_ROM
 };
 
-addrbank kickram_bank = {
+UAE_TLS addrbank kickram_bank = {
 	kickmem_lget, kickmem_wget, kickmem_bget,
 	kickmem2_lput, kickmem2_wput, kickmem2_bput,
 	kickmem_xlate, kickmem_check, NULL, _T("Kickstart Shadow RAM"),
 	kickmem_lget, kickmem_wget, ABFLAG_UNK | ABFLAG_SAFE
 };
 
-addrbank extendedkickmem_bank = {
+UAE_TLS addrbank extendedkickmem_bank = {
 	extendedkickmem_lget, extendedkickmem_wget, extendedkickmem_bget,
 	extendedkickmem_lput, extendedkickmem_wput, extendedkickmem_bput,
 	extendedkickmem_xlate, extendedkickmem_check, NULL, _T("Extended Kickstart ROM"),
 	extendedkickmem_lget, extendedkickmem_wget, ABFLAG_ROM
 };
-addrbank extendedkickmem2_bank = {
+UAE_TLS addrbank extendedkickmem2_bank = {
 	extendedkickmem2_lget, extendedkickmem2_wget, extendedkickmem2_bget,
 	extendedkickmem2_lput, extendedkickmem2_wput, extendedkickmem2_bput,
 	extendedkickmem2_xlate, extendedkickmem2_check, NULL, _T("Extended 2nd Kickstart ROM"),
@@ -1426,9 +1440,9 @@ addrbank extendedkickmem2_bank = {
 };
 
 
-static uae_u32 allocated_custmem1, allocated_custmem2;
-static uae_u32 custmem1_mask, custmem2_mask;
-static uae_u8 *custmem1, *custmem2;
+static UAE_TLS uae_u32 allocated_custmem1, allocated_custmem2;
+static UAE_TLS uae_u32 custmem1_mask, custmem2_mask;
+static UAE_TLS uae_u8 *custmem1, *custmem2;
 
 static uae_u32 REGPARAM3 custmem1_lget (uaecptr) REGPARAM;
 static uae_u32 REGPARAM3 custmem1_wget (uaecptr) REGPARAM;
@@ -1562,24 +1576,44 @@ static uae_u8 *REGPARAM2 custmem2_xlate (uaecptr addr)
 	return custmem2 + addr;
 }
 
-addrbank custmem1_bank = {
+UAE_TLS addrbank custmem1_bank = {
 	custmem1_lget, custmem1_wget, custmem1_bget,
 	custmem1_lput, custmem1_wput, custmem1_bput,
 	custmem1_xlate, custmem1_check, NULL, _T("Non-autoconfig RAM #1"),
 	custmem1_lget, custmem1_wget, ABFLAG_RAM
 };
-addrbank custmem2_bank = {
+UAE_TLS addrbank custmem2_bank = {
 	custmem2_lget, custmem2_wget, custmem2_bget,
 	custmem2_lput, custmem2_wput, custmem2_bput,
 	custmem2_xlate, custmem2_check, NULL, _T("Non-autoconfig RAM #2"),
 	custmem2_lget, custmem2_wget, ABFLAG_RAM
 };
 
+/* Swaps a ROM image read from f at pos for a mapping of the file itself,
+ * when the image is the unmodified file contents. */
+static uae_u8 *share_rom (struct zfile *f, uae_u64 pos, int len, uae_u8 *mem, int size)
+{
+#ifndef NATMEM_OFFSET
+	uae_u8 *p = romshare_map_rom (f, pos, len, mem, size);
+	if (p) {
+		mapped_free (mem);
+		return p;
+	}
+#endif
+	return mem;
+}
+
+static void free_rom (uae_u8 *p)
+{
+	if (p && !romshare_unmap (p))
+		mapped_free (p);
+}
+
 #define fkickmem_size 524288
-static int a3000_f0;
+static UAE_TLS int a3000_f0;
 void a3000_fakekick (int map)
 {
-	static uae_u8 *kickstore;
+	static UAE_TLS uae_u8 *kickstore;
 
 #ifdef NATMEM_OFFSET
 	protect_roms (false);
@@ -1607,7 +1641,7 @@ void a3000_fakekick (int map)
 	} else {
 		if (a3000_f0) {
 			map_banks (&dummy_bank, 0xf0, 1, 1);
-			mapped_free (extendedkickmemory);
+			free_rom (extendedkickmemory);
 			extendedkickmemory = NULL;
 			a3000_f0 = 0;
 		}
@@ -1621,7 +1655,7 @@ void a3000_fakekick (int map)
 #endif
 }
 
-static uae_char *kickstring = "exec.library";
+static UAE_TLS uae_char *kickstring = "exec.library";
 static int read_kickstart (struct zfile *f, uae_u8 *mem, int size, int dochecksum, int noalias)
 {
 	uae_char buffer[20];
@@ -1760,7 +1794,9 @@ static bool load_extendedkickstart (const TCHAR *romextfile, int type)
 			break;
 		}
 		if (extendedkickmemory) {
-			read_kickstart (f, extendedkickmemory, extendedkickmem_size, 0, 1);
+			int len = read_kickstart (f, extendedkickmemory, extendedkickmem_size, 0, 1);
+			extendedkickmemory = share_rom (f, off, len, extendedkickmemory, extendedkickmem_size);
+			extendedkickmem_bank.baseaddr = extendedkickmemory;
 			extendedkickmem_mask = extendedkickmem_size - 1;
 			ret = true;
 		}
@@ -1843,29 +1879,93 @@ static void patch_kick (void)
 		kickstart_fix_checksum (kickmemory, kickmem_size);
 }
 
-extern unsigned char arosrom[];
+extern const unsigned char arosrom[];
 extern unsigned int arosrom_len;
 
-static bool load_kickstart_replacement (void)
+static struct zfile *open_aros (void)
 {
-	struct zfile *f = NULL;
-	
+	struct zfile *f;
+
 	f = zfile_fopen_data (_T("aros.gz"), arosrom_len, arosrom);
 	if (!f)
-		return false;
-	f = zfile_gunzip (f, NULL);
+		return NULL;
+	return zfile_gunzip (f, NULL);
+}
+
+/* the unpacked AROS image is the same for every instance, keep it in the table cache */
+static bool fill_aros (uae_u8 *p, int len, int kick)
+{
+	struct zfile *f = open_aros ();
+	bool ok;
+
+	/* gunzip or allocation failure, the caller loads a private copy */
 	if (!f)
 		return false;
+	zfile_fseek (f, kick ? 0x80000 : 0, SEEK_SET);
+	/* a short image would stay in the cache for every other process */
+	ok = read_kickstart (f, p, len, kick, !kick) >= len;
+	zfile_fclose (f);
+	return ok;
+}
+
+static bool fill_aros_ext (uae_u8 *p, int len)
+{
+	return fill_aros (p, len, 0);
+}
+
+static bool fill_aros_kick (uae_u8 *p, int len)
+{
+	return fill_aros (p, len, 1);
+}
+
+static bool share_kickstart_replacement (void)
+{
+	uae_u32 key;
+	uae_u8 *ext, *kick;
+
+	if (!romshare_enabled () || currprefs.cs_a1000ram)
+		return false;
+	key = get_crc32 ((uae_u8*)arosrom, arosrom_len);
+	ext = romshare_map_table (_T("aros_ext"), key, 0x80000, fill_aros_ext, true);
+	kick = romshare_map_table (_T("aros_kick"), key, 0x80000, fill_aros_kick, true);
+	if (!ext || !kick) {
+		romshare_unmap (ext);
+		romshare_unmap (kick);
+		return false;
+	}
+	free_rom (kickmemory);
+	kickmemory = kick;
+	kickmem_bank.baseaddr = kickmemory;
+	extendedkickmemory = ext;
+	return true;
+}
+
+static bool load_kickstart_replacement (void)
+{
+	struct zfile *f = NULL;
+	bool shared = false;
+	
+#ifndef NATMEM_OFFSET
+	shared = share_kickstart_replacement ();
+#endif
+	if (!shared) {
+		f = open_aros ();
+		if (!f)
+			return false;
+	}
 	kickmem_mask = 0x80000 - 1;
 	kickmem_size = 0x80000;
 	extendedkickmem_size = 0x80000;
 	extendedkickmem_type = EXTENDED_ROM_KS;
-	extendedkickmemory = mapped_malloc (extendedkickmem_size, _T("rom_e0"));
+	if (!shared)
+		extendedkickmemory = mapped_malloc (extendedkickmem_size, _T("rom_e0"));
 	extendedkickmem_bank.baseaddr = extendedkickmemory;
-	read_kickstart (f, extendedkickmemory, extendedkickmem_size, 0, 1);
 	extendedkickmem_mask = extendedkickmem_size - 1;
-	read_kickstart (f, kickmemory, 0x80000, 1, 0);
-	zfile_fclose (f);
+	if (!shared) {
+		read_kickstart (f, extendedkickmemory, extendedkickmem_size, 0, 1);
+		read_kickstart (f, kickmemory, 0x80000, 1, 0);
+		zfile_fclose (f);
+	}
 
 	return true;
 }
@@ -1913,6 +2013,7 @@ static int load_kickstart (void)
 		int filesize, size, maxsize;
 		int kspos = 524288;
 		int extpos = 0;
+		uae_u64 kickpos;
 
 		maxsize = 524288;
 		zfile_fseek (f, 0, SEEK_END);
@@ -1935,9 +2036,12 @@ static int load_kickstart (void)
 			extpos = 0;
 			zfile_fseek (f, kspos, SEEK_SET);
 		}
+		kickpos = zfile_ftell (f);
 		size = read_kickstart (f, kickmemory, maxsize, 1, 0);
 		if (size == 0)
 			goto err;
+		kickmemory = share_rom (f, kickpos, size, kickmemory, 0x80000);
+		kickmem_bank.baseaddr = kickmemory;
 		kickmem_mask = size - 1;
 		kickmem_size = size;
 		if (filesize >= 524288 * 2 && !extendedkickmem_type) {
@@ -1955,6 +2059,8 @@ static int load_kickstart (void)
 			extendedkickmem_bank.baseaddr = extendedkickmemory;
 			zfile_fseek (f, extpos, SEEK_SET);
 			read_kickstart (f, extendedkickmemory, extendedkickmem_size, 0, 1);
+			extendedkickmemory = share_rom (f, extpos, extendedkickmem_size, extendedkickmemory, extendedkickmem_size);
+			extendedkickmem_bank.baseaddr = extendedkickmemory;
 			extendedkickmem_mask = extendedkickmem_size - 1;
 		}
 		if (filesize > 524288 * 2) {
@@ -1965,6 +2071,8 @@ static int load_kickstart (void)
 			read_kickstart (f, extendedkickmemory2, 524288, 0, 1);
 			zfile_fseek (f, extpos + 524288 * 2, SEEK_SET);
 			read_kickstart (f, extendedkickmemory2 + 524288, 524288, 0, 1);
+			extendedkickmemory2 = share_rom (f, extpos + 524288, extendedkickmem2_size, extendedkickmemory2, extendedkickmem2_size);
+			extendedkickmem2_bank.baseaddr = extendedkickmemory2;
 			extendedkickmem2_mask = extendedkickmem2_size - 1;
 			extendedkickmem2_start = 0xa80000;
 		}
@@ -2410,6 +2518,7 @@ static void allocate_memory (void)
 	a3000lmem_bank.baseaddr = a3000lmemory;
 	a3000hmem_bank.baseaddr = a3000hmemory;
 	cardmem_bank.baseaddr = cardmemory;
+	statehash_reset ();
 	bootrom_filepos = 0;
 	chip_filepos = 0;
 	bogo_filepos = 0;
@@ -2552,10 +2661,11 @@ void memory_clear (void)
 	if (a3000hmemory)
 		memset (a3000hmemory, 0, allocated_a3000hmem);
 	expansion_clear ();
+	statehash_reset ();
 }
 
 #ifdef __LIBRETRO__
-int romnotfound=0;
+UAE_TLS int romnotfound=0;
 #endif
 
 void memory_reset (void)
@@ -2611,9 +2721,14 @@ void memory_reset (void)
 		memcpy (currprefs.romfile, changed_prefs.romfile, sizeof currprefs.romfile);
 		memcpy (currprefs.romextfile, changed_prefs.romextfile, sizeof currprefs.romextfile);
 		need_hardreset = true;
-		mapped_free (extendedkickmemory);
+		if (romshare_unmap (kickmemory)) {
+			kickmemory = mapped_malloc (0x80000, _T("kick"));
+			kickmem_bank.baseaddr = kickmemory;
+		}
+		free_rom (extendedkickmemory);
 		extendedkickmemory = 0;
 		extendedkickmem_size = 0;
+		free_rom (extendedkickmemory2);
 		extendedkickmemory2 = 0;
 		extendedkickmem2_size = 0;
 		extendedkickmem_type = 0;
@@ -2736,7 +2851,9 @@ void memory_reset (void)
 #ifdef CD32
 	if (currprefs.cs_cd32c2p || currprefs.cs_cd32cd || currprefs.cs_cd32nvram) {
 		map_banks (&akiko_bank, AKIKO_BASE >> 16, 1, 0);
+#ifdef GAYLE
 		map_banks (&gayle2_bank, 0xDD, 2, 0);
+#endif
 	}
 #endif
 #ifdef CDTV
@@ -2913,7 +3030,7 @@ void memory_cleanup (void)
 	if (bogomemory && bogomemory_allocated)
 		mapped_free (bogomemory);
 	if (kickmemory)
-		mapped_free (kickmemory);
+		free_rom (kickmemory);
 	if (a1000_bootrom)
 		xfree (a1000_bootrom);
 	if (chipmemory)
@@ -3165,7 +3282,7 @@ uae_u8 *restore_rom (uae_u8 *src)
 
 uae_u8 *save_rom (int first, int *len, uae_u8 *dstptr)
 {
-	static int count;
+	static UAE_TLS int count;
 	uae_u8 *dst, *dstbak;
 	uae_u8 *mem_real_start;
 	uae_u32 version;
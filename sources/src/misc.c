@@ -36,12 +36,12 @@
 
 // this is handled by the graphics drivers and set up in picasso96.c
 #if defined(PICASSO96)
-extern int screen_is_picasso;
+extern UAE_TLS int screen_is_picasso;
 #else
 static int screen_is_picasso = 0;
 #endif
 
-uae_u32 redc[3 * 256], grec[3 * 256], bluc[3 * 256];
+UAE_TLS uae_u32 redc[3 * 256], grec[3 * 256], bluc[3 * 256];
 
 #define VBLANKTH_KILL 0
 #define VBLANKTH_CALIBRATE 1
@@ -52,7 +52,7 @@ uae_u32 redc[3 * 256], grec[3 * 256], bluc[3 * 256];
 #define VBLANKTH_ACTIVE_SKIPFRAME 6
 #define VBLANKTH_ACTIVE_SKIPFRAME2 7
 
-static volatile frame_time_t vblank_prev_time;
+static UAE_TLS volatile frame_time_t vblank_prev_time;
 
 struct winuae_currentmode {
         unsigned int flags;
@@ -65,8 +65,8 @@ struct winuae_currentmode {
         int vsync;
 };
 
-static struct winuae_currentmode currentmodestruct;
-static struct winuae_currentmode *currentmode = &currentmodestruct;
+static UAE_TLS struct winuae_currentmode currentmodestruct;
+#define currentmode (&currentmodestruct)
 #ifndef _WIN32
 typedef struct {
   WORD  dmSize;
@@ -168,7 +168,7 @@ return false;
 }
 
 //win32.cpp
-int extraframewait = 0;
+UAE_TLS int extraframewait = 0;
 
 void sleep_millis_main (int ms)
 {
@@ -252,8 +252,8 @@ char *au_fs_copy (char *dst, int maxlen, const char *src)
 }
 
 // clipboard
-static uaecptr clipboard_data;
-static int signaling, initialized;
+static UAE_TLS uaecptr clipboard_data;
+static UAE_TLS int signaling, initialized;
 
 void amiga_clipboard_die (void)
 {
@@ -345,7 +345,7 @@ char *ua_copy (char *dst, int maxlen, const char *src)
 }
 
 // win32gui
-static int qs_override;
+static UAE_TLS int qs_override;
 
 int target_cfgfile_load (struct uae_prefs *p, const TCHAR *filename, int type, int isdefault)
 {
@@ -567,7 +567,6 @@ void target_fixup_options (struct uae_prefs *p)
 
 }
 
-TCHAR start_path_data[MAX_DPATH];
 
 void fetch_path (TCHAR *name, TCHAR *out, int size)
 {
@@ -664,10 +663,10 @@ TCHAR *au_copy (TCHAR *dst, int maxlen, const char *src)
 }
 
 // writelog
-int consoleopen = 0;
-static int realconsole = 1;
+UAE_TLS int consoleopen = 0;
+static UAE_TLS int realconsole = 1;
 
-static int debugger_type = -1;
+static UAE_TLS int debugger_type = -1;
 
 static void openconsole (void)
 {
@@ -733,8 +732,10 @@ void update_debug_info(void)
 }
 
 #ifdef __LIBRETRO__
+#ifndef PICASSO96
 const TCHAR *target_get_display_name (int num, bool friendlyname){return NULL;}
 int target_get_display (const TCHAR *name){return -1;}
+#endif
 int target_checkcapslock (int scancode, int *state){return 0;}
 void setmaintitle(){}
 #endif
@@ -744,7 +745,7 @@ void setmaintitle(){}
 // win32gfx.cpp
 ///////////////////////////////////////////////////
 #define MAX_DISPLAYS 10
-struct MultiDisplay Displays[MAX_DISPLAYS];
+UAE_TLS struct MultiDisplay Displays[MAX_DISPLAYS];
 
 static struct MultiDisplay *getdisplay2 (struct uae_prefs *p, int index)
 {
@@ -1075,6 +1076,39 @@ void enumeratedisplays (void) {
 	md->fullname = strdup ("DeviceName");
 	md->primary = true;
 }
+#elif defined(PICASSO96)
+/* There is no host display to enumerate. A single 1024x768 mode is the
+ * largest the libretro framebuffer takes, picasso96.c adds the usual
+ * smaller resolutions below it. */
+void enumeratedisplays (void)
+{
+	struct MultiDisplay *md = Displays;
+
+	md->adaptername = strdup ("libretro");
+	md->adapterid = strdup ("libretro");
+	md->adapterkey = strdup ("libretro");
+	md->monitorname = strdup ("libretro");
+	md->monitorid = strdup ("libretro");
+	md->fullname = strdup ("libretro");
+	md->primary = true;
+}
+
+void sortdisplays (void)
+{
+	struct MultiDisplay *md = Displays;
+	struct PicassoResolution *pr;
+
+	md->DisplayModes = xcalloc (struct PicassoResolution, MAX_PICASSO_MODES);
+	pr = &md->DisplayModes[0];
+	pr->res.width = 1024;
+	pr->res.height = 768;
+	pr->depth = 4;
+	pr->refresh[0] = 50;
+	pr->colormodes = RGBMASK_32BIT;
+	_stprintf (pr->name, _T("%dx%d, %d-bit"), pr->res.width, pr->res.height, pr->depth * 8);
+	md->DisplayModes[1].depth = -1;
+	write_log (_T("%s\n"), pr->name);
+}
 #endif
 void updatedisplayarea (void)
 {
@@ -1102,9 +1136,9 @@ void updatedisplayarea (void)
 */
 }
 
-static bool render_ok;
+static UAE_TLS bool render_ok;
 
-int vsync_busy_wait_mode;
+UAE_TLS int vsync_busy_wait_mode;
 
 static void vsync_sleep (bool preferbusy)
 {
@@ -1145,7 +1179,7 @@ void show_screen (int mode)
 	render_ok = false;
 }
 
-static int maxscanline, minscanline, prevvblankpos;
+static UAE_TLS int maxscanline, minscanline, prevvblankpos;
 
 static bool getvblankpos (int *vp)
 {
@@ -1224,7 +1258,7 @@ static bool isthreadedvsync (void)
 bool vsync_busywait_do (int *freetime, bool lace, bool oddeven)
 {
 	bool v;
-	static bool framelost;
+	static UAE_TLS bool framelost;
 	int ti;
 	frame_time_t t;
 	frame_time_t prevtime = vblank_prev_time;
@@ -1292,7 +1326,7 @@ bool vsync_busywait_do (int *freetime, bool lace, bool oddeven)
 // parser.c
 ///////////////////////////////////////////////////
 
-unsigned int flashscreen;   
+UAE_TLS unsigned int flashscreen;   
 
 void doflashscreen (void)
 {
@@ -21,8 +21,8 @@
 #include "traps.h"
 #include "native2amiga.h"
 
-smp_comm_pipe native2amiga_pending;
-static uae_sem_t n2asem;
+UAE_TLS smp_comm_pipe native2amiga_pending;
+static UAE_TLS uae_sem_t n2asem;
 
 /*
  * to be called when setting up the hardware
@@ -37,6 +37,9 @@
 #include "inputrecord.h"
 #include "inputdevice.h"
 #include "misc.h"
+#include "crc32.h"
+#include "romshare.h"
+#include "statehash.h"
 
 #define f_out write_log
 #define console_out write_log
@@ -50,50 +53,54 @@ STATIC_INLINE void build_comp (void) {}
 STATIC_INLINE bool check_prefs_changed_comp (void) { return false; }
 #endif
 /* For faster JIT cycles handling */
-signed long pissoff = 0;
+UAE_TLS signed long pissoff = 0;
 
 /* Opcode of faulting instruction */
-static uae_u16 last_op_for_exception_3;
+static UAE_TLS uae_u16 last_op_for_exception_3;
 /* PC at fault time */
-static uaecptr last_addr_for_exception_3;
+static UAE_TLS uaecptr last_addr_for_exception_3;
 /* Address that generated the exception */
-static uaecptr last_fault_for_exception_3;
+static UAE_TLS uaecptr last_fault_for_exception_3;
 /* read (0) or write (1) access */
-static int last_writeaccess_for_exception_3;
+static UAE_TLS int last_writeaccess_for_exception_3;
 /* instruction (1) or data (0) access */
-static int last_instructionaccess_for_exception_3;
-int mmu_enabled, mmu_triggered;
-int cpu_cycles;
-static int baseclock;
+static UAE_TLS int last_instructionaccess_for_exception_3;
+UAE_TLS int mmu_enabled, mmu_triggered;
+UAE_TLS int cpu_cycles;
+static UAE_TLS int baseclock;
 
-int cpucycleunit;
-int cpu_tracer;
+UAE_TLS int cpucycleunit;
+UAE_TLS int cpu_tracer;
 
 const int areg_byteinc[] = { 1, 1, 1, 1, 1, 1, 1, 2 };
 const int imm8_table[] = { 8, 1, 2, 3, 4, 5, 6, 7 };
 
-int movem_index1[256];
-int movem_index2[256];
-int movem_next[256];
+UAE_TLS int movem_index1[256];
+UAE_TLS int movem_index2[256];
+UAE_TLS int movem_next[256];
 
-cpuop_func *cpufunctbl[65536];
+UAE_TLS cpuop_func *cpufunctbl[65536];
 
-struct mmufixup mmufixup[2];
+UAE_TLS struct mmufixup mmufixup[2];
 
 extern uae_u32 get_fpsr (void);
 
+/* 1 counts every opcode into "insncount", 2 counts per generated handler
+ * into "frequent.68k", the profile gencpu lays out cpuemu_*.c from. */
+#ifndef COUNT_INSTRS
 #define COUNT_INSTRS 0
+#endif
 #define MC68060_PCR   0x04300000
 #define MC68EC060_PCR 0x04310000
 
-static uae_u64 fake_srp_030, fake_crp_030;
-static uae_u32 fake_tt0_030, fake_tt1_030, fake_tc_030;
-static uae_u16 fake_mmusr_030;
+static UAE_TLS uae_u64 fake_srp_030, fake_crp_030;
+static UAE_TLS uae_u32 fake_tt0_030, fake_tt1_030, fake_tc_030;
+static UAE_TLS uae_u16 fake_mmusr_030;
 
-static struct cache020 caches020[CACHELINES020];
-static struct cache030 icaches030[CACHELINES030];
-static struct cache030 dcaches030[CACHELINES030];
-static struct cache040 caches040[CACHESETS040];
+static UAE_TLS struct cache020 caches020[CACHELINES020];
+static UAE_TLS struct cache030 icaches030[CACHELINES030];
+static UAE_TLS struct cache030 dcaches030[CACHELINES030];
+static UAE_TLS struct cache040 caches040[CACHESETS040];
 
 #if COUNT_INSTRS
 static unsigned long int instrcount[65536];
@@ -101,7 +108,10 @@ static uae_u16 opcodenums[65536];
 
 static int compfn (const void *el1, const void *el2)
 {
-	return instrcount[*(const uae_u16 *)el1] < instrcount[*(const uae_u16 *)el2];
+	unsigned long int c1 = instrcount[*(const uae_u16 *)el1];
+	unsigned long int c2 = instrcount[*(const uae_u16 *)el2];
+
+	return c1 < c2 ? 1 : (c1 > c2 ? -1 : 0);
 }
 
 static TCHAR *icountfilename (void)
@@ -115,9 +125,11 @@ static TCHAR *icountfilename (void)
 void dump_counts (void)
 {
 	FILE *f = fopen (icountfilename (), "w");
-	unsigned long int total;
+	unsigned long int total = 0;
 	int i;
 
+	if (!f)
+		return;
 	write_log (_T("Writing instruction count file...\n"));
 	for (i = 0; i < 65536; i++) {
 		opcodenums[i] = i;
@@ -133,6 +145,9 @@ void dump_counts (void)
 		if (!cnt)
 			break;
 		dp = table68k + opcodenums[i];
+		/* gencpu only lays out real handlers */
+		if (COUNT_INSTRS == 2 && dp->mnemo == i_ILLG)
+			continue;
 		for (lookup = lookuptab;lookup->mnemo != dp->mnemo; lookup++)
 			;
 		fprintf (f, "%04x: %lu %s\n", opcodenums[i], cnt, lookup->name);
@@ -152,52 +167,52 @@ void dump_counts (void)
 
  */
 
-static uae_u32 (*x2_prefetch)(int);
-static uae_u32 (*x2_prefetch_long)(int);
-static uae_u32 (*x2_next_iword)(void);
-static uae_u32 (*x2_next_ilong)(void);
-static uae_u32 (*x2_get_ilong)(int);
-static uae_u32 (*x2_get_iword)(int);
-static uae_u32 (*x2_get_ibyte)(int);
-static uae_u32 (*x2_get_long)(uaecptr);
-static uae_u32 (*x2_get_word)(uaecptr);
-static uae_u32 (*x2_get_byte)(uaecptr);
-static void (*x2_put_long)(uaecptr,uae_u32);
-static void (*x2_put_word)(uaecptr,uae_u32);
-static void (*x2_put_byte)(uaecptr,uae_u32);
-static void (*x2_do_cycles)(unsigned long);
-static void (*x2_do_cycles_pre)(unsigned long);
-static void (*x2_do_cycles_post)(unsigned long, uae_u32);
-
-uae_u32 (*x_prefetch)(int);
-uae_u32 (*x_prefetch_long)(int);
-uae_u32 (*x_next_iword)(void);
-uae_u32 (*x_next_ilong)(void);
-uae_u32 (*x_get_ilong)(int);
-uae_u32 (*x_get_iword)(int);
-uae_u32 (*x_get_ibyte)(int);
-uae_u32 (*x_get_long)(uaecptr);
-uae_u32 (*x_get_word)(uaecptr);
-uae_u32 (*x_get_byte)(uaecptr);
-void (*x_put_long)(uaecptr,uae_u32);
-void (*x_put_word)(uaecptr,uae_u32);
-void (*x_put_byte)(uaecptr,uae_u32);
-
-uae_u32 (*x_cp_next_iword)(void);
-uae_u32 (*x_cp_next_ilong)(void);
-uae_u32 (*x_cp_get_long)(uaecptr);
-uae_u32 (*x_cp_get_word)(uaecptr);
-uae_u32 (*x_cp_get_byte)(uaecptr);
-void (*x_cp_put_long)(uaecptr,uae_u32);
-void (*x_cp_put_word)(uaecptr,uae_u32);
-void (*x_cp_put_byte)(uaecptr,uae_u32);
-uae_u32 (REGPARAM3 *x_cp_get_disp_ea_020)(uae_u32 base, int idx) REGPARAM;
-
-void (*x_do_cycles)(unsigned long);
-void (*x_do_cycles_pre)(unsigned long);
-void (*x_do_cycles_post)(unsigned long, uae_u32);
-
-static struct cputracestruct cputrace;
+static UAE_TLS uae_u32 (*x2_prefetch)(int);
+static UAE_TLS uae_u32 (*x2_prefetch_long)(int);
+static UAE_TLS uae_u32 (*x2_next_iword)(void);
+static UAE_TLS uae_u32 (*x2_next_ilong)(void);
+static UAE_TLS uae_u32 (*x2_get_ilong)(int);
+static UAE_TLS uae_u32 (*x2_get_iword)(int);
+static UAE_TLS uae_u32 (*x2_get_ibyte)(int);
+static UAE_TLS uae_u32 (*x2_get_long)(uaecptr);
+static UAE_TLS uae_u32 (*x2_get_word)(uaecptr);
+static UAE_TLS uae_u32 (*x2_get_byte)(uaecptr);
+static UAE_TLS void (*x2_put_long)(uaecptr,uae_u32);
+static UAE_TLS void (*x2_put_word)(uaecptr,uae_u32);
+static UAE_TLS void (*x2_put_byte)(uaecptr,uae_u32);
+static UAE_TLS void (*x2_do_cycles)(unsigned long);
+static UAE_TLS void (*x2_do_cycles_pre)(unsigned long);
+static UAE_TLS void (*x2_do_cycles_post)(unsigned long, uae_u32);
+
+UAE_TLS uae_u32 (*x_prefetch)(int);
+UAE_TLS uae_u32 (*x_prefetch_long)(int);
+UAE_TLS uae_u32 (*x_next_iword)(void);
+UAE_TLS uae_u32 (*x_next_ilong)(void);
+UAE_TLS uae_u32 (*x_get_ilong)(int);
+UAE_TLS uae_u32 (*x_get_iword)(int);
+UAE_TLS uae_u32 (*x_get_ibyte)(int);
+UAE_TLS uae_u32 (*x_get_long)(uaecptr);
+UAE_TLS uae_u32 (*x_get_word)(uaecptr);
+UAE_TLS uae_u32 (*x_get_byte)(uaecptr);
+UAE_TLS void (*x_put_long)(uaecptr,uae_u32);
+UAE_TLS void (*x_put_word)(uaecptr,uae_u32);
+UAE_TLS void (*x_put_byte)(uaecptr,uae_u32);
+
+UAE_TLS uae_u32 (*x_cp_next_iword)(void);
+UAE_TLS uae_u32 (*x_cp_next_ilong)(void);
+UAE_TLS uae_u32 (*x_cp_get_long)(uaecptr);
+UAE_TLS uae_u32 (*x_cp_get_word)(uaecptr);
+UAE_TLS uae_u32 (*x_cp_get_byte)(uaecptr);
+UAE_TLS void (*x_cp_put_long)(uaecptr,uae_u32);
+UAE_TLS void (*x_cp_put_word)(uaecptr,uae_u32);
+UAE_TLS void (*x_cp_put_byte)(uaecptr,uae_u32);
+UAE_TLS uae_u32 (REGPARAM3 *x_cp_get_disp_ea_020)(uae_u32 base, int idx) REGPARAM;
+
+UAE_TLS void (*x_do_cycles)(unsigned long);
+UAE_TLS void (*x_do_cycles_pre)(unsigned long);
+UAE_TLS void (*x_do_cycles_post)(unsigned long, uae_u32);
+
+static UAE_TLS struct cputracestruct cputrace;
 
 #if CPUTRACE_DEBUG
 static void validate_trace (void)
@@ -1018,6 +1033,13 @@ static void set_cpu_caches (void)
 
 STATIC_INLINE void count_instr (unsigned int opcode)
 {
+#if COUNT_INSTRS == 2
+	if (table68k[opcode].handler != -1)
+		opcode = table68k[opcode].handler;
+	instrcount[opcode]++;
+#elif COUNT_INSTRS == 1
+	instrcount[opcode]++;
+#endif
 }
 
 static uae_u32 REGPARAM2 op_illg_1 (uae_u32 opcode)
@@ -1193,7 +1215,7 @@ static void fill_prefetch_quick (void)
 }
 
 #define CYCLES_DIV 8192
-static unsigned long cycles_mult;
+static UAE_TLS unsigned long cycles_mult;
 
 static void update_68k_cycles (void)
 {
@@ -1302,6 +1324,80 @@ void check_prefs_changed_cpu (void)
 
 }
 
+static uae_u32 crc32_bytes (const void *p, int len, uae_u32 crc)
+{
+	const uae_u8 *b = (const uae_u8*)p;
+
+	while (len-- > 0)
+		crc = get_crc32_val (*b++, crc);
+	return crc;
+}
+
+#ifdef GIT_VERSION
+#define TABLE68K_BUILD GIT_VERSION " " __DATE__ " " __TIME__
+#else
+#define TABLE68K_BUILD __DATE__ " " __TIME__
+#endif
+
+/* everything table68k is built from, opcstr only by contents. The build
+ * id covers read_table68k () and do_merges () themselves changing. */
+static uae_u32 table68k_key (void)
+{
+	static const char build[] = TABLE68K_BUILD;
+	uae_u32 crc = sizeof (struct instr);
+	int i;
+
+	crc = crc32_bytes (build, sizeof build - 1, crc);
+
+	for (i = 0; i < n_defs68k; i++) {
+		struct instr_def *d = &defs68k[i];
+		crc = crc32_bytes (&d->bits, sizeof d->bits, crc);
+		crc = crc32_bytes (&d->mask, sizeof d->mask, crc);
+		crc = crc32_bytes (d->bitpos, sizeof d->bitpos, crc);
+		crc = crc32_bytes (&d->cpulevel, sizeof d->cpulevel, crc);
+		crc = crc32_bytes (&d->unimpcpulevel, sizeof d->unimpcpulevel, crc);
+		crc = crc32_bytes (&d->plevel, sizeof d->plevel, crc);
+		crc = crc32_bytes (d->flaginfo, sizeof d->flaginfo, crc);
+		crc = crc32_bytes (&d->sduse, sizeof d->sduse, crc);
+		crc = crc32_bytes (d->opcstr, strlen (d->opcstr), crc);
+	}
+	return crc;
+}
+
+static bool fill_table68k (uae_u8 *p, int len)
+{
+	read_table68k ();
+	do_merges ();
+	memcpy (p, table68k, len);
+	xfree (table68k);
+	table68k = NULL;
+	return true;
+}
+
+/* table68k only depends on defs68k, instances with the table cache map one shared copy */
+static void build_table68k (void)
+{
+	struct instr *t;
+	int opcode;
+
+	if (!romshare_unmap (table68k))
+		xfree (table68k);
+	table68k = NULL;
+	t = (struct instr*)romshare_map_table (_T("table68k"), table68k_key (), 65536 * sizeof (struct instr), fill_table68k, false);
+	if (!t) {
+		read_table68k ();
+		do_merges ();
+		return;
+	}
+	table68k = t;
+	/* what do_merges () counts: the opcodes left as handlers of their own */
+	nr_cpuop_funcs = 0;
+	for (opcode = 0; opcode < 65536; opcode++) {
+		if (table68k[opcode].handler == -1 && table68k[opcode].mnemo != i_ILLG)
+			nr_cpuop_funcs++;
+	}
+}
+
 void init_m68k (void)
 {
 	int i;
@@ -1367,8 +1463,7 @@ void init_m68k (void)
 	}
 	write_log (_T("\n"));
 
-	read_table68k ();
-	do_merges ();
+	build_table68k ();
 
 	write_log (_T("%d CPU functions\n"), nr_cpuop_funcs);
 
@@ -1382,9 +1477,8 @@ void init_m68k (void)
 #endif
 }
 
-struct regstruct regs, mmu_backup_regs;
-struct flag_struct regflags;
-static long int m68kpc_offset;
+UAE_TLS struct regstruct regs, mmu_backup_regs;
+static UAE_TLS long int m68kpc_offset;
 
 #define get_ibyte_1(o) get_byte (regs.pc + (regs.pc_p - regs.pc_oldp) + (o) + 1)
 #define get_iword_1(o) get_word (regs.pc + (regs.pc_p - regs.pc_oldp) + (o))
@@ -3299,6 +3393,8 @@ void m68k_mull (uae_u32 opcode, uae_u32 src, uae_u16 extra)
 static void m68k_reset (bool hardreset)
 {
 	regs.spcflags = 0;
+	/* m68k_run_1 () charges an instruction's cycles on the next pass, not across a reset */
+	cpu_cycles = 0;
 	regs.ipl = regs.ipl_pin = 0;
 #ifdef SAVESTATE
 	if (isrestore ()) {
@@ -3392,7 +3488,7 @@ static void m68k_reset (bool hardreset)
 
 void REGPARAM2 op_unimpl (uae_u16 opcode)
 {
-	static int warned;
+	static UAE_TLS int warned;
 	if (warned < 20) {
 		write_log (_T("68060 unimplemented opcode %04X, PC=%08x\n"), opcode, regs.instruction_pc);
 		warned++;
@@ -3403,7 +3499,7 @@ void REGPARAM2 op_unimpl (uae_u16 opcode)
 uae_u32 REGPARAM2 op_illg (uae_u32 opcode)
 {
 	uaecptr pc = m68k_getpc ();
-	static int warned;
+	static UAE_TLS int warned;
 	int inrom = in_rom (pc);
 	int inrt = in_rtarea (pc);
 
@@ -3704,7 +3800,7 @@ void mmu_op (uae_u32 opcode, uae_u32 extra)
 
 #endif
 
-static uaecptr last_trace_ad = 0;
+static UAE_TLS uaecptr last_trace_ad = 0;
 
 static void do_trace (void)
 {
@@ -3894,7 +3990,7 @@ STATIC_INLINE int do_specialties (int cycles)
 			 * but only if we have free frametime left to prevent slowdown
 			 */
 			{
-				static int sleepcnt, lvpos, zerocnt;
+				static UAE_TLS int sleepcnt, lvpos, zerocnt;
 				if (vpos != lvpos) {
 					lvpos = vpos;
 					frame_time_t rpt = read_processor_time ();
@@ -4123,6 +4219,8 @@ static void m68k_run_1_ce (void)
 	for (;;) {
 		opcode = r->ir;
 
+		count_instr (opcode);
+
 #if DEBUG_CD32CDTVIO
 		out_cd32io (m68k_getpc ());
 #endif
@@ -4619,6 +4717,7 @@ static void m68k_run_2ce (void)
 		r->instruction_pc = m68k_getpc ();
 		opcode = get_word_ce020_prefetch (0);
 
+		count_instr (opcode);
 
 #if DEBUG_CD32CDTVIO
 		out_cd32io (r->instruction_pc);
@@ -4819,7 +4918,7 @@ static void m68k_run_mmu (void)
 
 #endif /* CPUEMU_0 */
 
-int in_m68k_go = 0;
+UAE_TLS int in_m68k_go = 0;
 
 static void exception2_handle (uaecptr addr, uaecptr fault)
 {
@@ -5926,6 +6025,33 @@ uae_u8 *restore_mmu (uae_u8 *src)
 #endif //MMUEMU
 #endif /* SAVESTATE */
 
+/* CPU part of the frame digest, see statehash.c */
+uae_u64 hash_cpu (uae_u64 h)
+{
+	MakeSR ();
+	h = statehash_mem (h, regs.regs, sizeof regs.regs);
+	h = statehash_mix (h, m68k_getpc ());
+	h = statehash_mix (h, ((uae_u64)regs.sr << 32) | ((uae_u32)regs.ir << 16) | regs.irc);
+	/* the inactive stack pointers only, a7 is hashed with the other registers */
+	h = statehash_mix (h, regs.s ? regs.usp : 0);
+	h = statehash_mix (h, ((uae_u64)(!regs.s || regs.m ? regs.isp : 0) << 32) | (!regs.s || !regs.m ? regs.msp : 0));
+	h = statehash_mix (h, regs.vbr);
+	h = statehash_mix (h, ((uae_u64)regs.stopped << 32) | (regs.intmask << 8) | regs.ipl);
+#ifndef CPUEMU_68000_ONLY
+	h = statehash_mix (h, ((uae_u64)regs.cacr << 32) | regs.caar);
+#endif
+#ifdef FPUEMU
+	if (currprefs.fpu_model) {
+		for (int i = 0; i < 8; i++) {
+			double d = regs.fp[i];
+			h = statehash_mem (h, &d, sizeof d);
+		}
+		h = statehash_mix (h, ((uae_u64)regs.fpcr << 32) | regs.fpsr);
+	}
+#endif
+	return h;
+}
+
 static void exception3f (uae_u32 opcode, uaecptr addr, int writeaccess, int instructionaccess, uae_u32 pc)
 {
 	if (currprefs.cpu_model >= 68040)
@@ -53,9 +53,9 @@
 #include "misc.h"
 #include "gcc_warnings.h"
 
-int debug_rtg_blitter = 3;
-int screen_is_picasso  = 0;
-int screen_was_picasso = 0;
+UAE_TLS int debug_rtg_blitter = 3;
+UAE_TLS int screen_is_picasso  = 0;
+UAE_TLS int screen_was_picasso = 0;
 
 #define NOBLITTER (0 || !(debug_rtg_blitter & 1))
 #define NOBLITTER_BLIT (0 || !(debug_rtg_blitter & 2))
@@ -64,15 +64,15 @@ int screen_was_picasso = 0;
 #define P96TRACING_ENABLED 0
 #define P96SPRTRACING_ENABLED 0
 
-static int hwsprite = 0;
-static int picasso96_BT = BT_uaegfx;
-static int picasso96_GCT = GCT_Unknown;
-static int picasso96_PCT = PCT_Unknown;
+static UAE_TLS int hwsprite = 0;
+static UAE_TLS int picasso96_BT = BT_uaegfx;
+static UAE_TLS int picasso96_GCT = GCT_Unknown;
+static UAE_TLS int picasso96_PCT = PCT_Unknown;
 
-int p96refresh_active;
-bool have_done_picasso = 1; /* For the JIT compiler */
-static int p96syncrate;
-int p96hsync_counter, full_refresh;
+UAE_TLS int p96refresh_active;
+UAE_TLS bool have_done_picasso = 1; /* For the JIT compiler */
+static UAE_TLS int p96syncrate;
+UAE_TLS int p96hsync_counter, full_refresh;
 
 #ifdef PICASSO96
 #ifdef DEBUG // Change this to _DEBUG for debugging
@@ -96,42 +96,42 @@ static void REGPARAM2 gfxmem_lputx (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM2 gfxmem_wputx (uaecptr, uae_u32) REGPARAM;
 static void REGPARAM2 gfxmem_bputx (uaecptr, uae_u32) REGPARAM;
 
-static uae_u8 all_ones_bitmap, all_zeros_bitmap; /* yuk */
+static UAE_TLS uae_u8 all_ones_bitmap, all_zeros_bitmap; /* yuk */
 
-struct picasso96_state_struct picasso96_state;
-struct picasso_vidbuf_description picasso_vidinfo;
-static struct PicassoResolution *newmodes;
+UAE_TLS struct picasso96_state_struct picasso96_state;
+UAE_TLS struct picasso_vidbuf_description picasso_vidinfo;
+static UAE_TLS struct PicassoResolution *newmodes;
 
-static int picasso_convert;
-static RGBFTYPE host_mode;
+static UAE_TLS int picasso_convert;
+static UAE_TLS RGBFTYPE host_mode;
 
 /* These are the maximum resolutions... They are filled in by GetSupportedResolutions() */
 /* have to fill this in, otherwise problems occur on the Amiga side P96 s/w which expects */
 /* data here. */
-static struct ScreenResolution planar = { 320, 240 };
-static struct ScreenResolution chunky = { 640, 480 };
-static struct ScreenResolution hicolour = { 640, 480 };
-static struct ScreenResolution truecolour = { 640, 480 };
-static struct ScreenResolution alphacolour = { 640, 480 };
-
-uae_u32 p96_rgbx16[65536];
-uae_u32 p96rc[256], p96gc[256], p96bc[256];
-
-static int cursorwidth, cursorheight, cursorok;
-static uae_u8 *cursordata;
-static uae_u32 cursorrgb[4], cursorrgbn[4];
-static int cursordeactivate, setupcursor_needed;
-static bool cursorvisible;
+static UAE_TLS struct ScreenResolution planar = { 320, 240 };
+static UAE_TLS struct ScreenResolution chunky = { 640, 480 };
+static UAE_TLS struct ScreenResolution hicolour = { 640, 480 };
+static UAE_TLS struct ScreenResolution truecolour = { 640, 480 };
+static UAE_TLS struct ScreenResolution alphacolour = { 640, 480 };
+
+UAE_TLS uae_u32 p96_rgbx16[65536];
+UAE_TLS uae_u32 p96rc[256], p96gc[256], p96bc[256];
+
+static UAE_TLS int cursorwidth, cursorheight, cursorok;
+static UAE_TLS uae_u8 *cursordata;
+static UAE_TLS uae_u32 cursorrgb[4], cursorrgbn[4];
+static UAE_TLS int cursordeactivate, setupcursor_needed;
+static UAE_TLS bool cursorvisible;
 //static HCURSOR wincursor;
 /// REMOVEME: nowhere used: static int wincursor_shown;
-static uaecptr boardinfo, ABI_interrupt;
-static int interrupt_enabled;
-double p96vblank;
-static int rtg_clear_flag;
-
-static int uaegfx_old, uaegfx_active;
-static uae_u32 reserved_gfxmem;
-static uaecptr uaegfx_resname,
+static UAE_TLS uaecptr boardinfo, ABI_interrupt;
+static UAE_TLS int interrupt_enabled;
+UAE_TLS double p96vblank;
+static UAE_TLS int rtg_clear_flag;
+
+static UAE_TLS int uaegfx_old, uaegfx_active;
+static UAE_TLS uae_u32 reserved_gfxmem;
+static UAE_TLS uaecptr uaegfx_resname,
 	uaegfx_resid,
 	uaegfx_init,
 	uaegfx_base,
@@ -142,7 +142,7 @@ static uaecptr uaegfx_resname,
 static void checkrtglibrary(void)
 {
 	uae_u32 v;
-	static int checked = false;
+	static UAE_TLS int checked = false;
 
 	if (checked)
 		return;
@@ -170,10 +170,10 @@ static void checkrtglibrary(void)
 	}
 }
 
-static uae_u32 p2ctab[256][2];
-static int set_gc_called = 0, init_picasso_screen_called = 0;
+static UAE_TLS uae_u32 p2ctab[256][2];
+static UAE_TLS int set_gc_called = 0, init_picasso_screen_called = 0;
 //fastscreen
-static uaecptr oldscr = 0;
+static UAE_TLS uaecptr oldscr = 0;
 
 
 STATIC_INLINE void endianswap (uae_u32 *vp, int bpp)
@@ -324,8 +324,50 @@ static void ShowSupportedResolutions (void)
 
 #endif
 
-static void **gwwbuf;
-static int gwwbufsize, gwwpagesize, gwwpagemask;
+/* Write tracking for flushpixels (): one byte per GWW_PAGESIZE bytes of
+ * gfx memory, set by the gfxmem_*putx handlers and by the host side blits,
+ * cleared once the covered rows have been converted. There is no host
+ * write-watch, so this is our own and does not need to match the MMU. */
+#define GWW_PAGESHIFT 10
+#define GWW_PAGESIZE (1 << GWW_PAGESHIFT)
+static UAE_TLS uae_u8 *gwwdirty;
+static UAE_TLS int gwwpages;
+
+STATIC_INLINE void gfxmem_dirty (uae_u32 offset)
+{
+	if (gwwdirty)
+		gwwdirty[offset >> GWW_PAGESHIFT] = 1;
+}
+
+/* Host pointer into gfx memory, as used by the RenderInfo based blits */
+static void gfxmem_dirty_range (uae_u8 *p, int bytes)
+{
+	uae_u32 start, end;
+
+	if (!gwwdirty || bytes <= 0 || p < gfxmemory || p >= gfxmemory + allocated_gfxmem)
+		return;
+	start = (uae_u32)(p - gfxmemory);
+	end = start + bytes;
+	if (end > allocated_gfxmem)
+		end = allocated_gfxmem;
+	memset (gwwdirty + (start >> GWW_PAGESHIFT), 1, ((end - 1) >> GWW_PAGESHIFT) - (start >> GWW_PAGESHIFT) + 1);
+}
+
+static void gfxmem_dirty_rect (struct RenderInfo *ri, int x, int y, int w, int h, int Bpp)
+{
+	if (w > 0 && h > 0)
+		gfxmem_dirty_range (ri->Memory + y * ri->BytesPerRow + x * Bpp, (h - 1) * ri->BytesPerRow + w * Bpp);
+}
+
+/* get_real_address () for the blit traps. They mark what they write with
+ * gfxmem_dirty_rect (), going through gfxmem_xlate () would force a full
+ * refresh every time. */
+static uae_u8 *p96_real_address (uaecptr addr)
+{
+	if (gfxmemory && addr - gfxmem_start < allocated_gfxmem)
+		return gfxmemory + (addr - gfxmem_start);
+	return get_real_address (addr);
+}
 extern uae_u8 *natmem_offset;
 
 static uae_u8 GetBytesPerPixel (uae_u32 RGBfmt)
@@ -398,7 +440,7 @@ static int CopyRenderInfoStructureA2U (uaecptr amigamemptr, struct RenderInfo *r
 	if (valid_address (amigamemptr, PSSO_RenderInfo_sizeof)) {
 		uaecptr memp = get_long (amigamemptr + PSSO_RenderInfo_Memory);
 		ri->AMemory = memp;
-		ri->Memory = get_real_address (memp);
+		ri->Memory = p96_real_address (memp);
 		ri->BytesPerRow = get_word (amigamemptr + PSSO_RenderInfo_BytesPerRow);
 		ri->RGBFormat = (RGBFTYPE)get_long (amigamemptr + PSSO_RenderInfo_RGBFormat);
 		// Can't really validate this better at this point, no height.
@@ -413,7 +455,7 @@ static int CopyPatternStructureA2U (uaecptr amigamemptr, struct pPattern *patter
 {
 	if (valid_address (amigamemptr, PSSO_Pattern_sizeof)) {
 		uaecptr memp = get_long (amigamemptr + PSSO_Pattern_Memory);
-		pattern->Memory = get_real_address (memp);
+		pattern->Memory = p96_real_address (memp);
 		pattern->XOffset = get_word (amigamemptr + PSSO_Pattern_XOffset);
 		pattern->YOffset = get_word (amigamemptr + PSSO_Pattern_YOffset);
 		pattern->FgPen = get_long (amigamemptr + PSSO_Pattern_FgPen);
@@ -464,7 +506,7 @@ static int CopyBitMapStructureA2U (uaecptr amigamemptr, struct pBitMap *bm)
 			break;
 		default:
 			if (valid_address (plane, bm->BytesPerRow * bm->Rows))
-				bm->Planes[i] = get_real_address (plane);
+				bm->Planes[i] = p96_real_address (plane);
 			else
 				return 0;
 			break;
@@ -478,7 +520,7 @@ static int CopyTemplateStructureA2U (uaecptr amigamemptr, struct Template *tmpl)
 	uaecptr memp = get_long (amigamemptr + PSSO_Template_Memory);
 
 	if (valid_address (memp, sizeof(struct Template))) {
-		tmpl->Memory = get_real_address (memp);
+		tmpl->Memory = p96_real_address (memp);
 		tmpl->BytesPerRow = get_word (amigamemptr + PSSO_Template_BytesPerRow);
 		tmpl->XOffset = get_byte (amigamemptr + PSSO_Template_XOffset);
 		tmpl->DrawMode = get_byte (amigamemptr + PSSO_Template_DrawMode);
@@ -608,7 +650,7 @@ static void disablemouse (void)
 	//D3D_setcursor (0, 0, 0);
 }
 
-static int newcursor_x, newcursor_y;
+static UAE_TLS int newcursor_x, newcursor_y;
 
 static void mouseupdate (void)
 {
@@ -634,8 +676,8 @@ static void mouseupdate (void)
 	//D3D_setcursor (x, y, cursorvisible);
 }
 
-static int framecnt;
-int p96skipmode = -1;
+static UAE_TLS int framecnt;
+UAE_TLS int p96skipmode = -1;
 static int doskip (void)
 {
 	if (framecnt >= currprefs.gfx_framerate)
@@ -672,7 +714,7 @@ static void rtg_clear (void)
 
 static void picasso_handle_vsync2 (void)
 {
-	static int vsynccnt;
+	static UAE_TLS int vsynccnt;
 	int thisisvsync = 1;
 	int vsync = isvsync_rtg ();
 	int mult;
@@ -707,7 +749,7 @@ static void picasso_handle_vsync2 (void)
 		rtg_show ();
 }
 
-static int p96hsync;
+static UAE_TLS int p96hsync;
 
 void picasso_handle_vsync (void)
 {
@@ -756,7 +798,7 @@ void picasso_handle_hsync (void)
 }
 
 
-static int set_panning_called = 0;
+static UAE_TLS int set_panning_called = 0;
 
 
 typedef enum {
@@ -898,7 +940,7 @@ static int getconvert (int rgbformat, int pixbytes)
 
 static void setconvert (void)
 {
-	static RGBFTYPE ohost_mode, orgbformat;
+	static UAE_TLS RGBFTYPE ohost_mode, orgbformat;
 
 	picasso_convert = getconvert (picasso96_state.RGBFormat, picasso_vidinfo.pixbytes);
 	if (currprefs.gfx_api) {
@@ -1623,7 +1665,7 @@ static uae_u32 REGPARAM2 picasso_FindCard (TrapContext *ctx)
 	} else
 		return 0;
 }
-int default_freq = 75;
+UAE_TLS int default_freq = 75;
 static void FillBoardInfo (uaecptr amigamemptr, struct LibResolution *res, int width, int height, int depth)
 {
 	int i;
@@ -1674,7 +1716,7 @@ struct modeids {
 	int width, height;
 	int id;
 };
-static struct modeids mi[] =
+static UAE_TLS struct modeids mi[] =
 {
 	/* "original" modes */
 
@@ -1758,7 +1800,7 @@ static int AssignModeID (int w, int h, int *unkcnt)
 	return 0x51001000 - (*unkcnt) * 0x10000;
 }
 
-static uaecptr picasso96_amem, picasso96_amemend;
+static UAE_TLS uaecptr picasso96_amem, picasso96_amemend;
 
 
 static void CopyLibResolutionStructureU2A (struct LibResolution *libres, uaecptr amigamemptr)
@@ -1791,11 +1833,9 @@ static void init_alloc (TrapContext *ctx, int size)
 	}
 	picasso96_amemend = picasso96_amem + size;
 	write_log (_T("P96 RESINFO: %08X-%08X (%d,%d)\n"), picasso96_amem, picasso96_amemend, size / PSSO_ModeInfo_sizeof, size);
-	xfree (gwwbuf);
-	gwwpagesize = getpagesize();
-	gwwbufsize = allocated_gfxmem / gwwpagesize + 1;
-	gwwpagemask = gwwpagesize - 1;
-	gwwbuf = xmalloc (void*, gwwbufsize);
+	xfree (gwwdirty);
+	gwwpages = (allocated_gfxmem >> GWW_PAGESHIFT) + 1;
+	gwwdirty = xcalloc (uae_u8, gwwpages);
 }
 
 static int p96depth (int depth)
@@ -1831,7 +1871,7 @@ static int resolution_compare (const void *a, const void *b)
 	return ma->depth - mb->depth;
 }
 
-static int missmodes[] = { 320, 200, 320, 240, 320, 256, 640, 400, 640, 480, 640, 512, 800, 600, 1024, 768, 1280, 1024, -1 };
+static UAE_TLS int missmodes[] = { 320, 200, 320, 240, 320, 256, 640, 400, 640, 480, 640, 512, 800, 600, 1024, 768, 1280, 1024, -1 };
 
 static uaecptr uaegfx_card_install (TrapContext *ctx, uae_u32 size);
 
@@ -2516,6 +2556,7 @@ static uae_u32 REGPARAM2 picasso_InvertRect (TrapContext *ctx)
 		for (lines = 0; lines < Height; lines++, uae_mem += ri.BytesPerRow)
 			do_xor8 (uae_mem, width_in_bytes, xorval);
 		result = 1;
+		gfxmem_dirty_rect (&ri, X, Y, Width, Height, Bpp);
 	}
 
 	return result; /* 1 if supported, 0 otherwise */
@@ -2593,6 +2634,8 @@ static uae_u32 REGPARAM2 picasso_FillRect (TrapContext *ctx)
 				result = 1;
 			}
 		}
+		if (result)
+			gfxmem_dirty_rect (&ri, X, Y, Width, Height, Bpp);
 	}
 	return result;
 }
@@ -2619,7 +2662,7 @@ static uae_u32 REGPARAM2 picasso_FillRect (TrapContext *ctx)
  * 14 = OR:       dst = src | dst
  * 15 = TRUE:     dst = 0xFF
  */
-struct blitdata
+UAE_TLS struct blitdata
 {
 	struct RenderInfo ri_struct;
 	struct RenderInfo dstri_struct;
@@ -2674,6 +2717,7 @@ STATIC_INLINE int BlitRectHelper (void)
 		dstri = ri;
 	}
 	/* Do our virtual frame-buffer memory first */
+	gfxmem_dirty_rect (dstri, dstx, dsty, width, height, Bpp);
 	return do_blitrect_frame_buffer (ri, dstri, srcx, srcy, dstx, dsty, width, height, mask, opcode);
 }
 
@@ -2851,6 +2895,7 @@ static uae_u32 REGPARAM2 picasso_BlitPattern (TrapContext *ctx)
 
 		Bpp = GetBytesPerPixel(ri.RGBFormat);
 		uae_mem = ri.Memory + Y * ri.BytesPerRow + X * Bpp; /* offset with address */
+		gfxmem_dirty_rect (&ri, X, Y, W, H, Bpp);
 
 		if (pattern.DrawMode & INVERS)
 			inversion = 1;
@@ -3014,6 +3059,7 @@ static uae_u32 REGPARAM2 picasso_BlitTemplate (TrapContext *ctx)
 
 		Bpp = GetBytesPerPixel (ri.RGBFormat);
 		uae_mem = ri.Memory + Y * ri.BytesPerRow + X * Bpp; /* offset into address */
+		gfxmem_dirty_rect (&ri, X, Y, W, H, Bpp);
 
 		if (tmp.DrawMode & INVERS)
 			inversion = 1;
@@ -3296,6 +3342,7 @@ static uae_u32 REGPARAM2 picasso_BlitPlanar2Chunky (TrapContext *ctx)
 			srcx, srcy, dstx, dsty, width, height, minterm, mask, local_bm.Depth));
 		P96TRACE((_T("P2C - BitMap has %d BPR, %d rows\n"), local_bm.BytesPerRow, local_bm.Rows));
 		PlanarToChunky (&local_ri, &local_bm, srcx, srcy, dstx, dsty, width, height, mask);
+		gfxmem_dirty_rect (&local_ri, dstx, dsty, width, height, 1);
 		result = 1;
 	}
 	return result;
@@ -3439,6 +3486,7 @@ static uae_u32 REGPARAM2 picasso_BlitPlanar2Direct (TrapContext *ctx)
 		P96TRACE((_T("BlitPlanar2Direct(%d, %d, %d, %d, %d, %d) Minterm 0x%x, Mask 0x%x, Depth %d\n"),
 			srcx, srcy, dstx, dsty, width, height, minterm, Mask, local_bm.Depth));
 		PlanarToDirect (&local_ri, &local_bm, srcx, srcy, dstx, dsty, width, height, Mask, &local_cim);
+		gfxmem_dirty_rect (&local_ri, dstx, dsty, width, height, GetBytesPerPixel (local_ri.RGBFormat));
 		result = 1;
 	}
 	return result;
@@ -3739,35 +3787,58 @@ static void copyall (uae_u8 *src, uae_u8 *dst, int pwidth, int pheight, int srcb
 	}
 }
 
-static bool flushpixels (void)
+#ifdef __LIBRETRO__
+/* The visible screen, straight from gfx memory, when it already is in the
+ * host pixel format. The frontend then presents it without any copy and
+ * flushpixels () has nothing to convert. */
+uae_u8 *picasso_direct_screen (int *width, int *height, int *pitch)
 {
-	int i;
-#ifdef NATMEM_OFFSET
-	uae_u8 *src = (uae_u8*)((size_t)p96ram_start + natmem_offset);
-#else
-	uae_u8 *src = (uae_u8*)((size_t)p96ram_start); //gfxmemory
+	int pwidth = picasso96_state.Width > picasso96_state.VirtualWidth ? picasso96_state.VirtualWidth : picasso96_state.Width;
+	int pheight = picasso96_state.Height > picasso96_state.VirtualHeight ? picasso96_state.VirtualHeight : picasso96_state.Height;
+	uae_u32 off = picasso96_state.XYOffset - gfxmem_start;
+
+	if (!picasso_on || !gfxmemory || picasso96_state.RGBFormat != host_mode || flashscreen)
+		return NULL;
+	if (pwidth <= 0 || pheight <= 0 || picasso96_state.BytesPerRow < pwidth * picasso_vidinfo.pixbytes)
+		return NULL;
+	if (off >= allocated_gfxmem || off + picasso96_state.BytesPerRow * pheight > allocated_gfxmem)
+		return NULL;
+	*width = pwidth;
+	*height = pheight;
+	*pitch = picasso96_state.BytesPerRow;
+	return gfxmemory + off;
+}
 #endif
-	int off = picasso96_state.XYOffset - gfxmem_start;
-	uae_u8 *src_start;
-	uae_u8 *src_end;
+
+static bool flushpixels (void)
+{
+	uae_u8 *src = gfxmemory;
+	uae_u32 off = picasso96_state.XYOffset - gfxmem_start;
 	int lock = 0;
 	uae_u8 *dst = NULL;
-	ULONG gwwcnt;
+	int dirtycnt = 0;
 	int pwidth = picasso96_state.Width > picasso96_state.VirtualWidth ? picasso96_state.VirtualWidth : picasso96_state.Width;
 	int pheight = picasso96_state.Height > picasso96_state.VirtualHeight ? picasso96_state.VirtualHeight : picasso96_state.Height;
+	int bpr = picasso96_state.BytesPerRow;
+	bool direct = picasso96_state.RGBFormat == host_mode;
 	int maxy = -1;
 	int miny = pheight - 1;
+	int first, last;
 
-	src_start = src + (off & ~gwwpagemask);
-	src_end = src + ((off + picasso96_state.BytesPerRow * pheight + gwwpagesize - 1) & ~gwwpagemask);
 #if 0
 	write_log (_T("%dx%d %dx%d %dx%d (%dx%d)\n"), picasso96_state.Width, picasso96_state.Height,
 		picasso96_state.VirtualWidth, picasso96_state.VirtualHeight,
 		picasso_vidinfo.width, picasso_vidinfo.height,
 		pwidth, pheight);
 #endif
-	if (!picasso_vidinfo.extra_mem || !gwwbuf || src_start >= src_end)
+	if (!picasso_vidinfo.extra_mem || !gwwdirty || !src || pheight <= 0 || bpr <= 0)
+		return false;
+	if (off >= allocated_gfxmem)
 		return false;
+	first = off >> GWW_PAGESHIFT;
+	last = (off + bpr * pheight - 1) >> GWW_PAGESHIFT;
+	if (last >= gwwpages)
+		last = gwwpages - 1;
 
 	if (flashscreen) {
 		full_refresh = 1;
@@ -3777,28 +3848,33 @@ static bool flushpixels (void)
 
 	for (;;) {
 		bool dofull;
-
-		gwwcnt = 0;
+		int i, y;
 
 		if (doskip () && p96skipmode == 1)
 			break;
 
+#ifdef __LIBRETRO__
+		/* Presented straight from gfx memory, only the bookkeeping is left */
+		int dw, dh, dp;
+		if (picasso_direct_screen (&dw, &dh, &dp)) {
+			full_refresh = 0;
+			memset (gwwdirty + first, 0, last - first + 1);
+			return true;
+		}
+#endif
+
 		if (full_refresh < 0) {
-			gwwcnt = (src_end - src_start) / gwwpagesize + 1;
+			dirtycnt = last - first + 1;
 			full_refresh = 1;
-			for (i = 0; (ULONG)i < gwwcnt; i++)
-				gwwbuf[i] = src_start + i * gwwpagesize;
 		} else {
-			/*ULONG ps;*/
-			gwwcnt = gwwbufsize;
-			/*if (mman_GetWriteWatch (src_start, src_end - src_start, gwwbuf, &gwwcnt, &ps))
-				break;*/
+			for (i = first; i <= last; i++)
+				dirtycnt += gwwdirty[i];
 		}
 
-		if (gwwcnt == 0)
+		if (dirtycnt == 0)
 			break;
 
-		dofull = gwwcnt >= (ULONG)(((src_end - src_start) / gwwpagesize) * 80 / 100);
+		dofull = dirtycnt >= (last - first + 1) * 80 / 100;
 
 		dst = gfx_lock_picasso (dofull, rtg_clear_flag != 0);
 		if (rtg_clear_flag)
@@ -3814,60 +3890,46 @@ static bool flushpixels (void)
 		if (dofull) {
 			if (flashscreen != 0)
 				copyallinvert (src + off, dst, pwidth, pheight,
-					picasso96_state.BytesPerRow, picasso96_state.BytesPerPixel,
+					bpr, picasso96_state.BytesPerPixel,
 					picasso_vidinfo.rowbytes, picasso_vidinfo.pixbytes,
-					picasso96_state.RGBFormat == host_mode, picasso_convert);
+					direct, picasso_convert);
 			else
 				copyall (src + off, dst, pwidth, pheight,
-					picasso96_state.BytesPerRow, picasso96_state.BytesPerPixel,
+					bpr, picasso96_state.BytesPerPixel,
 					picasso_vidinfo.rowbytes, picasso_vidinfo.pixbytes,
-					picasso96_state.RGBFormat == host_mode, picasso_convert);
+					direct, picasso_convert);
 
 			miny = 0;
 			maxy = pheight;
 			break;
 		}
 
-		for (i = 0; (ULONG)i < gwwcnt; i++) {
-			uae_u8 *p = (uae_u8*)gwwbuf[i];
-
-			if (p >= src_start && p < src_end) {
-				int y, x, realoffset;
-
-				if (p >= src + off) {
-					realoffset = p - (src + off);
-				} else {
-					realoffset = 0;
-				}
-
-				y = realoffset / picasso96_state.BytesPerRow;
-				if (y < pheight) {
-					int w = gwwpagesize / picasso96_state.BytesPerPixel;
-					x = (realoffset % picasso96_state.BytesPerRow) / picasso96_state.BytesPerPixel;
-					if (x < pwidth)
-						copyrow (src + off, dst, x, y, pwidth - x,
-							picasso96_state.BytesPerRow, picasso96_state.BytesPerPixel,
-							picasso_vidinfo.rowbytes, picasso_vidinfo.pixbytes,
-							picasso96_state.RGBFormat == host_mode, picasso_convert);
-					w = (gwwpagesize - (picasso96_state.BytesPerRow - x * picasso96_state.BytesPerPixel)) / picasso96_state.BytesPerPixel;
-					if (y < miny)
-						miny = y;
-					y++;
-					while (y < pheight && w > 0) {
-						int maxw = w > pwidth ? pwidth : w;
-						copyrow (src + off, dst, 0, y, maxw,
-							picasso96_state.BytesPerRow, picasso96_state.BytesPerPixel,
-							picasso_vidinfo.rowbytes, picasso_vidinfo.pixbytes,
-							picasso96_state.RGBFormat == host_mode, picasso_convert);
-						w -= maxw;
-						y++;
-					}
-					if (y > maxy)
-						maxy = y;
-				}
-
-			}
+		/* Convert every row touched by a dirty page, once */
+		y = 0;
+		for (i = first; i <= last; i++) {
+			uae_u32 start, end;
+			int y1;
 
+			if (!gwwdirty[i])
+				continue;
+			start = i << GWW_PAGESHIFT;
+			end = start + GWW_PAGESIZE;
+			start = start < off ? 0 : start - off;
+			end -= off;
+			if (start < (uae_u32)y * bpr)
+				start = y * bpr;
+			y1 = (end - 1) / bpr;
+			if (y1 >= pheight)
+				y1 = pheight - 1;
+			for (y = start / bpr; y <= y1; y++)
+				copyrow (src + off, dst, 0, y, pwidth,
+					bpr, picasso96_state.BytesPerPixel,
+					picasso_vidinfo.rowbytes, picasso_vidinfo.pixbytes,
+					direct, picasso_convert);
+			if ((int)(start / bpr) < miny)
+				miny = start / bpr;
+			if (y > maxy)
+				maxy = y;
 		}
 		break;
 	}
@@ -3906,11 +3968,11 @@ static bool flushpixels (void)
 
 	if (lock)
 		gfx_unlock_picasso (true);
-	if (dst && gwwcnt) {
+	if (dst && dirtycnt) {
 		if (doskip () && p96skipmode == 3) {
 			;
 		} else {
-			;//mman_ResetWatch (src_start, src_end - src_start);
+			memset (gwwdirty + first, 0, last - first + 1);
 		}
 		full_refresh = 0;
 	}
@@ -3950,6 +4012,8 @@ static void REGPARAM2 gfxmem_lputx (uaecptr addr, uae_u32 l)
 	addr &= gfxmem_mask;
 	m = (uae_u32 *)(gfxmemory + addr);
 	do_put_mem_long (m, l);
+	gfxmem_dirty (addr);
+	gfxmem_dirty (addr + 3);
 }
 
 static void REGPARAM2 gfxmem_wputx (uaecptr addr, uae_u32 w)
@@ -3959,6 +4023,8 @@ static void REGPARAM2 gfxmem_wputx (uaecptr addr, uae_u32 w)
 	addr &= gfxmem_mask;
 	m = (uae_u16 *)(gfxmemory + addr);
 	do_put_mem_word (m, (uae_u16)w);
+	gfxmem_dirty (addr);
+	gfxmem_dirty (addr + 1);
 }
 
 static void REGPARAM2 gfxmem_bputx (uaecptr addr, uae_u32 b)
@@ -3966,6 +4032,7 @@ static void REGPARAM2 gfxmem_bputx (uaecptr addr, uae_u32 b)
 	addr -= gfxmem_start & gfxmem_mask;
 	addr &= gfxmem_mask;
 	gfxmemory[addr] = b;
+	gfxmem_dirty (addr);
 }
 
 static int REGPARAM2 gfxmem_check (uaecptr addr, uae_u32 size)
@@ -3979,10 +4046,14 @@ static uae_u8 *REGPARAM2 gfxmem_xlate (uaecptr addr)
 {
 	addr -= gfxmem_start & gfxmem_mask;
 	addr &= gfxmem_mask;
+	/* Traps and other host code write through this pointer where the
+	 * dirty map cannot see it, convert the whole screen next time. */
+	if (!full_refresh)
+		full_refresh = 1;
 	return gfxmemory + addr;
 }
 
-addrbank gfxmem_bank = {
+UAE_TLS addrbank gfxmem_bank = {
 	gfxmem_lgetx, gfxmem_wgetx, gfxmem_bgetx,
 	gfxmem_lputx, gfxmem_wputx, gfxmem_bputx,
 	gfxmem_xlate, gfxmem_check, NULL, _T("RTG RAM"),
@@ -4024,7 +4095,7 @@ static uae_u32 REGPARAM2 picasso_SetInterrupt (TrapContext *ctx)
 	return onoff;
 }
 
-static uaecptr uaegfx_vblankname, uaegfx_portsname;
+static UAE_TLS uaecptr uaegfx_vblankname, uaegfx_portsname;
 static void initvblankABI (uaecptr base, uaecptr ABI)
 {
 	for (unsigned int i = 0; i < 22; i++)
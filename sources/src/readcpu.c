@@ -32,7 +32,7 @@
 # define CPU_EMU_SIZE 0
 #endif
 
-int nr_cpuop_funcs;
+UAE_TLS int nr_cpuop_funcs;
 
 struct mnemolookup lookuptab[] = {
 	{ i_ILLG, _T("ILLEGAL"), NULL },
@@ -172,7 +172,7 @@ struct mnemolookup lookuptab[] = {
 	{ i_ILLG, _T(""), NULL },
 };
 
-struct instr *table68k;
+UAE_TLS struct instr *table68k;
 
 static amodes mode_from_str (const char *str)
 {
@@ -782,7 +782,7 @@ void read_table68k (void)
 	}
 }
 
-static int imismatch;
+static UAE_TLS int imismatch;
 
 static void handle_merges (long int opcode)
 {
@@ -18,8 +18,8 @@
 
 #include "autoconf.h"
 
-static struct romlist *rl;
-static int romlist_cnt;
+static UAE_TLS struct romlist *rl;
+static UAE_TLS int romlist_cnt;
 
 struct romlist *romlist_getit (void)
 {
@@ -102,7 +102,7 @@ static struct romheader romheaders[] = {
 #define ALTROMPN(id,grp,num,size,flags,pn,crc32,a,b,c,d,e) \
 { _T("X"), 0, 0, 0, 0, 0, size, id, 0, 0, flags, (grp << 16) | num, 0, pn, crc32, { a, b, c, d, e }, NULL },
 
-static struct romdata roms[] = {
+static UAE_TLS struct romdata roms[] = {
 /* Format of the regular ROM initialization: (Please keep valid!)
  *  { *name,                                                ver,rev,subv,subr, *model,                      size, id, cpu, cloanto, type,        group,ttl,*partnumber,           crc32, { sha1[5]                                                    }, *configname } */
 	{ _T("Cloanto Amiga Forever ROM key"),                    0,  0,  0,   0, NULL,                         2069,  0, 0,     1, ROMTYPE_KEY,         0,  0, NULL,            0x869ae1b1, { 0x801bbab3, 0x2e3d3738, 0x6dd1636d, 0x4f1d6fa7, 0xe21d5874 }, NULL },
@@ -323,7 +323,7 @@ struct romlist **getromlistbyident (int ver, int rev, int subver, int subrev, co
 	struct romdata *rd;
 	struct romlist **rdout, *rltmp;
 	void *buf;
-	static struct romlist rlstatic;
+	static UAE_TLS struct romlist rlstatic;
 
 	for (i = 0; roms[i].name; i++);
 	if (all)
@@ -462,7 +462,7 @@ struct rom_key {
 	int size;
 };
 
-static struct rom_key keyring[ROM_KEY_NUM];
+static UAE_TLS struct rom_key keyring[ROM_KEY_NUM];
 
 static void addkey (uae_u8 *key, int size, const TCHAR *name)
 {
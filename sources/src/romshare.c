@@ -0,0 +1,232 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * ROM and table pages shared between processes
+  *
+  * A ROM read from a plain file is compared with a private mapping of the
+  * same file, when they match the read copy is dropped and the mapping is
+  * used: its pages come from the page cache and are shared by every process
+  * running that ROM until one of them patches a page.
+  *
+  * Cached tables live in files named puae_<name>.v<version>.cache. The
+  * header holds the table size and a key computed by the caller from the
+  * table's inputs, the data starts at ROMSHARE_DATA so it can be mapped on
+  * any page size. A missing or stale file is built under a temporary name
+  * and renamed into place, an instance mapping the old file keeps using it.
+  */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "zfile.h"
+#include "romshare.h"
+
+#ifdef ROMSHARE
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define ROMSHARE_VERSION 1
+#define ROMSHARE_DATA 65536
+#define ROMSHARE_MAPS 16
+
+struct romshare_header {
+	uae_char magic[8];
+	uae_u32 version;
+	uae_u32 key;
+	uae_u32 len;
+};
+
+struct romshare_map {
+	uae_u8 *p;
+	int size;
+};
+
+static UAE_TLS bool romshare_on;
+static UAE_TLS TCHAR romshare_dir[MAX_DPATH];
+static UAE_TLS struct romshare_map romshare_maps[ROMSHARE_MAPS];
+
+void romshare_init (bool enable, const TCHAR *cachedir)
+{
+	romshare_on = enable;
+	romshare_dir[0] = 0;
+	if (enable && cachedir)
+		_tcsncpy (romshare_dir, cachedir, MAX_DPATH - 1);
+}
+
+bool romshare_enabled (void)
+{
+	return romshare_on;
+}
+
+static uae_u8 *addmap (uae_u8 *p, int size)
+{
+	int i;
+
+	for (i = 0; i < ROMSHARE_MAPS; i++) {
+		if (!romshare_maps[i].p) {
+			romshare_maps[i].p = p;
+			romshare_maps[i].size = size;
+			return p;
+		}
+	}
+	munmap (p, size);
+	return NULL;
+}
+
+bool romshare_unmap (void *p)
+{
+	int i;
+
+	if (!p)
+		return false;
+	for (i = 0; i < ROMSHARE_MAPS; i++) {
+		if (romshare_maps[i].p == p) {
+			munmap (romshare_maps[i].p, romshare_maps[i].size);
+			romshare_maps[i].p = NULL;
+			return true;
+		}
+	}
+	return false;
+}
+
+uae_u8 *romshare_map_rom (struct zfile *f, uae_u64 pos, int len, const uae_u8 *mem, int size)
+{
+	long pagesize = sysconf (_SC_PAGESIZE);
+	struct stat st;
+	uae_u8 *p;
+	int fd, i;
+
+	if (!romshare_on || !f->f || f->data || f->zfileread || f->useparent)
+		return NULL;
+	if (len <= 0 || size % len || len % pagesize || pos % pagesize)
+		return NULL;
+	fd = fileno (f->f);
+	/* pages past the end of the file would fault on access */
+	if (fstat (fd, &st) || (uae_u64)st.st_size < pos + len)
+		return NULL;
+	/* reserve the whole range, then map the file into it as often as it fits */
+	p = (uae_u8*)mmap (NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED)
+		return NULL;
+	for (i = 0; i < size; i += len) {
+		if (mmap (p + i, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, pos) == MAP_FAILED) {
+			munmap (p, size);
+			return NULL;
+		}
+	}
+	if (memcmp (p, mem, size)) {
+		munmap (p, size);
+		return NULL;
+	}
+	write_log (_T("ROMSHARE: '%s' mapped, %d bytes at %llu\n"), f->name, len, pos);
+	return addmap (p, size);
+}
+
+static uae_u8 *map_cachefile (const TCHAR *path, uae_u32 key, int len, bool writable)
+{
+	struct romshare_header h;
+	struct stat st;
+	uae_u8 *p;
+	int fd;
+
+	fd = open (path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	p = NULL;
+	if (pread (fd, &h, sizeof h, 0) == sizeof h && !memcmp (h.magic, "PUAETBL", 8)
+		&& h.version == ROMSHARE_VERSION && h.key == key && h.len == len
+		&& !fstat (fd, &st) && st.st_size >= ROMSHARE_DATA + len) {
+		p = (uae_u8*)mmap (NULL, len, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, ROMSHARE_DATA);
+		if (p == MAP_FAILED)
+			p = NULL;
+	}
+	close (fd);
+	return p ? addmap (p, len) : NULL;
+}
+
+static bool build_cachefile (const TCHAR *path, uae_u32 key, int len, romshare_fill fill)
+{
+	struct romshare_header h;
+	TCHAR tmp[MAX_DPATH];
+	uae_u8 *p;
+	bool ok = false;
+	int fd;
+
+	_stprintf (tmp, _T("%s.XXXXXX"), path);
+	fd = mkstemp (tmp);
+	if (fd < 0) {
+		write_log (_T("ROMSHARE: can't create '%s'\n"), tmp);
+		return false;
+	}
+	/* readable by other users' cores as well */
+	fchmod (fd, 0644);
+	if (!ftruncate (fd, ROMSHARE_DATA + len)) {
+		p = (uae_u8*)mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, ROMSHARE_DATA);
+		if (p != MAP_FAILED) {
+			ok = fill (p, len);
+			munmap (p, len);
+		}
+	}
+	/* the header goes in last, a file left behind half written never matches */
+	memset (&h, 0, sizeof h);
+	memcpy (h.magic, "PUAETBL", 8);
+	h.version = ROMSHARE_VERSION;
+	h.key = key;
+	h.len = len;
+	if (ok)
+		ok = pwrite (fd, &h, sizeof h, 0) == sizeof h;
+	close (fd);
+	if (ok)
+		ok = !rename (tmp, path);
+	if (!ok)
+		unlink (tmp);
+	return ok;
+}
+
+uae_u8 *romshare_map_table (const TCHAR *name, uae_u32 key, int len, romshare_fill fill, bool writable)
+{
+	TCHAR path[MAX_DPATH];
+	uae_u8 *p;
+
+	if (!romshare_on || !romshare_dir[0])
+		return NULL;
+	_stprintf (path, _T("%s%spuae_%s.v%d.cache"), romshare_dir, FSDB_DIR_SEPARATOR_S, name, ROMSHARE_VERSION);
+	p = map_cachefile (path, key, len, writable);
+	if (p)
+		return p;
+	if (!build_cachefile (path, key, len, fill))
+		return NULL;
+	write_log (_T("ROMSHARE: '%s' built\n"), path);
+	return map_cachefile (path, key, len, writable);
+}
+
+#else
+
+void romshare_init (bool enable, const TCHAR *cachedir)
+{
+}
+
+bool romshare_enabled (void)
+{
+	return false;
+}
+
+uae_u8 *romshare_map_rom (struct zfile *f, uae_u64 pos, int len, const uae_u8 *mem, int size)
+{
+	return NULL;
+}
+
+uae_u8 *romshare_map_table (const TCHAR *name, uae_u32 key, int len, romshare_fill fill, bool writable)
+{
+	return NULL;
+}
+
+bool romshare_unmap (void *p)
+{
+	return false;
+}
+
+#endif
@@ -65,24 +65,30 @@
 #include "inputrecord.h"
 #include "disk.h"
 #include "misc.h"
+#include "lzfast.h"
+#include "statehash.h"
+#include "lockstep.h"
+#include "threaddep/thread.h"
 
-int savestate_state = 0;
-static int savestate_first_capture;
+UAE_TLS int savestate_state = 0;
+static UAE_TLS int savestate_first_capture;
 
-static bool new_blitter = false;
+static UAE_TLS bool new_blitter = false;
 
-static int replaycounter;
+static UAE_TLS int replaycounter;
 
-struct zfile *savestate_file;
-static int savestate_docompress, savestate_specialdump, savestate_nodialogs;
+UAE_TLS struct zfile *savestate_file;
+static UAE_TLS int savestate_docompress, savestate_specialdump, savestate_nodialogs;
 
-TCHAR savestate_fname[MAX_DPATH];
+UAE_TLS TCHAR savestate_fname[MAX_DPATH];
 
 #define STATEFILE_ALLOC_SIZE 600000
-static int statefile_alloc;
-static int staterecords_max = 1000;
-static int staterecords_first = 0;
-static struct zfile *staterecord_statefile;
+static UAE_TLS int statefile_alloc;
+static UAE_TLS int staterecords_max = 1000;
+static UAE_TLS int staterecords_first = 0;
+static UAE_TLS struct zfile *staterecord_statefile;
+static UAE_TLS struct zfile *snapshot_file;
+static UAE_TLS uae_u32 snapshot_hsync, snapshot_vsync;
 struct staterecord
 {
 	int len;
@@ -93,11 +99,11 @@ struct staterecord
 	int inprecoffset;
 };
 
-static struct staterecord **staterecords;
+static UAE_TLS struct staterecord **staterecords;
 
 static void state_incompatible_warn (void)
 {
-	static int warned;
+	static UAE_TLS int warned;
 	int dowarn = 0;
 	int i;
 
@@ -134,7 +140,7 @@ static void state_incompatible_warn (void)
 /* functions for reading/writing bytes, shorts and longs in big-endian
 * format independent of host machine's endianess */
 
-static uae_u8 *storepos;
+static UAE_TLS uae_u8 *storepos;
 void save_store_pos_func (uae_u8 **dstp)
 {
 	storepos = *dstp;
@@ -302,6 +308,296 @@ TCHAR *restore_path_func (uae_u8 **dstp, int type)
 #ifdef SAVESTATE
 /* read and write IFF-style hunks */
 
+/* chunk flags, also used as the compression mode */
+#define CHUNK_ZLIB 1
+#define CHUNK_FAST 2
+
+/* CHUNK_FAST data is a sequence of 64k blocks, each starting with
+ * a longword: type << 30 | stored size. Zero filled blocks store
+ * nothing, the unpacked size of a block is implied. */
+#define STATE_BLOCK_SIZE 65536
+#define STATE_BLOCK_STORED 0
+#define STATE_BLOCK_ZERO 1
+#define STATE_BLOCK_LZ 2
+
+struct state_block
+{
+	const uae_u8 *src;
+	int len;
+	int type;
+	uae_u8 *data;
+	int datalen;
+};
+
+struct state_chunk
+{
+	uae_u8 *data;
+	int len;
+	const TCHAR *name;
+	struct state_block *blocks;
+	int numblocks;
+};
+
+static bool is_zero_block (const uae_u8 *p, int len)
+{
+	int i;
+
+	for (i = 0; i + 4 <= len; i += 4) {
+		if (*(uae_u32*)(p + i))
+			return false;
+	}
+	for (; i < len; i++) {
+		if (p[i])
+			return false;
+	}
+	return true;
+}
+
+static void compress_block (struct state_block *b, uae_u8 *tmp)
+{
+	int len;
+
+	b->data = NULL;
+	b->datalen = b->len;
+	if (is_zero_block (b->src, b->len)) {
+		b->type = STATE_BLOCK_ZERO;
+		b->datalen = 0;
+		return;
+	}
+	b->type = STATE_BLOCK_STORED;
+	/* no scratch buffer, the block is stored as it is */
+	if (!tmp)
+		return;
+	len = lzfast_compress (b->src, b->len, tmp, LZFAST_BOUND (STATE_BLOCK_SIZE));
+	if (len > 0 && len < b->len) {
+		b->data = xmalloc (uae_u8, len);
+		if (b->data) {
+			memcpy (b->data, tmp, len);
+			b->type = STATE_BLOCK_LZ;
+			b->datalen = len;
+		}
+	}
+}
+
+/* Blocks are compressed by a pool of worker threads and the calling
+ * thread, in any order. Only the writing back is sequential. */
+
+static UAE_TLS struct state_block *state_jobs;
+static UAE_TLS int state_jobs_num, state_jobs_next, state_jobs_done;
+#ifdef SUPPORT_THREADS
+#define STATE_THREADS_MAX 7
+static UAE_TLS int state_threads = -1;
+static UAE_TLS bool state_threads_quit;
+static UAE_TLS uae_thread_id state_thread_ids[STATE_THREADS_MAX];
+static UAE_TLS uae_sem_t state_sem_work, state_sem_done, state_sem_lock;
+#endif
+
+static int get_state_job (void)
+{
+	int i;
+
+#ifdef SUPPORT_THREADS
+	uae_sem_wait (&state_sem_lock);
+#endif
+	i = state_jobs_next < state_jobs_num ? state_jobs_next++ : -1;
+#ifdef SUPPORT_THREADS
+	uae_sem_post (&state_sem_lock);
+#endif
+	return i;
+}
+
+static void run_state_jobs (uae_u8 *tmp)
+{
+	int i;
+
+	while ((i = get_state_job ()) >= 0) {
+		compress_block (&state_jobs[i], tmp);
+#ifdef SUPPORT_THREADS
+		uae_sem_wait (&state_sem_lock);
+		if (++state_jobs_done == state_jobs_num)
+			uae_sem_post (&state_sem_done);
+		uae_sem_post (&state_sem_lock);
+#endif
+	}
+}
+
+#ifdef SUPPORT_THREADS
+static void *state_compress_thread (void *v)
+{
+	uae_u8 *tmp = (uae_u8*)v;
+
+	for (;;) {
+		uae_sem_wait (&state_sem_work);
+		if (state_threads_quit)
+			break;
+		run_state_jobs (tmp);
+	}
+	xfree (tmp);
+	return NULL;
+}
+
+static void init_state_threads (void)
+{
+	int i, cpus = 2;
+
+	if (state_threads >= 0)
+		return;
+#ifdef _SC_NPROCESSORS_ONLN
+	cpus = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+#ifdef UAE_MULTI_INSTANCE
+	/* helper threads would only take turns on the machine's host thread */
+	cpus = 1;
+#endif
+	state_threads = cpus > STATE_THREADS_MAX + 1 ? STATE_THREADS_MAX : (cpus > 1 ? cpus - 1 : 0);
+	state_threads_quit = false;
+	uae_sem_init (&state_sem_work, 0, 0);
+	uae_sem_init (&state_sem_done, 0, 0);
+	uae_sem_init (&state_sem_lock, 0, 1);
+	for (i = 0; i < state_threads; i++) {
+		uae_u8 *tmp = xmalloc (uae_u8, LZFAST_BOUND (STATE_BLOCK_SIZE));
+		if (!tmp)
+			break;
+		if (!uae_start_thread (_T("statecompress"), state_compress_thread, tmp, &state_thread_ids[i])) {
+			xfree (tmp);
+			break;
+		}
+	}
+	state_threads = i;
+	write_log (_T("Statefile compression threads: %d\n"), state_threads);
+}
+
+static void free_state_sem (uae_sem_t *sem)
+{
+	uae_sem_destroy (sem);
+#if !defined(_WIN32) && !defined(UAE_MULTI_INSTANCE)
+#if !defined(WIIU) && !defined(USE_NAMED_SEMAPHORES)
+	/* calloc'd by uae_sem_init () */
+	free (sem->sem);
+#endif
+	sem->sem = NULL;
+#endif
+}
+
+static void free_state_threads (void)
+{
+	int i;
+
+	if (state_threads < 0)
+		return;
+	state_threads_quit = true;
+	for (i = 0; i < state_threads; i++)
+		uae_sem_post (&state_sem_work);
+	for (i = 0; i < state_threads; i++)
+		uae_wait_thread (state_thread_ids[i]);
+	free_state_sem (&state_sem_work);
+	free_state_sem (&state_sem_done);
+	free_state_sem (&state_sem_lock);
+	state_threads = -1;
+}
+#endif
+
+static void compress_blocks (struct state_block *blocks, int num)
+{
+	uae_u8 *tmp;
+	int i;
+
+	if (num <= 0)
+		return;
+	tmp = xmalloc (uae_u8, LZFAST_BOUND (STATE_BLOCK_SIZE));
+#ifdef SUPPORT_THREADS
+	init_state_threads ();
+	uae_sem_wait (&state_sem_lock);
+#endif
+	state_jobs = blocks;
+	state_jobs_num = num;
+	state_jobs_next = 0;
+	state_jobs_done = 0;
+#ifdef SUPPORT_THREADS
+	uae_sem_post (&state_sem_lock);
+	for (i = 0; i < state_threads && i < num - 1; i++)
+		uae_sem_post (&state_sem_work);
+#endif
+	run_state_jobs (tmp);
+#ifdef SUPPORT_THREADS
+	uae_sem_wait (&state_sem_done);
+#endif
+	xfree (tmp);
+}
+
+static void write_chunk_blocks (struct zfile *f, struct state_chunk *c)
+{
+	uae_u8 tmp[16], *dst;
+	uae_u8 zero[4]= { 0, 0, 0, 0 };
+	size_t len, len2;
+	char *s;
+	int i;
+
+	len = 0;
+	for (i = 0; i < c->numblocks; i++)
+		len += 4 + c->blocks[i].datalen;
+	s = ua (c->name);
+	zfile_fwrite (s, 1, 4, f);
+	xfree (s);
+	dst = &tmp[0];
+	save_u32 (len + 4 + 4 + 4 + 4);
+	save_u32 (CHUNK_FAST);
+	save_u32 (c->len);
+	zfile_fwrite (&tmp[0], 1, dst - tmp, f);
+	for (i = 0; i < c->numblocks; i++) {
+		struct state_block *b = &c->blocks[i];
+		dst = &tmp[0];
+		save_u32 ((b->type << 30) | b->datalen);
+		zfile_fwrite (&tmp[0], 1, 4, f);
+		if (b->type == STATE_BLOCK_LZ)
+			zfile_fwrite (b->data, 1, b->datalen, f);
+		else if (b->type == STATE_BLOCK_STORED)
+			zfile_fwrite (b->src, 1, b->datalen, f);
+		xfree (b->data);
+		b->data = NULL;
+	}
+	/* alignment */
+	len2 = 4 - (len & 3);
+	if (len2)
+		zfile_fwrite (zero, 1, len2, f);
+
+	write_log (_T("Chunk '%s' chunk size %d (%d)\n"), c->name, len + 16, c->len);
+}
+
+static void save_chunk (struct zfile *f, uae_u8 *chunk, size_t len, TCHAR *name, int compress);
+
+/* compress all chunks concurrently, then write them in order */
+static void save_chunks_fast (struct zfile *f, struct state_chunk *chunks, int num)
+{
+	struct state_block *blocks;
+	int i, j, total = 0;
+
+	for (i = 0; i < num; i++)
+		total += (chunks[i].len + STATE_BLOCK_SIZE - 1) / STATE_BLOCK_SIZE;
+	blocks = xcalloc (struct state_block, total > 0 ? total : 1);
+	if (!blocks) {
+		for (i = 0; i < num; i++)
+			save_chunk (f, chunks[i].data, chunks[i].len, (TCHAR*)chunks[i].name, CHUNK_ZLIB);
+		return;
+	}
+	total = 0;
+	for (i = 0; i < num; i++) {
+		struct state_chunk *c = &chunks[i];
+		c->blocks = &blocks[total];
+		c->numblocks = 0;
+		for (j = 0; j < c->len; j += STATE_BLOCK_SIZE) {
+			struct state_block *b = &c->blocks[c->numblocks++];
+			b->src = c->data + j;
+			b->len = c->len - j < STATE_BLOCK_SIZE ? c->len - j : STATE_BLOCK_SIZE;
+		}
+		total += c->numblocks;
+	}
+	compress_blocks (blocks, total);
+	for (i = 0; i < num; i++)
+		write_chunk_blocks (f, &chunks[i]);
+	xfree (blocks);
+}
+
 static void save_chunk (struct zfile *f, uae_u8 *chunk, size_t len, TCHAR *name, int compress)
 {
 	uae_u8 tmp[8], *dst;
@@ -318,6 +614,14 @@ static void save_chunk (struct zfile *f, uae_u8 *chunk, size_t len, TCHAR *name,
 		zfile_fwrite (chunk, 1, len, f);
 		return;
 	}
+	if (compress == CHUNK_FAST) {
+		struct state_chunk c;
+		c.data = chunk;
+		c.len = len;
+		c.name = name;
+		save_chunks_fast (f, &c, 1);
+		return;
+	}
 
 	/* chunk name */
 	s = ua (name);
@@ -368,6 +672,45 @@ static void save_chunk (struct zfile *f, uae_u8 *chunk, size_t len, TCHAR *name,
 	write_log (_T("Chunk '%s' chunk size %d (%d)\n"), name, chunklen, len);
 }
 
+static void restore_blocks (uae_u8 *dst, int dstsize, struct zfile *f, int srcsize)
+{
+	uae_u8 tmp[4], *src, *buf = NULL;
+	int pos = 0;
+
+	while (pos < dstsize && srcsize >= 4) {
+		uae_u32 v;
+		int type, size, len;
+
+		zfile_fread (tmp, 1, 4, f);
+		src = tmp;
+		v = restore_u32 ();
+		srcsize -= 4;
+		type = v >> 30;
+		size = v & 0x3fffffff;
+		len = dstsize - pos < STATE_BLOCK_SIZE ? dstsize - pos : STATE_BLOCK_SIZE;
+		if (size > srcsize || (type == STATE_BLOCK_STORED && size != len) || size > LZFAST_BOUND (STATE_BLOCK_SIZE))
+			break;
+		if (type == STATE_BLOCK_ZERO) {
+			memset (dst + pos, 0, len);
+		} else if (type == STATE_BLOCK_STORED) {
+			zfile_fread (dst + pos, 1, len, f);
+		} else if (type == STATE_BLOCK_LZ) {
+			if (!buf)
+				buf = xmalloc (uae_u8, LZFAST_BOUND (STATE_BLOCK_SIZE));
+			zfile_fread (buf, 1, size, f);
+			if (lzfast_decompress (buf, size, dst + pos, len) != len)
+				break;
+		} else {
+			break;
+		}
+		srcsize -= size;
+		pos += len;
+	}
+	if (pos < dstsize)
+		write_log (_T("Statefile chunk corrupt at offset %d/%d\n"), pos, dstsize);
+	xfree (buf);
+}
+
 static uae_u8 *restore_chunk (struct zfile *f, TCHAR *name, size_t *len, size_t *totallen, size_t *filepos)
 {
 	uae_u8 tmp[6], dummy[4], *mem, *src;
@@ -396,7 +739,7 @@ static uae_u8 *restore_chunk (struct zfile *f, TCHAR *name, size_t *len, size_t
 	src = tmp;
 	flags = restore_u32 ();
 	*totallen = *len;
-	if (flags & 1) {
+	if (flags & (CHUNK_ZLIB | CHUNK_FAST)) {
 		zfile_fread (tmp, 1, 4, f);
 		src = tmp;
 		*totallen = restore_u32 ();
@@ -422,8 +765,10 @@ static uae_u8 *restore_chunk (struct zfile *f, TCHAR *name, size_t *len, size_t
 		mem = xcalloc (uae_u8, *totallen + 100);
 		if (!mem)
 			return NULL;
-		if (flags & 1) {
+		if (flags & CHUNK_ZLIB) {
 			zfile_zuncompress (mem, *totallen, f, len2);
+		} else if (flags & CHUNK_FAST) {
+			restore_blocks (mem, *totallen, f, len2);
 		} else {
 			zfile_fread (mem, 1, len2, f);
 		}
@@ -453,12 +798,15 @@ void restore_ram (size_t filepos, uae_u8 *memory)
 	size = restore_u32 ();
 	flags = restore_u32 ();
 	size -= 4 + 4 + 4;
-	if (flags & 1) {
+	if (flags & (CHUNK_ZLIB | CHUNK_FAST)) {
 		zfile_fread (tmp, 1, 4, savestate_file);
 		src = tmp;
 		fullsize = restore_u32 ();
 		size -= 4;
-		zfile_zuncompress (memory, fullsize, savestate_file, size);
+		if (flags & CHUNK_ZLIB)
+			zfile_zuncompress (memory, fullsize, savestate_file, size);
+		else
+			restore_blocks (memory, fullsize, savestate_file, size);
 	} else {
 		zfile_fread (memory, 1, size, savestate_file);
 	}
@@ -502,7 +850,15 @@ void restore_state (const TCHAR *filename)
 	int z3num;
 
 	chunk = 0;
-	f = zfile_fopen (filename, _T("rb"), ZFD_NORMAL);
+	if (snapshot_file) {
+		/* input recording snapshot, statefiles do not store the counters */
+		f = snapshot_file;
+		snapshot_file = NULL;
+		hsync_counter = snapshot_hsync;
+		vsync_counter = snapshot_vsync;
+	} else {
+		f = zfile_fopen (filename, _T("rb"), ZFD_NORMAL);
+	}
 	if (!f)
 		goto error;
 	zfile_fseek (f, 0, SEEK_END);
@@ -523,6 +879,7 @@ void restore_state (const TCHAR *filename)
 	restore_header (chunk);
 	xfree (chunk);
 	restore_cia_start ();
+	lockstep_reset ();
 	changed_prefs.bogomem_size = 0;
 	changed_prefs.chipmem_size = 0;
 	changed_prefs.fastmem_size = 0;
@@ -575,6 +932,8 @@ void restore_state (const TCHAR *filename)
 #endif
 		} else if (!_tcscmp (name, _T("CYCS"))) {
 			end = restore_cycles (chunk);
+		} else if (!_tcscmp (name, _T("LCKS"))) {
+			end = restore_lockstep (chunk);
 		} else if (!_tcscmp (name, _T("CPU "))) {
 			end = restore_cpu (chunk);
 		} else if (!_tcscmp (name, _T("CPUX")))
@@ -757,12 +1116,13 @@ void savestate_restore_finish (void)
 #endif
 	restore_cia_finish ();
 	restore_debug_memwatch_finish ();
+	statehash_reset ();
 	savestate_state = 0;
 	init_hz_normal ();
 	audio_activate ();
 }
 
-/* 1=compressed,2=not compressed,3=ram dump,4=audio dump */
+/* 1=compressed,2=not compressed,3=ram dump,4=audio dump,5=fast compressed */
 void savestate_initsave (const TCHAR *filename, int mode, int nodialogs, bool save)
 {
 	if (filename == NULL) {
@@ -773,7 +1133,7 @@ void savestate_initsave (const TCHAR *filename, int mode, int nodialogs, bool sa
 		return;
 	}
 	_tcscpy (savestate_fname, filename);
-	savestate_docompress = (mode == 1) ? 1 : 0;
+	savestate_docompress = (mode == 1) ? CHUNK_ZLIB : (mode == 5) ? CHUNK_FAST : 0;
 	savestate_specialdump = (mode == 3) ? 1 : (mode == 4) ? 2 : 0;
 	savestate_nodialogs = nodialogs;
 	new_blitter = false;
@@ -783,35 +1143,59 @@ void savestate_initsave (const TCHAR *filename, int mode, int nodialogs, bool sa
 	}
 }
 
+/* compression of the next save_state, same modes as savestate_initsave */
+void savestate_setcompress (int mode)
+{
+	savestate_docompress = (mode == 1) ? CHUNK_ZLIB : (mode == 5) ? CHUNK_FAST : 0;
+}
+
+static int add_ram (struct state_chunk *rams, int num, uae_u8 *dst, int len, const TCHAR *name)
+{
+	if (!dst)
+		return num;
+	rams[num].data = dst;
+	rams[num].len = len;
+	rams[num].name = name;
+	return num + 1;
+}
+
 static void save_rams (struct zfile *f, int comp)
 {
+	struct state_chunk rams[10];
 	uae_u8 *dst;
-	int len;
+	int len, num = 0, i;
 
 	dst = save_cram (&len);
-	save_chunk (f, dst, len, _T("CRAM"), comp);
+	num = add_ram (rams, num, dst, len, _T("CRAM"));
 	dst = save_bram (&len);
-	save_chunk (f, dst, len, _T("BRAM"), comp);
+	num = add_ram (rams, num, dst, len, _T("BRAM"));
 	dst = save_a3000lram (&len);
-	save_chunk (f, dst, len, _T("A3K1"), comp);
+	num = add_ram (rams, num, dst, len, _T("A3K1"));
 	dst = save_a3000hram (&len);
-	save_chunk (f, dst, len, _T("A3K2"), comp);
+	num = add_ram (rams, num, dst, len, _T("A3K2"));
 #ifdef AUTOCONFIG
 	dst = save_fram (&len);
-	save_chunk (f, dst, len, _T("FRAM"), comp);
+	num = add_ram (rams, num, dst, len, _T("FRAM"));
 	dst = save_zram (&len, 0);
-	save_chunk (f, dst, len, _T("ZRAM"), comp);
+	num = add_ram (rams, num, dst, len, _T("ZRAM"));
 	dst = save_zram (&len, 1);
-	save_chunk (f, dst, len, _T("ZRAM"), comp);
+	num = add_ram (rams, num, dst, len, _T("ZRAM"));
 	dst = save_zram (&len, -1);
-	save_chunk (f, dst, len, _T("ZCRM"), comp);
+	num = add_ram (rams, num, dst, len, _T("ZCRM"));
 	dst = save_bootrom (&len);
-	save_chunk (f, dst, len, _T("BORO"), comp);
+	num = add_ram (rams, num, dst, len, _T("BORO"));
 #endif
 #ifdef PICASSO96
 	dst = save_pram (&len);
-	save_chunk (f, dst, len, _T("PRAM"), comp);
+	num = add_ram (rams, num, dst, len, _T("PRAM"));
 #endif
+	/* the memory chunks are most of the statefile, pack them together */
+	if (comp == CHUNK_FAST) {
+		save_chunks_fast (f, rams, num);
+		return;
+	}
+	for (i = 0; i < num; i++)
+		save_chunk (f, rams[i].data, rams[i].len, (TCHAR*)rams[i].name, comp);
 }
 
 /* Save all subsystems */
@@ -838,6 +1222,12 @@ static int save_state_internal (struct zfile *f, const TCHAR *description, int c
 	save_chunk (f, dst, len, _T("CYCS"), 0);
 	xfree (dst);
 
+	dst = save_lockstep (&len, 0);
+	if (dst) {
+		save_chunk (f, dst, len, _T("LCKS"), 0);
+		xfree (dst);
+	}
+
 	dst = save_cpu (&len, 0);
 	save_chunk (f, dst, len, _T("CPU "), 0);
 	xfree (dst);
@@ -1111,7 +1501,7 @@ void savestate_quick (int slot, int save)
 		_stprintf (savestate_fname + i, _T("_%d.uss"), slot);
 	if (save) {
 		write_log (_T("saving '%s'\n"), savestate_fname);
-		savestate_docompress = 1;
+		savestate_docompress = CHUNK_FAST;
 		save_state (savestate_fname, _T(""));
 	} else {
 		if (!zfile_exists (savestate_fname)) {
@@ -1129,6 +1519,7 @@ bool savestate_check (void)
 		if (hsync_counter == 0 && input_play == INPREC_PLAY_NORMAL)
 			savestate_memorysave ();
 		savestate_capture (0);
+		inprec_vsync ();
 	}
 	if (savestate_state == STATE_DORESTORE) {
 		savestate_state = STATE_RESTORE;
@@ -1140,7 +1531,7 @@ bool savestate_check (void)
 	return false;
 }
 
-static int rewindmode;
+static UAE_TLS int rewindmode;
 
 
 static struct staterecord *canrewind (int pos)
@@ -1313,7 +1704,31 @@ void savestate_memorysave (void)
 	zfile_fclose (staterecord_statefile);
 	staterecord_statefile = zfile_fopen_empty (NULL, _T("statefile.inp.uss"), 0);
 	if (staterecord_statefile)
-		save_state_internal (staterecord_statefile, _T("rerecording"), 1, false);
+		save_state_internal (staterecord_statefile, _T("rerecording"), CHUNK_FAST, false);
+}
+
+/* in-memory statefile embedded in input recordings */
+struct zfile *savestate_snapshot (void)
+{
+	struct zfile *f;
+
+	new_blitter = true;
+	f = zfile_fopen_empty (NULL, _T("snapshot.uss"), 0);
+	if (f && !save_state_internal (f, _T("snapshot"), CHUNK_FAST, false)) {
+		zfile_fclose (f);
+		f = NULL;
+	}
+	return f;
+}
+
+/* restore at next vsync, takes ownership of f */
+void savestate_restore_snapshot (struct zfile *f, uae_u32 hsync, uae_u32 vsync)
+{
+	zfile_fclose (snapshot_file);
+	snapshot_file = f;
+	snapshot_hsync = hsync;
+	snapshot_vsync = vsync;
+	savestate_state = STATE_DORESTORE;
 }
 
 void savestate_capture (int force)
@@ -1696,6 +2111,14 @@ void savestate_free (void)
 	staterecords = NULL;
 }
 
+/* the compression threads run code of this module, stop them before it goes */
+void savestate_cleanup (void)
+{
+#ifdef SUPPORT_THREADS
+	free_state_threads ();
+#endif
+}
+
 void savestate_capture_request (void)
 {
 	savestate_first_capture = -1;
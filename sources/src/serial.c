@@ -56,7 +56,7 @@
 #define SERIALDEBUG 1 /* 0, 1, 2 3 */
 #define MODEMTEST   0 /* 0 or 1 */
 
-extern unsigned int ciabpra;
+extern UAE_TLS unsigned int ciabpra;
 
 void serial_open (void);
 void serial_close (void);
@@ -78,10 +78,10 @@ int  SERDATS (void);
 void  SERPER (uae_u16 w);
 void  SERDAT (uae_u16 w);
 
-static char inbuf[1024], outbuf[1024];
-static int inptr, inlast, outlast;
+static UAE_TLS char inbuf[1024], outbuf[1024];
+static UAE_TLS int inptr, inlast, outlast;
 
-int waitqueue=0,
+UAE_TLS int waitqueue=0,
     carrier=0,
     serdev=0,
     dsr=0,
@@ -90,13 +90,13 @@ int waitqueue=0,
     doreadser=0,
     serstat=-1;
 
-int sd = -1;
+UAE_TLS int sd = -1;
 
 #ifdef POSIX_SERIAL
-struct termios tios;
+UAE_TLS struct termios tios;
 #endif
 
-uae_u16 serper=0,serdat;
+UAE_TLS uae_u16 serper=0,serdat;
 
 void SERPER (uae_u16 w)
 {
@@ -26,20 +26,20 @@
 #define LOG_MSG(x) printf(x);
 #define LOG_MSG2(...)
 
-uae_u16 *paula_sndbuffer = NULL;
-uae_u16 *paula_sndbufpt;
-int paula_sndbufsize;
-int sound_initialized = 0;
-int soundcheck = 0;
-int have_sound = 0;
+UAE_TLS uae_u16 *paula_sndbuffer = NULL;
+UAE_TLS uae_u16 *paula_sndbufpt;
+UAE_TLS int paula_sndbufsize;
+UAE_TLS int sound_initialized = 0;
+UAE_TLS int soundcheck = 0;
+UAE_TLS int have_sound = 0;
 
-unsigned long last_time = 0;
-unsigned long now_time;
+UAE_TLS unsigned long last_time = 0;
+UAE_TLS unsigned long now_time;
 
-unsigned long stat_time;
-unsigned long stat_count;
+UAE_TLS unsigned long stat_time;
+UAE_TLS unsigned long stat_count;
 
-static unsigned long scaled_sample_evtime;
+static UAE_TLS unsigned long scaled_sample_evtime;
 
 void sound_mute (int newmute)
 {
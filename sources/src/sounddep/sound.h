@@ -15,12 +15,13 @@ extern int retro_renderSound(short* samples, int sampleCount);
 #define sndbufpt paula_sndbufpt
 #define sndbufsize paula_sndbufsize
 
-extern uae_u16 *paula_sndbuffer;
-extern uae_u16 *paula_sndbufpt;
-extern int paula_sndbufsize;
+extern UAE_TLS uae_u16 *paula_sndbuffer;
+extern UAE_TLS uae_u16 *paula_sndbufpt;
+extern UAE_TLS int paula_sndbufsize;
 extern void driveclick_mix (uae_s16*, int, int);
+extern void cda_audio_mix (uae_s16*, int);
 
-extern int soundcheck;
+extern UAE_TLS int soundcheck;
 
 static __inline__ void check_sound_buffers (void)
 {
@@ -31,6 +32,7 @@ static __inline__ void check_sound_buffers (void)
 #ifdef DRIVESOUND
         driveclick_mix ((uae_s16*)sndbuffer, sndbufsize >> 1,currprefs.dfxclickchannelmask);
 #endif	
+        cda_audio_mix ((uae_s16*)sndbuffer, sndbufsize >> 1);
         retro_renderSound((short*) sndbuffer, sndbufsize >> 1);
         sndbufpt = sndbuffer;
     }
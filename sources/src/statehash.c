@@ -0,0 +1,237 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Per-frame machine state digest
+  *
+  * Every RAM page keeps its own hash, seeded with the region and page
+  * number, and the RAM hash is the xor of all of them: a rehashed page is
+  * swapped in by xoring out its old hash and xoring in the new one. The
+  * frame digest combines the RAM hash with the CPU, custom chip, CIA and
+  * blitter registers, it is not chained to earlier frames so a peer that
+  * loads a statefile agrees from its first frame on.
+  *
+  * Memory is hashed as it is stored (big endian), host word order enters
+  * the result, so digests compare between hosts of the same endianness.
+  */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "options.h"
+#include "memory_uae.h"
+#include "statehash.h"
+
+#define STATEHASH_PAGE (1 << STATEHASH_PAGE_SHIFT)
+
+struct statehash_region {
+	uae_u8 *base;
+	uae_u32 len;
+	int pages;
+	uae_u64 *pagehash;
+};
+
+UAE_TLS uae_u8 *statehash_dirty[STATEHASH_REGIONS];
+
+static UAE_TLS struct statehash_region regions[STATEHASH_REGIONS];
+static UAE_TLS int statehash_checkpoint, statehash_countdown;
+static UAE_TLS bool statehash_full;
+static UAE_TLS uae_u64 statehash_ram, statehash_digest;
+
+uae_u64 statehash_mem (uae_u64 h, const void *p, int len)
+{
+	const uae_u8 *m = (const uae_u8*)p;
+	uae_u64 v;
+
+	for (; len >= 8; len -= 8, m += 8) {
+		memcpy (&v, m, 8);
+		h = statehash_mix (h, v);
+	}
+	if (len > 0) {
+		v = 0;
+		memcpy (&v, m, len);
+		h = statehash_mix (h, v);
+	}
+	return h;
+}
+
+static void region_get (int i, uae_u8 **base, uae_u32 *len)
+{
+	switch (i)
+	{
+	case STATEHASH_CHIP:
+		*base = chipmem_bank.baseaddr;
+		/* agnus may address past the cpu mask and the other way round */
+		*len = chipmem_full_size > chipmem_mask + 1 ? chipmem_full_size : chipmem_mask + 1;
+		break;
+	case STATEHASH_BOGO:
+		*base = bogomem_bank.baseaddr;
+		*len = allocated_bogomem;
+		break;
+	case STATEHASH_FAST:
+		*base = fastmem_bank.baseaddr;
+		*len = allocated_fastmem;
+		break;
+	case STATEHASH_Z3FAST:
+		*base = z3fastmem_bank.baseaddr;
+		*len = allocated_z3fastmem;
+		break;
+	}
+	if (!*base)
+		*len = 0;
+}
+
+static void region_free (int i)
+{
+	struct statehash_region *r = &regions[i];
+
+	xfree (statehash_dirty[i]);
+	statehash_dirty[i] = NULL;
+	xfree (r->pagehash);
+	r->pagehash = NULL;
+	r->base = NULL;
+	r->len = 0;
+	r->pages = 0;
+}
+
+/* memory is reallocated when the configuration changes */
+static void region_check (int i)
+{
+	struct statehash_region *r = &regions[i];
+	uae_u8 *base;
+	uae_u32 len;
+
+	region_get (i, &base, &len);
+	if (base == r->base && len == r->len)
+		return;
+	region_free (i);
+	statehash_full = true;
+	if (!len)
+		return;
+	r->pages = (len + STATEHASH_PAGE - 1) >> STATEHASH_PAGE_SHIFT;
+	r->pagehash = xcalloc (uae_u64, r->pages);
+	/* one spare page for a long write at the very end, rounded for the 64-bit scan */
+	statehash_dirty[i] = xcalloc (uae_u8, (r->pages + 1 + 7) & ~7);
+	if (!r->pagehash || !statehash_dirty[i]) {
+		region_free (i);
+		return;
+	}
+	r->base = base;
+	r->len = len;
+}
+
+static uae_u64 hash_page (int i, int page)
+{
+	struct statehash_region *r = &regions[i];
+	uae_u32 offset = page << STATEHASH_PAGE_SHIFT;
+	int len = r->len - offset < STATEHASH_PAGE ? r->len - offset : STATEHASH_PAGE;
+
+	return statehash_mem (statehash_mix (i, page), r->base + offset, len);
+}
+
+/* returns the number of clean pages that did not match, full only */
+static int region_update (int i, bool full)
+{
+	struct statehash_region *r = &regions[i];
+	uae_u8 *d = statehash_dirty[i];
+	int page, missed = 0;
+
+	if (!r->pages)
+		return 0;
+	for (page = 0; page < r->pages; page += 8) {
+		int j, end;
+		if (!full && !*(uae_u64*)(d + page))
+			continue;
+		end = page + 8 < r->pages ? page + 8 : r->pages;
+		for (j = page; j < end; j++) {
+			uae_u64 h;
+			if (!full && !d[j])
+				continue;
+			h = hash_page (i, j);
+			if (h != r->pagehash[j]) {
+				if (!d[j])
+					missed++;
+				statehash_ram ^= r->pagehash[j] ^ h;
+				r->pagehash[j] = h;
+			}
+			d[j] = 0;
+		}
+	}
+	/* the spare byte, written by a long at the last page boundary */
+	d[r->pages] = 0;
+	return missed;
+}
+
+void statehash_vsync (void)
+{
+	uae_u64 h;
+	bool full;
+	int i, missed = 0;
+
+	if (!statehash_checkpoint)
+		return;
+	for (i = 0; i < STATEHASH_REGIONS; i++)
+		region_check (i);
+	full = statehash_full || --statehash_countdown <= 0;
+	if (statehash_full) {
+		/* new tables: their zero hashes are not in statehash_ram */
+		statehash_ram = 0;
+		for (i = 0; i < STATEHASH_REGIONS; i++) {
+			if (regions[i].pagehash)
+				memset (regions[i].pagehash, 0, regions[i].pages * sizeof (uae_u64));
+		}
+	}
+	for (i = 0; i < STATEHASH_REGIONS; i++)
+		missed += region_update (i, full);
+	if (full) {
+		if (missed && !statehash_full)
+			write_log (_T("STATEHASH: %d page(s) written behind the memory handlers\n"), missed);
+		statehash_countdown = statehash_checkpoint;
+		statehash_full = false;
+	}
+	h = statehash_mix (0, statehash_ram);
+	h = hash_cpu (h);
+	h = hash_custom (h);
+	h = hash_cia (h);
+	h = hash_blitter (h);
+	statehash_digest = h;
+}
+
+/* also called right after RAM is reallocated: the write handlers index
+ * the dirty tables with the new masks before the next vsync */
+void statehash_reset (void)
+{
+	int i;
+
+	statehash_full = true;
+	if (!statehash_checkpoint)
+		return;
+	for (i = 0; i < STATEHASH_REGIONS; i++)
+		region_check (i);
+}
+
+void statehash_enable (int checkpoint)
+{
+	int i;
+
+	if (checkpoint < 0)
+		checkpoint = 0;
+	if (checkpoint == statehash_checkpoint)
+		return;
+	if (!checkpoint) {
+		for (i = 0; i < STATEHASH_REGIONS; i++)
+			region_free (i);
+		statehash_digest = 0;
+	}
+	statehash_checkpoint = checkpoint;
+	statehash_countdown = checkpoint;
+	statehash_full = true;
+	if (checkpoint)
+		write_log (_T("STATEHASH: on, full RAM pass every %d frames\n"), checkpoint);
+	else
+		write_log (_T("STATEHASH: off\n"));
+}
+
+uae_u64 statehash_get (void)
+{
+	return statehash_digest;
+}
@@ -14,8 +14,8 @@
 #include "statusline.h"
 
 #ifdef __LIBRETRO__
-extern int opt_statusbar_position;
-extern int LEDON;
+extern UAE_TLS int opt_statusbar_position;
+extern UAE_TLS int LEDON;
 #endif
 
 /*
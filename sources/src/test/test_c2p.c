@@ -0,0 +1,128 @@
+ /*
+  * UAE - The Un*x Amiga Emulator
+  *
+  * Test for the Akiko chunky to planar kernels: the scalar kernel against
+  * the bit by bit reference, and the SSE2/NEON kernel, where the compiler
+  * targets one, against the scalar kernel. Random input plus a few fixed
+  * patterns.
+  */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "akiko_c2p.c"
+
+#define NUM_RANDOM 1000000
+
+int num_fails;
+int num_tests;
+
+static uae_u32 rnd_state = 0x2545f491;
+
+static uae_u32 rnd (void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+/* What akiko.c used before the precalculated tables */
+static void c2p_reference (const uae_u32 *buffer, uae_u32 *result)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+	result[i] = 0;
+    for (i = 0; i < 8 * 32; i++) {
+	if (buffer[7 - (i >> 5)] & (1u << (i & 31)))
+	    result[i & 7] |= 1u << (i >> 3);
+    }
+}
+
+static void print_words (const char *name, const uae_u32 *w)
+{
+    int i;
+
+    printf ("  %-9s", name);
+    for (i = 0; i < 8; i++)
+	printf (" %08x", w[i]);
+    printf ("\n");
+}
+
+static void test_c2p (const uae_u32 *buffer)
+{
+    uae_u32 ref[8], scalar[8];
+#ifdef AKIKO_C2P_SIMD
+    uae_u32 simd[8];
+#endif
+    int fail = 0;
+
+    num_tests++;
+
+    c2p_reference (buffer, ref);
+    akiko_c2p_scalar (buffer, scalar);
+    if (memcmp (ref, scalar, sizeof ref))
+	fail = 1;
+#ifdef AKIKO_C2P_SIMD
+    akiko_c2p_simd (buffer, simd);
+    if (memcmp (scalar, simd, sizeof scalar))
+	fail = 1;
+#endif
+
+    if (fail) {
+	if (num_fails < 10) {
+	    printf ("C2P mismatch\n");
+	    print_words ("input", buffer);
+	    print_words ("reference", ref);
+	    print_words ("scalar", scalar);
+#ifdef AKIKO_C2P_SIMD
+	    print_words ("simd", simd);
+#endif
+	}
+	num_fails++;
+    }
+}
+
+int main (void)
+{
+    uae_u32 buffer[8];
+    int i, j;
+
+    akiko_precalculate ();
+
+    for (i = 0; i < 8; i++)
+	buffer[i] = 0;
+    test_c2p (buffer);
+    for (i = 0; i < 8; i++)
+	buffer[i] = 0xffffffff;
+    test_c2p (buffer);
+
+    /* every single input bit on its own */
+    for (i = 0; i < 8 * 32; i++) {
+	for (j = 0; j < 8; j++)
+	    buffer[j] = 0;
+	buffer[i >> 5] = 1u << (i & 31);
+	test_c2p (buffer);
+    }
+
+    for (i = 0; i < NUM_RANDOM; i++) {
+	for (j = 0; j < 8; j++)
+	    buffer[j] = rnd ();
+	test_c2p (buffer);
+    }
+
+#if defined(AKIKO_C2P_SSE2)
+    printf ("C2P: SSE2 and scalar kernels, %d tests.\n", num_tests);
+#elif defined(AKIKO_C2P_NEON)
+    printf ("C2P: NEON and scalar kernels, %d tests.\n", num_tests);
+#else
+    printf ("C2P: scalar kernel only, %d tests.\n", num_tests);
+#endif
+    if (num_fails)
+	printf ("%d tests failed.\n", num_fails);
+    return num_fails != 0;
+}
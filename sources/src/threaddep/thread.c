@@ -9,7 +9,153 @@
   * This handles initialization when using named semaphores.
   * Idea stolen from SDL.
   */
-#ifdef _WIN32
+#ifdef UAE_MULTI_INSTANCE
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include <libco.h>
+
+#include "sleep.h"
+#include "thread.h"
+
+#define COTHREAD_STACK (1024 * 1024)
+
+struct uae_cothread {
+	cothread_t co;
+	void *(*f) (void *);
+	void *arg;
+	int detached;
+	int finished;
+	struct uae_cothread *next;
+};
+
+UAE_TLS int uae_thread_count;
+static UAE_TLS struct uae_cothread *cothreads;
+static UAE_TLS struct uae_cothread *cothread_current;
+static UAE_TLS cothread_t cothread_caller;
+
+int uae_sem_init (uae_sem_t *sem, int pshared, unsigned int value)
+{
+	if (!sem || sem->sem)
+		return -1;
+	sem->sem = xcalloc (int, 1);
+	*sem->sem = value;
+	return 0;
+}
+
+int uae_sem_destroy (uae_sem_t *sem)
+{
+	xfree (sem->sem);
+	sem->sem = NULL;
+	return 0;
+}
+
+int uae_sem_wait (uae_sem_t *sem)
+{
+	while (*sem->sem <= 0)
+		uae_thread_yield ();
+	(*sem->sem)--;
+	return 0;
+}
+
+void uae_thread_exit (void)
+{
+	cothread_current->finished = 1;
+	for (;;)
+		co_switch (cothread_caller);
+}
+
+static void cothread_entry (void)
+{
+	struct uae_cothread *t = cothread_current;
+
+	t->f (t->arg);
+	uae_thread_exit ();
+}
+
+/* runs each helper thread until it blocks, sleeps or ends */
+void uae_thread_run_all (void)
+{
+	struct uae_cothread **tp = &cothreads;
+
+	if (cothread_current)
+		return;
+	while (*tp) {
+		struct uae_cothread *t = *tp;
+		if (!t->finished) {
+			cothread_caller = co_active ();
+			cothread_current = t;
+			co_switch (t->co);
+			cothread_current = NULL;
+		}
+		if (t->finished && t->detached) {
+			*tp = t->next;
+			co_delete (t->co);
+			xfree (t);
+			uae_thread_count--;
+			continue;
+		}
+		tp = &t->next;
+	}
+}
+
+void uae_thread_yield (void)
+{
+	if (cothread_current)
+		co_switch (cothread_caller);
+	else
+		uae_thread_run_all ();
+}
+
+void uae_thread_sleep (int ms)
+{
+	if (cothread_current) {
+		co_switch (cothread_caller);
+		return;
+	}
+	uae_thread_run_all ();
+	uae_msleep (ms);
+}
+
+int uae_start_thread (const TCHAR *name, void *(*f) (void *), void *arg, uae_thread_id *thread)
+{
+	struct uae_cothread *t, **tp;
+
+	t = xcalloc (struct uae_cothread, 1);
+	if (t)
+		t->co = co_create (COTHREAD_STACK, cothread_entry);
+	if (!t || !t->co) {
+		xfree (t);
+		write_log (_T("Thread '%s' failed to start!?\n"), name ? name : _T("<unknown>"));
+		return 0;
+	}
+	t->f = f;
+	t->arg = arg;
+	t->detached = thread == NULL;
+	/* appended, uae_thread_run_all () may be walking the list */
+	for (tp = &cothreads; *tp; tp = &(*tp)->next);
+	*tp = t;
+	uae_thread_count++;
+	if (thread)
+		*thread = t;
+	return 1;
+}
+
+int uae_wait_thread (uae_thread_id thread)
+{
+	while (!thread->finished)
+		uae_thread_yield ();
+	thread->detached = 1;
+	return 0;
+}
+
+void uae_kill_thread (uae_thread_id *thread)
+{
+	(*thread)->detached = 1;
+}
+
+#elif defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <process.h>
@@ -6,7 +6,67 @@
   * Copyright 1997 Bernd Schmidt
   * Copyright 2004 Richard Drummond
   */
-#ifdef _WIN32
+#ifdef UAE_MULTI_INSTANCE
+
+/* Several emulated machines in one process, each on its own host thread
+ * with thread local state. The helper threads of a machine are cothreads
+ * of its host thread: they run while the emulation waits on a semaphore
+ * or calls uae_thread_run (), and switch back when they block. */
+
+typedef struct {
+	int *sem;
+} uae_sem_t;
+
+typedef struct uae_cothread *uae_thread_id;
+#define BAD_THREAD 0
+
+extern int uae_sem_init (uae_sem_t *sem, int pshared, unsigned int value);
+extern int uae_sem_destroy (uae_sem_t *sem);
+extern int uae_sem_wait (uae_sem_t *sem);
+
+STATIC_INLINE int uae_sem_post (uae_sem_t *sem)
+{
+	(*sem->sem)++;
+	return 0;
+}
+
+STATIC_INLINE int uae_sem_trywait (uae_sem_t *sem)
+{
+	if (*sem->sem <= 0)
+		return -1;
+	(*sem->sem)--;
+	return 0;
+}
+
+STATIC_INLINE int uae_sem_getvalue (uae_sem_t *sem, int *sval)
+{
+	*sval = *sem->sem;
+	return 0;
+}
+
+#include "commpipe.h"
+
+extern int uae_start_thread (const TCHAR *name, void *(*f) (void *), void *arg, uae_thread_id *thread);
+extern int uae_wait_thread (uae_thread_id thread);
+extern void uae_kill_thread (uae_thread_id *thread);
+extern void uae_thread_exit (void);
+extern void uae_thread_yield (void);
+extern void uae_thread_run_all (void);
+
+#define UAE_THREAD_EXIT uae_thread_exit ()
+
+#define uae_set_thread_priority(pri)
+
+extern UAE_TLS int uae_thread_count;
+
+/* gives the helper threads of this machine a turn */
+STATIC_INLINE void uae_thread_run (void)
+{
+	if (uae_thread_count)
+		uae_thread_run_all ();
+}
+
+#elif defined(_WIN32)
 
 #define WIN32_LEAN_AND_MEAN
 typedef HANDLE uae_sem_t;
@@ -229,8 +289,12 @@ typedef pthread_t uae_thread_id;
 
 STATIC_INLINE int uae_start_thread (char *name, void *(*f) (void *), void *arg, uae_thread_id *foo)
 {
+	uae_thread_id tid;
 	int result;
-	result = pthread_create (foo, 0, f, arg);
+	/* callers that do not want the id get a detached thread */
+	result = pthread_create (foo ? foo : &tid, 0, f, arg);
+	if (result == 0 && !foo)
+		pthread_detach (tid);
 
 	return 0 == result;
 }
@@ -251,3 +315,7 @@ STATIC_INLINE void uae_kill_thread (uae_thread_id* thread)
 #define uae_set_thread_priority(pri)
 
 #endif
+
+#ifndef UAE_MULTI_INSTANCE
+#define uae_thread_run()
+#endif
@@ -21,6 +21,11 @@
 #include "autoconf.h"
 #include "traps.h"
 
+#ifdef __LIBRETRO__
+#define TRAP_COROUTINES
+#include <libco.h>
+#endif
+
 /*
  * Traps are the mechanism via which 68k code can call emulator code
  * (and for that emulator code in turn to call 68k code). They are
@@ -56,6 +61,11 @@
  * of paranoia when it comes to thread synchronization. Once all the
  * bugs are knocked out of the bsdsocket emulation, a simpler scheme may
  * suffice.
+ *
+ * With TRAP_COROUTINES the trap context is a libco coroutine of the
+ * emulator thread instead. Switching between the two is a plain stack
+ * switch and no lock is needed, as only one of them runs at any time.
+ * Coroutines are kept in a pool and reused by later traps.
  */
 
 /*
@@ -72,8 +82,8 @@ struct Trap
 #define MAX_TRAPS 4096
 
 /* Defined traps */
-static struct Trap  traps[MAX_TRAPS];
-static unsigned int trap_count = 1;
+static UAE_TLS struct Trap  traps[MAX_TRAPS];
+static UAE_TLS unsigned int trap_count = 1;
 
 
 static const int trace_traps = 0;
@@ -203,12 +213,19 @@ struct TrapContext
 	//struct regstruct saved_regs;
 	struct TrapCPUContext saved_regs;
 
+#ifdef TRAP_COROUTINES
+	/* Coroutine which effects the trap context. */
+	struct trap_coroutine *co;
+	/* Emulator context to switch back to. */
+	cothread_t emu;
+#else
 	/* Thread which effects the trap context. */
 	uae_thread_id thread;
 	/* For IPC between the main emulator. */
 	uae_sem_t switch_to_emu_sem;
 	/* context and the trap context. */
 	uae_sem_t switch_to_trap_sem;
+#endif
 
 	/* When calling a 68k function from a trap handler, this is set to the
 	* address of the function to call.  */
@@ -232,26 +249,27 @@ static void copyfromcpucontext(struct TrapCPUContext *cpu, uae_u32 pc)
 
 
 /* 68k addresses which invoke the corresponding traps. */
-static uaecptr m68k_call_trapaddr;
-static uaecptr m68k_return_trapaddr;
-static uaecptr exit_trap_trapaddr;
+static UAE_TLS uaecptr m68k_call_trapaddr;
+static UAE_TLS uaecptr m68k_return_trapaddr;
+static UAE_TLS uaecptr exit_trap_trapaddr;
 
 /* For IPC between main thread and trap context */
-static uae_sem_t trap_mutex;
-static TrapContext *current_context;
+#ifdef TRAP_COROUTINES
+#define trap_lock()
+#define trap_unlock()
+#else
+static UAE_TLS uae_sem_t trap_mutex;
+#define trap_lock() uae_sem_wait (&trap_mutex)
+#define trap_unlock() uae_sem_post (&trap_mutex)
+#endif
+static UAE_TLS TrapContext *current_context;
 
 
 /*
- * Thread body for trap context
+ * Run the trap handler function on the trap context
  */
-static void *trap_thread (void *arg)
+static void trap_run_handler (TrapContext *context)
 {
-	TrapContext *context = (TrapContext *) arg;
-
-	/* Wait until main thread is ready to switch to the
-	 * this trap context. */
-	uae_sem_wait (&context->switch_to_trap_sem);
-
 	/* Execute trap handler function. */
 	context->trap_retval = context->trap_handler (context);
 
@@ -263,7 +281,7 @@ static void *trap_thread (void *arg)
 	 */
 
 	/* Enter critical section - only one trap at a time, please! */
-	uae_sem_wait (&trap_mutex);
+	trap_lock ();
 
 	//regs = context->saved_regs;
 	/* Set PC to address of the exit handler, so that it will be called
@@ -276,6 +294,109 @@ static void *trap_thread (void *arg)
 
 	//m68k_setpc (exit_trap_trapaddr);
 	current_context = context;
+}
+
+#ifdef TRAP_COROUTINES
+
+#define TRAP_STACK (1024 * 1024)
+#define TRAP_POOL 4
+
+struct trap_coroutine
+{
+	cothread_t co;
+	struct trap_coroutine *next;
+};
+
+/* Idle coroutines, ready for the next trap */
+static UAE_TLS struct trap_coroutine *trap_pool;
+static UAE_TLS int trap_pool_size;
+/* Context a coroutine picks up when it is switched to for a new trap */
+static UAE_TLS TrapContext *trap_starting;
+
+/*
+ * Coroutine body for trap contexts. It runs one handler per
+ * switch from trap_start () and is reused until the pool is full.
+ */
+static void trap_coroutine (void)
+{
+	for (;;) {
+		TrapContext *context = trap_starting;
+
+		trap_run_handler (context);
+
+		/* Switch back to 68k context, the next trap starts from here */
+		co_switch (context->emu);
+	}
+}
+
+static bool trap_start (TrapContext *context)
+{
+	struct trap_coroutine *tc = trap_pool;
+
+	if (tc) {
+		trap_pool = tc->next;
+		trap_pool_size--;
+	} else {
+		tc = xcalloc (struct trap_coroutine, 1);
+		if (!tc)
+			return false;
+		tc->co = co_create (TRAP_STACK, trap_coroutine);
+		if (!tc->co) {
+			write_log (_T("Trap coroutine failed to start!?\n"));
+			xfree (tc);
+			return false;
+		}
+	}
+	context->co = tc;
+	context->emu = co_active ();
+	trap_starting = context;
+
+	/* Run trap handler until it is done or wants to call 68k code. */
+	co_switch (tc->co);
+	return true;
+}
+
+/* Called by the trap context, returns when the emulator switches back */
+STATIC_INLINE void trap_switch_to_emu (TrapContext *context)
+{
+	co_switch (context->emu);
+}
+
+/* Called by the emulator, returns when the trap context switches back */
+STATIC_INLINE void trap_switch_to_trap (TrapContext *context)
+{
+	context->emu = co_active ();
+	co_switch (context->co->co);
+}
+
+static void trap_end (TrapContext *context)
+{
+	struct trap_coroutine *tc = context->co;
+
+	if (trap_pool_size < TRAP_POOL) {
+		tc->next = trap_pool;
+		trap_pool = tc;
+		trap_pool_size++;
+	} else {
+		co_delete (tc->co);
+		xfree (tc);
+	}
+}
+
+#else
+
+/*
+ * Thread body for trap context
+ */
+static void *trap_thread (void *arg)
+{
+	TrapContext *context = (TrapContext *) arg;
+
+	/* Wait until main thread is ready to switch to the
+	 * this trap context. */
+	uae_sem_wait (&context->switch_to_trap_sem);
+
+	trap_run_handler (context);
 
 	/* Switch back to 68k context */
 	uae_sem_post (&context->switch_to_emu_sem);
@@ -286,6 +407,50 @@ static void *trap_thread (void *arg)
 	return 0;
 }
 
+static bool trap_start (TrapContext *context)
+{
+	uae_sem_init (&context->switch_to_trap_sem, 0, 0);
+	uae_sem_init (&context->switch_to_emu_sem, 0, 0);
+
+	/* Start thread to handle new trap context. */
+	uae_start_thread ("Trap", trap_thread, (void *)context, &context->thread);
+
+	/* Switch to trap context to begin execution of
+	 * trap handler function.
+	 */
+	uae_sem_post (&context->switch_to_trap_sem);
+
+	/* Wait for trap context to switch back to us.
+	 *
+	 * It'll do this when the trap handler is done - or when
+	 * the handler wants to call 68k code. */
+	uae_sem_wait (&context->switch_to_emu_sem);
+	return true;
+}
+
+STATIC_INLINE void trap_switch_to_emu (TrapContext *context)
+{
+	uae_sem_post (&context->switch_to_emu_sem);
+	uae_sem_wait (&context->switch_to_trap_sem);
+}
+
+STATIC_INLINE void trap_switch_to_trap (TrapContext *context)
+{
+	uae_sem_post (&context->switch_to_trap_sem);
+	uae_sem_wait (&context->switch_to_emu_sem);
+}
+
+static void trap_end (TrapContext *context)
+{
+	/* Wait for trap context thread to exit. */
+	uae_wait_thread (context->thread);
+
+	uae_sem_destroy (&context->switch_to_trap_sem);
+	uae_sem_destroy (&context->switch_to_emu_sem);
+}
+
+#endif
+
 /*
  * Set up extended trap context and call handler function
  */
@@ -294,28 +459,14 @@ static void trap_HandleExtendedTrap (TrapHandler handler_func, int has_retval)
 	struct TrapContext *context = xcalloc (TrapContext, 1);
 
 	if (context) {
-		uae_sem_init (&context->switch_to_trap_sem, 0, 0);
-		uae_sem_init (&context->switch_to_emu_sem, 0, 0);
-
 		context->trap_handler = handler_func;
 		context->trap_has_retval = has_retval;
 
 		//context->saved_regs = regs;
 		copytocpucontext (&context->saved_regs);
 
-		/* Start thread to handle new trap context. */
-		uae_start_thread ("Trap", trap_thread, (void *)context, &context->thread);
-
-		/* Switch to trap context to begin execution of
-		 * trap handler function.
-		 */
-		uae_sem_post (&context->switch_to_trap_sem);
-
-		/* Wait for trap context to switch back to us.
-		 *
-		 * It'll do this when the trap handler is done - or when
-		 * the handler wants to call 68k code. */
-		uae_sem_wait (&context->switch_to_emu_sem);
+		if (!trap_start (context))
+			xfree (context);
 	}
 }
 
@@ -327,7 +478,7 @@ static void trap_HandleExtendedTrap (TrapHandler handler_func, int has_retval)
 static uae_u32 trap_Call68k (TrapContext *context, uaecptr func_addr)
 {
 	/* Enter critical section - only one trap at a time, please! */
-	uae_sem_wait (&trap_mutex);
+	trap_lock ();
 	current_context = context;
 
 	/* Don't allow an interrupt and thus potentially another
@@ -343,14 +494,12 @@ static uae_u32 trap_Call68k (TrapContext *context, uaecptr func_addr)
 	m68k_setpc (m68k_call_trapaddr);
 	fill_prefetch ();
 
-	/* Switch to emulator context. */
-	uae_sem_post (&context->switch_to_emu_sem);
-
-	/* Wait for 68k call return handler to switch back to us. */
-	uae_sem_wait (&context->switch_to_trap_sem);
+	/* Switch to emulator context and wait for 68k call
+	 * return handler to switch back to us. */
+	trap_switch_to_emu (context);
 
 	/* End critical section. */
-	uae_sem_post (&trap_mutex);
+	trap_unlock ();
 
 	/* Get return value from 68k function called. */
 	return context->call68k_retval;
@@ -385,7 +534,7 @@ static uae_u32 REGPARAM2 m68k_call_handler (TrapContext *dummy_ctx)
 	fill_prefetch ();
 
 	/* End critical section: allow other traps run. */
-	uae_sem_post (&trap_mutex);
+	trap_unlock ();
 
 	/* Restore interrupts. */
 	regs.intmask = context->saved_regs.intmask;
@@ -403,7 +552,7 @@ static uae_u32 REGPARAM2 m68k_return_handler (TrapContext *dummy_ctx)
 	uae_u32 sp;
 
 	/* One trap returning at a time, please! */
-	uae_sem_wait (&trap_mutex);
+	trap_lock ();
 
 	/* Get trap context from 68k stack. */
 	sp = m68k_areg (regs, 7);
@@ -414,14 +563,11 @@ static uae_u32 REGPARAM2 m68k_return_handler (TrapContext *dummy_ctx)
 	/* Get return value from the 68k call. */
 	context->call68k_retval = m68k_dreg (regs, 0);
 
-	/* Switch back to trap context. */
-	uae_sem_post (&context->switch_to_trap_sem);
-
-	/* Wait for trap context to switch back to us.
+	/* Switch back to trap context and wait for it to switch back to us.
 	 *
 	 * It'll do this when the trap handler is done - or when
 	 * the handler wants to call another 68k function. */
-	uae_sem_wait (&context->switch_to_emu_sem);
+	trap_switch_to_trap (context);
 
 	/* Dummy return value. */
 	return 0;
@@ -435,8 +581,7 @@ static uae_u32 REGPARAM2 exit_trap_handler (TrapContext *dummy_ctx)
 {
 	TrapContext *context = current_context;
 
-	/* Wait for trap context thread to exit. */
-	uae_wait_thread (context->thread);
+	trap_end (context);
 
 	/* Restore 68k state saved at trap entry. */
 	//regs = context->saved_regs;
@@ -447,13 +592,10 @@ static uae_u32 REGPARAM2 exit_trap_handler (TrapContext *dummy_ctx)
 	if (context->trap_has_retval)
 		m68k_dreg (regs, 0) = context->trap_retval;
 
-	uae_sem_destroy (&context->switch_to_trap_sem);
-	uae_sem_destroy (&context->switch_to_emu_sem);
-
 	xfree (context);
 
 	/* End critical section */
-	uae_sem_post (&trap_mutex);
+	trap_unlock ();
 
 	/* Dummy return value. */
 	return 0;
@@ -507,5 +649,7 @@ void init_extended_traps (void)
 	exit_trap_trapaddr = here();
 	calltrap (deftrap2 (exit_trap_handler, TRAPFLAG_NO_RETVAL, _T("exit_trap")));
 
+#ifndef TRAP_COROUTINES
 	uae_sem_init (&trap_mutex, 0, 1);
+#endif
 }
@@ -17,9 +17,9 @@
 #include "uaeexe.h"
 #include "misc.h"
 
-static struct uae_xcmd *first = NULL;
-static struct uae_xcmd *last  = NULL;
-static TCHAR running = 0;
+static UAE_TLS struct uae_xcmd *first = NULL;
+static UAE_TLS struct uae_xcmd *last  = NULL;
+static UAE_TLS TCHAR running = 0;
 static uae_u32 REGPARAM3 uaeexe_server (TrapContext *context) REGPARAM;
 
 /*
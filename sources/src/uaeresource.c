@@ -38,7 +38,7 @@ struct uaebase
 
 #endif
 
-static uaecptr res_init, res_name, res_id, base;
+static UAE_TLS uaecptr res_init, res_name, res_id, base;
 
 static uae_u32 REGPARAM2 res_getfunc (TrapContext *ctx)
 {
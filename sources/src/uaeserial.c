@@ -25,7 +25,7 @@
 
 #define MAX_TOTAL_DEVICES 8
 
-int log_uaeserial = 0;
+UAE_TLS int log_uaeserial = 0;
 
 #define SDCMD_QUERY	9
 #define SDCMD_BREAK	10
@@ -126,10 +126,10 @@ struct devstruct {
 	void *sysdata;
 };
 
-static int uniq;
-static uae_u32 nscmd_cmd;
-static struct devstruct devst[MAX_TOTAL_DEVICES];
-static uae_sem_t change_sem, async_sem;
+static UAE_TLS int uniq;
+static UAE_TLS uae_u32 nscmd_cmd;
+static UAE_TLS struct devstruct devst[MAX_TOTAL_DEVICES];
+static UAE_TLS uae_sem_t change_sem, async_sem;
 
 static TCHAR *getdevname (void)
 {
@@ -652,7 +652,7 @@ static void dev_reset (void)
 	}
 }
 
-static uaecptr ROM_uaeserialdev_resname = 0,
+static UAE_TLS uaecptr ROM_uaeserialdev_resname = 0,
 	ROM_uaeserialdev_resid = 0,
 	ROM_uaeserialdev_init = 0;
 
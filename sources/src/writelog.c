@@ -95,8 +95,8 @@ void write_dlog (const char *format, ...)
 #endif
 }
 
-static char *console_buffer;
-static int console_buffer_size;
+static UAE_TLS char *console_buffer;
+static UAE_TLS int console_buffer_size;
 
 char *setconsolemode (char *buffer, int maxlen)
 {
@@ -32,7 +32,7 @@
 #include <stdarg.h>
 #include "misc.h"
 
-static struct zfile *zlist = 0;
+static UAE_TLS struct zfile *zlist = 0;
 
 const TCHAR *uae_archive_extensions[] = { _T("zip"), _T("rar"), _T("7z"), _T("lha"), _T("lzh"), _T("lzx"), _T("tar"), NULL };
 
@@ -57,7 +57,7 @@ struct zcache
 	struct zcache *next;
 	time_t tm;
 };
-static struct zcache *zcachedata;
+static UAE_TLS struct zcache *zcachedata;
 
 static struct zcache *cache_get (const TCHAR *name)
 {
@@ -2279,7 +2279,7 @@ uae_u32 zfile_crc32 (struct zfile *f)
 	return crc;
 }
 
-static struct zvolume *zvolume_list;
+static UAE_TLS struct zvolume *zvolume_list;
 
 static void recurparent (TCHAR *newpath, struct znode *zn, int recurse)
 {